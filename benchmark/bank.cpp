@@ -0,0 +1,100 @@
+#include <benchmark/benchmark.h>
+
+#include "synthetic.hpp"
+#include "containers/files/mid2smps/gyb.hpp"
+#include "containers/instrument_index.hpp"
+#include "helpers/copy_on_write.hpp"
+
+namespace MID3SMPS::benchmark {
+	namespace {
+		void instrument_bank_insert(::benchmark::State &state) {
+			const auto count = static_cast<std::size_t>(state.range(0));
+			for(auto _ : state) {
+				M2S::gyb bank;
+				const auto id = bank.add_bank("Benchmark");
+				for(std::size_t idx = 0; idx < count; idx++) {
+					bank.add_patch(id);
+				}
+				::benchmark::DoNotOptimize(bank.instruments.size());
+			}
+			state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+		}
+		BENCHMARK(instrument_bank_insert)->Arg(128)->Arg(1024)->Arg(8192);
+
+		void instrument_bank_lookup(::benchmark::State &state) {
+			const auto count = static_cast<std::size_t>(state.range(0));
+			M2S::gyb bank;
+			const auto id = bank.add_bank("Benchmark");
+			for(std::size_t idx = 0; idx < count; idx++) {
+				bank.add_patch(id);
+			}
+			const auto &order = bank.instruments_order->at(id);
+			for(auto _ : state) {
+				std::size_t total = 0;
+				for(const auto key : order) {
+					total += bank.instruments.at(key)->name.size();
+				}
+				::benchmark::DoNotOptimize(total);
+			}
+			state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+		}
+		BENCHMARK(instrument_bank_lookup)->Arg(128)->Arg(1024)->Arg(8192);
+
+		void instrument_bank_add_bank(::benchmark::State &state) {
+			const auto count = static_cast<std::size_t>(state.range(0));
+			for(auto _ : state) {
+				M2S::gyb bank;
+				for(std::size_t idx = 0; idx < count; idx++) {
+					::benchmark::DoNotOptimize(bank.add_bank("Bank " + std::to_string(idx)));
+				}
+			}
+			state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+		}
+		BENCHMARK(instrument_bank_add_bank)->Arg(16)->Arg(128);
+
+		// What the editor pays for its first edit after a background job took a snapshot, should be the same for any bank size
+		void instrument_bank_snapshot_edit(::benchmark::State &state) {
+			const auto count = static_cast<std::size_t>(state.range(0));
+			copy_on_write<M2S::gyb> bank;
+			const auto id = bank.write().add_bank("Benchmark");
+			for(std::size_t idx = 0; idx < count; idx++) {
+				bank.write().add_patch(id);
+			}
+			const auto key = bank->instruments_order->at(id)[count / 2];
+			for(auto _ : state) {
+				const auto snapshot = bank.snapshot();
+				::benchmark::DoNotOptimize(&bank.write().writable(key));
+			}
+		}
+		BENCHMARK(instrument_bank_snapshot_edit)->Arg(128)->Arg(8192)->Arg(32768);
+	
+		void instrument_index_build(::benchmark::State &state) {
+			const auto patches = static_cast<std::uint16_t>(state.range(0));
+			const temp_file file(make_gyb(patches, patches / 2), "mid3smps_benchmark.gyb");
+			const M2S::gyb bank(file.path());
+			for(auto _ : state) {
+				const instrument_index index(bank);
+				::benchmark::DoNotOptimize(index.size());
+			}
+			state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(bank.instruments.size()));
+		}
+		BENCHMARK(instrument_index_build)->Arg(1024)->Arg(32768)->Unit(::benchmark::kMillisecond);
+
+		// One search per keystroke, has to stay well below a frame
+		void instrument_index_search(::benchmark::State &state, const char *text) {
+			const auto patches = static_cast<std::uint16_t>(state.range(0));
+			const temp_file file(make_gyb(patches, patches / 2), "mid3smps_benchmark.gyb");
+			const M2S::gyb bank(file.path());
+			const instrument_index index(bank);
+			const auto search = instrument_index::query::parse(text);
+			for(auto _ : state) {
+				::benchmark::DoNotOptimize(index.search(search));
+			}
+			state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(index.size()));
+		}
+		BENCHMARK_CAPTURE(instrument_index_search, name, "melody 12")->Arg(1024)->Arg(32768)->Unit(::benchmark::kMicrosecond);
+		BENCHMARK_CAPTURE(instrument_index_search, fuzzy_name, "melodi")->Arg(1024)->Arg(32768)->Unit(::benchmark::kMicrosecond);
+		BENCHMARK_CAPTURE(instrument_index_search, predicates, "alg==7 fb>=5 ar<10")->Arg(1024)->Arg(32768)->Unit(::benchmark::kMicrosecond);
+		BENCHMARK_CAPTURE(instrument_index_search, mixed, "drum ar2<16 tl1>64")->Arg(1024)->Arg(32768)->Unit(::benchmark::kMicrosecond);
+	}
+}
@@ -0,0 +1,57 @@
+#include <benchmark/benchmark.h>
+#include <libremidi/reader.hpp>
+
+#include "synthetic.hpp"
+#include "containers/midi/event_store.hpp"
+#include "containers/smps/simulator.hpp"
+#include "conversion/tempo_solver.hpp"
+
+namespace MID3SMPS::benchmark {
+	namespace {
+		midi::event_store make_events(const std::uint32_t density) {
+			libremidi::reader reader;
+			reader.parse(make_midi(16, 256, density));
+			return midi::event_store(reader);
+		}
+
+		void tempo_solve(::benchmark::State &state) {
+			const auto events = make_events(static_cast<std::uint32_t>(state.range(0)));
+			for(auto _ : state) {
+				conversion::tempo_solver solver(events);
+				for(const auto &profile : smps::profiles) {
+					::benchmark::DoNotOptimize(solver.solve(profile, smps::ntsc_frame_rate));
+				}
+			}
+			state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(events.event_count()));
+		}
+		BENCHMARK(tempo_solve)->Arg(1)->Arg(4)->Arg(16)->Unit(::benchmark::kMillisecond);
+
+		// Sonic 1 layout: one FM track alternating notes and durations, looping back to its start
+		std::vector<std::uint8_t> make_smps(const std::uint32_t notes) {
+			std::vector<std::uint8_t> song = {0x00, 0x00, 0x02, 0x00, 0x01, 0x00, 0x00, 0x0E, 0x00, 0x00, 0x00, 0x0F, 0x00, 0x00};
+			song.insert(song.end(), {0xF2}); // DAC track stops straight away
+			for(std::uint32_t idx = 0; idx < notes; idx++) {
+				song.push_back(static_cast<std::uint8_t>(0x81 + idx % 0x5E));
+				song.push_back(static_cast<std::uint8_t>(1 + idx % 6));
+			}
+			song.push_back(0xF6);
+			const auto distance = static_cast<std::uint16_t>(0x0F - static_cast<std::int32_t>(song.size()) - 1);
+			song.push_back(static_cast<std::uint8_t>(distance >> 8));
+			song.push_back(static_cast<std::uint8_t>(distance));
+			return song;
+		}
+
+		void smps_simulate(::benchmark::State &state) {
+			const auto song = make_smps(static_cast<std::uint32_t>(state.range(0)));
+			smps::simulator simulator(song, smps::profiles[0]);
+			std::size_t events = 0;
+			for(auto _ : state) {
+				const auto result = simulator.run();
+				events = result.events.size();
+				::benchmark::DoNotOptimize(events);
+			}
+			state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(events));
+		}
+		BENCHMARK(smps_simulate)->Arg(256)->Arg(4096);
+	}
+}
@@ -0,0 +1,42 @@
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <benchmark/benchmark.h>
+
+#include "synthetic.hpp"
+#include "conversion/dac/encoder.hpp"
+
+namespace MID3SMPS::benchmark {
+	namespace {
+		using encoder = std::vector<std::uint8_t> (*)(std::span<const float>);
+
+		// Drum-like hits: a falling sine under decaying noise, restarting every 4000 samples
+		std::vector<float> make_drums(const std::size_t count) {
+			std::mt19937 random(seed);
+			std::uniform_real_distribution noise(-1.f, 1.f);
+			std::vector<float> samples(count);
+			double phase = 0;
+			for(std::size_t idx = 0; idx < count; idx++) {
+				const auto time     = static_cast<double>(idx % 4000) / 8000;
+				const auto envelope = std::exp(-time * 12);
+				phase += 2 * std::numbers::pi * (60 + 200 * std::exp(-time * 30)) / 8000;
+				samples[idx] = static_cast<float>(envelope * (0.7 * std::sin(phase) + 0.25 * std::exp(-time * 40) * noise(random)));
+			}
+			return samples;
+		}
+
+		// Throughput, plus how close the driver's playback gets to the source so quality and speed can be weighed together
+		void dpcm_encode(::benchmark::State &state, const encoder encode) {
+			const auto samples = make_drums(static_cast<std::size_t>(state.range(0)));
+			std::vector<std::uint8_t> data;
+			for(auto _ : state) {
+				data = encode(samples);
+				::benchmark::DoNotOptimize(data.data());
+			}
+			state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(samples.size()));
+			state.counters["snr_db"] = conversion::dac::snr(samples, conversion::dac::decode_dpcm(data));
+		}
+		BENCHMARK_CAPTURE(dpcm_encode, greedy, &conversion::dac::encode_dpcm_greedy)->Arg(1 << 14)->Arg(1 << 18)->Unit(::benchmark::kMicrosecond);
+		BENCHMARK_CAPTURE(dpcm_encode, trellis, &conversion::dac::encode_dpcm)->Arg(1 << 14)->Arg(1 << 18)->Unit(::benchmark::kMicrosecond);
+	}
+}
@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+#include <libremidi/reader.hpp>
+
+#include "synthetic.hpp"
+#include "containers/files/mid2smps/dac_map.hpp"
+#include "containers/files/mid2smps/gyb.hpp"
+#include "containers/midi/event_store.hpp"
+
+namespace MID3SMPS::benchmark {
+	namespace {
+		void gyb_load(::benchmark::State &state) {
+			const auto patches = static_cast<std::uint16_t>(state.range(0));
+			const auto data    = make_gyb(patches, patches / 2);
+			const temp_file file(data, "mid3smps_benchmark.gyb");
+			for(auto _ : state) {
+				M2S::gyb bank(file.path());
+				::benchmark::DoNotOptimize(bank.instruments.size());
+			}
+			state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(data.size()));
+			state.counters["patches"] = patches + patches / 2;
+		}
+		BENCHMARK(gyb_load)->Arg(16)->Arg(128)->Arg(1024);
+
+		void dac_map_load(::benchmark::State &state) {
+			const auto data = make_dac_map(static_cast<std::uint16_t>(state.range(0)));
+			const temp_file file(data, "mid3smps_benchmark_dac.txt");
+			for(auto _ : state) {
+				M2S::dac_map map(file.path());
+				::benchmark::DoNotOptimize(map.hits.data());
+			}
+			state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(data.size()));
+			state.counters["hits"] = static_cast<double>(state.range(0) * 128);
+		}
+		BENCHMARK(dac_map_load)->Arg(1)->Arg(16)->Arg(128);
+
+		void midi_parse(::benchmark::State &state) {
+			const auto data = make_midi(16, 256, static_cast<std::uint32_t>(state.range(0)));
+			for(auto _ : state) {
+				libremidi::reader reader;
+				::benchmark::DoNotOptimize(reader.parse(data));
+			}
+			state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(data.size()));
+		}
+		BENCHMARK(midi_parse)->Arg(1)->Arg(4)->Arg(16);
+
+		void midi_event_store(::benchmark::State &state) {
+			const auto data = make_midi(16, 256, static_cast<std::uint32_t>(state.range(0)));
+			libremidi::reader reader;
+			reader.parse(data);
+			std::size_t events = 0;
+			for(auto _ : state) {
+				const midi::event_store store(reader);
+				events = store.event_count();
+				::benchmark::DoNotOptimize(events);
+			}
+			state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(events));
+		}
+		BENCHMARK(midi_event_store)->Arg(1)->Arg(4)->Arg(16);
+	}
+}
@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <bit>
+#include <random>
+#include <benchmark/benchmark.h>
+
+#include "synthetic.hpp"
+#include "containers/chips/ym2612/operators.hpp"
+#include "containers/chips/ym2612/operator_columns.hpp"
+
+namespace MID3SMPS::benchmark {
+	namespace {
+		using op_id = ym2612::operators::op_id;
+
+		std::vector<ym2612::operators> make_patches(const std::size_t count) {
+			std::mt19937 random(seed);
+			std::vector<ym2612::operators> patches(count);
+			for(auto &patch : patches) {
+				for(auto &reg : patch.registers) {
+					reg = static_cast<std::uint8_t>(random());
+				}
+			}
+			return patches;
+		}
+
+		void operators_read(::benchmark::State &state) {
+			const auto patches = make_patches(static_cast<std::size_t>(state.range(0)));
+			for(auto _ : state) {
+				std::uint32_t total = 0;
+				for(const auto &patch : patches) {
+					for(const auto &op : list<op_id>()) {
+						total += patch.total_level(op).value;
+						total += patch.attack_rate(op).value;
+						total += patch.decay_rate(op).value;
+						total += patch.sustain_rate(op).value;
+						total += patch.sustain_level(op).value;
+						total += patch.release_rate(op).value;
+						total += patch.multiple(op).value;
+						total += std::to_underlying(patch.detune(op));
+					}
+					total += std::to_underlying(patch.algorithm());
+					total += std::to_underlying(patch.feedback());
+				}
+				::benchmark::DoNotOptimize(total);
+			}
+			state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(patches.size()));
+		}
+		BENCHMARK(operators_read)->Arg(256)->Arg(4096);
+
+		void operators_write(::benchmark::State &state) {
+			auto patches = make_patches(static_cast<std::size_t>(state.range(0)));
+			std::uint8_t value = 0;
+			for(auto _ : state) {
+				for(auto &patch : patches) {
+					for(const auto &op : list<op_id>()) {
+						patch.total_level(op, std::min<std::uint8_t>(value, 0x7F));
+						patch.attack_rate(op, std::min<std::uint8_t>(value, 0x1F));
+						patch.release_rate(op, std::min<std::uint8_t>(value, 0x0F));
+						patch.multiple(op, std::min<std::uint8_t>(value, 0x0F));
+					}
+					++value;
+				}
+				::benchmark::ClobberMemory();
+			}
+			state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(patches.size()));
+		}
+		BENCHMARK(operators_write)->Arg(256)->Arg(4096);
+
+		// The same reads and writes done by hand on plain bytes. In release builds safe_int doesn't check anything,
+		// so the accessors above should compile to the same code and run as fast as these.
+		using raw_patch = std::array<std::uint8_t, sizeof(ym2612::operators)>;
+
+		std::vector<raw_patch> make_raw_patches(const std::size_t count) {
+			std::vector<raw_patch> patches;
+			for(const auto &patch : make_patches(count)) {
+				patches.push_back(std::bit_cast<raw_patch>(patch));
+			}
+			return patches;
+		}
+
+		void operators_read_raw(::benchmark::State &state) {
+			const auto patches = make_raw_patches(static_cast<std::size_t>(state.range(0)));
+			for(auto _ : state) {
+				std::uint32_t total = 0;
+				for(const auto &patch : patches) {
+					for(const auto &op : list<op_id>()) {
+						const auto idx = std::to_underlying(op);
+						total += patch[idx + 4] & 0x7Fu;
+						total += patch[idx + 8] & 0x1Fu;
+						total += patch[idx + 12] & 0x1Fu;
+						total += patch[idx + 16] & 0x1Fu;
+						total += static_cast<std::uint32_t>(patch[idx + 20]) >> 4;
+						total += patch[idx + 20] & 0x0Fu;
+						total += patch[idx] & 0x0Fu;
+						total += static_cast<std::uint32_t>(patch[idx]) >> 4;
+					}
+					total += patch[28] & 0x07u;
+					total += static_cast<std::uint32_t>(patch[28]) >> 3;
+				}
+				::benchmark::DoNotOptimize(total);
+			}
+			state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(patches.size()));
+		}
+		BENCHMARK(operators_read_raw)->Arg(256)->Arg(4096);
+
+		void operators_write_raw(::benchmark::State &state) {
+			auto patches = make_raw_patches(static_cast<std::size_t>(state.range(0)));
+			std::uint8_t value = 0;
+			for(auto _ : state) {
+				for(auto &patch : patches) {
+					for(const auto &op : list<op_id>()) {
+						const auto idx = std::to_underlying(op);
+						patch[idx + 4]  = std::min<std::uint8_t>(value, 0x7F);
+						patch[idx + 8]  = static_cast<std::uint8_t>((patch[idx + 8] & 0xC0) | std::min<std::uint8_t>(value, 0x1F));
+						patch[idx + 20] = static_cast<std::uint8_t>((patch[idx + 20] & 0xF0) | std::min<std::uint8_t>(value, 0x0F));
+						patch[idx]      = static_cast<std::uint8_t>((patch[idx] & 0xF0) | std::min<std::uint8_t>(value, 0x0F));
+					}
+					++value;
+				}
+				::benchmark::ClobberMemory();
+			}
+			state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(patches.size()));
+		}
+		BENCHMARK(operators_write_raw)->Arg(256)->Arg(4096);
+	
+		// What decoding a library looks like without the bulk decoder
+		void decode_scalar(const std::vector<ym2612::operators> &patches, ym2612::operator_columns &columns) {
+			using columns_t = ym2612::operator_columns;
+			const auto count = patches.size();
+			for(auto *column : {&columns.ams, &columns.fms, &columns.feedback, &columns.algorithm}) {
+				column->resize(count);
+			}
+			for(const auto &op : list<op_id>()) {
+				const auto slot = columns_t::slot(op);
+				for(auto *column : {&columns.detune, &columns.multiple, &columns.total_level, &columns.rate_scaling, &columns.attack_rate,
+				                    &columns.amplitude_modulation, &columns.decay_rate, &columns.sustain_rate, &columns.sustain_level,
+				                    &columns.release_rate, &columns.ssgeg}) {
+					(*column)[slot].resize(count);
+				}
+			}
+
+			for(std::size_t idx = 0; idx < count; idx++) {
+				const auto &patch = patches[idx];
+				for(const auto &op : list<op_id>()) {
+					const auto slot = columns_t::slot(op);
+					columns.detune[slot][idx]               = std::to_underlying(patch.detune(op));
+					columns.multiple[slot][idx]             = patch.multiple(op).value;
+					columns.total_level[slot][idx]          = patch.total_level(op).value;
+					columns.rate_scaling[slot][idx]         = std::to_underlying(patch.rate_scaling(op));
+					columns.attack_rate[slot][idx]          = patch.attack_rate(op).value;
+					columns.amplitude_modulation[slot][idx] = patch.amplitude_modulation(op);
+					columns.decay_rate[slot][idx]           = patch.decay_rate(op).value;
+					columns.sustain_rate[slot][idx]         = patch.sustain_rate(op).value;
+					columns.sustain_level[slot][idx]        = patch.sustain_level(op).value;
+					columns.release_rate[slot][idx]         = patch.release_rate(op).value;
+					columns.ssgeg[slot][idx]                = std::to_underlying(patch.ssgeg(op));
+				}
+				columns.ams[idx]       = patch.ams().value;
+				columns.fms[idx]       = patch.fms().value;
+				columns.feedback[idx]  = std::to_underlying(patch.feedback());
+				columns.algorithm[idx] = std::to_underlying(patch.algorithm());
+			}
+		}
+
+		void operators_decode_scalar(::benchmark::State &state) {
+			const auto patches = make_patches(static_cast<std::size_t>(state.range(0)));
+			ym2612::operator_columns columns;
+			for(auto _ : state) {
+				decode_scalar(patches, columns);
+				::benchmark::DoNotOptimize(columns.algorithm.data());
+			}
+			state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(patches.size()));
+		}
+		BENCHMARK(operators_decode_scalar)->Arg(256)->Arg(4096)->Arg(65536);
+
+		void operators_decode_bulk(::benchmark::State &state) {
+			const auto patches = make_patches(static_cast<std::size_t>(state.range(0)));
+			ym2612::operator_columns columns;
+			for(auto _ : state) {
+				columns.decode(patches);
+				::benchmark::DoNotOptimize(columns.algorithm.data());
+			}
+			state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(patches.size()));
+		}
+		BENCHMARK(operators_decode_bulk)->Arg(256)->Arg(4096)->Arg(65536);
+	}
+}
@@ -0,0 +1,167 @@
+#include "synthetic.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <random>
+#include <string>
+
+namespace MID3SMPS::benchmark {
+	namespace {
+		void put16le(std::vector<std::uint8_t> &out, const std::uint16_t value) {
+			out.push_back(static_cast<std::uint8_t>(value));
+			out.push_back(static_cast<std::uint8_t>(value >> 8));
+		}
+
+		void put32le(std::vector<std::uint8_t> &out, const std::uint32_t value) {
+			put16le(out, static_cast<std::uint16_t>(value));
+			put16le(out, static_cast<std::uint16_t>(value >> 16));
+		}
+
+		void patch32le(std::vector<std::uint8_t> &out, const std::size_t at, const std::uint32_t value) {
+			for(std::size_t idx = 0; idx < 4; idx++) {
+				out[at + idx] = static_cast<std::uint8_t>(value >> (idx * 8));
+			}
+		}
+
+		void put32be(std::vector<std::uint8_t> &out, const std::uint32_t value) {
+			for(int shift = 24; shift >= 0; shift -= 8) {
+				out.push_back(static_cast<std::uint8_t>(value >> shift));
+			}
+		}
+
+		void put_vlq(std::vector<std::uint8_t> &out, std::uint32_t value) {
+			std::array<std::uint8_t, 4> bytes{};
+			std::size_t count = 0;
+			do {
+				bytes[count++] = static_cast<std::uint8_t>(value & 0x7F);
+				value >>= 7;
+			} while(value != 0 && count < 4);
+			while(count > 1) {
+				out.push_back(static_cast<std::uint8_t>(bytes[--count] | 0x80));
+			}
+			out.push_back(bytes[0]);
+		}
+
+		void put_bank(std::vector<std::uint8_t> &out, const std::uint16_t count, std::mt19937 &random, const char *prefix) {
+			std::uniform_int_distribution<unsigned> byte(0, 0xFF);
+			put16le(out, count);
+			for(std::uint16_t idx = 0; idx < count; idx++) {
+				const auto name = prefix + std::to_string(static_cast<unsigned>(idx));
+				put16le(out, static_cast<std::uint16_t>(2 + 0x1E + 3 + name.size()));
+				for(std::size_t reg = 0; reg < 0x1E; reg++) {
+					out.push_back(static_cast<std::uint8_t>(byte(random)));
+				}
+				out.push_back(static_cast<std::uint8_t>(byte(random) % 24)); // Transposition or drum note
+				out.push_back(0);                                              // No chord notes
+				out.push_back(static_cast<std::uint8_t>(name.size()));
+				out.insert(out.end(), name.begin(), name.end());
+			}
+		}
+
+		void put_map(std::vector<std::uint8_t> &out, const std::uint16_t count, const bool drums, std::mt19937 &random) {
+			for(std::size_t key = 0; key < 128; key++) {
+				const auto entries = count == 0 ? 0u : 1u + random() % 3;
+				put16le(out, static_cast<std::uint16_t>(entries));
+				for(std::uint16_t entry = 0; entry < entries; entry++) {
+					out.push_back(entry == 0 ? 0 : static_cast<std::uint8_t>(entry));
+					out.push_back(0xFF);
+					const auto instrument = static_cast<std::uint16_t>(random() % count);
+					put16le(out, static_cast<std::uint16_t>(drums ? instrument | 0x8000 : instrument));
+				}
+			}
+		}
+	}
+
+	std::vector<std::uint8_t> make_gyb(const std::uint16_t melody_count, const std::uint16_t drum_count) {
+		std::mt19937 random(seed);
+		std::vector<std::uint8_t> out = {26, 12, 3, 0};
+		put32le(out, 0); // File size
+		put32le(out, 0); // Banks
+		put32le(out, 0); // Maps
+
+		patch32le(out, 8, static_cast<std::uint32_t>(out.size()));
+		put_bank(out, melody_count, random, "Melody ");
+		put_bank(out, drum_count, random, "Drum ");
+
+		patch32le(out, 12, static_cast<std::uint32_t>(out.size()));
+		put_map(out, melody_count, false, random);
+		put_map(out, drum_count, true, random);
+
+		patch32le(out, 4, static_cast<std::uint32_t>(out.size()));
+		return out;
+	}
+
+	std::vector<std::uint8_t> make_midi(const std::uint16_t tracks, const std::uint32_t quarters, const std::uint32_t density) {
+		static constexpr std::uint16_t ticks_per_quarter = 480;
+		std::mt19937 random(seed);
+		std::vector<std::uint8_t> out = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1};
+		out.push_back(static_cast<std::uint8_t>((tracks + 1) >> 8));
+		out.push_back(static_cast<std::uint8_t>(tracks + 1));
+		out.push_back(ticks_per_quarter >> 8);
+		out.push_back(ticks_per_quarter & 0xFF);
+
+		const auto put_track = [&out](const std::vector<std::uint8_t> &body) {
+			out.insert(out.end(), {'M', 'T', 'r', 'k'});
+			put32be(out, static_cast<std::uint32_t>(body.size()));
+			out.insert(out.end(), body.begin(), body.end());
+		};
+		const auto end_of_track = [](std::vector<std::uint8_t> &body) {
+			body.insert(body.end(), {0x00, 0xFF, 0x2F, 0x00});
+		};
+
+		// Tempo track, a change every 16 quarters
+		std::vector<std::uint8_t> body;
+		for(std::uint32_t quarter = 0; quarter < quarters; quarter += 16) {
+			const auto tempo = 400'000 + random() % 300'000;
+			put_vlq(body, quarter == 0 ? 0 : 16u * ticks_per_quarter);
+			body.insert(body.end(), {0xFF, 0x51, 0x03});
+			body.push_back(static_cast<std::uint8_t>(tempo >> 16));
+			body.push_back(static_cast<std::uint8_t>(tempo >> 8));
+			body.push_back(static_cast<std::uint8_t>(tempo));
+		}
+		end_of_track(body);
+		put_track(body);
+
+		const auto step = std::max<std::uint32_t>(ticks_per_quarter / std::max<std::uint32_t>(density, 1), 1);
+		for(std::uint16_t track = 0; track < tracks; track++) {
+			body.clear();
+			const auto channel = static_cast<std::uint8_t>(track % 16);
+			put_vlq(body, 0);
+			body.insert(body.end(), {static_cast<std::uint8_t>(0xC0 | channel), static_cast<std::uint8_t>(random() % 128)});
+			for(std::uint32_t tick = 0; tick < quarters * ticks_per_quarter; tick += step) {
+				const auto note = static_cast<std::uint8_t>(36 + random() % 48);
+				put_vlq(body, 0);
+				body.insert(body.end(), {static_cast<std::uint8_t>(0x90 | channel), note, static_cast<std::uint8_t>(1 + random() % 127)});
+				put_vlq(body, step);
+				body.insert(body.end(), {static_cast<std::uint8_t>(0x80 | channel), note, 0x40});
+			}
+			end_of_track(body);
+			put_track(body);
+		}
+		return out;
+	}
+
+	std::vector<std::uint8_t> make_dac_map(const std::uint16_t kits) {
+		std::mt19937 random(seed);
+		std::string text = "; Generated drum kits\n";
+		for(std::uint16_t kit = 0; kit < kits; kit++) {
+			text += "kit " + std::to_string(static_cast<unsigned>(kit)) + "\n";
+			for(std::uint32_t note = 0; note < 128; note++) {
+				text += std::to_string(note) + "\t$" + std::to_string(random() % 100) + "\t" + std::to_string(random() % 256) + "\t" +
+				        std::to_string(random() % 128) + "\t; hit " + std::to_string(note) + "\n";
+			}
+		}
+		return {text.begin(), text.end()};
+	}
+
+	temp_file::temp_file(const std::vector<std::uint8_t> &data, const fs::path &name) : path_(fs::temp_directory_path() / name) {
+		std::ofstream file(path_, std::ios::binary);
+		file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+	}
+
+	temp_file::~temp_file() {
+		std::error_code error;
+		fs::remove(path_, error);
+	}
+}
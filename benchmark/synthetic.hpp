@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// Inputs for the benchmarks are generated from a fixed seed so every run measures the same data
+namespace MID3SMPS::benchmark {
+	namespace fs = std::filesystem;
+
+	static constexpr std::uint32_t seed = 0x3D5A'F00D;
+
+	// GYB v3 file with random patches and instrument maps pointing at them
+	[[nodiscard]] std::vector<std::uint8_t> make_gyb(std::uint16_t melody_count, std::uint16_t drum_count);
+
+	// Format 1 SMF with a tempo track and the given number of note tracks.
+	// Density is the average number of note on events per quarter note in every track.
+	[[nodiscard]] std::vector<std::uint8_t> make_midi(std::uint16_t tracks, std::uint32_t quarters, std::uint32_t density);
+
+	// mid2smps DAC map with every note of every kit mapped, comments included
+	[[nodiscard]] std::vector<std::uint8_t> make_dac_map(std::uint16_t kits);
+
+	// Writes data to a file in the temp directory that is removed with the object
+	class temp_file {
+		fs::path path_;
+
+	public:
+		temp_file(const std::vector<std::uint8_t> &data, const fs::path &name);
+		temp_file(const temp_file &) = delete;
+		temp_file &operator=(const temp_file &) = delete;
+		~temp_file();
+
+		[[nodiscard]] const fs::path &path() const noexcept {
+			return path_;
+		}
+	};
+}
@@ -0,0 +1,113 @@
+#include "psg.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace MID3SMPS::sn76489 {
+	namespace {
+		// 2 dB per attenuation step, the last step is off
+		constexpr std::array<std::int16_t, 16> levels = {
+			2000, 1589, 1262, 1002, 796, 632, 502, 399, 317, 252, 200, 159, 126, 100, 80, 0
+		};
+		constexpr std::uint16_t white_noise_taps = 0x0009;
+	}
+
+	void psg::reset() noexcept {
+		period_.fill(0);
+		attenuation_.fill(silent);
+		counter_.fill(0);
+		output_.fill(false);
+		lfsr_        = 0x8000;
+		latched_     = 0;
+		accumulator_ = 0;
+	}
+
+	void psg::write(const std::uint8_t data) noexcept {
+		if(data & 0x80) {
+			latched_ = data & 0x70;
+		}
+		const std::uint8_t channel = latched_ >> 5;
+		const bool is_volume       = latched_ & 0x10;
+		if(is_volume) {
+			attenuation_[channel] = data & 0x0F;
+			return;
+		}
+		if(channel == noise_channel) {
+			period_[channel] = data & 0x07;
+			lfsr_            = 0x8000;
+			return;
+		}
+		if(data & 0x80) {
+			period_[channel] = static_cast<std::uint16_t>((period_[channel] & 0x3F0) | (data & 0x0F));
+		} else {
+			period_[channel] = static_cast<std::uint16_t>((period_[channel] & 0x00F) | ((data & 0x3F) << 4));
+		}
+	}
+
+	void psg::tone(const std::uint8_t channel, const double frequency) noexcept {
+		if(channel >= noise_channel || frequency <= 0) {
+			return;
+		}
+		const auto period = static_cast<std::uint16_t>(std::clamp(std::lround(clock_ / (32. * frequency)), 1l, 0x3FFl));
+		write(static_cast<std::uint8_t>(0x80 | channel << 5 | (period & 0x0F)));
+		write(static_cast<std::uint8_t>(period >> 4));
+	}
+
+	void psg::volume(const std::uint8_t channel, const std::uint8_t attenuation) noexcept {
+		write(static_cast<std::uint8_t>(0x90 | (channel & 0x03) << 5 | std::min(attenuation, silent)));
+	}
+
+	void psg::noise(const bool white, const std::uint8_t rate) noexcept {
+		write(static_cast<std::uint8_t>(0xE0 | (white ? 0x04 : 0x00) | (rate & 0x03)));
+	}
+
+	std::uint16_t psg::noise_period() const noexcept {
+		switch(period_[noise_channel] & 0x03) {
+			case 0: return 0x10;
+			case 1: return 0x20;
+			case 2: return 0x40;
+			default: return std::max<std::uint16_t>(period_[2], 1);
+		}
+	}
+
+	void psg::tick() noexcept {
+		for(std::uint8_t channel = 0; channel < channel_count; channel++) {
+			if(counter_[channel] > 1) {
+				--counter_[channel];
+				continue;
+			}
+			counter_[channel] = channel == noise_channel ? noise_period() : std::max<std::uint16_t>(period_[channel], 1);
+			output_[channel]  = !output_[channel];
+			if(channel == noise_channel && output_[channel]) {
+				const bool white    = period_[noise_channel] & 0x04;
+				const auto feedback = white ? std::popcount(static_cast<std::uint16_t>(lfsr_ & white_noise_taps)) & 1 : lfsr_ & 1;
+				lfsr_               = static_cast<std::uint16_t>(lfsr_ >> 1 | feedback << 15);
+			}
+		}
+	}
+
+	void psg::mix(const std::span<std::int16_t> stereo) noexcept {
+		const auto ticks_per_sample = static_cast<std::uint64_t>(sample_rate_) * 16;
+		for(std::size_t frame = 0; frame + 1 < stereo.size(); frame += 2) {
+			accumulator_ += clock_;
+			while(accumulator_ >= ticks_per_sample) {
+				accumulator_ -= ticks_per_sample;
+				tick();
+			}
+			int sample = 0;
+			for(std::uint8_t channel = 0; channel < noise_channel; channel++) {
+				const auto level = levels[attenuation_[channel]];
+				sample += output_[channel] ? level : -level;
+			}
+			const auto noise_level = levels[attenuation_[noise_channel]];
+			sample += lfsr_ & 1 ? noise_level : -noise_level;
+
+			for(std::size_t side = 0; side < 2; side++) {
+				auto &out = stereo[frame + side];
+				out = static_cast<std::int16_t>(std::clamp(out + sample, int{std::numeric_limits<std::int16_t>::min()}, int{std::numeric_limits<std::int16_t>::max()}));
+			}
+		}
+	}
+}
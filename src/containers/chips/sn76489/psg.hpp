@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+namespace MID3SMPS::sn76489 {
+	// Small SN76489 model, good enough to audition PSG parts. It is not cycle accurate.
+	class psg {
+	public:
+		static constexpr std::uint32_t clock_ntsc = 3'579'545;
+		static constexpr std::uint8_t channel_count = 4; // 3 tone channels and the noise channel
+		static constexpr std::uint8_t noise_channel = 3;
+		static constexpr std::uint8_t silent        = 0x0F;
+
+	private:
+		std::array<std::uint16_t, channel_count> period_{};
+		std::array<std::uint8_t, channel_count> attenuation_{silent, silent, silent, silent};
+		std::array<std::uint16_t, channel_count> counter_{};
+		std::array<bool, channel_count> output_{};
+		std::uint16_t lfsr_  = 0x8000;
+		std::uint8_t latched_ = 0;
+
+		std::uint32_t sample_rate_;
+		std::uint32_t clock_;
+		std::uint64_t accumulator_ = 0;
+
+		void tick() noexcept;
+		[[nodiscard]] std::uint16_t noise_period() const noexcept;
+
+	public:
+		explicit psg(std::uint32_t sample_rate, std::uint32_t clock = clock_ntsc) noexcept : sample_rate_(sample_rate), clock_(clock) {}
+
+		void reset() noexcept;
+		void write(std::uint8_t data) noexcept; // Same bytes the 68k/Z80 would write to the PSG port
+
+		void tone(std::uint8_t channel, double frequency) noexcept;
+		void volume(std::uint8_t channel, std::uint8_t attenuation) noexcept;
+		void noise(bool white, std::uint8_t rate) noexcept;
+
+		// Adds the PSG output to interleaved stereo samples
+		void mix(std::span<std::int16_t> stereo) noexcept;
+	};
+}
@@ -0,0 +1,121 @@
+#include "chip.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+extern "C" {
+#include <ym3438.h>
+}
+
+namespace MID3SMPS::ym2612 {
+	namespace {
+		constexpr std::uint8_t address_settle = 2;  // Clocks between the address and the data write
+		constexpr std::uint8_t busy_clocks    = 32; // Clocks the chip stays busy after a data write
+		constexpr std::uint8_t clocks_per_sample = 24;
+		constexpr int output_gain = 4;
+
+		constexpr std::uint8_t key_on_register = 0x28;
+		constexpr std::uint8_t stereo_both     = 0xC0;
+	}
+
+	struct chip::state {
+		ym3438_t opn2{};
+	};
+
+	chip::chip() : state_(std::make_unique<state>()) {
+		reset();
+	}
+
+	chip::chip(chip &&) noexcept            = default;
+	chip &chip::operator=(chip &&) noexcept = default;
+	chip::~chip()                           = default;
+
+	void chip::reset() {
+		OPN2_SetChipType(ym3438_mode_ym2612);
+		OPN2_Reset(&state_->opn2);
+		queue_.clear();
+		queue_head_  = 0;
+		write_phase_ = 0;
+		cooldown_    = 0;
+	}
+
+	void chip::write(const std::uint8_t port, const std::uint8_t address, const std::uint8_t data) {
+		queue_.push_back({port, address, data});
+	}
+
+	void chip::write_channel(const std::uint8_t channel, const std::uint8_t address, const std::uint8_t data) {
+		write(channel < 3 ? 0 : 1, static_cast<std::uint8_t>(address + channel % 3), data);
+	}
+
+	void chip::load_patch(const std::uint8_t channel, const operators &patch) {
+		// Registers are stored in write order, 30 34 38 3C ... 9C followed by B0 and B4
+		static constexpr std::size_t operator_registers = 0x1C;
+		for(std::size_t idx = 0; idx < operator_registers; idx++) {
+			const auto address = static_cast<std::uint8_t>(0x30 + (idx / 4) * 0x10 + (idx % 4) * 4);
+			write_channel(channel, address, patch.registers[idx].value);
+		}
+		write_channel(channel, 0xB0, patch.registers[operator_registers].value);
+		write_channel(channel, 0xB4, static_cast<std::uint8_t>(patch.registers[operator_registers + 1].value | stereo_both));
+	}
+
+	void chip::frequency(const std::uint8_t channel, const double hz) {
+		std::uint8_t block = 0;
+		auto fnum          = hz * 144. * (1 << 21) / clock_ntsc;
+		while(fnum >= 0x800 && block < 7) {
+			fnum /= 2;
+			++block;
+		}
+		const auto value = static_cast<std::uint16_t>(std::clamp(std::lround(fnum), 0l, 0x7FFl));
+		write_channel(channel, 0xA4, static_cast<std::uint8_t>(block << 3 | value >> 8));
+		write_channel(channel, 0xA0, static_cast<std::uint8_t>(value & 0xFF));
+	}
+
+	void chip::key(const std::uint8_t channel, const bool on) {
+		const auto slot = static_cast<std::uint8_t>(channel < 3 ? channel : channel + 1);
+		write(0, key_on_register, static_cast<std::uint8_t>((on ? 0xF0 : 0x00) | slot));
+	}
+
+	void chip::step_queue() {
+		if(cooldown_ > 0) {
+			--cooldown_;
+			return;
+		}
+		if(!writes_pending()) {
+			return;
+		}
+		const auto &[port, address, data] = queue_[queue_head_];
+		if(write_phase_ == 0) {
+			OPN2_Write(&state_->opn2, static_cast<Bit32u>(port * 2), address);
+			write_phase_ = 1;
+			cooldown_    = address_settle;
+			return;
+		}
+		OPN2_Write(&state_->opn2, static_cast<Bit32u>(port * 2 + 1), data);
+		write_phase_ = 0;
+		cooldown_    = busy_clocks;
+		if(++queue_head_ == queue_.size()) {
+			queue_.clear();
+			queue_head_ = 0;
+		}
+	}
+
+	void chip::render(const std::span<std::int16_t> stereo) {
+		for(std::size_t frame = 0; frame + 1 < stereo.size(); frame += 2) {
+			int left  = 0;
+			int right = 0;
+			for(std::uint8_t clock = 0; clock < clocks_per_sample; clock++) {
+				step_queue();
+				std::array<Bit16s, 2> buffer{};
+				OPN2_Clock(&state_->opn2, buffer.data());
+				left += buffer[0];
+				right += buffer[1];
+			}
+			constexpr int min = std::numeric_limits<std::int16_t>::min();
+			constexpr int max = std::numeric_limits<std::int16_t>::max();
+			stereo[frame]     = static_cast<std::int16_t>(std::clamp(left * output_gain, min, max));
+			stereo[frame + 1] = static_cast<std::int16_t>(std::clamp(right * output_gain, min, max));
+		}
+	}
+}
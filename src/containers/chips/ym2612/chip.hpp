@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "operators.hpp"
+
+namespace MID3SMPS::ym2612 {
+	// Nuked-OPN2 with a write queue that respects the chip's busy time, so callers can write registers back to back
+	class chip {
+	public:
+		static constexpr std::uint32_t clock_ntsc   = 7'670'453;
+		static constexpr std::uint32_t sample_rate  = clock_ntsc / 144;
+		static constexpr std::uint8_t channel_count = 6;
+
+	private:
+		struct state;
+		std::unique_ptr<state> state_;
+
+		struct pending_write {
+			std::uint8_t port; // 0 for registers of channels 1-3 and globals, 1 for channels 4-6
+			std::uint8_t address;
+			std::uint8_t data;
+		};
+		std::vector<pending_write> queue_{};
+		std::size_t queue_head_ = 0;
+		std::uint8_t write_phase_ = 0;
+		std::uint8_t cooldown_    = 0;
+
+		void step_queue();
+
+	public:
+		chip();
+		chip(chip &&) noexcept;
+		chip &operator=(chip &&) noexcept;
+		~chip();
+
+		void reset();
+		void write(std::uint8_t port, std::uint8_t address, std::uint8_t data);
+		void write_channel(std::uint8_t channel, std::uint8_t address, std::uint8_t data);
+
+		void load_patch(std::uint8_t channel, const operators &patch);
+		void frequency(std::uint8_t channel, double hz);
+		void key(std::uint8_t channel, bool on);
+
+		// Overwrites interleaved stereo samples with the chip's output
+		void render(std::span<std::int16_t> stereo);
+
+		[[nodiscard]] bool writes_pending() const noexcept {
+			return queue_head_ < queue_.size();
+		}
+	};
+}
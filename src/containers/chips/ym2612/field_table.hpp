@@ -0,0 +1,218 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <utility>
+
+#include "helpers/list_helper.hpp"
+
+namespace MID3SMPS::ym2612 {
+	using namespace std::string_view_literals;
+
+	// Every parameter of a patch as a plain number, for code that handles fields generically instead of calling each accessor
+	enum class field : std::uint8_t {
+		// Channel fields
+		algorithm,
+		feedback,
+		ams,
+		fms,
+		// Operator fields
+		detune,
+		multiple,
+		total_level,
+		rate_scaling,
+		attack_rate,
+		amplitude_modulation,
+		decay_rate,
+		sustain_rate,
+		sustain_level,
+		release_rate,
+		ssgeg,
+	};
+	static constexpr std::size_t channel_field_count  = 4;
+	static constexpr std::size_t operator_field_count = 11;
+	static constexpr std::size_t field_count          = channel_field_count + operator_field_count;
+
+	[[nodiscard, gnu::const]] constexpr bool is_channel_field(const field target) noexcept {
+		return std::to_underlying(target) < channel_field_count;
+	}
+
+	// A value a field can take and what the editor calls it
+	struct field_choice {
+		std::uint8_t value;
+		std::string_view name;
+	};
+
+	namespace choices {
+		inline constexpr std::array<field_choice, 8> algorithm = {{
+			{0, "0 (Out 4)"sv}, {1, "1 (Out 4)"sv}, {2, "2 (Out 4)"sv}, {3, "3 (Out 4)"sv},
+			{4, "4 (Out 2-4)"sv}, {5, "5 (Out 2-3-4)"sv}, {6, "6 (Out 2-3-4)"sv}, {7, "7 (Out 1-2-3-4)"sv},
+		}};
+		inline constexpr std::array<field_choice, 8> feedback = {{
+			{0, "Off"sv}, {1, "Pi / 16"sv}, {2, "Pi / 8"sv}, {3, "Pi / 4"sv},
+			{4, "Pi / 2"sv}, {5, "Pi"sv}, {6, "2 * Pi"sv}, {7, "4 * Pi"sv},
+		}};
+		// dB
+		inline constexpr std::array<field_choice, 4> ams = {{
+			{0, "0"sv}, {1, "1.4"sv}, {2, "5.9"sv}, {3, "11.8"sv},
+		}};
+		// Percent
+		inline constexpr std::array<field_choice, 8> fms = {{
+			{0, "0"sv}, {1, "±3.4"sv}, {2, "±6.7"sv}, {3, "±10"sv},
+			{4, "±14"sv}, {5, "±20"sv}, {6, "±40"sv}, {7, "±80"sv},
+		}};
+		inline constexpr std::array<field_choice, 8> detune = {{
+			{0, "No Change"sv}, {1, "+1 × E"sv}, {2, "+2 × E"sv}, {3, "+3 × E"sv},
+			{4, "No Change"sv}, {5, "-1 × E"sv}, {6, "-2 × E"sv}, {7, "-3 × E"sv},
+		}};
+		inline constexpr std::array<field_choice, 4> rate_scaling = {{
+			{0, "(KC/8) + (2×Rate)"sv}, {1, "(KC/4) + (2×Rate)"sv}, {2, "(KC/2) + (2×Rate)"sv}, {3, "(KC/1) + (2×Rate)"sv},
+		}};
+		inline constexpr std::array<field_choice, 2> amplitude_modulation = {{
+			{0, "Disabled"sv}, {1, "Enabled"sv},
+		}};
+		// Bit 3 turns SSG-EG on, the modes below it aren't modes
+		inline constexpr std::array<field_choice, 9> ssgeg = {{
+			{0, "Disabled"sv},
+			{8, R"(\\\\)"sv}, {9, R"(\___)"sv}, {10, R"(\/\/)"sv}, {11, R"(\¯¯¯)"sv},
+			{12, R"(////)"sv}, {13, R"(/¯¯¯)"sv}, {14, R"(/\/\)"sv}, {15, R"(/___)"sv},
+		}};
+	}
+
+	// Where a field sits in a patch's registers. They come in rows of four, one register per operator in register order
+	// (1, 3, 2, 4). Operator fields are in their operator's slot of the row, channel fields always use the same slot.
+	// Accessors, the editor rows, bulk decoding and validation are all built from this, nothing else knows the layout.
+	struct field_descriptor {
+		field id;
+		std::string_view name;
+		std::string_view description; // Tooltip, where the name needs explaining
+		std::uint8_t row;
+		std::uint8_t slot; // Channel fields only
+		std::uint8_t shift;
+		std::uint8_t mask; // After shifting
+		std::uint8_t max;
+		std::span<const field_choice> options{}; // Empty for plain numbers, otherwise every value the field can take
+
+		[[nodiscard, gnu::const]] constexpr bool per_operator() const noexcept {
+			return !is_channel_field(id);
+		}
+
+		// op_slot is std::to_underlying(op_id)
+		[[nodiscard, gnu::const]] constexpr std::size_t register_index(const std::size_t op_slot) const noexcept {
+			return static_cast<std::size_t>(row) * 4 + (per_operator() ? op_slot : slot);
+		}
+
+		[[nodiscard, gnu::const]] constexpr std::uint8_t register_mask() const noexcept {
+			return static_cast<std::uint8_t>(mask << shift);
+		}
+
+		[[nodiscard, gnu::const]] constexpr bool valid(const std::uint8_t value) const noexcept {
+			if(value > max) {
+				return false;
+			}
+			if(options.empty()) {
+				return true;
+			}
+			for(const auto &option : options) {
+				if(option.value == value) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Clamped to max, then down to the closest value the field can take
+		[[nodiscard, gnu::const]] constexpr std::uint8_t nearest(std::uint8_t value) const noexcept {
+			value = value > max ? max : value;
+			std::uint8_t result = 0;
+			for(const auto &option : options) {
+				if(option.value == value) {
+					return value;
+				}
+				if(option.value < value && option.value >= result) {
+					result = option.value;
+				}
+			}
+			return options.empty() ? value : result;
+		}
+
+		// Empty if value isn't one of the options
+		[[nodiscard, gnu::const]] constexpr std::string_view option_name(const std::uint8_t value) const noexcept {
+			for(const auto &option : options) {
+				if(option.value == value) {
+					return option.name;
+				}
+			}
+			return {};
+		}
+	};
+
+	// In the order of field
+	inline constexpr std::array<field_descriptor, field_count> field_table = {{
+		{field::algorithm, "Algorithm"sv, {}, 7, 0, 0, 0x07, 7, choices::algorithm},
+		{field::feedback, "Feedback"sv, {}, 7, 0, 3, 0x07, 7, choices::feedback},
+		{field::ams, "AMS"sv, "Amplitude modulation sensitivity, in dB"sv, 7, 1, 4, 0x03, 3, choices::ams},
+		{field::fms, "FMS"sv, "Frequency modulation sensitivity, in percent"sv, 7, 1, 0, 0x07, 7, choices::fms},
+		{field::detune, "Detune"sv, {}, 0, 0, 4, 0x07, 7, choices::detune},
+		{field::multiple, "Multiple"sv, {}, 0, 0, 0, 0x0F, 15},
+		{field::total_level, "Total Level"sv, {}, 1, 0, 0, 0x7F, 127},
+		{field::rate_scaling, "Rate Scaling"sv, {}, 2, 0, 6, 0x03, 3, choices::rate_scaling},
+		{field::attack_rate, "Attack Rate"sv, {}, 2, 0, 0, 0x1F, 31},
+		{field::amplitude_modulation, "Amplitude Modulation"sv, {}, 3, 0, 7, 0x01, 1, choices::amplitude_modulation},
+		{field::decay_rate, "Decay Rate"sv, {}, 3, 0, 0, 0x1F, 31},
+		{field::sustain_rate, "Sustain Rate"sv, {}, 4, 0, 0, 0x1F, 31},
+		{field::sustain_level, "Sustain Level"sv, {}, 5, 0, 4, 0x0F, 15},
+		{field::release_rate, "Release Rate"sv, {}, 5, 0, 0, 0x0F, 15},
+		{field::ssgeg, "SSG-EG"sv, {}, 6, 0, 0, 0x0F, 15, choices::ssgeg},
+	}};
+
+	[[nodiscard, gnu::const]] constexpr const field_descriptor &describe(const field target) noexcept {
+		return field_table[std::to_underlying(target)];
+	}
+
+	[[nodiscard, gnu::const]] constexpr std::uint8_t max_value(const field target) noexcept {
+		return describe(target).max;
+	}
+
+	[[nodiscard, gnu::const]] constexpr std::string_view string(const field target) noexcept {
+		return describe(target).name;
+	}
+
+	namespace detail {
+		// Bits no field uses, per register of one operator slot and row
+		[[nodiscard]] consteval bool table_is_consistent() {
+			for(std::size_t idx = 0; idx < field_table.size(); idx++) {
+				const auto &desc = field_table[idx];
+				if(std::to_underlying(desc.id) != idx || desc.max > desc.mask || (desc.register_mask() >> desc.shift) != desc.mask) {
+					return false;
+				}
+				for(const auto &other : std::span(field_table).subspan(idx + 1)) {
+					// Fields sharing a register can't overlap
+					if(desc.register_index(0) == other.register_index(0) && (desc.register_mask() & other.register_mask()) != 0) {
+						return false;
+					}
+				}
+			}
+			return true;
+		}
+	}
+	static_assert(detail::table_is_consistent(), "Every field is listed in order, fits its mask and doesn't overlap another field");
+}
+
+template<>
+struct MID3SMPS::list_helper<MID3SMPS::ym2612::field> {
+	using type                         = std::span<const ym2612::field, ym2612::field_count>;
+	static constexpr std::array values = [] {
+		std::array<ym2612::field, ym2612::field_count> result{};
+		for(std::size_t idx = 0; idx < result.size(); idx++) {
+			result[idx] = ym2612::field_table[idx].id;
+		}
+		return result;
+	}();
+
+	[[nodiscard, gnu::const]] static constexpr type list() {
+		return values;
+	}
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include "field_table.hpp"
+#include "operators.hpp"
+
+namespace MID3SMPS::ym2612 {
+	// Enums as their underlying value, amplitude modulation as 0 or 1
+	[[nodiscard, gnu::pure]] constexpr std::uint8_t value(const operators &patch, const field target, const operators::op_id op = operators::op_id::op1) {
+		return patch.get(describe(target), op);
+	}
+
+	// Values are clamped to the field's maximum and then moved down to one it can take, so SSG-EG values between
+	// disabled and mode 0 turn it off
+	constexpr void set_value(operators &patch, const field target, const operators::op_id op, const std::uint8_t new_value) {
+		const auto &desc = describe(target);
+		patch.set(desc, op, desc.nearest(new_value));
+	}
+
+	// A field holding a value it can't take, or a register with bits set that no field uses
+	struct invalid_field {
+		std::size_t register_index;
+		std::optional<field> target; // Empty for stray bits
+	};
+
+	// The first problem in the patch, if there is one. Bits no field covers are ignored by the chip but can't be edited either.
+	[[nodiscard]] constexpr std::optional<invalid_field> validate(const operators &patch) {
+		std::array<std::uint8_t, std::tuple_size_v<decltype(operators::registers)>> used{};
+		for(const auto &desc : field_table) {
+			for(const auto op : list<operators::op_id>()) {
+				const auto index = desc.register_index(std::to_underlying(op));
+				used[index] = static_cast<std::uint8_t>(used[index] | desc.register_mask());
+				if(!desc.valid(patch.get(desc, op))) {
+					return invalid_field{index, desc.id};
+				}
+				if(!desc.per_operator()) {
+					break;
+				}
+			}
+		}
+		for(std::size_t index = 0; index < used.size(); index++) {
+			if((patch.registers[index].value & ~used[index]) != 0) {
+				return invalid_field{index, std::nullopt};
+			}
+		}
+		return std::nullopt;
+	}
+}
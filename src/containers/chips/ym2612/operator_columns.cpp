@@ -0,0 +1,125 @@
+#include "operator_columns.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace MID3SMPS::ym2612 {
+	namespace {
+		constexpr std::size_t register_count = std::tuple_size_v<decltype(operators::registers)>;
+		constexpr std::size_t chunk_size     = 512; // Patches per pass, small enough for the transposed registers to stay in L1
+
+		using planes_t = std::array<std::array<std::uint8_t, chunk_size>, register_count>;
+
+		// out[idx] = in[idx] >> shift & mask, sixteen bytes at a time where SSE2 is available
+		template<int shift, std::uint8_t mask>
+		void extract(const std::uint8_t *in, std::uint8_t *out, const std::size_t count) noexcept {
+			// There are no byte shifts, so the mask also has to clear what a 16-bit shift pulls in from the neighbouring byte
+			static_assert(mask <= (0xFF >> shift));
+			std::size_t idx = 0;
+#if defined(__SSE2__)
+			const auto bits = _mm_set1_epi8(static_cast<char>(mask));
+			for(; idx + 16 <= count; idx += 16) {
+				auto value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + idx));
+				if constexpr(shift != 0) {
+					value = _mm_srli_epi16(value, shift);
+				}
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + idx), _mm_and_si128(value, bits));
+			}
+#endif
+			for(; idx < count; idx++) {
+				out[idx] = static_cast<std::uint8_t>(in[idx] >> shift & mask);
+			}
+		}
+
+#if defined(__SSE2__)
+		// Transposes sixteen patches' registers first to first + 15 into the planes.
+		// Interleaving row n with row n + 8 four times over moves every byte to its transposed position.
+		void transpose_16(const std::uint8_t *block, planes_t &planes, const std::size_t patch, const std::size_t first) noexcept {
+			// Plain arrays, std::array<__m128i> drops the vector type's attributes
+			__m128i rows[16];
+			__m128i next[16];
+			for(std::size_t row = 0; row < 16; row++) {
+				rows[row] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + (patch + row) * register_count + first));
+			}
+			for(int round = 0; round < 4; round++) {
+				for(std::size_t row = 0; row < 8; row++) {
+					next[row * 2]     = _mm_unpacklo_epi8(rows[row], rows[row + 8]);
+					next[row * 2 + 1] = _mm_unpackhi_epi8(rows[row], rows[row + 8]);
+				}
+				std::ranges::copy(next, rows);
+			}
+			for(std::size_t row = 0; row < 16; row++) {
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(planes[first + row].data() + patch), rows[row]);
+			}
+		}
+#endif
+
+		// planes[reg][idx] = register reg of patch idx
+		void transpose(const std::uint8_t *block, planes_t &planes, const std::size_t count) noexcept {
+			std::size_t idx = 0;
+#if defined(__SSE2__)
+			// Registers 0-15 and 14-29, the overlap keeps both loads inside the patch
+			for(; idx + 16 <= count; idx += 16) {
+				transpose_16(block, planes, idx, 0);
+				transpose_16(block, planes, idx, register_count - 16);
+			}
+#endif
+			for(; idx < count; idx++) {
+				for(std::size_t reg = 0; reg < register_count; reg++) {
+					planes[reg][idx] = block[idx * register_count + reg];
+				}
+			}
+		}
+
+		// One field's column(s) for a chunk, the shift and mask come from its descriptor at compile time
+		template<std::size_t idx>
+		void decode_field(operator_columns &columns, const planes_t &planes, const std::size_t start, const std::size_t size) noexcept {
+			constexpr auto &desc = field_table[idx];
+			for(std::size_t op = 0; op < (desc.per_operator() ? 4 : 1); op++) {
+				extract<desc.shift, desc.mask>(planes[desc.register_index(op)].data(), columns.column(desc.id, op).data() + start, size);
+			}
+		}
+
+		template<std::size_t... idx>
+		void decode_fields(operator_columns &columns, const planes_t &planes, const std::size_t start, const std::size_t size,
+		                   std::index_sequence<idx...>) noexcept {
+			(decode_field<idx>(columns, planes, start, size), ...);
+		}
+	}
+
+	operator_columns::column_t &operator_columns::column(const field target, const std::size_t op) noexcept {
+		static constexpr std::array<column_t operator_columns::*, channel_field_count> channel = {
+			&operator_columns::algorithm, &operator_columns::feedback, &operator_columns::ams, &operator_columns::fms,
+		};
+		static constexpr std::array<op_column_t operator_columns::*, operator_field_count> per_operator = {
+			&operator_columns::detune, &operator_columns::multiple, &operator_columns::total_level, &operator_columns::rate_scaling,
+			&operator_columns::attack_rate, &operator_columns::amplitude_modulation, &operator_columns::decay_rate, &operator_columns::sustain_rate,
+			&operator_columns::sustain_level, &operator_columns::release_rate, &operator_columns::ssgeg,
+		};
+		const auto idx = std::to_underlying(target);
+		return is_channel_field(target) ? this->*channel[idx] : (this->*per_operator[idx - channel_field_count])[op];
+	}
+
+	void operator_columns::decode(const std::span<const operators> patches) {
+		const auto count = patches.size();
+		for(const auto &desc : field_table) {
+			for(std::size_t op = 0; op < (desc.per_operator() ? 4 : 1); op++) {
+				column(desc.id, op).resize(count);
+			}
+		}
+
+		// Registers sit 30 bytes apart from one patch to the next, transposing a chunk of patches into one plane per register
+		// leaves contiguous runs the shift and mask kernels can work through
+		const auto *bytes = reinterpret_cast<const std::uint8_t *>(patches.data());
+		planes_t planes; // Left uninitialised, transpose fills what gets read
+		for(std::size_t start = 0; start < count; start += chunk_size) {
+			const auto size = std::min(chunk_size, count - start);
+			transpose(bytes + start * register_count, planes, size);
+			decode_fields(*this, planes, start, size, std::make_index_sequence<field_count>{});
+		}
+	}
+}
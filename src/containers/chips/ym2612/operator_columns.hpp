@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "operators.hpp"
+
+namespace MID3SMPS::ym2612 {
+	// Every field of many patches decoded at once, one array per field (and operator) instead of one accessor call per value.
+	// Values are exactly what the operators accessors return, enums as their underlying value and amplitude modulation as 0 or 1.
+	// Which register, shift and mask each column comes from is read from field_table.
+	struct operator_columns {
+		using column_t    = std::vector<std::uint8_t>;
+		using op_column_t = std::array<column_t, 4>; // Indexed by std::to_underlying(op_id), the order of the registers
+
+		op_column_t detune{};
+		op_column_t multiple{};
+		op_column_t total_level{};
+		op_column_t rate_scaling{};
+		op_column_t attack_rate{};
+		op_column_t amplitude_modulation{};
+		op_column_t decay_rate{};
+		op_column_t sustain_rate{};
+		op_column_t sustain_level{};
+		op_column_t release_rate{};
+		op_column_t ssgeg{};
+		column_t ams{};
+		column_t fms{};
+		column_t feedback{};
+		column_t algorithm{};
+
+		operator_columns() = default;
+		explicit operator_columns(const std::span<const operators> patches) {
+			decode(patches);
+		}
+
+		// Replaces the contents with the fields of the given patches
+		void decode(std::span<const operators> patches);
+
+		// The column for a field, channel fields only have the one so op is ignored
+		[[nodiscard]] column_t &column(field target, std::size_t op) noexcept;
+
+		[[nodiscard]] bool operator==(const operator_columns &) const = default;
+
+		[[nodiscard]] std::size_t size() const noexcept {
+			return algorithm.size();
+		}
+
+		[[nodiscard]] static constexpr std::size_t slot(const operators::op_id op) noexcept {
+			return std::to_underlying(op);
+		}
+	};
+
+	static_assert(sizeof(operators) == std::tuple_size_v<decltype(operators::registers)> && std::is_standard_layout_v<operators>,
+	              "Bulk decoding reads patches as packed register bytes");
+}
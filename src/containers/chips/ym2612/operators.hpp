@@ -1,10 +1,12 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <stdexcept>
 #include <utility>
 #include <fmt/core.h>
 
+#include "field_table.hpp"
 #include "helpers/default_usings.hpp"
 #include "helpers/list_helper.hpp"
 
@@ -85,169 +87,120 @@ namespace MID3SMPS::ym2612 {
 			mode7
 		};
 
-		struct masks {
-			static constexpr register_t detune               = 0xF0;
-			static constexpr register_t multiple             = 0x0F;
-			static constexpr register_t total_level          = 0x7F;
-			static constexpr register_t rate_scaling         = 0xC0;
-			static constexpr register_t attack_rate          = 0x1F;
-			static constexpr register_t amplitude_modulation = 0x80;
-			static constexpr register_t decay_rate           = 0x1F;
-			static constexpr register_t sustain_rate         = 0x1F;
-			static constexpr register_t sustain_level        = 0xF0;
-			static constexpr register_t release_rate         = 0x0F;
-			static constexpr register_t ssgeg_mode           = 0x0F;
-			static constexpr register_t ams                  = 0x30;
-			static constexpr register_t fms                  = 0x07;
-			static constexpr register_t feedback             = 0x38;
-			static constexpr register_t algorithm            = 0x07;
-
-			masks() = delete;
-
-			static_assert(detune == ~multiple);
-			static_assert((rate_scaling | attack_rate) == 0b11011111);
-			static_assert((amplitude_modulation | decay_rate) == 0b10011111);
-			static_assert(sustain_level == ~release_rate);
-			static_assert((ams | fms) == 0b00110111);
-			static_assert((feedback | algorithm) == 0b00111111);
-		};
+		// Any field through its descriptor. With the field known at compile time this is one load, shift and mask.
+		[[nodiscard, gnu::pure]] constexpr std::uint8_t get(const field_descriptor &desc, const op_id op = op_id::op1) const noexcept {
+			return static_cast<std::uint8_t>(registers[desc.register_index(std::to_underlying(op))].value >> desc.shift & desc.mask);
+		}
+
+		// Values above the field's maximum throw when register_t checks, release builds clamp them. The register's other fields are kept.
+		constexpr void set(const field_descriptor &desc, const op_id op, const std::uint8_t new_value) noexcept(!register_t::policy_type::checks) {
+			if constexpr(register_t::policy_type::checks) {
+				if(new_value > desc.max) {
+					throw std::overflow_error(fmt::format("{} can't be {}, its maximum is {}", desc.name, new_value, desc.max));
+				}
+			}
+			auto &target = registers[desc.register_index(std::to_underlying(op))];
+			const auto bits = std::min(new_value, desc.max);
+			target = static_cast<std::uint8_t>((target.value & ~desc.register_mask()) | bits << desc.shift);
+		}
+
+		template<field target>
+		[[nodiscard, gnu::pure]] constexpr std::uint8_t get(const op_id op = op_id::op1) const noexcept {
+			return get(describe(target), op);
+		}
+
+		template<field target>
+		constexpr void set(const op_id op, const std::uint8_t new_value) noexcept(!register_t::policy_type::checks) {
+			set(describe(target), op, new_value);
+		}
 
+		// Named accessors for the fields, channel fields ignore the operator
 		[[nodiscard, gnu::pure]] constexpr detune_mode detune(const op_id &op) const {
-			register_t value = reg(op, 0);
-			value >>= 4;
-			return static_cast<detune_mode>(value.value);
+			return static_cast<detune_mode>(get<field::detune>(op));
 		}
 
 		constexpr void detune(const op_id &op, const detune_mode mode) {
-			register_t value = std::to_underlying(mode);
-			value <<= 4;
-			auto &detune_reg = reg(op, 0);
-			detune_reg &= masks::multiple;
-			detune_reg |= value;
+			set<field::detune>(op, std::to_underlying(mode));
 		}
 
 		[[nodiscard, gnu::pure]] constexpr register_t multiple(const op_id &op) const {
-			const register_t &value = reg(op, 0);
-			return value & masks::multiple;
+			return get<field::multiple>(op);
 		}
 
 		constexpr void multiple(const op_id &op, const register_t &new_multiple) {
-			const register_t &value  = std::min(new_multiple, masks::multiple); //value &= masks::multiple;
-			register_t &multiple_reg = reg(op, 0);
-			multiple_reg &= masks::detune;
-			multiple_reg |= value;
+			set<field::multiple>(op, new_multiple.value);
 		}
 
 		[[nodiscard, gnu::pure]] constexpr register_t total_level(const op_id &op) const {
-			const register_t &value = reg(op, 1);
-			return value & masks::total_level;
+			return get<field::total_level>(op);
 		}
 
 		constexpr void total_level(const op_id &op, const register_t &new_total_level) {
-			const register_t &value = std::min(new_total_level, masks::total_level); //value &= masks::total_level;
-			reg(op, 1)              = value;
+			set<field::total_level>(op, new_total_level.value);
 		}
 
 		[[nodiscard, gnu::pure]] constexpr rate_scaling_mode rate_scaling(const op_id &op) const {
-			register_t value = reg(op, 2);
-			value >>= 6;
-			return static_cast<rate_scaling_mode>(value.value);
+			return static_cast<rate_scaling_mode>(get<field::rate_scaling>(op));
 		}
 
 		constexpr void rate_scaling(const op_id &op, const rate_scaling_mode mode) {
-			register_t value = std::to_underlying(mode);
-			value <<= 6;
-			auto &rs_reg = reg(op, 2);
-			rs_reg &= masks::attack_rate;
-			rs_reg |= value;
+			set<field::rate_scaling>(op, std::to_underlying(mode));
 		}
 
 		[[nodiscard, gnu::pure]] constexpr register_t attack_rate(const op_id &op) const {
-			const register_t &value = reg(op, 2);
-			return value & masks::attack_rate;
+			return get<field::attack_rate>(op);
 		}
 
 		constexpr void attack_rate(const op_id &op, const register_t &new_attack_rate) {
-			const register_t &value = std::min(new_attack_rate, masks::attack_rate); //value &= masks::attack_rate;
-			register_t &ar_reg      = reg(op, 2);
-			ar_reg &= masks::rate_scaling;
-			ar_reg |= value;
+			set<field::attack_rate>(op, new_attack_rate.value);
 		}
 
 		[[nodiscard, gnu::pure]] constexpr bool amplitude_modulation(const op_id &op) const {
-			register_t value = reg(op, 3);
-			value &= masks::amplitude_modulation;
-			return value == masks::amplitude_modulation;
+			return get<field::amplitude_modulation>(op) != 0;
 		}
 
 		constexpr void amplitude_modulation(const op_id &op, const bool enabled) {
-			register_t &am_reg = reg(op, 3);
-			if(enabled) {
-				am_reg |= masks::amplitude_modulation;
-			} else {
-				am_reg &= masks::amplitude_modulation;
-				//reg &= 0b10011111; // ANDing off the last 3 bits instead of only the last 1 because 2 bits go unused
-			}
+			set<field::amplitude_modulation>(op, enabled ? 1 : 0);
 		}
 
 		[[nodiscard, gnu::pure]] constexpr register_t decay_rate(const op_id &op) const {
-			const register_t &dr_reg = reg(op, 3);
-			return dr_reg & masks::decay_rate;
+			return get<field::decay_rate>(op);
 		}
 
 		constexpr void decay_rate(const op_id &op, const register_t &new_decay_rate) {
-			const register_t &value = std::min(new_decay_rate, masks::decay_rate); //value &= masks::decay_rate;
-			register_t &dr_reg      = reg(op, 3);
-			dr_reg &= ~masks::decay_rate;
-			dr_reg |= value;
+			set<field::decay_rate>(op, new_decay_rate.value);
 		}
 
 		[[nodiscard, gnu::pure]] constexpr register_t sustain_rate(const op_id &op) const {
-			const register_t &sr_reg = reg(op, 4);
-			return sr_reg & masks::sustain_rate;
+			return get<field::sustain_rate>(op);
 		}
 
 		constexpr void sustain_rate(const op_id &op, const register_t &new_sustain_rate) {
-			register_t &sr_reg = reg(op, 4);
-			sr_reg             = std::min(new_sustain_rate, masks::sustain_rate);
+			set<field::sustain_rate>(op, new_sustain_rate.value);
 		}
 
 		[[nodiscard, gnu::pure]] constexpr register_t sustain_level(const op_id &op) const {
-			const register_t &sl_reg = reg(op, 5);
-			return sl_reg >> 4;
+			return get<field::sustain_level>(op);
 		}
 
 		constexpr void sustain_level(const op_id &op, const register_t &new_sustain_level) {
-			register_t value = std::min(new_sustain_level, static_cast<register_t>(0x0F));
-			value <<= 4;
-			register_t &sl_reg = reg(op, 5);
-			sl_reg &= masks::release_rate;
-			sl_reg |= value;
+			set<field::sustain_level>(op, new_sustain_level.value);
 		}
 
 		[[nodiscard, gnu::pure]] constexpr register_t release_rate(const op_id &op) const {
-			const register_t &rr_reg = reg(op, 5);
-			return rr_reg & masks::release_rate;
+			return get<field::release_rate>(op);
 		}
 
 		constexpr void release_rate(const op_id &op, const register_t &new_release_rate) {
-			const register_t &value = std::min(new_release_rate, masks::release_rate);
-			//value &= masks::release_rate;
-			register_t &rr_reg = reg(op, 5);
-			rr_reg &= masks::sustain_level;
-			rr_reg |= value;
+			set<field::release_rate>(op, new_release_rate.value);
 		}
 
 		[[nodiscard, gnu::pure]] constexpr ssgeg_mode ssgeg(const op_id &op) const {
-			register_t value = reg(op, 6);
-			[[assume(value <= masks::ssgeg_mode)]];
-			//value &= masks::ssgeg_mode;
-			return static_cast<ssgeg_mode>(value.value);
+			return static_cast<ssgeg_mode>(get<field::ssgeg>(op));
 		}
 
 		constexpr void ssgeg(const op_id &op, const ssgeg_mode mode) {
-			register_t &ssgeg_reg = reg(op, 6);
-			ssgeg_reg             = std::to_underlying(mode);
+			set<field::ssgeg>(op, std::to_underlying(mode));
 		}
 
 		static constexpr std::array ams_values = {
@@ -258,18 +211,11 @@ namespace MID3SMPS::ym2612 {
 		};
 
 		[[nodiscard, gnu::pure]] constexpr register_t ams() const {
-			const register_t &lfo_sensitivity_reg = reg(op_id::op3, 7);
-			register_t val                        = lfo_sensitivity_reg & masks::ams;
-			val >>= 4;
-			return val;
+			return get<field::ams>();
 		}
 
 		constexpr void ams(const register_t &new_ams_val) {
-			register_t val = std::min(new_ams_val, static_cast<register_t>(3));
-			val <<= 4;
-			register_t &lfo_sensitivity_reg = reg(op_id::op3, 7);
-			lfo_sensitivity_reg &= masks::fms;
-			lfo_sensitivity_reg |= val;
+			set<field::ams>(op_id::op1, new_ams_val.value);
 		}
 
 		static constexpr std::array fms_values = {
@@ -284,42 +230,27 @@ namespace MID3SMPS::ym2612 {
 		};
 
 		[[nodiscard, gnu::pure]] constexpr register_t fms() const {
-			const register_t &lfo_sensitivity_reg = reg(op_id::op3, 7);
-			return lfo_sensitivity_reg & masks::fms;
+			return get<field::fms>();
 		}
 
 		constexpr void fms(const register_t &new_fms_val) {
-			const register_t &val           = std::min(new_fms_val, masks::fms);
-			register_t &lfo_sensitivity_reg = reg(op_id::op3, 7);
-			lfo_sensitivity_reg &= masks::ams;
-			lfo_sensitivity_reg |= val;
+			set<field::fms>(op_id::op1, new_fms_val.value);
 		}
 
 		[[nodiscard, gnu::pure]] constexpr feedback_mode feedback() const {
-			const register_t &feedback_algo_reg = reg(op_id::op1, 7);
-			return static_cast<feedback_mode>((feedback_algo_reg >> 3).value);
+			return static_cast<feedback_mode>(get<field::feedback>());
 		}
 
 		constexpr void feedback(const feedback_mode new_feedback_mode) {
-			register_t val = std::to_underlying(new_feedback_mode);
-			val <<= 3;
-			val &= masks::feedback;
-			register_t &feedback_algo_reg = reg(op_id::op1, 7);
-			feedback_algo_reg &= masks::algorithm;
-			feedback_algo_reg |= val;
+			set<field::feedback>(op_id::op1, std::to_underlying(new_feedback_mode));
 		}
 
 		[[nodiscard, gnu::pure]] constexpr algorithm_mode algorithm() const {
-			const register_t &feedback_algo_reg = reg(op_id::op1, 7);
-			return static_cast<algorithm_mode>((feedback_algo_reg & masks::algorithm).value);
+			return static_cast<algorithm_mode>(get<field::algorithm>());
 		}
 
 		constexpr void algorithm(const algorithm_mode new_algorithm_mode) {
-			register_t val = std::to_underlying(new_algorithm_mode);
-			val &= masks::algorithm;
-			register_t &feedback_algo_reg = reg(op_id::op1, 7);
-			feedback_algo_reg &= masks::feedback;
-			feedback_algo_reg |= val;
+			set<field::algorithm>(op_id::op1, std::to_underlying(new_algorithm_mode));
 		}
 
 		[[nodiscard, gnu::const]] static constexpr auto string(const op_id &id) {
@@ -334,80 +265,23 @@ namespace MID3SMPS::ym2612 {
 		}
 
 		[[nodiscard, gnu::const]] static constexpr auto string(const detune_mode &mode) {
-			using namespace std::string_view_literals;
-			using enum detune_mode;
-			switch(mode) {
-				case no_change_1:
-				case no_change_2: return "No Change"sv;
-				case plus_e: return "+1 × E"sv;
-				case plus_2e: return "+2 × E"sv;
-				case plus_3e: return "+3 × E"sv;
-				case minus_e: return "-1 × E"sv;
-				case minus_2e: return "-2 × E"sv;
-				case minus_3e: return "-3 × E"sv;
-				default: throw std::logic_error(fmt::format("Invalid value for detune_mode, got {}", std::to_underlying(mode)));
-			}
+			return option_string(field::detune, std::to_underlying(mode), "detune_mode"sv);
 		}
 
 		[[nodiscard, gnu::const]] static constexpr auto string(const rate_scaling_mode &mode) {
-			using namespace std::string_view_literals;
-			using enum rate_scaling_mode;
-			switch(mode) {
-				case kc8: return "(KC/8) + (2×Rate)"sv;
-				case kc4: return "(KC/4) + (2×Rate)"sv;
-				case kc2: return "(KC/2) + (2×Rate)"sv;
-				case kc1: return "(KC/1) + (2×Rate)"sv;
-				default: throw std::logic_error(fmt::format("Invalid value for rate_scaling_mode, got {}", std::to_underlying(mode)));
-			}
+			return option_string(field::rate_scaling, std::to_underlying(mode), "rate_scaling_mode"sv);
 		}
 
 		[[nodiscard, gnu::const]] static constexpr auto string(const ssgeg_mode &mode) {
-			using namespace std::string_view_literals;
-			using enum ssgeg_mode;
-			switch(mode) {
-				case disabled: return "Disabled"sv;
-				case mode0: return R"(\\\\)"sv;
-				case mode1: return R"(\___)"sv;
-				case mode2: return R"(\/\/)"sv;
-				case mode3: return R"(\¯¯¯)"sv;
-				case mode4: return R"(////)"sv;
-				case mode5: return R"(/¯¯¯)"sv;
-				case mode6: return R"(/\/\)"sv;
-				case mode7: return R"(/___)"sv;
-				default: throw std::logic_error(fmt::format("Invalid value for ssgeg_mode, got {}", std::to_underlying(mode)));
-			}
+			return option_string(field::ssgeg, std::to_underlying(mode), "ssgeg_mode"sv);
 		}
 
 		[[nodiscard, gnu::const]] static constexpr auto string(const feedback_mode &mode) {
-			using namespace std::string_view_literals;
-			using enum feedback_mode;
-			switch(mode) {
-				case off: return "Off"sv;
-				case pi_div_16: return "Pi / 16"sv;
-				case pi_div_8: return "Pi / 8"sv;
-				case pi_div_4: return "Pi / 4"sv;
-				case pi_div_2: return "Pi / 2"sv;
-				case pi: return "Pi"sv;
-				case pi_mul_2: return "2 * Pi"sv;
-				case pi_mul_4: return "4 * Pi"sv;
-				default: throw std::logic_error(fmt::format("Invalid value for feedback_mode, got {}", std::to_underlying(mode)));
-			}
+			return option_string(field::feedback, std::to_underlying(mode), "feedback_mode"sv);
 		}
 
 		[[nodiscard, gnu::const]] static constexpr auto string(const algorithm_mode &mode) {
-			using namespace std::string_view_literals;
-			using enum algorithm_mode;
-			switch(mode) {
-				case mode0: return "0 (Out 4)"sv;
-				case mode1: return "1 (Out 4)"sv;
-				case mode2: return "2 (Out 4)"sv;
-				case mode3: return "3 (Out 4)"sv;
-				case mode4: return "4 (Out 2-4)"sv;
-				case mode5: return "5 (Out 2-3-4)"sv;
-				case mode6: return "6 (Out 2-3-4)"sv;
-				case mode7: return "7 (Out 1-2-3-4)"sv;
-				default: throw std::logic_error(fmt::format("Invalid value for algorithm_mode, got {}", std::to_underlying(mode)));
-			}
+			return option_string(field::algorithm, std::to_underlying(mode), "algorithm_mode"sv);
 		}
 
 		[[nodiscard, gnu::const]] static constexpr std::size_t operator_to_index(const op_id &op) {
@@ -416,6 +290,15 @@ namespace MID3SMPS::ym2612 {
 			}
 			return std::to_underlying(op);
 		}
+
+	private:
+		[[nodiscard]] static constexpr std::string_view option_string(const field target, const std::uint8_t value, const std::string_view type) {
+			const auto name = describe(target).option_name(value);
+			if(name.empty()) {
+				throw std::logic_error(fmt::format("Invalid value for {}, got {}", type, value));
+			}
+			return name;
+		}
 	};
 
 	static_assert(sizeof(operators) == operators::instrument_register_size.value);
@@ -0,0 +1,30 @@
+#include "dirty_graph.hpp"
+
+#include <algorithm>
+
+namespace MID3SMPS {
+	std::uint64_t dirty_node::recomputations_ = 0;
+
+	dirty_node::dirty_node(const std::initializer_list<dirty_node *> inputs) : inputs_(inputs) {
+		for(auto *input : inputs_) {
+			input->dependents_.push_back(this);
+		}
+	}
+
+	dirty_node::~dirty_node() {
+		for(auto *input : inputs_) {
+			std::erase(input->dependents_, this);
+		}
+		for(auto *dependent : dependents_) {
+			std::erase(dependent->inputs_, this);
+		}
+	}
+
+	void dirty_node::mark_dirty() noexcept {
+		// Dependents that are already dirty still pass it on, one of theirs may have been recomputed without reading them
+		for(auto *dependent : dependents_) {
+			dependent->invalidate();
+			dependent->mark_dirty();
+		}
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+#include "dirtyable.hpp"
+#include "helpers/trace.hpp"
+
+namespace MID3SMPS {
+	// A node in a graph of data derived from other data. Marking a node dirty marks everything computed from it, directly or not,
+	// and derived values are only recomputed when they're read while dirty, so frames where nothing changed recompute nothing.
+	// Edges point at the nodes, so nodes can't be copied or moved and must outlive the ones that depend on them.
+	class dirty_node {
+		std::vector<dirty_node *> inputs_{};
+		std::vector<dirty_node *> dependents_{};
+
+		static std::uint64_t recomputations_;
+
+	protected:
+		virtual void invalidate() noexcept {}
+
+		static void count_recomputation() noexcept {
+			++recomputations_;
+		}
+
+	public:
+		dirty_node() = default;
+		explicit dirty_node(std::initializer_list<dirty_node *> inputs);
+		dirty_node(const dirty_node &other)            = delete;
+		dirty_node &operator=(const dirty_node &other) = delete;
+		virtual ~dirty_node();
+
+		// Call after changing whatever this node stands for
+		void mark_dirty() noexcept;
+
+		// Derived values recomputed since startup, across every graph. Reading it each frame shows whether idle frames do any work.
+		[[nodiscard]] static std::uint64_t recomputations() noexcept {
+			return recomputations_;
+		}
+	};
+
+	// Stands for some state owned elsewhere (a selection, the bank's order) that derived values read
+	using dirty_input = dirty_node;
+
+	template<typename T>
+	class derived final : public dirty_node {
+		dirtyable<T> value_{};
+		std::function<T()> compute_;
+		std::uint64_t recomputed_ = 0;
+
+		void invalidate() noexcept override {
+			value_.markDirty();
+		}
+
+	public:
+		// compute must only read what the inputs stand for
+		derived(std::function<T()> compute, const std::initializer_list<dirty_node *> inputs) : dirty_node(inputs), compute_(std::move(compute)) {}
+
+		// Changing the value in place is fine as long as it stays what compute would return
+		[[nodiscard]] T &get() {
+			if(value_.dirty()) {
+				TRACE_ZONE("Recompute derived value");
+				value_ = compute_();
+				value_.clearDirty();
+				++recomputed_;
+				count_recomputation();
+			}
+			return *value_;
+		}
+
+		[[nodiscard]] bool dirty() const noexcept {
+			return value_.dirty();
+		}
+
+		[[nodiscard]] std::uint64_t recomputed() const noexcept {
+			return recomputed_;
+		}
+	};
+}
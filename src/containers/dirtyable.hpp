@@ -1,5 +1,6 @@
 #pragma once
 
+#include <concepts>
 #include <utility>
 #include <optional>
 
@@ -59,7 +60,12 @@ public:
 	}
 
 	constexpr dirtyable& operator =(T&& newData){
-		if(data != newData){
+		// Values that can't be compared are always treated as changed
+		if constexpr(std::equality_comparable<T>){
+			if(data != newData){
+				isDirty = true;
+			}
+		} else {
 			isDirty = true;
 		}
 		data = std::make_optional<T>(std::move(newData));
@@ -0,0 +1,121 @@
+#include "edit_journal.hpp"
+
+#include <algorithm>
+
+namespace MID3SMPS {
+	void edit_journal::drop_redo() {
+		// A new step drops everything that could have been redone, positions are never reused so a save point in there stays unreachable
+		while(steps_.size() > cursor_) {
+			bytes_ -= cost(steps_.back());
+			steps_.pop_back();
+		}
+	}
+
+	void edit_journal::push(step &&entry) {
+		entry.deltas.shrink_to_fit();
+		entry.position = next_position_++;
+		steps_.push_back(std::move(entry));
+		bytes_ += cost(steps_.back());
+		cursor_ = steps_.size();
+		enforce_capacity();
+	}
+
+	void edit_journal::record(std::vector<delta> &&deltas, const std::uint32_t key, const clock::time_point now) {
+		if(deltas.empty()) {
+			return;
+		}
+		drop_redo();
+
+		if(!steps_.empty()) {
+			auto &last = steps_.back();
+			const auto same_patch = [&] {
+				return !last.deltas.empty() && std::ranges::all_of(deltas, [&last](const delta &change) {
+					return change.id == last.deltas.front().id;
+				});
+			};
+			if(key != 0 && key == last.key && now - last.last_change < coalesce_window && same_patch()) {
+				bytes_ -= cost(last);
+				for(const auto &change : deltas) {
+					const auto existing = std::ranges::find_if(last.deltas, [&change](const delta &other) {
+						return other.id == change.id && other.offset == change.offset;
+					});
+					if(existing != last.deltas.end()) {
+						existing->after = change.after; // The step still starts from the first before value
+					} else {
+						last.deltas.push_back(change);
+					}
+				}
+				last.last_change = now;
+				bytes_ += cost(last);
+				enforce_capacity();
+				return;
+			}
+		}
+
+		push({.deltas = std::move(deltas), .renames = {}, .key = key, .last_change = now, .position = 0});
+	}
+
+	void edit_journal::record(rename &&change, const clock::time_point now) {
+		if(change.before == change.after) {
+			return;
+		}
+		drop_redo();
+		std::vector<rename> renames;
+		renames.push_back(std::move(change));
+		push({.deltas = {}, .renames = std::move(renames), .key = 0, .last_change = now, .position = 0});
+	}
+
+	void edit_journal::enforce_capacity() {
+		// Always keeps the latest step, even one that is larger than the whole capacity
+		while(bytes_ > capacity_ && steps_.size() > 1) {
+			bytes_ -= cost(steps_.front());
+			first_ = steps_.front().position;
+			steps_.pop_front();
+			--cursor_;
+		}
+	}
+
+	void edit_journal::seal() noexcept {
+		if(cursor_ > 0) {
+			steps_[cursor_ - 1].key = 0;
+		}
+	}
+
+	edit_journal::changes edit_journal::undo() noexcept {
+		if(!can_undo()) {
+			return {};
+		}
+		--cursor_;
+		seal(); // Whatever gets recorded after an undo is a step of its own
+		return {steps_[cursor_].deltas, steps_[cursor_].renames};
+	}
+
+	edit_journal::changes edit_journal::redo() noexcept {
+		if(!can_redo()) {
+			return {};
+		}
+		steps_[cursor_].key = 0;
+		const auto &applied = steps_[cursor_++];
+		return {applied.deltas, applied.renames};
+	}
+
+	void edit_journal::clear() noexcept {
+		steps_.clear();
+		cursor_  = 0;
+		cleared_ = next_position_++;
+		first_   = cleared_;
+		saved_   = cleared_;
+		bytes_   = 0;
+	}
+
+	edit_journal::position_t edit_journal::position() noexcept {
+		seal();
+		return cursor_ == 0 ? first_ : steps_[cursor_ - 1].position;
+	}
+
+	void edit_journal::mark_saved(const position_t saved) noexcept {
+		if(saved >= cleared_) {
+			saved_ = saved; // Might be a step that was dropped since, then nothing matches it any more
+		}
+	}
+}
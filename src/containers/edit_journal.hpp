@@ -0,0 +1,122 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "instrument_bank.hpp"
+
+namespace MID3SMPS {
+	// Undo/redo history of patch edits that keeps only the bytes that changed.
+	// A step is a list of deltas, undoing it writes every before value back and redoing it every after value.
+	class edit_journal {
+	public:
+		struct delta {
+			ins_key_t id;
+			std::uint8_t offset; // Register index, transposition_offset or lfo_offset
+			std::uint8_t before;
+			std::uint8_t after;
+		};
+		static constexpr std::uint8_t transposition_offset = 0x1E; // The byte after the registers, transposition or drum note
+		static constexpr std::uint8_t lfo_offset           = 0x1F; // The bank's default LFO speed, the ID isn't used
+
+		// Names don't fit in a delta, a rename is a step of its own
+		struct rename {
+			ins_key_t id;
+			std::string before;
+			std::string after;
+		};
+
+		// What undo and redo hand back, empty if there was nothing to undo or redo
+		struct changes {
+			std::span<const delta> deltas{};
+			std::span<const rename> renames{};
+
+			[[nodiscard]] bool empty() const noexcept {
+				return deltas.empty() && renames.empty();
+			}
+		};
+
+		// Names a point in the history. Positions aren't reused, one from before a clear or of a step that was dropped never comes back.
+		using position_t = std::uint64_t;
+
+		using clock = std::chrono::steady_clock;
+		static constexpr auto coalesce_window         = std::chrono::milliseconds(750);
+		static constexpr std::size_t default_capacity = 8 << 20;
+
+	private:
+		struct step {
+			std::vector<delta> deltas;
+			std::vector<rename> renames;
+			std::uint32_t key;
+			clock::time_point last_change;
+			position_t position; // Where the history is once this step has been applied
+		};
+
+		std::deque<step> steps_{};
+		std::size_t cursor_       = 0; // Steps before the cursor can be undone, the ones after it redone
+		position_t cleared_       = 0; // Position the bank was loaded at, anything older belongs to another bank
+		position_t first_         = 0; // Position before the oldest step still kept
+		position_t saved_         = 0; // Position when the bank was last saved or loaded
+		position_t next_position_ = 1;
+		std::size_t bytes_        = 0;
+		std::size_t capacity_;
+
+		[[nodiscard]] static std::size_t cost(const step &entry) noexcept {
+			std::size_t bytes = sizeof(step) + entry.deltas.capacity() * sizeof(delta) + entry.renames.capacity() * sizeof(rename);
+			for(const auto &[id, before, after] : entry.renames) {
+				bytes += before.capacity() + after.capacity();
+			}
+			return bytes;
+		}
+		void drop_redo();
+		void push(step &&entry);
+		void enforce_capacity();
+
+	public:
+		explicit edit_journal(const std::size_t capacity = default_capacity) noexcept : capacity_(capacity) {}
+
+		// Adds a step, or extends the last one if it has the same non-zero key, touches the same patch and came within
+		// coalesce_window of it. Dragging a slider keeps the key (the widget's ID) and ends up as a single step.
+		void record(std::vector<delta> &&deltas, std::uint32_t key = 0, clock::time_point now = clock::now());
+		// Adds a rename as its own step, nothing if the name didn't change
+		void record(rename &&change, clock::time_point now = clock::now());
+		// The next record starts a new step even if it could be merged
+		void seal() noexcept;
+
+		[[nodiscard]] bool can_undo() const noexcept {
+			return cursor_ > 0;
+		}
+		[[nodiscard]] bool can_redo() const noexcept {
+			return cursor_ < steps_.size();
+		}
+		// The step to revert, its deltas to be written back in reverse order using their before values
+		[[nodiscard]] changes undo() noexcept;
+		// The step to reapply, its deltas in order using their after values
+		[[nodiscard]] changes redo() noexcept;
+
+		void clear() noexcept;
+
+		// Where the history is right now. Seals the last step, so later edits can't merge into what this position stands for.
+		[[nodiscard]] position_t position() noexcept;
+		// The patches as they were at saved are what's on disk now. Ignored if saved is from before the last clear.
+		void mark_saved(position_t saved) noexcept;
+		void mark_saved() noexcept {
+			mark_saved(position());
+		}
+		// Whether the patches differ from when they were last saved or loaded
+		[[nodiscard]] bool modified() const noexcept {
+			return (cursor_ == 0 ? first_ : steps_[cursor_ - 1].position) != saved_;
+		}
+
+		[[nodiscard]] std::size_t size() const noexcept {
+			return steps_.size();
+		}
+		[[nodiscard]] std::size_t memory_usage() const noexcept {
+			return bytes_;
+		}
+	};
+}
@@ -0,0 +1,76 @@
+#include "batch_edit.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "helpers/trace.hpp"
+
+namespace MID3SMPS::M2S {
+	std::uint8_t batch_edit::field_change::operator()(const std::uint8_t current) const {
+		int result = current;
+		switch(apply) {
+			case operation::set: result = amount;
+				break;
+			case operation::offset: result = current + amount;
+				break;
+			case operation::scale: result = static_cast<int>(std::lround(current * factor));
+				break;
+			case operation::clamp: result = std::clamp<int>(current, low, std::max(low, high));
+				break;
+			default: break;
+		}
+		return static_cast<std::uint8_t>(std::clamp<int>(result, 0, ym2612::max_value(target)));
+	}
+
+	std::vector<edit_journal::delta> batch_edit::apply(copy_on_write<gyb> &bank, const std::span<const target_t> targets) const {
+		TRACE_ZONE("Batch edit");
+		std::vector<edit_journal::delta> deltas;
+		for(const auto &[bank_id, id] : targets) {
+			const auto *current = dynamic_cast<const fm::patch *>(bank->instruments.find(id));
+			if(current == nullptr) {
+				continue;
+			}
+			// Worked out on a copy, the patch is only unshared from the bank's snapshots if its bytes change
+			auto operators = current->operators;
+			auto note      = current->default_drum_note; // Shares its byte with the transposition
+			for(const auto &change : changes) {
+				if(ym2612::is_channel_field(change.target)) {
+					ym2612::set_value(operators, change.target, ym2612::operators::op_id::op1, change(ym2612::value(operators, change.target)));
+					continue;
+				}
+				for(const auto &op : list<ym2612::operators::op_id>()) {
+					if((change.operators >> std::to_underlying(op) & 1) != 0) {
+						ym2612::set_value(operators, change.target, op, change(ym2612::value(operators, change.target, op)));
+					}
+				}
+			}
+
+			if(transpose != 0 && bank_id == bank->drum_bank) {
+				note = static_cast<std::uint8_t>(std::clamp(note + transpose, 0, 127));
+			} else if(transpose != 0) {
+				using limits = std::numeric_limits<std::int8_t>;
+				note         = static_cast<std::uint8_t>(std::clamp<int>(current->instrument_transposition + transpose, limits::min(), limits::max()));
+			}
+
+			const auto first      = deltas.size();
+			const auto &registers = current->operators.registers;
+			for(std::uint8_t offset = 0; offset < registers.size(); offset++) {
+				if(registers[offset] != operators.registers[offset]) {
+					deltas.push_back({id, offset, registers[offset].value, operators.registers[offset].value});
+				}
+			}
+			if(note != current->default_drum_note) {
+				deltas.push_back({id, edit_journal::transposition_offset, current->default_drum_note, note});
+			}
+			if(deltas.size() == first) {
+				continue;
+			}
+
+			auto &patch             = dynamic_cast<fm::patch &>(bank.write().writable(id));
+			patch.operators         = operators;
+			patch.default_drum_note = note;
+		}
+		return deltas;
+	}
+}
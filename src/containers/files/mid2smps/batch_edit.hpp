@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "gyb.hpp"
+#include "containers/edit_journal.hpp"
+#include "containers/chips/ym2612/fields.hpp"
+#include "helpers/copy_on_write.hpp"
+
+namespace MID3SMPS::M2S {
+	// Changes made to many patches of a bank at once, like lowering the release rate of every drum
+	struct batch_edit {
+		enum class operation : std::uint8_t {
+			set,
+			offset,
+			scale,
+			clamp,
+		};
+
+		struct field_change {
+			ym2612::field target   = ym2612::field::total_level;
+			std::uint8_t operators = 0b1111; // Bit per operator, std::to_underlying(op_id) is the bit. Ignored for channel fields.
+			operation apply        = operation::set;
+			int amount             = 0;   // The new value for set, added for offset
+			float factor           = 1.f; // For scale
+			std::uint8_t low       = 0;   // Bounds for clamp
+			std::uint8_t high      = 0xFF;
+
+			// Results are clamped to what the field can hold
+			[[nodiscard]] std::uint8_t operator()(std::uint8_t current) const;
+		};
+
+		using target_t = std::pair<bank_key_t, ins_key_t>;
+
+		std::vector<field_change> changes{};
+		std::int8_t transpose = 0; // Semitones added to the transposition of melody patches and the note of drum patches
+
+		// Goes over every target once, applying all changes to it. Targets that aren't FM patches are skipped, and neither
+		// the bank nor a patch is unshared from its snapshots unless something in it changes.
+		// Returns the bytes that changed, as one step for the edit journal.
+		std::vector<edit_journal::delta> apply(copy_on_write<gyb> &bank, std::span<const target_t> targets) const;
+	};
+}
@@ -0,0 +1,44 @@
+#include "dac_list.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <fmt/core.h>
+
+#include "exceptions/formatException.hpp"
+#include "helpers/file_io.hpp"
+#include "helpers/text.hpp"
+#include "helpers/trace.hpp"
+
+namespace MID3SMPS::M2S {
+	dac_list::dac_list(const fs::path &path) {
+		TRACE_ZONE("Load DAC list");
+		const auto data = read_file(path);
+		*this = dac_list({reinterpret_cast<const char *>(data.data()), data.size()}, path.parent_path(), path.filename().string());
+	}
+
+	dac_list::dac_list(const std::string_view text, const fs::path &base, const std::string_view source) {
+		text_lines lines(text);
+		std::string_view line;
+		while(lines.next(line)) {
+			line = trim(line);
+			if(line.empty() || line.front() == ';' || line.front() == '#') {
+				continue;
+			}
+
+			// Paths can have spaces in them, a rate is only taken from the end if it's all digits
+			std::uint32_t rate = 0;
+			if(const auto split = line.find_last_of(" \t"); split != std::string_view::npos) {
+				const auto last = line.substr(split + 1);
+				if(std::ranges::all_of(last, [](const unsigned char digit) { return std::isdigit(digit) != 0; })) {
+					const auto parsed = parse_number<std::uint32_t>(last);
+					if(!parsed || *parsed == 0) {
+						throw format_exception(fmt::format("{}:{}: Invalid sample rate '{}'", source, lines.number(), last));
+					}
+					rate = *parsed;
+					line = trim(line.substr(0, split));
+				}
+			}
+			entries.push_back({base / fs::path(line), rate, lines.number()});
+		}
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+namespace MID3SMPS::M2S {
+	namespace fs = std::filesystem;
+
+	// The samples a mapping's drums can play, one per line in the order the driver numbers them:
+	//	path [source rate]
+	// Paths are relative to the list. Blank lines and lines starting with ';' or '#' are skipped.
+	// The rate is only needed for headerless 8-bit unsigned samples, WAV files carry their own.
+	struct dac_list {
+		struct entry {
+			fs::path path;
+			std::uint32_t rate = 0; // 0 if the list didn't give one
+			std::size_t line   = 0; // For errors about the sample later on
+		};
+
+		std::vector<entry> entries{};
+
+		dac_list() = default;
+		explicit dac_list(const fs::path &path);
+		// Errors name the line they're on, prefixed with source
+		dac_list(std::string_view text, const fs::path &base, std::string_view source);
+	};
+}
@@ -0,0 +1,78 @@
+#include "dac_map.hpp"
+
+#include <fmt/core.h>
+
+#include "exceptions/formatException.hpp"
+#include "helpers/file_io.hpp"
+#include "helpers/text.hpp"
+#include "helpers/trace.hpp"
+
+namespace MID3SMPS::M2S {
+	dac_map::dac_map(const fs::path &path) {
+		TRACE_ZONE("Load DAC map");
+		const auto data = read_file(path);
+		*this = dac_map({reinterpret_cast<const char *>(data.data()), data.size()}, path.filename().string());
+	}
+
+	dac_map::dac_map(const std::string_view text, const std::string_view source) {
+		text_lines lines(text);
+		std::string_view line;
+		// Which line set each hit, only needed to point at both lines when a note is given twice
+		std::vector<std::uint32_t> set_on;
+		std::size_t kit = 0;
+
+		const auto fail = [&](const std::string_view message, const std::string_view word) {
+			return format_exception(fmt::format("{}:{}: {} '{}'", source, lines.number(), message, word));
+		};
+		const auto number = [&](const std::string_view word, const std::size_t limit, const std::string_view what) {
+			if(word.empty()) {
+				throw format_exception(fmt::format("{}:{}: Missing {}", source, lines.number(), what));
+			}
+			const auto value = parse_number<std::uint32_t>(word);
+			if(!value || *value > limit) {
+				throw fail(fmt::format("Invalid {}", what), word);
+			}
+			return static_cast<std::uint8_t>(*value);
+		};
+
+		while(lines.next(line)) {
+			line = line.substr(0, line.find_first_of(";#"));
+			auto word = take_word(line);
+			if(word.empty()) {
+				continue;
+			}
+			if(word == "kit") {
+				word = take_word(line);
+				kit  = number(word, max_kits - 1, "kit");
+				if(!line.empty()) {
+					throw fail("Unexpected text after the kit", line);
+				}
+				continue;
+			}
+
+			const auto note = number(word, notes - 1, "note");
+			hit entry;
+			entry.sample = number(take_word(line), no_sample - 1, "sample");
+			if(!line.empty()) {
+				entry.pitch = number(take_word(line), 0xFF, "pitch");
+			}
+			if(!line.empty()) {
+				entry.volume = number(take_word(line), 127, "volume");
+			}
+			if(!line.empty()) {
+				throw fail("Unexpected text after the volume", line);
+			}
+
+			if(hits.size() <= kit * notes) {
+				hits.resize((kit + 1) * notes);
+				set_on.resize(hits.size());
+			}
+			const auto idx = kit * notes + note;
+			if(set_on[idx] != 0) {
+				throw format_exception(fmt::format("{}:{}: Note {} of kit {} is already mapped on line {}", source, lines.number(), note, kit, set_on[idx]));
+			}
+			hits[idx]   = entry;
+			set_on[idx] = static_cast<std::uint32_t>(lines.number());
+		}
+	}
+}
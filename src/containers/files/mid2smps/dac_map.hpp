@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+namespace MID3SMPS::M2S {
+	namespace fs = std::filesystem;
+
+	// Which DAC sample every MIDI drum note plays, per drum kit (the program on the drum channel). One hit per line:
+	//	note sample [pitch [volume]]
+	// "kit N" switches to kit N for the lines after it, lines before the first one go to kit 0.
+	// Numbers are decimal or hex after 0x or $, samples count from 0 in the DAC list.
+	// Blank lines and anything after ';' or '#' are skipped.
+	struct dac_map {
+		static constexpr std::size_t notes      = 128;
+		static constexpr std::size_t max_kits   = 128;
+		static constexpr std::uint8_t no_sample = 0xFF;
+
+		struct hit {
+			std::uint8_t sample = no_sample;
+			std::uint8_t pitch  = 0;   // The driver's playback rate byte, 0 keeps the sample's own
+			std::uint8_t volume = 127; // Velocity scale, 127 leaves it alone
+		};
+
+		// Every kit up to the highest one used gets a full table, a note's hit is hits[kit * notes + note]
+		std::vector<hit> hits{};
+
+		dac_map() = default;
+		explicit dac_map(const fs::path &path);
+		// Errors name the line they're on, prefixed with source
+		dac_map(std::string_view text, std::string_view source);
+
+		[[nodiscard]] std::size_t kit_count() const noexcept {
+			return hits.size() / notes;
+		}
+
+		// Kits the map doesn't have play nothing
+		[[nodiscard]] hit find(const std::size_t kit, const std::uint8_t note) const noexcept {
+			const auto idx = kit * notes + (note & 0x7F);
+			return idx < hits.size() ? hits[idx] : hit{};
+		}
+	};
+}
@@ -1,5 +1,6 @@
 #include "patch.hpp"
 
+#include <algorithm>
 #include <spanstream>
 #include <fmt/core.h>
 
@@ -20,4 +21,22 @@ namespace MID3SMPS::M2S::fm {
 		name.resize(name_length);
 		stream.read(reinterpret_cast<std::uint8_t*>(name.data()), name_length);
 	}
+
+	void patch::save_v3(std::vector<std::uint8_t> &out) const {
+		if(options.chord_notes) {
+			throw std::logic_error("chord notes not implimented yet"); // todo
+		}
+		// The length is a single byte, longer names are cut short
+		const auto name_length = std::min<std::size_t>(name.size(), 0xFF);
+		const auto total_size  = static_cast<std::uint16_t>(2 + operators.registers.size() + 3 + name_length);
+		out.push_back(static_cast<std::uint8_t>(total_size & 0xFF));
+		out.push_back(static_cast<std::uint8_t>(total_size >> 8));
+		for(const auto &reg : operators.registers) {
+			out.push_back(reg.value);
+		}
+		out.push_back(default_drum_note); // Same byte as the transposition
+		out.push_back(0);                 // No additional data
+		out.push_back(static_cast<std::uint8_t>(name_length));
+		out.insert(out.end(), name.begin(), name.begin() + static_cast<std::ptrdiff_t>(name_length));
+	}
 }
\ No newline at end of file
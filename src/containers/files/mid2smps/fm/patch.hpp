@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <span>
 #include <spanstream>
+#include <vector>
 
 #include "containers/fm_instrument.hpp"
 
@@ -60,6 +61,13 @@ namespace MID3SMPS::M2S {
 			}
 
 			constexpr ~patch() override = default;
+
+			// Appends the patch as GYB v3 instrument data, what the v3 constructor reads back
+			void save_v3(std::vector<std::uint8_t> &out) const;
+
+			[[nodiscard]] std::shared_ptr<instrument> clone() const override {
+				return std::make_shared<patch>(*this);
+			}
 		};
 
 		static patch empty_patch{};
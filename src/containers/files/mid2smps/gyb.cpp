@@ -1,8 +1,11 @@
 #include "gyb.hpp"
 
 #include <fstream>
+#include <limits>
 #include <spanstream>
 
+#include "helpers/trace.hpp"
+
 namespace MID3SMPS::M2S {
 	namespace errors {
 		static constexpr auto invalid = "Not a valid GYB formatted file";
@@ -10,6 +13,7 @@ namespace MID3SMPS::M2S {
 	}
 
 	gyb::gyb(const fs::path &path) {
+		TRACE_ZONE("Load GYB");
 		using byte_t = std::uint8_t;
 		std::vector<byte_t> data;
 		if(exists(path)) {
@@ -26,8 +30,11 @@ namespace MID3SMPS::M2S {
 		} else {
 			throw std::runtime_error(errors::missing);
 		}
+		*this = gyb(std::span<const byte_t>(data));
+	}
 
-		if(data[0] != 26 || data[1] != 12) {
+	gyb::gyb(const std::span<const std::uint8_t> data) {
+		if(data.size() < 3 || data[0] != 26 || data[1] != 12) {
 			throw std::runtime_error(errors::invalid);
 		}
 
@@ -64,12 +71,11 @@ namespace MID3SMPS::M2S {
 			throw std::runtime_error(errors::invalid);
 		}
 		const auto bank_offset = stream_convert<std::uint32_t>(stream);
-		const auto maps_offset = stream_convert<std::uint32_t>(stream); (void)maps_offset; // Todo impliment reading mappings
+		const auto maps_offset = stream_convert<std::uint32_t>(stream);
 		stream.seekg(bank_offset);
 		const auto instrument_count = stream_convert<std::uint16_t>(stream);
-		instruments.reserve(instrument_count);
-		const auto melodic_id = add_bank("M2S Melodic bank");
-		auto &melodic_order = instruments_order[melodic_id];
+		const auto melodic_id = melody_bank = add_bank("M2S Melodic bank");
+		auto &melodic_order = instruments_order.write()[melodic_id];
 		melodic_order.reserve(instrument_count);
 		for(ins_key_t current_instrument = 0; current_instrument < instrument_count; current_instrument++) {
 			const auto start_of_instrument = stream.tellg();
@@ -79,9 +85,8 @@ namespace MID3SMPS::M2S {
 		}
 
 		const auto drum_count = stream_convert<std::uint16_t>(stream);
-		instruments.reserve(drum_count);
-		const auto drum_id = add_bank("M2S Drum bank");
-		auto &drum_order = instruments_order[drum_id];
+		const auto drum_id = drum_bank = add_bank("M2S Drum bank");
+		auto &drum_order = instruments_order.write()[drum_id];
 		drum_order.reserve(instrument_count + drum_count);
 		for(ins_key_t current_instrument = 0; current_instrument < drum_count; current_instrument++) {
 			const auto start_of_instrument = stream.tellg();
@@ -89,5 +94,117 @@ namespace MID3SMPS::M2S {
 			add_patch(drum_id, version, data.subspan(static_cast<std::size_t>(start_of_instrument), instrument_size));
 			stream.seekg(start_of_instrument + static_cast<std::streamoff>(instrument_size));
 		}
+
+		if(maps_offset != 0 && maps_offset < data.size()) {
+			stream.seekg(maps_offset);
+			load_map_v3(stream, melody_map.write());
+			load_map_v3(stream, drum_map.write());
+		}
+	}
+
+	std::vector<std::uint8_t> gyb::save() const {
+		TRACE_ZONE("Save GYB");
+		std::vector<std::uint8_t> out;
+		const auto put16 = [&out](const std::uint16_t value) {
+			out.push_back(static_cast<std::uint8_t>(value & 0xFF));
+			out.push_back(static_cast<std::uint8_t>(value >> 8));
+		};
+		const auto put32_at = [&out](const std::size_t position, const std::size_t value) {
+			if(value > std::numeric_limits<std::uint32_t>::max()) {
+				throw std::runtime_error("Bank is too large for a GYB file");
+			}
+			for(std::size_t idx = 0; idx < 4; idx++) {
+				out[position + idx] = static_cast<std::uint8_t>(value >> (idx * 8));
+			}
+		};
+
+		// Size and offsets are filled in once they're known
+		out.insert(out.end(), {26, 12, 3, std::to_underlying(default_LFO_speed)});
+		out.resize(16);
+
+		const auto put_bank = [&, this](const bank_key_t bank) {
+			std::vector<const fm::patch *> patches;
+			if(const auto order = instruments_order->find(bank); order != instruments_order->end()) {
+				for(const auto id : order->second) {
+					if(const auto *patch = dynamic_cast<const fm::patch *>(instruments.find(id))) {
+						patches.push_back(patch);
+					}
+				}
+			}
+			if(patches.size() > std::numeric_limits<std::uint16_t>::max()) {
+				throw std::runtime_error("Bank has too many instruments for a GYB file");
+			}
+			put16(static_cast<std::uint16_t>(patches.size()));
+			for(const auto *patch : patches) {
+				patch->save_v3(out);
+			}
+		};
+		put32_at(8, out.size());
+		put_bank(melody_bank);
+		if(drum_bank != melody_bank) {
+			put_bank(drum_bank);
+		} else {
+			put16(0); // A bank that was never given drums has both pointing at the melody bank
+		}
+
+		put32_at(12, out.size());
+		for(const auto *map : {&*melody_map, &*drum_map}) {
+			for(const auto &entries : *map) {
+				put16(static_cast<std::uint16_t>(entries.size()));
+				for(const auto &[bank_msb, bank_lsb, instrument] : entries) {
+					out.push_back(bank_msb);
+					out.push_back(bank_lsb);
+					put16(instrument);
+				}
+			}
+		}
+		put32_at(4, out.size());
+		return out;
+	}
+
+	void gyb::load_map_v3(std::basic_ispanstream<std::uint8_t> &stream, instrument_map &map) {
+		for(auto &entries : map) {
+			const auto count = stream_convert<std::uint16_t>(stream);
+			entries.reserve(count);
+			for(std::uint16_t entry = 0; entry < count; entry++) {
+				const auto bank_msb   = stream_convert<std::uint8_t>(stream);
+				const auto bank_lsb   = stream_convert<std::uint8_t>(stream);
+				const auto instrument = stream_convert<std::uint16_t>(stream);
+				entries.push_back({bank_msb, bank_lsb, instrument});
+			}
+			if(!stream) {
+				throw std::runtime_error(errors::invalid);
+			}
+		}
+	}
+
+	const fm::patch *gyb::find_patch(const instrument_map &map, const std::uint8_t key, const std::uint8_t bank_msb, const std::uint8_t bank_lsb) const {
+		if(key >= map.size()) {
+			return nullptr;
+		}
+		const map_entry *fallback = nullptr;
+		const map_entry *found    = nullptr;
+		for(const auto &entry : map[key]) {
+			const bool msb_matches = entry.bank_msb == bank_msb || entry.bank_msb == map_entry::all;
+			const bool lsb_matches = entry.bank_lsb == bank_lsb || entry.bank_lsb == map_entry::all;
+			if(msb_matches && lsb_matches) {
+				found = &entry;
+				break;
+			}
+			if(entry.bank_msb == 0 && fallback == nullptr) {
+				fallback = &entry;
+			}
+		}
+		if(found == nullptr && (found = fallback) == nullptr) {
+			return nullptr;
+		}
+
+		const auto bank  = found->instrument & map_entry::drum_bank_bit ? drum_bank : melody_bank;
+		const auto index = static_cast<std::size_t>(found->instrument & ~map_entry::drum_bank_bit);
+		const auto order = instruments_order->find(bank);
+		if(order == instruments_order->end() || index >= order->second.size()) {
+			return nullptr;
+		}
+		return dynamic_cast<const fm::patch*>(instruments.find(order->second[index]));
 	}
 }
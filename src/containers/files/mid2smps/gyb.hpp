@@ -1,8 +1,11 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <span>
+#include <spanstream>
 #include <filesystem>
+#include <vector>
 
 #include "containers/instrument_bank.hpp"
 #include "fm/patch.hpp"
@@ -13,7 +16,23 @@ namespace MID3SMPS::M2S {
 	struct gyb : instrument_bank {
 		using ins_key_t = std::uint16_t;
 
+		struct map_entry {
+			std::uint8_t bank_msb;    // [Melody] 00 = default, FF = all / [Drum] drum kit
+			std::uint8_t bank_lsb;    // [Melody] FF = all / [Drum] unused
+			std::uint16_t instrument; // Index into the melody bank, or the drum bank when bit 15 is set
+
+			static constexpr std::uint16_t drum_bank_bit = 0x8000;
+			static constexpr std::uint8_t all            = 0xFF;
+		};
+		using instrument_map = std::array<std::vector<map_entry>, 128>;
+
 		ym2612::lfo default_LFO_speed{};
+		copy_on_write<instrument_map> melody_map{};
+		copy_on_write<instrument_map> drum_map{};
+		bank_key_t melody_bank{};
+		bank_key_t drum_bank{};
+
+		[[nodiscard]] const fm::patch *find_patch(const instrument_map &map, std::uint8_t key, std::uint8_t bank_msb = 0, std::uint8_t bank_lsb = 0) const;
 
 		template<typename... Args>
 		fm::patch &add_patch(const bank_key_t &selected_bank, Args &&... args) {
@@ -22,15 +41,23 @@ namespace MID3SMPS::M2S {
 		}
 
 		gyb()                                = default;
+		gyb(const gyb &other)                = default; // Shallow, patches are shared until writable() is called on them
 		gyb(gyb &&other) noexcept            = default;
+		gyb &operator=(const gyb &other)     = default;
 		gyb &operator=(gyb &&other) noexcept = default;
 		//~gyb() override						 = default;
 		explicit gyb(const fs::path &path);
+		// A GYB file that's already in memory
+		explicit gyb(std::span<const std::uint8_t> data);
+
+		// The bank as a GYB v3 file. Only the melody and drum banks are written, other banks have no place in the format.
+		[[nodiscard]] std::vector<std::uint8_t> save() const;
 
 	private:
 		void load_v1(std::span<const std::uint8_t> data);
 		void load_v2(std::span<const std::uint8_t> data);
 		void load_v3(std::span<const std::uint8_t> data);
+		static void load_map_v3(std::basic_ispanstream<std::uint8_t> &stream, instrument_map &map);
 	};
 }
 
@@ -1,23 +1,52 @@
-#include <fstream>
+#include <array>
+#include <future>
 
 #include "mapping.hpp"
 #include "exceptions/formatException.hpp"
+#include "helpers/file_io.hpp"
+#include "helpers/text.hpp"
+#include "helpers/trace.hpp"
 
 namespace MID3SMPS::M2S {
 	mapping::mapping(const fs::path &path) {
-		std::ifstream input(path);
-		input.exceptions(std::ios::badbit | std::ios::failbit | std::ios::eofbit);
-		std::string line;
-		std::getline(input, line);
-		if(static constexpr std::string_view header = "-- mid2smps Configuration --"; header != line) {
+		TRACE_ZONE("Parse mapping");
+		const auto data = read_file(path);
+		*this = mapping({reinterpret_cast<const char *>(data.data()), data.size()}, path.parent_path());
+	}
+
+	mapping::mapping(const std::string_view text, const fs::path &base) {
+		text_lines lines(text);
+		std::string_view line;
+		if(static constexpr std::string_view header = "-- mid2smps Configuration --"; !lines.next(line) || trim(line) != header) {
 			throw format_exception("File is not a mappings file");
 		}
 
-		const auto parent = path.parent_path();
+		for(auto *target : {&gyb_, &dac_map_, &dac_list_, &psg_list_}) {
+			if(!lines.next(line)) {
+				break;
+			}
+			if(line = trim(line); !line.empty()) {
+				*target = base / fs::path(line);
+			}
+		}
+	}
 
-		std::getline(input, line); gyb_		= parent / line;
-		std::getline(input, line); dac_map_	= parent / line;
-		std::getline(input, line); dac_list_	= parent / line;
-		std::getline(input, line); psg_list_	= parent / line;
+	std::vector<fs::path> mapping::missing_files() const {
+		TRACE_ZONE("Check mapping files");
+		const std::array paths = {&gyb_, &dac_map_, &dac_list_, &psg_list_};
+		std::array<std::future<bool>, paths.size()> exists;
+		for(std::size_t idx = 0; idx < paths.size(); idx++) {
+			exists[idx] = std::async(std::launch::async, [path = *paths[idx]] {
+				std::error_code error;
+				return path.empty() || fs::is_regular_file(path, error);
+			});
+		}
+		std::vector<fs::path> missing;
+		for(std::size_t idx = 0; idx < paths.size(); idx++) {
+			if(!exists[idx].get()) {
+				missing.push_back(*paths[idx]);
+			}
+		}
+		return missing;
 	}
 }
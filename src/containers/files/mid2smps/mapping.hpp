@@ -1,6 +1,8 @@
 #pragma once
 
 #include <filesystem>
+#include <string_view>
+#include <vector>
 
 namespace fs = std::filesystem;
 
@@ -13,6 +15,11 @@ namespace MID3SMPS::M2S {
 
 	public:
 		explicit mapping(const fs::path &path);
+		// Relative paths in text are taken from base. Lines the file doesn't have leave their path empty.
+		mapping(std::string_view text, const fs::path &base);
+
+		// Referenced files that don't exist, all of them checked at once since any can be on a slow drive
+		[[nodiscard]] std::vector<fs::path> missing_files() const;
 
 		[[nodiscard]] constexpr const fs::path &gyb() const {
 			return gyb_;
@@ -0,0 +1,93 @@
+#include "mapping_assets.hpp"
+
+#include <chrono>
+#include <thread>
+
+#include "helpers/trace.hpp"
+
+namespace MID3SMPS::M2S {
+	namespace {
+		template<typename T>
+		[[nodiscard]] std::function<std::shared_ptr<const T>()> from_file(const fs::path &path) {
+			return [path] {
+				std::error_code error;
+				return path.empty() || !fs::exists(path, error) ? std::make_shared<const T>() : std::make_shared<const T>(path);
+			};
+		}
+
+		// A detached thread rather than std::async, so replacing the assets never waits for the old loads to finish
+		template<typename T>
+		std::shared_future<std::shared_ptr<const T>> load(const std::function<std::shared_ptr<const T>()> &loader, const std::function<void()> &loaded) {
+			if(!loader) {
+				return {};
+			}
+			std::packaged_task<std::shared_ptr<const T>()> task([loader] {
+				TRACE_ZONE("Preload mapping file");
+				return loader();
+			});
+			auto future = task.get_future().share();
+			// Told only once the result can be read, failed loads included
+			std::thread([task = std::move(task), loaded]() mutable {
+				task();
+				if(loaded) {
+					loaded();
+				}
+			}).detach();
+			return future;
+		}
+
+		template<typename T>
+		[[nodiscard]] bool finished(const std::shared_future<T> &future) {
+			return !future.valid() || future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+		}
+
+		template<typename T>
+		[[nodiscard]] std::shared_ptr<const T> get(const std::shared_future<std::shared_ptr<const T>> &future) {
+			return future.valid() ? future.get() : std::make_shared<const T>();
+		}
+	}
+
+	mapping_assets::loaders mapping_assets::loaders::from(const mapping &map) {
+		return {from_file<gyb>(map.gyb()), from_file<dac_map>(map.dac_map()), from_file<dac_list>(map.dac_list()), from_file<psg_list>(map.psg_list())};
+	}
+
+	mapping_assets::mapping_assets(const loaders &from, const std::function<void()> &loaded) :
+		bank_(load(from.bank, loaded)),
+		dac_map_(load(from.dac, loaded)),
+		dac_list_(load(from.samples, loaded)),
+		psg_list_(load(from.envelopes, loaded)),
+		encoded_samples_(load(from.encoded_samples, loaded)),
+		compiled_envelopes_(load(from.compiled_envelopes, loaded)) {}
+
+	bool mapping_assets::bank_ready() const {
+		return finished(bank_);
+	}
+
+	bool mapping_assets::ready() const {
+		return finished(bank_) && finished(dac_map_) && finished(dac_list_) && finished(psg_list_) && finished(encoded_samples_) && finished(compiled_envelopes_);
+	}
+
+	std::shared_ptr<const gyb> mapping_assets::bank() const {
+		return get(bank_);
+	}
+
+	std::shared_ptr<const dac_map> mapping_assets::dac() const {
+		return get(dac_map_);
+	}
+
+	std::shared_ptr<const dac_list> mapping_assets::samples() const {
+		return get(dac_list_);
+	}
+
+	std::shared_ptr<const psg_list> mapping_assets::envelopes() const {
+		return get(psg_list_);
+	}
+
+	std::shared_ptr<const conversion::dac::encoded_list> mapping_assets::encoded_samples() const {
+		return encoded_samples_.valid() ? encoded_samples_.get() : nullptr;
+	}
+
+	std::shared_ptr<const conversion::psg_envelopes> mapping_assets::compiled_envelopes() const {
+		return compiled_envelopes_.valid() ? compiled_envelopes_.get() : nullptr;
+	}
+}
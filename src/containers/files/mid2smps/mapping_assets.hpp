@@ -0,0 +1,59 @@
+#pragma once
+
+#include <functional>
+#include <future>
+#include <memory>
+
+#include "dac_list.hpp"
+#include "dac_map.hpp"
+#include "gyb.hpp"
+#include "mapping.hpp"
+#include "psg_list.hpp"
+#include "conversion/psg_envelopes.hpp"
+#include "conversion/dac/sample_encoder.hpp"
+
+namespace MID3SMPS::M2S {
+	// Everything a mapping points at, loaded on background threads from the moment the mapping is opened.
+	// Copies share the loads, so a copy can be handed to another thread.
+	class mapping_assets {
+		std::shared_future<std::shared_ptr<const gyb>> bank_{};
+		std::shared_future<std::shared_ptr<const dac_map>> dac_map_{};
+		std::shared_future<std::shared_ptr<const dac_list>> dac_list_{};
+		std::shared_future<std::shared_ptr<const psg_list>> psg_list_{};
+		std::shared_future<std::shared_ptr<const conversion::dac::encoded_list>> encoded_samples_{};
+		std::shared_future<std::shared_ptr<const conversion::psg_envelopes>> compiled_envelopes_{};
+
+	public:
+		// Where each part comes from, every one is called on its own thread
+		struct loaders {
+			std::function<std::shared_ptr<const gyb>()> bank;
+			std::function<std::shared_ptr<const dac_map>()> dac;
+			std::function<std::shared_ptr<const dac_list>()> samples;
+			std::function<std::shared_ptr<const psg_list>()> envelopes;
+			// The lists already built for the driver, a project has them. Left empty they're built from the lists when needed.
+			std::function<std::shared_ptr<const conversion::dac::encoded_list>()> encoded_samples{};
+			std::function<std::shared_ptr<const conversion::psg_envelopes>()> compiled_envelopes{};
+
+			// The files the mapping points at
+			[[nodiscard]] static loaders from(const mapping &map);
+		};
+
+		mapping_assets() = default;
+		// Starts every load, loaded is called from the loading thread after each one finishes
+		explicit mapping_assets(const loaders &from, const std::function<void()> &loaded = {});
+		explicit mapping_assets(const mapping &map, const std::function<void()> &loaded = {}) : mapping_assets(loaders::from(map), loaded) {}
+
+		[[nodiscard]] bool bank_ready() const;
+		[[nodiscard]] bool ready() const;
+
+		// These wait for a file that's still loading and rethrow what loading it threw.
+		// Files the mapping doesn't have or that don't exist come back empty.
+		[[nodiscard]] std::shared_ptr<const gyb> bank() const;
+		[[nodiscard]] std::shared_ptr<const dac_map> dac() const;
+		[[nodiscard]] std::shared_ptr<const dac_list> samples() const;
+		[[nodiscard]] std::shared_ptr<const psg_list> envelopes() const;
+		// Null if there's no loader for them
+		[[nodiscard]] std::shared_ptr<const conversion::dac::encoded_list> encoded_samples() const;
+		[[nodiscard]] std::shared_ptr<const conversion::psg_envelopes> compiled_envelopes() const;
+	};
+}
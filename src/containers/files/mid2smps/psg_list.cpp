@@ -0,0 +1,69 @@
+#include "psg_list.hpp"
+
+#include <fmt/core.h>
+
+#include "exceptions/formatException.hpp"
+#include "helpers/file_io.hpp"
+#include "helpers/text.hpp"
+#include "helpers/trace.hpp"
+
+namespace MID3SMPS::M2S {
+	psg_list::psg_list(const fs::path &path) {
+		TRACE_ZONE("Load PSG list");
+		const auto data = read_file(path);
+		*this = psg_list({reinterpret_cast<const char *>(data.data()), data.size()}, path.filename().string());
+	}
+
+	psg_list::psg_list(const std::string_view text, const std::string_view source) {
+		text_lines lines(text);
+		std::string_view line;
+		while(lines.next(line)) {
+			line = trim(line.substr(0, line.find_first_of(";#")));
+			if(line.empty()) {
+				continue;
+			}
+
+			envelope entry;
+			entry.line = lines.number();
+			if(const auto colon = line.find(':'); colon != std::string_view::npos) {
+				const auto name = trim(line.substr(0, colon));
+				if(name.empty()) {
+					throw format_exception(fmt::format("{}:{}: Missing envelope name before ':'", source, lines.number()));
+				}
+				const auto [existing, added] = ids_.try_emplace(std::string(name), envelopes.size() + 1);
+				if(!added) {
+					throw format_exception(fmt::format("{}:{}: Envelope '{}' is already defined on line {}", source, lines.number(), name,
+					                                   envelopes[existing->second - 1].line));
+				}
+				entry.name = name;
+				line       = line.substr(colon + 1);
+			}
+
+			for(auto word = take_word(line); !word.empty(); word = take_word(line)) {
+				if(word == "hold" || word == "loop" || word == "stop") {
+					entry.end = word == "hold" ? end_mode::hold : word == "loop" ? end_mode::loop : end_mode::stop;
+					if(!line.empty()) {
+						throw format_exception(fmt::format("{}:{}: Unexpected text after '{}' '{}'", source, lines.number(), word, line));
+					}
+					break;
+				}
+				const auto level = parse_number<std::uint8_t>(word);
+				if(!level || *level > 15) {
+					throw format_exception(fmt::format("{}:{}: Invalid level '{}', levels go from 0 to 15", source, lines.number(), word));
+				}
+				entry.levels.push_back(*level);
+			}
+			if(entry.levels.empty()) {
+				throw format_exception(fmt::format("{}:{}: Envelope has no levels", source, lines.number()));
+			}
+			envelopes.push_back(std::move(entry));
+		}
+	}
+
+	std::optional<std::size_t> psg_list::find(const std::string_view name) const {
+		if(const auto found = ids_.find(std::string(name)); found != ids_.end()) {
+			return found->second;
+		}
+		return std::nullopt;
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace MID3SMPS::M2S {
+	namespace fs = std::filesystem;
+
+	// PSG volume envelopes, one per line, numbered from 1 in the order they're listed (0 is no envelope):
+	//	[name:] level level ... [hold | loop | stop]
+	// Levels are attenuation steps from 0 to 15 added to the channel's volume, one per frame.
+	// Without a keyword the last level holds. Numbers are decimal or hex after 0x or $.
+	// Blank lines and anything after ';' or '#' are skipped.
+	struct psg_list {
+		enum class end_mode : std::uint8_t {
+			hold, // Stays on the last level
+			loop, // Starts over from the first level
+			stop, // Silences the note
+		};
+
+		struct envelope {
+			std::string name{};
+			std::vector<std::uint8_t> levels{};
+			end_mode end     = end_mode::hold;
+			std::size_t line = 0; // For errors about the envelope later on
+		};
+
+		std::vector<envelope> envelopes{};
+
+		psg_list() = default;
+		explicit psg_list(const fs::path &path);
+		// Errors name the line they're on, prefixed with source
+		psg_list(std::string_view text, std::string_view source);
+
+		// The ID of a named envelope
+		[[nodiscard]] std::optional<std::size_t> find(std::string_view name) const;
+
+	private:
+		std::unordered_map<std::string, std::size_t> ids_{};
+	};
+}
@@ -0,0 +1,317 @@
+#include "project.hpp"
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <utility>
+#include <fmt/core.h>
+
+#include "exceptions/formatException.hpp"
+#include "helpers/file_io.hpp"
+#include "helpers/trace.hpp"
+
+namespace MID3SMPS {
+	namespace {
+		constexpr std::array<std::uint8_t, 4> magic = {'M', '3', 'S', 'P'};
+		constexpr std::uint32_t format_version = 1;
+		constexpr std::size_t header_size       = 16; // Magic, version, section count, reserved
+		constexpr std::size_t entry_size        = 24; // ID, reserved, offset, size
+		constexpr std::size_t alignment         = 16;
+
+		// Setting flags, in the order they were added
+		constexpr std::array<bool conversion::settings::*, 6> flags = {
+			&conversion::settings::convert_song_title,
+			&conversion::settings::per_file_instruments,
+			&conversion::settings::auto_reload_midi,
+			&conversion::settings::auto_optimize_midi,
+			&conversion::settings::chorus_cc_volume_boost,
+			&conversion::settings::pan_law_compensation,
+		};
+
+		class writer {
+		public:
+			std::vector<std::uint8_t> bytes;
+
+			template<std::unsigned_integral T>
+			void number(const T value) {
+				for(std::size_t idx = 0; idx < sizeof(T); idx++) {
+					bytes.push_back(static_cast<std::uint8_t>(value >> (idx * 8)));
+				}
+			}
+
+			void raw(const std::span<const std::uint8_t> data) {
+				bytes.insert(bytes.end(), data.begin(), data.end());
+			}
+
+			void path(const fs::path &value) {
+				const auto text = value.u8string();
+				number(static_cast<std::uint32_t>(text.size()));
+				raw({reinterpret_cast<const std::uint8_t *>(text.data()), text.size()});
+			}
+		};
+
+		// Bounds checked reads through a section, anything past its end means the file is damaged
+		class reader {
+			std::span<const std::uint8_t> data_;
+			std::size_t position_ = 0;
+			std::string_view name_;
+
+		public:
+			reader(const std::span<const std::uint8_t> data, const std::string_view name) : data_(data), name_(name) {}
+
+			[[nodiscard]] std::span<const std::uint8_t> raw(const std::size_t size) {
+				if(size > data_.size() - position_) {
+					throw format_exception(fmt::format("Project {} section is truncated", name_));
+				}
+				const auto result = data_.subspan(position_, size);
+				position_ += size;
+				return result;
+			}
+
+			template<std::unsigned_integral T>
+			[[nodiscard]] T number() {
+				T value{};
+				const auto bytes = raw(sizeof(T));
+				for(std::size_t idx = 0; idx < sizeof(T); idx++) {
+					value = static_cast<T>(value | static_cast<T>(bytes[idx]) << (idx * 8));
+				}
+				return value;
+			}
+
+			[[nodiscard]] fs::path path() {
+				const auto bytes = raw(number<std::uint32_t>());
+				return fs::path(std::u8string(reinterpret_cast<const char8_t *>(bytes.data()), bytes.size()));
+			}
+
+			[[nodiscard]] std::span<const std::uint8_t> rest() noexcept {
+				return data_.subspan(std::exchange(position_, data_.size()));
+			}
+		};
+	}
+
+	void project::save(const fs::path &path, const contents &project) {
+		TRACE_ZONE("Save project");
+		std::vector<std::pair<section, std::vector<std::uint8_t>>> sections;
+
+		writer settings;
+		settings.path(project.midi);
+		settings.number(static_cast<std::uint32_t>(project.settings.ticks_per_quarter));
+		settings.number(static_cast<std::uint32_t>(project.settings.ticks_multiplier));
+		std::uint32_t bits = 0;
+		for(std::size_t idx = 0; idx < flags.size(); idx++) {
+			bits |= static_cast<std::uint32_t>(project.settings.*flags[idx]) << idx;
+		}
+		settings.number(bits);
+		sections.emplace_back(section::settings, std::move(settings.bytes));
+
+		if(project.mapping != nullptr) {
+			writer mapping;
+			mapping.path(project.mapping->gyb());
+			mapping.path(project.mapping->dac_map());
+			mapping.path(project.mapping->dac_list());
+			mapping.path(project.mapping->psg_list());
+			sections.emplace_back(section::mapping, std::move(mapping.bytes));
+		}
+		if(!project.bank.empty()) {
+			sections.emplace_back(section::bank, std::vector(project.bank.begin(), project.bank.end()));
+		}
+		if(project.drums != nullptr && !project.drums->hits.empty()) {
+			writer drums;
+			for(const auto &[sample, pitch, volume] : project.drums->hits) {
+				drums.raw(std::array{sample, pitch, volume});
+			}
+			sections.emplace_back(section::drums, std::move(drums.bytes));
+		}
+		if(!project.samples.empty()) {
+			// Offsets count from the end of the table
+			writer samples;
+			samples.number(static_cast<std::uint32_t>(std::to_underlying(project.sample_format)));
+			samples.number(project.sample_rate);
+			samples.number(static_cast<std::uint32_t>(project.samples.size()));
+			std::uint32_t offset = 0;
+			for(const auto &sample : project.samples) {
+				samples.number(offset);
+				samples.number(static_cast<std::uint32_t>(sample.size()));
+				offset += static_cast<std::uint32_t>(sample.size());
+			}
+			for(const auto &sample : project.samples) {
+				samples.raw(sample);
+			}
+			sections.emplace_back(section::samples, std::move(samples.bytes));
+		}
+		if(project.envelopes != nullptr && !project.envelopes->offsets().empty()) {
+			writer envelopes;
+			envelopes.number(static_cast<std::uint32_t>(project.envelopes->offsets().size()));
+			envelopes.number(static_cast<std::uint32_t>(project.envelopes->data().size()));
+			for(const auto offset : project.envelopes->offsets()) {
+				envelopes.number(offset);
+			}
+			envelopes.raw(project.envelopes->data());
+			sections.emplace_back(section::envelopes, std::move(envelopes.bytes));
+		}
+
+		const auto align = [](const std::size_t size) { return (size + alignment - 1) / alignment * alignment; };
+		writer file;
+		file.raw(magic);
+		file.number(format_version);
+		file.number(static_cast<std::uint32_t>(sections.size()));
+		file.number(std::uint32_t{0});
+		std::size_t offset = align(header_size + sections.size() * entry_size);
+		for(const auto &[id, data] : sections) {
+			const std::uint64_t start = offset;
+			const std::uint64_t size  = data.size();
+			file.number(std::to_underlying(id));
+			file.number(std::uint32_t{0});
+			file.number(start);
+			file.number(size);
+			offset = align(offset + data.size());
+		}
+		for(const auto &[id, data] : sections) {
+			file.bytes.resize(align(file.bytes.size()));
+			file.raw(data);
+		}
+		write_file_atomically(path, file.bytes);
+	}
+
+	project::project(const fs::path &path) : file_(path) {
+		TRACE_ZONE("Open project");
+		reader header(file_.bytes(), "header");
+		if(!std::ranges::equal(header.raw(magic.size()), magic)) {
+			throw format_exception(fmt::format("{} is not a project file", path.filename().string()));
+		}
+		if(const auto version = header.number<std::uint32_t>(); version > format_version) {
+			throw format_exception(fmt::format("{} was saved by a newer version (format {})", path.filename().string(), version));
+		}
+		const auto count = header.number<std::uint32_t>();
+		static_cast<void>(header.number<std::uint32_t>());
+		// The whole table has to be there before anything is sized by its count
+		reader table(header.raw(static_cast<std::size_t>(count) * entry_size), "header");
+		sections_.reserve(count);
+		for(std::uint32_t idx = 0; idx < count; idx++) {
+			const auto id = static_cast<section>(table.number<std::uint32_t>());
+			static_cast<void>(table.number<std::uint32_t>());
+			const auto offset = table.number<std::uint64_t>();
+			const auto size   = table.number<std::uint64_t>();
+			if(offset > file_.bytes().size() || size > file_.bytes().size() - offset) {
+				throw format_exception(fmt::format("{} is truncated", path.filename().string()));
+			}
+			sections_.push_back({id, file_.bytes().subspan(static_cast<std::size_t>(offset), static_cast<std::size_t>(size))});
+		}
+	}
+
+	std::optional<std::span<const std::uint8_t>> project::raw(const section id) const noexcept {
+		if(const auto found = std::ranges::find(sections_, id, &entry::id); found != sections_.end()) {
+			return found->data;
+		}
+		return std::nullopt;
+	}
+
+	bool project::has(const section id) const noexcept {
+		return raw(id).has_value();
+	}
+
+	fs::path project::midi() const {
+		const auto data = raw(section::settings);
+		return data ? reader(*data, "settings").path() : fs::path{};
+	}
+
+	conversion::settings project::settings() const {
+		conversion::settings result;
+		const auto data = raw(section::settings);
+		if(!data) {
+			return result;
+		}
+		reader input(*data, "settings");
+		static_cast<void>(input.path());
+		result.ticks_per_quarter = static_cast<int>(input.number<std::uint32_t>());
+		result.ticks_multiplier  = static_cast<int>(input.number<std::uint32_t>());
+		const auto bits          = input.number<std::uint32_t>();
+		for(std::size_t idx = 0; idx < flags.size(); idx++) {
+			result.*flags[idx] = (bits >> idx & 1) != 0;
+		}
+		return result;
+	}
+
+	M2S::mapping project::mapping() const {
+		M2S::mapping result;
+		if(const auto data = raw(section::mapping)) {
+			reader input(*data, "mapping");
+			result.gyb(input.path());
+			result.dac_map(input.path());
+			result.dac_list(input.path());
+			result.psg_list(input.path());
+		}
+		return result;
+	}
+
+	M2S::gyb project::bank() const {
+		TRACE_ZONE("Load project bank");
+		const auto data = raw(section::bank);
+		return data ? M2S::gyb(*data) : M2S::gyb{};
+	}
+
+	M2S::dac_map project::drums() const {
+		M2S::dac_map result;
+		if(const auto data = raw(section::drums)) {
+			if(data->size() % (3 * M2S::dac_map::notes) != 0) {
+				throw format_exception("Project drums section is truncated");
+			}
+			result.hits.resize(data->size() / 3);
+			for(std::size_t idx = 0; idx < result.hits.size(); idx++) {
+				result.hits[idx] = {(*data)[idx * 3], (*data)[idx * 3 + 1], (*data)[idx * 3 + 2]};
+			}
+		}
+		return result;
+	}
+
+	project::samples_view project::samples() const {
+		samples_view result;
+		const auto data = raw(section::samples);
+		if(!data) {
+			return result;
+		}
+		reader input(*data, "samples");
+		switch(const auto format = input.number<std::uint32_t>(); format) {
+			case std::to_underlying(smps::dac_format::dpcm): result.format = smps::dac_format::dpcm;
+				break;
+			case std::to_underlying(smps::dac_format::pcm8): result.format = smps::dac_format::pcm8;
+				break;
+			default: throw format_exception(fmt::format("Project samples section has an unknown DAC format {}", format));
+		}
+		result.rate      = input.number<std::uint32_t>();
+		const auto count = input.number<std::uint32_t>();
+		const auto table = input.raw(static_cast<std::size_t>(count) * 8);
+		const auto body  = input.rest();
+		reader entries(table, "samples");
+		result.data.reserve(count);
+		for(std::uint32_t idx = 0; idx < count; idx++) {
+			const auto offset = entries.number<std::uint32_t>();
+			const auto size   = entries.number<std::uint32_t>();
+			if(offset > body.size() || size > body.size() - offset) {
+				throw format_exception("Project samples section is truncated");
+			}
+			result.data.push_back(body.subspan(offset, size));
+		}
+		return result;
+	}
+
+	conversion::psg_envelopes project::envelopes() const {
+		const auto data = raw(section::envelopes);
+		if(!data) {
+			return {};
+		}
+		reader input(*data, "envelopes");
+		const auto count = input.number<std::uint32_t>();
+		const auto size  = input.number<std::uint32_t>();
+		reader table(input.raw(static_cast<std::size_t>(count) * sizeof(std::uint16_t)), "envelopes");
+		std::vector<std::uint16_t> offsets(count);
+		for(auto &offset : offsets) {
+			offset = table.number<std::uint16_t>();
+		}
+		const auto bytes = input.raw(size);
+		if(std::ranges::any_of(offsets, [&](const std::uint16_t offset) { return offset >= size; })) {
+			throw format_exception("Project envelopes section points outside its data");
+		}
+		return {std::vector(bytes.begin(), bytes.end()), std::move(offsets)};
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "containers/files/mid2smps/dac_map.hpp"
+#include "containers/files/mid2smps/gyb.hpp"
+#include "containers/files/mid2smps/mapping.hpp"
+#include "containers/smps/driver_profile.hpp"
+#include "conversion/psg_envelopes.hpp"
+#include "conversion/settings.hpp"
+#include "helpers/mapped_file.hpp"
+
+namespace MID3SMPS {
+	namespace fs = std::filesystem;
+
+	// A .m3sp file: everything needed to convert one song, already in the form conversion uses.
+	// A header, a table of sections and the sections, all little endian. The file stays mapped while the project is open
+	// and each section is only read when it's asked for, sections a reader doesn't know are skipped.
+	class project {
+	public:
+		static constexpr auto extension = ".m3sp";
+
+		enum class section : std::uint32_t {
+			settings  = 0x54'54'45'53, // "SETT", the MIDI and the conversion settings
+			mapping   = 0x50'50'41'4D, // "MAPP", the paths in the mapping the project was made from
+			bank      = 0x4B'4E'41'42, // "BANK", the GYB file
+			drums     = 0x50'41'4D'44, // "DMAP", the DAC map's note table
+			samples   = 0x53'43'41'44, // "DACS", DAC samples encoded for the driver
+			envelopes = 0x45'47'53'50, // "PSGE", compiled PSG envelopes
+		};
+
+		struct samples_view {
+			smps::dac_format format = smps::dac_format::dpcm;
+			std::uint32_t rate      = 0;
+			std::vector<std::span<const std::uint8_t>> data{}; // Point into the mapped file
+		};
+
+		// What save() writes, empty parts are left out
+		struct contents {
+			fs::path midi{};
+			conversion::settings settings{};
+			const M2S::mapping *mapping = nullptr;
+			std::span<const std::uint8_t> bank{}; // A GYB file, from gyb::save() or as it is on disk
+			const M2S::dac_map *drums = nullptr;
+			smps::dac_format sample_format = smps::dac_format::dpcm;
+			std::uint32_t sample_rate      = 0;
+			std::vector<std::span<const std::uint8_t>> samples{};
+			const conversion::psg_envelopes *envelopes = nullptr;
+		};
+
+		// Writes to a temporary file and renames it over path, throws if anything fails
+		static void save(const fs::path &path, const contents &project);
+
+		project() = default;
+		// Maps the file and reads the section table, throws if either fails
+		explicit project(const fs::path &path);
+
+		[[nodiscard]] bool has(section id) const noexcept;
+		// A section's bytes as they are in the file
+		[[nodiscard]] std::optional<std::span<const std::uint8_t>> raw(section id) const noexcept;
+
+		// These throw if the section is damaged. Missing sections give empty values.
+		[[nodiscard]] fs::path midi() const;
+		[[nodiscard]] conversion::settings settings() const;
+		[[nodiscard]] M2S::mapping mapping() const;
+		[[nodiscard]] M2S::gyb bank() const; // Parsed on every call
+		[[nodiscard]] M2S::dac_map drums() const;
+		[[nodiscard]] samples_view samples() const;
+		[[nodiscard]] conversion::psg_envelopes envelopes() const;
+
+	private:
+		struct entry {
+			section id;
+			std::span<const std::uint8_t> data;
+		};
+
+		mapped_file file_{};
+		std::vector<entry> sections_{};
+	};
+}
@@ -9,5 +9,9 @@ namespace MID3SMPS {
 
 		constexpr fm_instrument()           = default;
 		constexpr ~fm_instrument() override = default;
+
+		[[nodiscard]] std::shared_ptr<instrument> clone() const override {
+			return std::make_shared<fm_instrument>(*this);
+		}
 	};
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <string>
 
 namespace MID3SMPS {
@@ -8,5 +9,10 @@ namespace MID3SMPS {
 
 		constexpr instrument()          = default;
 		constexpr virtual ~instrument() = default;
+
+		// Copies of a bank share their instruments, this is how one gets its own copy before it's changed
+		[[nodiscard]] virtual std::shared_ptr<instrument> clone() const {
+			return std::make_shared<instrument>(*this);
+		}
 	};
 }
@@ -6,24 +6,27 @@
 #include <fmt/core.h>
 
 #include "instrument.hpp"
+#include "shared_table.hpp"
 #include "chips/ym2612/operators.hpp"
+#include "helpers/copy_on_write.hpp"
 
 namespace MID3SMPS {
 	using ins_key_t = std::uint16_t;
 	using bank_key_t = std::uint16_t;
 
 	struct instrument_bank {
-		using ins_container_t = std::unordered_map<ins_key_t, std::unique_ptr<instrument>>;
+		using ins_container_t = shared_table<instrument>;
 		using bank_container_t = std::unordered_map<bank_key_t, std::string>;
 		using ins_order_t = std::vector<ins_key_t>;
 		using bank_order_t = std::vector<bank_key_t>;
 		using ins_bank_t = std::unordered_map<bank_key_t, ins_order_t>;
 
+		// Copies of a bank share everything until one of them changes it, so copying one costs the same for any number of instruments
 		ins_container_t instruments{};
-		bank_container_t banks{};
+		copy_on_write<bank_container_t> banks{};
 
-		ins_bank_t instruments_order{};
-		bank_order_t bank_order{};
+		copy_on_write<ins_bank_t> instruments_order{};
+		copy_on_write<bank_order_t> bank_order{};
 
 	protected:
 		mutable ins_key_t current_ins_id = 0;
@@ -37,7 +40,7 @@ namespace MID3SMPS {
 		}
 
 		[[nodiscard]] bank_key_t new_unique_bank_id() const {
-			while(banks.contains(current_bank_id)) {
+			while(banks->contains(current_bank_id)) {
 				++current_bank_id;
 			}
 			return current_bank_id;
@@ -46,6 +49,8 @@ namespace MID3SMPS {
 	public:
 		[[nodiscard]] bank_key_t add_bank(const bank_container_t::mapped_type& new_bank_name);
 		instrument& add_instrument(ins_container_t::mapped_type &&instrument, const bank_key_t &selected_bank);
+		// Instruments are shared with any copy of the bank, this clones the one being changed first if it still is
+		[[nodiscard]] instrument& writable(ins_key_t id);
 		instrument_bank()			= default;
 		//virtual ~instrument_bank()	= default; // Causes an error with patch_container_t about std::construct_at(__p, std::forward<_Args>(__args)...);
 
@@ -0,0 +1,339 @@
+#include "instrument_index.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <limits>
+#include <ranges>
+
+#include "fm_instrument.hpp"
+
+namespace MID3SMPS {
+	namespace {
+		struct field_name {
+			std::string_view name;
+			instrument_index::field target;
+		};
+
+		constexpr std::array field_names = {
+			field_name{"alg", instrument_index::field::algorithm},
+			field_name{"algorithm", instrument_index::field::algorithm},
+			field_name{"fb", instrument_index::field::feedback},
+			field_name{"feedback", instrument_index::field::feedback},
+			field_name{"ams", instrument_index::field::ams},
+			field_name{"fms", instrument_index::field::fms},
+			field_name{"dt", instrument_index::field::detune},
+			field_name{"detune", instrument_index::field::detune},
+			field_name{"mul", instrument_index::field::multiple},
+			field_name{"multiple", instrument_index::field::multiple},
+			field_name{"tl", instrument_index::field::total_level},
+			field_name{"rs", instrument_index::field::rate_scaling},
+			field_name{"ar", instrument_index::field::attack_rate},
+			field_name{"am", instrument_index::field::amplitude_modulation},
+			field_name{"dr", instrument_index::field::decay_rate},
+			field_name{"d1r", instrument_index::field::decay_rate},
+			field_name{"sr", instrument_index::field::sustain_rate},
+			field_name{"d2r", instrument_index::field::sustain_rate},
+			field_name{"sl", instrument_index::field::sustain_level},
+			field_name{"rr", instrument_index::field::release_rate},
+			field_name{"ssg", instrument_index::field::ssgeg},
+			field_name{"ssgeg", instrument_index::field::ssgeg},
+		};
+
+		// Bits needed by every field, in the order of instrument_index::field
+		constexpr auto field_bits = [] {
+			std::array<std::uint8_t, instrument_index::channel_field_count + instrument_index::operator_field_count> bits{};
+			for(std::size_t idx = 0; idx < bits.size(); idx++) {
+				bits[idx] = std::bit_width(ym2612::field_table[idx].max);
+			}
+			return bits;
+		}();
+
+		// Operators as the editor numbers them
+		constexpr std::array operator_numbers = {
+			instrument_index::op_id::op1, instrument_index::op_id::op2, instrument_index::op_id::op3, instrument_index::op_id::op4
+		};
+
+		constexpr float minimum_term_score = 0.5f; // Share of a term's trigrams a name needs to count as a match
+
+		[[nodiscard]] std::string lower(const std::string_view text) {
+			std::string result(text);
+			for(auto &character : result) {
+				character = static_cast<char>(std::tolower(static_cast<unsigned char>(character)));
+			}
+			return result;
+		}
+
+		[[nodiscard]] constexpr std::uint32_t trigram(const std::string_view text, const std::size_t at) noexcept {
+			return static_cast<std::uint32_t>(static_cast<unsigned char>(text[at])) << 16 |
+			       static_cast<std::uint32_t>(static_cast<unsigned char>(text[at + 1])) << 8 |
+			       static_cast<unsigned char>(text[at + 2]);
+		}
+
+		[[nodiscard]] constexpr bool passes(const std::uint8_t value, const instrument_index::predicate &test) noexcept {
+			using enum instrument_index::comparison;
+			switch(test.compare) {
+				case equal: return value == test.value;
+				case not_equal: return value != test.value;
+				case less: return value < test.value;
+				case less_equal: return value <= test.value;
+				case greater: return value > test.value;
+				case greater_equal: return value >= test.value;
+				default: return false;
+			}
+		}
+
+		std::optional<instrument_index::predicate> parse_predicate(const std::string_view token) {
+			using enum instrument_index::comparison;
+			const auto split = token.find_first_of("=!<>");
+			if(split == 0 || split == std::string_view::npos) {
+				return std::nullopt;
+			}
+
+			auto name = lower(token.substr(0, split));
+			std::optional<instrument_index::op_id> op = std::nullopt;
+			if(const auto last = name.back(); last >= '1' && last <= '4' && name.size() > 1) {
+				op = operator_numbers[static_cast<std::size_t>(last - '1')];
+				name.pop_back();
+			}
+			const auto found = std::ranges::find(field_names, name, &field_name::name);
+			if(found == field_names.end() || (op && ym2612::is_channel_field(found->target))) {
+				return std::nullopt;
+			}
+
+			auto rest = token.substr(split);
+			instrument_index::comparison compare{};
+			if(rest.starts_with("==")) {
+				compare = equal;
+				rest.remove_prefix(2);
+			} else if(rest.starts_with("!=")) {
+				compare = not_equal;
+				rest.remove_prefix(2);
+			} else if(rest.starts_with("<=")) {
+				compare = less_equal;
+				rest.remove_prefix(2);
+			} else if(rest.starts_with(">=")) {
+				compare = greater_equal;
+				rest.remove_prefix(2);
+			} else if(rest.starts_with('=')) {
+				compare = equal;
+				rest.remove_prefix(1);
+			} else if(rest.starts_with('<')) {
+				compare = less;
+				rest.remove_prefix(1);
+			} else if(rest.starts_with('>')) {
+				compare = greater;
+				rest.remove_prefix(1);
+			} else {
+				return std::nullopt;
+			}
+
+			int base = 10;
+			if(rest.starts_with('$')) {
+				base = 16;
+				rest.remove_prefix(1);
+			} else if(rest.starts_with("0x")) {
+				base = 16;
+				rest.remove_prefix(2);
+			}
+			unsigned value = 0;
+			const auto [end, error] = std::from_chars(rest.data(), rest.data() + rest.size(), value, base);
+			if(error != std::errc{} || end != rest.data() + rest.size() || value > std::numeric_limits<std::uint8_t>::max()) {
+				return std::nullopt;
+			}
+			return instrument_index::predicate{found->target, op, compare, static_cast<std::uint8_t>(value)};
+		}
+	}
+
+	instrument_index::query instrument_index::query::parse(const std::string_view text) {
+		query result;
+		for(const auto part : text | std::views::split(' ')) {
+			const std::string_view token(part.begin(), part.end());
+			if(token.empty()) {
+				continue;
+			}
+			if(const auto test = parse_predicate(token)) {
+				result.predicates.push_back(*test);
+			} else {
+				result.terms.push_back(lower(token));
+			}
+		}
+		return result;
+	}
+
+	void instrument_index::packed_column::resize(const std::size_t rows) {
+		words_.resize((rows + per_word_ - 1) / per_word_);
+	}
+
+	void instrument_index::packed_column::set(const std::size_t row, const std::uint8_t value) noexcept {
+		const auto shift = (row % per_word_) * bits_;
+		const auto mask  = ((std::uint64_t{1} << bits_) - 1) << shift;
+		auto &word       = words_[row / per_word_];
+		word             = (word & ~mask) | (static_cast<std::uint64_t>(value) << shift & mask);
+	}
+
+	std::uint8_t instrument_index::packed_column::get(const std::size_t row) const noexcept {
+		const auto shift = (row % per_word_) * bits_;
+		return static_cast<std::uint8_t>(words_[row / per_word_] >> shift & ((std::uint64_t{1} << bits_) - 1));
+	}
+
+	void instrument_index::packed_column::filter(const predicate &test, const std::span<std::uint64_t> matches, const std::size_t rows) const {
+		// Columns are at most 7 bits wide, so the test turns into a table lookup and the scan has no branches
+		const auto value_mask = (std::uint64_t{1} << bits_) - 1;
+		std::array<std::uint64_t, 128> passing{};
+		for(std::uint8_t value = 0; value <= value_mask; value++) {
+			passing[value] = passes(value, test);
+		}
+
+		std::size_t row = 0;
+		for(const auto word : words_) {
+			for(std::uint8_t slot = 0; slot < per_word_ && row < rows; slot++, row++) {
+				matches[row / 64] |= passing[word >> (slot * bits_) & value_mask] << (row % 64);
+			}
+		}
+	}
+
+	instrument_index::instrument_index(const instrument_bank &bank) {
+		for(std::size_t idx = 0; idx < channel_columns_.size(); idx++) {
+			channel_columns_[idx] = packed_column(field_bits[idx]);
+		}
+		for(std::size_t idx = 0; idx < operator_columns_.size(); idx++) {
+			operator_columns_[idx].fill(packed_column(field_bits[channel_field_count + idx]));
+		}
+
+		for(const auto &bank_id : *bank.bank_order) {
+			const auto order = bank.instruments_order->find(bank_id);
+			if(order == bank.instruments_order->end()) {
+				continue;
+			}
+			for(const auto &id : order->second) {
+				if(dynamic_cast<const fm_instrument *>(bank.instruments.find(id)) == nullptr) {
+					continue;
+				}
+				entries_.push_back({bank_id, id});
+			}
+		}
+
+		const auto rows = entries_.size();
+		for(auto &column : channel_columns_) {
+			column.resize(rows);
+		}
+		for(auto &columns : operator_columns_) {
+			for(auto &column : columns) {
+				column.resize(rows);
+			}
+		}
+		names_.reserve(rows);
+		rows_.reserve(rows);
+
+		for(row_t row = 0; row < rows; row++) {
+			const auto &instrument = dynamic_cast<const fm_instrument &>(*bank.instruments.at(entries_[row].id));
+			names_.push_back(lower(instrument.name));
+			rows_.emplace(entries_[row].id, row);
+			store(row, instrument.operators);
+
+			const std::string_view name = names_.back();
+			for(std::size_t at = 0; at + 3 <= name.size(); at++) {
+				auto &postings = trigrams_[trigram(name, at)];
+				if(postings.empty() || postings.back() != row) {
+					postings.push_back(row);
+				}
+			}
+		}
+	}
+
+	void instrument_index::store(const row_t row, const ym2612::operators &operators) {
+		for(std::size_t idx = 0; idx < channel_columns_.size(); idx++) {
+			channel_columns_[idx].set(row, ym2612::value(operators, static_cast<field>(idx)));
+		}
+		for(std::size_t idx = 0; idx < operator_columns_.size(); idx++) {
+			for(std::size_t op = 0; op < operator_numbers.size(); op++) {
+				operator_columns_[idx][op].set(row, ym2612::value(operators, static_cast<field>(channel_field_count + idx), operator_numbers[op]));
+			}
+		}
+	}
+
+	void instrument_index::refresh(const ins_key_t id, const ym2612::operators &operators) {
+		if(const auto found = rows_.find(id); found != rows_.end()) {
+			store(found->second, operators);
+		}
+	}
+
+	void instrument_index::match_terms(const query &search, const std::span<const std::uint64_t> matches, std::vector<float> &scores) const {
+		std::vector<std::uint16_t> hits(entries_.size());
+		for(const auto &term : search.terms) {
+			std::ranges::fill(hits, 0);
+			std::size_t term_trigrams = 0;
+			for(std::size_t at = 0; at + 3 <= term.size(); at++, term_trigrams++) {
+				if(const auto found = trigrams_.find(trigram(term, at)); found != trigrams_.end()) {
+					for(const auto row : found->second) {
+						++hits[row];
+					}
+				}
+			}
+
+			for(row_t row = 0; row < entries_.size(); row++) {
+				if(scores[row] < 0 || (matches[row / 64] >> (row % 64) & 1) == 0) {
+					continue;
+				}
+				// Exact substrings rank above fuzzy matches and are the only way short terms match.
+				// Every trigram of a substring hits, so only those rows need the string compare.
+				float score = 0.f;
+				if(term_trigrams == 0 || hits[row] == term_trigrams) {
+					score = names_[row].find(term) != std::string::npos ? 2.f : 0.f;
+				}
+				if(score == 0 && term_trigrams > 0) {
+					score = static_cast<float>(hits[row]) / static_cast<float>(term_trigrams);
+				}
+				scores[row] = score >= minimum_term_score ? scores[row] + score : -1.f;
+			}
+		}
+	}
+
+	std::vector<instrument_index::row_t> instrument_index::search(const query &search) const {
+		const auto rows = entries_.size();
+		std::vector<std::uint64_t> matches((rows + 63) / 64, ~std::uint64_t{0});
+		std::vector<std::uint64_t> passing(matches.size());
+		for(const auto &test : search.predicates) {
+			std::ranges::fill(passing, 0);
+			if(ym2612::is_channel_field(test.target)) {
+				channel_columns_[std::to_underlying(test.target)].filter(test, passing, rows);
+			} else {
+				const auto &columns = operator_columns_[std::to_underlying(test.target) - channel_field_count];
+				if(test.op) {
+					const auto op = static_cast<std::size_t>(std::ranges::find(operator_numbers, *test.op) - operator_numbers.begin());
+					columns[op].filter(test, passing, rows);
+				} else {
+					for(const auto &column : columns) {
+						column.filter(test, passing, rows);
+					}
+				}
+			}
+			for(std::size_t word = 0; word < matches.size(); word++) {
+				matches[word] &= passing[word];
+			}
+		}
+
+		std::vector<float> scores(rows, 0.f);
+		if(!search.terms.empty()) {
+			match_terms(search, matches, scores);
+		}
+
+		std::vector<row_t> result;
+		for(std::size_t word = 0; word < matches.size(); word++) {
+			for(auto bits = matches[word]; bits != 0; bits &= bits - 1) {
+				const auto row = static_cast<row_t>(word * 64 + static_cast<std::size_t>(std::countr_zero(bits)));
+				if(row < rows && scores[row] >= 0) {
+					result.push_back(row);
+				}
+			}
+		}
+		if(!search.terms.empty()) {
+			std::ranges::stable_sort(result, std::greater{}, [&scores](const row_t row) {
+				return scores[row];
+			});
+		}
+		return result;
+	}
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "instrument_bank.hpp"
+#include "chips/ym2612/fields.hpp"
+
+namespace MID3SMPS {
+	// Search index over every FM instrument of a bank: trigrams of the names and bit-packed columns of every register field.
+	// Queries are whitespace separated, terms like "alg==7", "fb>=5" or "ar<10" filter by parameter and everything else
+	// is matched against the names. Operator fields without an operator number ("ar<10") match if any operator does.
+	class instrument_index {
+	public:
+		using row_t = std::uint32_t;
+		using op_id = ym2612::operators::op_id;
+
+		using field = ym2612::field;
+		static constexpr std::size_t channel_field_count  = ym2612::channel_field_count;
+		static constexpr std::size_t operator_field_count = ym2612::operator_field_count;
+
+		enum class comparison : std::uint8_t {
+			equal,
+			not_equal,
+			less,
+			less_equal,
+			greater,
+			greater_equal,
+		};
+
+		struct predicate {
+			field target;
+			std::optional<op_id> op; // Any operator when empty, ignored for channel fields
+			comparison compare;
+			std::uint8_t value;
+		};
+
+		struct query {
+			std::vector<std::string> terms{}; // Lower case name fragments, all of them have to match
+			std::vector<predicate> predicates{};
+
+			[[nodiscard]] static query parse(std::string_view text);
+
+			[[nodiscard]] bool empty() const noexcept {
+				return terms.empty() && predicates.empty();
+			}
+		};
+
+		struct entry {
+			bank_key_t bank;
+			ins_key_t id;
+		};
+
+	private:
+		// Fixed width values packed into 64-bit words, values never straddle two words
+		class packed_column {
+			std::vector<std::uint64_t> words_{};
+			std::uint8_t bits_     = 8;
+			std::uint8_t per_word_ = 8;
+
+		public:
+			packed_column() = default;
+			explicit packed_column(const std::uint8_t bits) noexcept : bits_(bits), per_word_(static_cast<std::uint8_t>(64 / bits)) {}
+
+			void resize(std::size_t rows);
+			void set(std::size_t row, std::uint8_t value) noexcept;
+			[[nodiscard]] std::uint8_t get(std::size_t row) const noexcept;
+			// Sets the bit of every one of the first rows whose value passes, other bits are left alone
+			void filter(const predicate &test, std::span<std::uint64_t> matches, std::size_t rows) const;
+		};
+
+		std::vector<entry> entries_{};
+		std::vector<std::string> names_{}; // Lower case
+		std::unordered_map<ins_key_t, row_t> rows_{};
+		std::unordered_map<std::uint32_t, std::vector<row_t>> trigrams_{};
+		std::array<packed_column, channel_field_count> channel_columns_{};
+		std::array<std::array<packed_column, 4>, operator_field_count> operator_columns_{};
+
+		void store(row_t row, const ym2612::operators &operators);
+		void match_terms(const query &search, std::span<const std::uint64_t> matches, std::vector<float> &scores) const;
+
+	public:
+		instrument_index() = default;
+		explicit instrument_index(const instrument_bank &bank);
+
+		// Picks up parameter edits of one instrument, renames need a rebuild
+		void refresh(ins_key_t id, const ym2612::operators &operators);
+
+		// Matching rows, best name matches first and bank order otherwise
+		[[nodiscard]] std::vector<row_t> search(const query &search) const;
+
+		[[nodiscard]] const entry &operator[](const row_t row) const noexcept {
+			return entries_[row];
+		}
+
+		[[nodiscard]] std::size_t size() const noexcept {
+			return entries_.size();
+		}
+	};
+}
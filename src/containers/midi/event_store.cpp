@@ -0,0 +1,166 @@
+#include "event_store.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <libremidi/reader.hpp>
+
+namespace MID3SMPS::midi {
+	namespace {
+		// libremidi may keep the variable length size in front of meta data, drop it so the arena only holds the data
+		std::span<const std::uint8_t> strip_length_prefix(const std::span<const std::uint8_t> payload) {
+			std::size_t length = 0;
+			for(std::size_t idx = 0; idx < payload.size() && idx < 4; idx++) {
+				length = (length << 7) | (payload[idx] & 0x7Fu);
+				if((payload[idx] & 0x80) == 0) {
+					if(length == payload.size() - idx - 1) {
+						return payload.subspan(idx + 1);
+					}
+					break;
+				}
+			}
+			return payload;
+		}
+	}
+
+	event_store::event_store(const libremidi::reader &reader) {
+		ticks_per_quarter_ = static_cast<std::uint16_t>(reader.ticksPerBeat);
+		format_            = static_cast<std::uint8_t>(reader.format);
+
+		std::size_t total = 0;
+		for(const auto &track : reader.tracks) {
+			total += track.size();
+		}
+		delta_.reserve(total);
+		status_.reserve(total);
+		data1_.reserve(total);
+		data2_.reserve(total);
+		track_offsets_.reserve(reader.tracks.size() + 1);
+		payload_offsets_.reserve(reader.tracks.size() + 1);
+
+		for(const auto &track : reader.tracks) {
+			begin_track();
+			for(const auto &[tick, _, message] : track) {
+				const auto delta = static_cast<tick_t>(std::max(tick, 0));
+				const std::span<const std::uint8_t> bytes{message.bytes.data(), message.bytes.size()};
+				if(bytes.empty()) {
+					continue;
+				}
+				switch(const auto status = bytes[0]) {
+					case status::meta:
+						if(bytes.size() < 2) {
+							continue;
+						}
+						push(delta, status, bytes[1], strip_length_prefix(bytes.subspan(2)));
+						break;
+					case status::sysex:
+					case status::sysex_escape:
+						push(delta, status, 0, bytes.subspan(1));
+						break;
+					default:
+						push(delta, status, bytes.size() > 1 ? bytes[1] : 0, bytes.size() > 2 ? bytes[2] : 0);
+						break;
+				}
+			}
+		}
+	}
+
+	void event_store::begin_track() {
+		track_offsets_.push_back(static_cast<std::uint32_t>(delta_.size()));
+		payload_offsets_.push_back(static_cast<std::uint32_t>(payloads_.size()));
+	}
+
+	void event_store::push(const tick_t delta, const std::uint8_t status, const std::uint8_t data1, const std::uint8_t data2) {
+		if(track_offsets_.size() == 1) {
+			begin_track();
+		}
+		delta_.push_back(delta);
+		status_.push_back(status);
+		data1_.push_back(data1);
+		data2_.push_back(data2);
+		track_offsets_.back()   = static_cast<std::uint32_t>(delta_.size());
+		payload_offsets_.back() = static_cast<std::uint32_t>(payloads_.size());
+	}
+
+	void event_store::push(const tick_t delta, const std::uint8_t status, const std::uint8_t data1, const std::span<const std::uint8_t> payload) {
+		if(!status::has_payload(status)) {
+			throw std::logic_error("Only meta and sysex events can carry a payload");
+		}
+		if(track_offsets_.size() == 1) {
+			begin_track();
+		}
+		const auto track_start = track_offsets_[track_offsets_.size() - 2];
+		payloads_.push_back({
+			.event = static_cast<std::uint32_t>(delta_.size() - track_start),
+			.offset = static_cast<std::uint32_t>(arena_.size()),
+			.length = static_cast<std::uint32_t>(payload.size())
+		});
+		arena_.insert(arena_.end(), payload.begin(), payload.end());
+		push(delta, status, data1, static_cast<std::uint8_t>(0));
+	}
+
+	event_store::track_view event_store::track(const std::size_t index) const noexcept {
+		const auto begin  = track_offsets_[index];
+		const auto count  = track_offsets_[index + 1] - begin;
+		const auto pbegin = payload_offsets_[index];
+		const auto pcount = payload_offsets_[index + 1] - pbegin;
+		return {
+			.delta = std::span{delta_}.subspan(begin, count),
+			.status = std::span{status_}.subspan(begin, count),
+			.data1 = std::span{data1_}.subspan(begin, count),
+			.data2 = std::span{data2_}.subspan(begin, count),
+			.payloads = std::span{payloads_}.subspan(pbegin, pcount)
+		};
+	}
+
+	std::span<const std::uint8_t> event_store::payload(const payload_ref &ref) const noexcept {
+		return std::span{arena_}.subspan(ref.offset, ref.length);
+	}
+
+	std::vector<tick_t> event_store::absolute_ticks(const std::size_t track) const {
+		const auto deltas = this->track(track).delta;
+		std::vector<tick_t> ticks(deltas.size());
+		std::inclusive_scan(deltas.begin(), deltas.end(), ticks.begin());
+		return ticks;
+	}
+
+	tick_t event_store::length_in_ticks() const noexcept {
+		tick_t longest = 0;
+		for(std::size_t idx = 0; idx < track_count(); idx++) {
+			const auto deltas = track(idx).delta;
+			longest = std::max(longest, std::reduce(deltas.begin(), deltas.end(), tick_t{0}));
+		}
+		return longest;
+	}
+
+	std::size_t event_store::memory_usage() const noexcept {
+		return delta_.capacity() * sizeof(tick_t)
+		       + (status_.capacity() + data1_.capacity() + data2_.capacity() + arena_.capacity())
+		       + (track_offsets_.capacity() + payload_offsets_.capacity()) * sizeof(std::uint32_t)
+		       + payloads_.capacity() * sizeof(payload_ref);
+	}
+
+	void event_store::clear() noexcept {
+		delta_.clear();
+		status_.clear();
+		data1_.clear();
+		data2_.clear();
+		payloads_.clear();
+		arena_.clear();
+		track_offsets_.assign(1, 0);
+		payload_offsets_.assign(1, 0);
+		ticks_per_quarter_ = 0;
+		format_            = 0;
+	}
+
+	void event_store::shrink_to_fit() {
+		delta_.shrink_to_fit();
+		status_.shrink_to_fit();
+		data1_.shrink_to_fit();
+		data2_.shrink_to_fit();
+		payloads_.shrink_to_fit();
+		arena_.shrink_to_fit();
+		track_offsets_.shrink_to_fit();
+		payload_offsets_.shrink_to_fit();
+	}
+}
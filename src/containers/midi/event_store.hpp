@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace libremidi {
+	class reader;
+}
+
+namespace MID3SMPS::midi {
+	using tick_t = std::uint32_t;
+
+	namespace status {
+		static constexpr std::uint8_t note_off         = 0x80;
+		static constexpr std::uint8_t note_on          = 0x90;
+		static constexpr std::uint8_t poly_pressure    = 0xA0;
+		static constexpr std::uint8_t control_change   = 0xB0;
+		static constexpr std::uint8_t program_change   = 0xC0;
+		static constexpr std::uint8_t channel_pressure = 0xD0;
+		static constexpr std::uint8_t pitch_bend       = 0xE0;
+		static constexpr std::uint8_t sysex            = 0xF0;
+		static constexpr std::uint8_t sysex_escape     = 0xF7;
+		static constexpr std::uint8_t meta             = 0xFF;
+
+		[[nodiscard, gnu::const]] constexpr std::uint8_t kind(const std::uint8_t status) noexcept {
+			return status < sysex ? static_cast<std::uint8_t>(status & 0xF0) : status;
+		}
+
+		[[nodiscard, gnu::const]] constexpr std::uint8_t channel(const std::uint8_t status) noexcept {
+			return status & 0x0F;
+		}
+
+		[[nodiscard, gnu::const]] constexpr bool has_payload(const std::uint8_t status) noexcept {
+			return status == sysex || status == sysex_escape || status == meta;
+		}
+	}
+
+	namespace meta_type {
+		static constexpr std::uint8_t track_name     = 0x03;
+		static constexpr std::uint8_t end_of_track   = 0x2F;
+		static constexpr std::uint8_t tempo          = 0x51;
+		static constexpr std::uint8_t time_signature = 0x58;
+	}
+
+	// Parsed MIDI stored column-wise: one array per field instead of one heap allocated message per event.
+	// Every track's events are a contiguous range of the shared columns so passes over the song stay sequential.
+	// Meta and sysex events keep their meta type in data1 and their bytes in a shared arena.
+	class event_store {
+	public:
+		struct payload_ref {
+			std::uint32_t event;  // Index of the owning event inside its track
+			std::uint32_t offset; // Offset into the arena
+			std::uint32_t length;
+		};
+
+		struct track_view {
+			std::span<const tick_t> delta;
+			std::span<const std::uint8_t> status;
+			std::span<const std::uint8_t> data1;
+			std::span<const std::uint8_t> data2;
+			std::span<const payload_ref> payloads;
+
+			[[nodiscard]] constexpr std::size_t size() const noexcept {
+				return delta.size();
+			}
+
+			[[nodiscard]] constexpr bool empty() const noexcept {
+				return delta.empty();
+			}
+		};
+
+	private:
+		std::vector<tick_t> delta_{};
+		std::vector<std::uint8_t> status_{};
+		std::vector<std::uint8_t> data1_{};
+		std::vector<std::uint8_t> data2_{};
+
+		std::vector<std::uint32_t> track_offsets_{0};   // track n spans [track_offsets_[n], track_offsets_[n + 1])
+		std::vector<payload_ref> payloads_{};
+		std::vector<std::uint32_t> payload_offsets_{0}; // Same layout as track_offsets_ but into payloads_
+		std::vector<std::uint8_t> arena_{};
+
+		std::uint16_t ticks_per_quarter_ = 0;
+		std::uint8_t format_             = 0;
+
+	public:
+		event_store() = default;
+		explicit event_store(const libremidi::reader &reader);
+
+		// Appending, used by the reader conversion and for building songs by hand
+		void begin_track();
+		void push(tick_t delta, std::uint8_t status, std::uint8_t data1 = 0, std::uint8_t data2 = 0);
+		void push(tick_t delta, std::uint8_t status, std::uint8_t data1, std::span<const std::uint8_t> payload);
+
+		[[nodiscard]] track_view track(std::size_t index) const noexcept;
+		[[nodiscard]] std::span<const std::uint8_t> payload(const payload_ref &ref) const noexcept;
+		[[nodiscard]] std::vector<tick_t> absolute_ticks(std::size_t track) const;
+		[[nodiscard]] tick_t length_in_ticks() const noexcept;
+
+		[[nodiscard]] std::size_t track_count() const noexcept {
+			return track_offsets_.size() - 1;
+		}
+
+		[[nodiscard]] std::size_t event_count() const noexcept {
+			return delta_.size();
+		}
+
+		[[nodiscard]] std::size_t memory_usage() const noexcept;
+
+		[[nodiscard]] constexpr std::uint16_t ticks_per_quarter() const noexcept {
+			return ticks_per_quarter_;
+		}
+
+		constexpr void ticks_per_quarter(const std::uint16_t ticks) noexcept {
+			ticks_per_quarter_ = ticks;
+		}
+
+		[[nodiscard]] constexpr std::uint8_t format() const noexcept {
+			return format_;
+		}
+
+		[[nodiscard]] bool empty() const noexcept {
+			return delta_.empty();
+		}
+
+		void clear() noexcept;
+		void shrink_to_fit();
+	};
+}
@@ -1,73 +1,182 @@
-#include <spanstream>
-#include <fmt/compile.h>
+#include <array>
+#include <utility>
+#include <fmt/core.h>
 
 #include "program_persistence.hpp"
+#include "helpers/file_io.hpp"
+#include "helpers/text.hpp"
+#include "helpers/trace.hpp"
 
 namespace MID3SMPS {
-	void* program_persistence::read_open(ImGuiContext*, ImGuiSettingsHandler*, const char* name) noexcept{
-		persistence->mode = mode_from_string(name);
-		return persistence.get();
+	namespace {
+		constexpr auto header = "# MID3SMPS settings\n";
+
+		constexpr std::array<std::pair<std::string_view, int conversion::settings::*>, 2> numbers = {{
+			{"ticks_per_quarter", &conversion::settings::ticks_per_quarter},
+			{"ticks_multiplier", &conversion::settings::ticks_multiplier},
+		}};
+
+		constexpr std::array<std::pair<std::string_view, bool conversion::settings::*>, 6> flags = {{
+			{"convert_song_title", &conversion::settings::convert_song_title},
+			{"per_file_instruments", &conversion::settings::per_file_instruments},
+			{"auto_reload_midi", &conversion::settings::auto_reload_midi},
+			{"auto_optimize_midi", &conversion::settings::auto_optimize_midi},
+			{"chorus_cc_volume_boost", &conversion::settings::chorus_cc_volume_boost},
+			{"pan_law_compensation", &conversion::settings::pan_law_compensation},
+		}};
+
+		// Paths are stored as UTF-8 so they read back the same on Windows
+		std::string utf8(const fs::path &path) {
+			const auto text = path.u8string();
+			return {reinterpret_cast<const char *>(text.data()), text.size()};
+		}
+
+		fs::path from_utf8(const std::string_view text) {
+			return std::u8string(reinterpret_cast<const char8_t *>(text.data()), text.size());
+		}
 	}
 
-	void program_persistence::read_line(ImGuiContext*, ImGuiSettingsHandler*, void* entry, const char* line) noexcept{
-		if(persistence.get() != entry) {
+	program_persistence::program_persistence(fs::path path) : path_(std::move(path)) {
+		TRACE_ZONE("Load settings");
+		std::error_code error;
+		if(!fs::exists(path_, error)) {
 			return;
 		}
-
-		const std::string_view view = line;
-		std::ispanstream input(view);
-
-		switch(persistence->mode) {
-			case data:
-				read_data(input);
-				return;
-			case open_history:
-				read_recents(input);
-				return;
-			case none:
-			default:
-				break;
+		try {
+			const auto data = read_file(path_);
+			read({reinterpret_cast<const char *>(data.data()), data.size()});
+		} catch(const std::exception &exception) {
+			fmt::print(stderr, "Couldn't read {}: {}\n", path_.string(), exception.what()); // Starts from the defaults
 		}
 	}
 
-	void program_persistence::read_data(std::ispanstream &input) {
-		std::string line;
-		std::getline(input, line, '=');
-		if(line == "lastConfig") {
-			std::getline(input, line);
-			persistence->last_config_ = line;
+	program_persistence::~program_persistence() {
+		{
+			const std::lock_guard lock(mutex_);
+			stopping_ = true;
+		}
+		wake_.notify_one();
+		if(writer_.joinable()) {
+			writer_.join();
 		}
 	}
 
-	void program_persistence::read_recents(std::ispanstream &input) {
-		std::string midi;
-		std::getline(input, midi);
-		fs::path midi_path = midi;
-		if(midi_path.empty()) return;
-		persistence->insert_recent(std::move(midi_path));
+	// One "key=value" per line, unknown keys are skipped so older versions can read newer files
+	void program_persistence::read(const std::string_view text) {
+		text_lines lines(text);
+		std::string_view line;
+		while(lines.next(line)) {
+			line = trim(line);
+			if(line.empty() || line.starts_with('#')) {
+				continue;
+			}
+			const auto equals = line.find('=');
+			if(equals == std::string_view::npos) {
+				continue;
+			}
+			const auto key   = trim(line.substr(0, equals));
+			const auto value = trim(line.substr(equals + 1));
+			if(key == "last_config") {
+				last_config_ = from_utf8(value);
+			} else if(key == "recent_midi") {
+				if(!value.empty()) {
+					recent_midis_.touch(from_utf8(value));
+				}
+			}
+			for(const auto &[name, member] : numbers) {
+				if(key == name) {
+					conversion_.*member = parse_number<int>(value).value_or(conversion_.*member);
+				}
+			}
+			for(const auto &[name, member] : flags) {
+				if(key == name) {
+					conversion_.*member = value == "1";
+				}
+			}
+		}
 	}
 
-	void program_persistence::write_all(ImGuiContext *, ImGuiSettingsHandler *, ImGuiTextBuffer *out_buf) noexcept{
-		static constexpr auto header_fmt = FMT_COMPILE("[{}][{}]\n");
-		if(!persistence->empty()) {
-			static const auto header = fmt::format(header_fmt, TypeName, string(data));
-			out_buf->append(header.c_str());
-			const auto config_path = fmt::format("lastConfig={}\n", persistence->last_config_.string());
-			out_buf->append(config_path.c_str());
+	std::string program_persistence::serialize() const {
+		std::string text = header;
+		text += fmt::format("last_config={}\n", utf8(last_config_));
+		for(const auto &[name, member] : numbers) {
+			text += fmt::format("{}={}\n", name, conversion_.*member);
+		}
+		for(const auto &[name, member] : flags) {
+			text += fmt::format("{}={}\n", name, conversion_.*member ? 1 : 0);
+		}
+		// Oldest first, reading them back in order leaves the newest on top
+		const auto recent = recent_midis_.items();
+		for(auto midi = recent.rbegin(); midi != recent.rend(); ++midi) {
+			text += fmt::format("recent_midi={}\n", utf8(*midi));
+		}
+		return text;
+	}
 
-			// Close out section
-			out_buf->append("\n");
+	// Called with mutex_ held
+	void program_persistence::changed() {
+		revision_++;
+		if(!writer_.joinable()) {
+			writer_ = std::thread(&program_persistence::write_changes, this);
 		}
-		if(!persistence->recent_midis_.empty()) {
-			static const auto header = fmt::format(header_fmt, TypeName, string(open_history));
-			out_buf->append(header.c_str());
-			for(const auto &midi_path : persistence->recent_midis_) {
-				const auto str = fmt::format("{}\n", midi_path->string());
-				out_buf->append(str.c_str());
+		wake_.notify_one();
+	}
+
+	void program_persistence::write_changes() {
+		std::unique_lock lock(mutex_);
+		while(true) {
+			wake_.wait(lock, [this] { return stopping_ || revision_ != written_revision_; });
+			if(revision_ == written_revision_) {
+				return; // Stopping with nothing left to write
 			}
+			const auto revision = revision_;
+			const auto text     = serialize();
+			lock.unlock();
+			try {
+				TRACE_ZONE("Save settings");
+				write_file_atomically(path_, {reinterpret_cast<const std::uint8_t *>(text.data()), text.size()});
+			} catch(const std::exception &error) {
+				fmt::print(stderr, "Couldn't save settings: {}\n", error.what());
+			}
+			lock.lock();
+			written_revision_ = revision;
+		}
+	}
+
+	fs::path program_persistence::last_config() const {
+		const std::lock_guard lock(mutex_);
+		return last_config_;
+	}
+
+	void program_persistence::last_config(fs::path path) {
+		const std::lock_guard lock(mutex_);
+		if(last_config_ != path) {
+			last_config_ = std::move(path);
+			changed();
+		}
+	}
+
+	std::vector<fs::path> program_persistence::recent_midis() const {
+		const std::lock_guard lock(mutex_);
+		return recent_midis_.items();
+	}
+
+	void program_persistence::insert_recent(fs::path path) {
+		const std::lock_guard lock(mutex_);
+		recent_midis_.touch(std::move(path));
+		changed();
+	}
+
+	conversion::settings program_persistence::conversion() const {
+		const std::lock_guard lock(mutex_);
+		return conversion_;
+	}
 
-			// Close out section
-			out_buf->append("\n");
+	void program_persistence::conversion(const conversion::settings &settings) {
+		const std::lock_guard lock(mutex_);
+		if(conversion_ != settings) {
+			conversion_ = settings;
+			changed();
 		}
 	}
-} // MID3SMPS
\ No newline at end of file
+} // MID3SMPS
@@ -1,75 +1,70 @@
 #pragma once
 
+#include <condition_variable>
+#include <cstdint>
 #include <filesystem>
-#include <imgui_internal.h>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
+#include "conversion/settings.hpp"
+#include "helpers/mru_list.hpp"
+
 namespace MID3SMPS {
 	namespace fs = std::filesystem;
 
+	// What the program remembers between runs, kept in its own file next to imgui.ini.
+	// Safe to use from any thread. Every change is written out on a background thread, to a temporary file that's
+	// renamed over the old one, changes made while a write is running are coalesced into the next one.
 	class program_persistence {
-		friend class main_window;
-		enum Mode{
-			none,
-			data,
-			open_history
-		} mode = none;
-
-		fs::path last_config_;
-		std::vector<std::unique_ptr<fs::path>> recent_midis_;
+		struct path_hash {
+			[[nodiscard]] std::size_t operator()(const fs::path &path) const noexcept {
+				return fs::hash_value(path);
+			}
+		};
 
 	public:
-		static constexpr auto TypeName = "MID3SMPS";
+		static constexpr auto default_path      = "MID3SMPS.settings";
+		static constexpr std::size_t max_recent = 16;
 
-		static void write_all(ImGuiContext*, ImGuiSettingsHandler*, ImGuiTextBuffer* out_buf) noexcept;
-		static void* read_open(ImGuiContext*, ImGuiSettingsHandler*, const char* name) noexcept;
-		static void read_line(ImGuiContext*, ImGuiSettingsHandler*, void* entry, const char* line) noexcept;
+		// Reads path if it exists, a damaged file is reported and ignored
+		explicit program_persistence(fs::path path = default_path);
+		// Waits for anything not written yet
+		~program_persistence();
 
-		static void read_data(std::ispanstream &input);
-		static void read_recents(std::ispanstream &input);
+		program_persistence(const program_persistence &)            = delete;
+		program_persistence &operator=(const program_persistence &) = delete;
 
-		[[nodiscard]] constexpr auto& last_config() const noexcept{
-			return last_config_;
-		}
+		[[nodiscard]] fs::path last_config() const;
+		void last_config(fs::path path);
 
-		[[nodiscard]] constexpr auto& recent_midis() const noexcept{
-			return recent_midis_;
-		}
+		// Most recent first
+		[[nodiscard]] std::vector<fs::path> recent_midis() const;
+		void insert_recent(fs::path path);
 
-		void insert_recent(fs::path &&path) {
-			for(auto iter = recent_midis_.begin(); iter != recent_midis_.end(); ++iter) {
-				if(auto &ptr = *iter; *ptr == path) {
-					recent_midis_.erase(iter);
-					break;
-				}
-			}
-			recent_midis_.push_back(std::make_unique<fs::path>(path)); // Insert path at end
-		}
+		[[nodiscard]] conversion::settings conversion() const;
+		void conversion(const conversion::settings &settings);
 
 	private:
-		static constexpr Mode mode_from_string(const std::string_view view) noexcept{
-			if(view == "Data") { return data; }
-			if(view == "OpenHistory") { return open_history; }
-			return none;
-		}
+		void read(std::string_view text);
+		[[nodiscard]] std::string serialize() const;
+		void changed();
+		void write_changes();
 
-		static constexpr std::string_view string(const Mode mode) noexcept{
-			switch(mode) {
-				case data:
-					return "Data";
-				case open_history:
-					return "OpenHistory";
-				default:
-					return "None";
-			}
-		}
+		mutable std::mutex mutex_;
+		std::condition_variable wake_;
+		std::thread writer_; // Started by the first change
+		bool stopping_ = false;
+		std::uint64_t revision_ = 0, written_revision_ = 0;
 
-		[[nodiscard]] bool empty() const noexcept {
-			if(!last_config_.empty()) { return false; }
-			return true;
-		}
+		fs::path path_;
+		fs::path last_config_;
+		mru_list<fs::path, path_hash> recent_midis_{max_recent};
+		conversion::settings conversion_{};
 	};
 
 	inline auto persistence = std::make_unique<program_persistence>();
-} // MID3SMPS
\ No newline at end of file
+} // MID3SMPS
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include <fmt/core.h>
+
+#include "helpers/copy_on_write.hpp"
+
+namespace MID3SMPS {
+	// Values by 16-bit key, shared between copies of the table.
+	// The keys are split over 256 pages of 256 slots and copies share the pages, so copying the table costs the same for any number of values.
+	// Changing a slot clones its page first if another copy still holds it. Like copy_on_write, only one thread may write to a page,
+	// other threads can read their copies of the table.
+	template<typename T>
+	class shared_table {
+	public:
+		using key_type    = std::uint16_t;
+		using mapped_type = std::shared_ptr<T>; // Null for empty slots
+
+	private:
+		static constexpr std::size_t page_size = 256;
+		using page_t = std::array<mapped_type, page_size>;
+
+		std::array<std::shared_ptr<page_t>, page_size> pages_{};
+		std::size_t size_ = 0;
+
+		[[nodiscard]] static constexpr std::size_t page_of(const key_type key) noexcept {
+			return key / page_size;
+		}
+		[[nodiscard]] static constexpr std::size_t slot_of(const key_type key) noexcept {
+			return key % page_size;
+		}
+
+		// The page holding key, allocated or unshared so it can be written
+		[[nodiscard]] page_t &writable_page(const key_type key) {
+			auto &page = pages_[page_of(key)];
+			if(!page) {
+				page = std::make_shared<page_t>();
+			} else if(!sole_owner(page)) {
+				page = std::make_shared<page_t>(std::as_const(*page));
+			}
+			return *page;
+		}
+
+	public:
+		[[nodiscard]] std::size_t size() const noexcept {
+			return size_;
+		}
+
+		[[nodiscard]] bool empty() const noexcept {
+			return size_ == 0;
+		}
+
+		// Null if there is no value for key
+		[[nodiscard]] const T *find(const key_type key) const noexcept {
+			const auto &page = pages_[page_of(key)];
+			return page ? (*page)[slot_of(key)].get() : nullptr;
+		}
+
+		[[nodiscard]] bool contains(const key_type key) const noexcept {
+			return find(key) != nullptr;
+		}
+
+		[[nodiscard]] const mapped_type &at(const key_type key) const {
+			if(!contains(key)) {
+				throw std::out_of_range(fmt::format("No value for key {}", key));
+			}
+			return (*pages_[page_of(key)])[slot_of(key)];
+		}
+
+		// False, and the table unchanged, if key already had a value
+		bool insert(const key_type key, mapped_type &&value) {
+			if(contains(key) || !value) {
+				return false;
+			}
+			writable_page(key)[slot_of(key)] = std::move(value);
+			++size_;
+			return true;
+		}
+
+		// The slot for key in a page no other copy shares, for replacing its value. Null if there is no value for key.
+		[[nodiscard]] mapped_type *write(const key_type key) {
+			if(!contains(key)) {
+				return nullptr;
+			}
+			return &writable_page(key)[slot_of(key)];
+		}
+	};
+}
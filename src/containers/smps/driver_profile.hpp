@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <string_view>
+
+namespace MID3SMPS::smps {
+	using namespace std::string_view_literals;
+
+	static constexpr double ntsc_frame_rate = 59.922743;
+	static constexpr double pal_frame_rate  = 49.701459;
+
+	enum class tempo_mode : std::uint8_t {
+		timeout,   // Counter reloaded with the tempo every time it runs out, that frame is delayed (S1)
+		overflow2, // Tempo added to an accumulator each frame, a tick happens only when it overflows (S2)
+		overflow,  // Tempo added to an accumulator each frame, the tick is skipped when it overflows (S3K)
+	};
+
+	enum class pointer_mode : std::uint8_t {
+		relative, // Header pointers from the start of the song, jump targets from the pointer itself (68k drivers)
+		absolute, // Z80 addresses, the song is expected at load_address
+	};
+
+	enum class flag_set : std::uint8_t {
+		classic, // Sonic 1 and 2 coordination flags
+		s3k,     // Sonic 3 & Knuckles coordination flags, FF prefixes the meta flags
+	};
+
+	enum class dac_format : std::uint8_t {
+		dpcm, // 4-bit deltas from a fixed table, two samples to a byte, high nibble first (S1, S2)
+		pcm8, // 8-bit unsigned (S3K)
+	};
+
+	struct driver_profile {
+		std::string_view name;
+		tempo_mode tempo;
+		std::endian byte_order     = std::endian::big;
+		pointer_mode pointers      = pointer_mode::relative;
+		std::uint16_t load_address = 0;
+		flag_set flags             = flag_set::classic;
+		dac_format dac             = dac_format::dpcm;
+		std::uint32_t dac_rate     = 8250; // Hz, the rate samples are encoded for. Close to what the drivers play drums at with their usual pitch values.
+
+		// Sequence ticks processed per frame for the given main tempo
+		[[nodiscard, gnu::pure]] constexpr double ticks_per_frame(const std::uint8_t main_tempo) const noexcept {
+			switch(tempo) {
+				case tempo_mode::timeout: {
+					const double period = main_tempo == 0 ? 256. : main_tempo;
+					return (period - 1.) / period;
+				}
+				case tempo_mode::overflow2: return main_tempo / 256.;
+				case tempo_mode::overflow: return (256. - main_tempo) / 256.;
+				default: return 0;
+			}
+		}
+	};
+
+	static constexpr std::array profiles = {
+		driver_profile{.name = "Sonic 1"sv, .tempo = tempo_mode::timeout},
+		driver_profile{
+			.name = "Sonic 2"sv, .tempo = tempo_mode::overflow2,
+			.byte_order = std::endian::little, .pointers = pointer_mode::absolute, .load_address = 0x1380
+		},
+		driver_profile{
+			.name = "Sonic 3 & Knuckles"sv, .tempo = tempo_mode::overflow,
+			.byte_order = std::endian::little, .pointers = pointer_mode::absolute, .load_address = 0x8000, .flags = flag_set::s3k,
+			.dac = dac_format::pcm8, .dac_rate = 16000
+		},
+	};
+}
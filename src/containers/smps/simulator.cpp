@@ -0,0 +1,373 @@
+#include "simulator.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <fmt/format.h>
+
+namespace MID3SMPS::smps {
+	namespace {
+		enum class flag_op : std::uint8_t {
+			ignore,
+			pan,
+			fm_volume,
+			psg_volume,
+			tie,
+			fill,
+			transpose,
+			tempo,
+			track_divider,
+			all_dividers,
+			voice,
+			voice_s3k, // A second byte follows when the voice number has bit 7 set
+			psg_voice,
+			noise,
+			stop,
+			jump,
+			loop,
+			call,
+			ret,
+			conditional_jump,
+			meta,
+			unknown,
+		};
+
+		struct flag_info {
+			flag_op op;
+			std::uint8_t parameters;
+		};
+
+		constexpr std::uint8_t first_flag = 0xE0;
+		constexpr std::uint8_t rest       = 0x80;
+
+		// E0 to FF
+		constexpr std::array<flag_info, 0x20> classic_flags = {{
+			{flag_op::pan, 1}, {flag_op::ignore, 1}, {flag_op::ignore, 1}, {flag_op::ret, 0},
+			{flag_op::ignore, 0}, {flag_op::track_divider, 1}, {flag_op::fm_volume, 1}, {flag_op::tie, 0},
+			{flag_op::fill, 1}, {flag_op::transpose, 1}, {flag_op::tempo, 1}, {flag_op::all_dividers, 1},
+			{flag_op::psg_volume, 1}, {flag_op::ignore, 0}, {flag_op::ignore, 0}, {flag_op::voice, 1},
+			{flag_op::ignore, 4}, {flag_op::ignore, 0}, {flag_op::stop, 0}, {flag_op::noise, 1},
+			{flag_op::ignore, 0}, {flag_op::psg_voice, 1}, {flag_op::jump, 2}, {flag_op::loop, 4},
+			{flag_op::call, 2}, {flag_op::ignore, 0}, {flag_op::unknown, 0}, {flag_op::unknown, 0},
+			{flag_op::unknown, 0}, {flag_op::unknown, 0}, {flag_op::unknown, 0}, {flag_op::unknown, 0},
+		}};
+
+		constexpr std::array<flag_info, 0x20> s3k_flags = {{
+			{flag_op::pan, 1}, {flag_op::ignore, 1}, {flag_op::ignore, 1}, {flag_op::stop, 0},
+			{flag_op::ignore, 1}, {flag_op::ignore, 2}, {flag_op::fm_volume, 1}, {flag_op::tie, 0},
+			{flag_op::fill, 1}, {flag_op::ignore, 0}, {flag_op::ignore, 1}, {flag_op::conditional_jump, 3},
+			{flag_op::psg_volume, 1}, {flag_op::ignore, 1}, {flag_op::ignore, 2}, {flag_op::voice_s3k, 1},
+			{flag_op::ignore, 4}, {flag_op::ignore, 2}, {flag_op::stop, 0}, {flag_op::noise, 1},
+			{flag_op::ignore, 1}, {flag_op::psg_voice, 1}, {flag_op::jump, 2}, {flag_op::loop, 4},
+			{flag_op::call, 2}, {flag_op::ret, 0}, {flag_op::ignore, 0}, {flag_op::transpose, 1},
+			{flag_op::ignore, 2}, {flag_op::ignore, 1}, {flag_op::ignore, 4}, {flag_op::meta, 1},
+		}};
+
+		// FF 00 to FF 07, the parameter count doesn't include the sub flag
+		constexpr std::array<flag_info, 8> s3k_meta_flags = {{
+			{flag_op::tempo, 1}, {flag_op::ignore, 1}, {flag_op::ignore, 1}, {flag_op::ignore, 3},
+			{flag_op::all_dividers, 1}, {flag_op::ignore, 4}, {flag_op::ignore, 2}, {flag_op::ignore, 0},
+		}};
+	}
+
+	simulator::simulator(const std::span<const std::uint8_t> song, const driver_profile &profile) : song_(song), profile_(profile) {
+		voice_table_                = header_pointer(0);
+		const auto fm_tracks        = byte(2);
+		const auto psg_tracks       = byte(3);
+		const auto divider          = std::max<std::uint8_t>(byte(4), 1);
+		header_tempo_               = byte(5);
+
+		std::size_t entry = 6;
+		for(std::uint8_t idx = 0; idx < fm_tracks; idx++, entry += 4) {
+			// The first FM entry always belongs to the DAC
+			const auto type = idx == 0 ? channel_type::dac : channel_type::fm;
+			track_state track{
+				.info = {type, static_cast<std::uint8_t>(idx == 0 ? 0 : idx - 1)},
+				.position = header_pointer(entry),
+				.transpose = static_cast<std::int8_t>(byte(entry + 2)),
+				.volume = byte(entry + 3),
+			};
+			track.divider = divider;
+			header_tracks_.push_back(track);
+		}
+		for(std::uint8_t idx = 0; idx < psg_tracks; idx++, entry += 6) {
+			track_state track{
+				.info = {channel_type::psg, idx},
+				.position = header_pointer(entry),
+				.transpose = static_cast<std::int8_t>(byte(entry + 2)),
+				.volume = byte(entry + 3),
+			};
+			track.divider = divider;
+			track.note    = byte(entry + 5); // Initial volume envelope, logged and replaced on the first run
+			header_tracks_.push_back(track);
+		}
+	}
+
+	std::uint8_t simulator::byte(const std::size_t offset) const {
+		if(offset >= song_.size()) {
+			throw std::runtime_error(fmt::format("SMPS data read out of bounds at {:#x}", offset));
+		}
+		return song_[offset];
+	}
+
+	std::uint16_t simulator::word(const std::size_t offset) const {
+		const auto first  = byte(offset);
+		const auto second = byte(offset + 1);
+		if(profile_.byte_order == std::endian::big) {
+			return static_cast<std::uint16_t>(first << 8 | second);
+		}
+		return static_cast<std::uint16_t>(second << 8 | first);
+	}
+
+	std::size_t simulator::header_pointer(const std::size_t offset) const {
+		const auto value = word(offset);
+		if(profile_.pointers == pointer_mode::relative) {
+			return value;
+		}
+		if(value < profile_.load_address) {
+			throw std::runtime_error(fmt::format("SMPS pointer {:#x} is below the load address {:#x}", value, profile_.load_address));
+		}
+		return value - profile_.load_address;
+	}
+
+	std::size_t simulator::jump_pointer(const std::size_t offset) const {
+		if(profile_.pointers == pointer_mode::absolute) {
+			return header_pointer(offset);
+		}
+		// 68k drivers store the distance from the pointer's own address plus one
+		const auto distance = static_cast<std::int16_t>(word(offset));
+		const auto target   = static_cast<std::ptrdiff_t>(offset) + distance + 1;
+		if(target < 0) {
+			throw std::runtime_error(fmt::format("SMPS jump at {:#x} points before the song", offset));
+		}
+		return static_cast<std::size_t>(target);
+	}
+
+	bool simulator::tick_this_frame() noexcept {
+		switch(profile_.tempo) {
+			case tempo_mode::timeout:
+				if(--tempo_counter_ == 0) {
+					tempo_counter_ = main_tempo_ == 0 ? 256 : main_tempo_;
+					return false;
+				}
+				return true;
+			case tempo_mode::overflow2:
+				tempo_counter_ = static_cast<std::uint16_t>(tempo_counter_ + main_tempo_);
+				if(tempo_counter_ >= 256) {
+					tempo_counter_ -= 256;
+					return true;
+				}
+				return false;
+			case tempo_mode::overflow:
+				tempo_counter_ = static_cast<std::uint16_t>(tempo_counter_ + main_tempo_);
+				if(tempo_counter_ >= 256) {
+					tempo_counter_ -= 256;
+					return false;
+				}
+				return true;
+			default: return true;
+		}
+	}
+
+	void simulator::log(const std::uint8_t index, const event_type type, const std::uint8_t value) {
+		events_.push_back({frame_, index, type, value});
+	}
+
+	void simulator::note_off(const std::uint8_t index) {
+		if(auto &track = tracks_[index]; track.sounding) {
+			track.sounding = false;
+			log(index, event_type::note_off);
+		}
+	}
+
+	bool simulator::coordination_flag(const std::uint8_t index, const std::uint8_t flag) {
+		auto &track = tracks_[index];
+		const auto flag_position = track.position - 1;
+		auto info = (profile_.flags == flag_set::s3k ? s3k_flags : classic_flags)[flag - first_flag];
+		if(info.op == flag_op::meta) {
+			const auto sub_flag = byte(track.position++);
+			if(sub_flag >= s3k_meta_flags.size()) {
+				throw std::runtime_error(fmt::format("Unknown SMPS meta flag FF {:02X} at {:#x}", sub_flag, flag_position));
+			}
+			info = s3k_meta_flags[sub_flag];
+		}
+
+		const auto parameter = info.parameters > 0 ? byte(track.position) : std::uint8_t{0};
+		switch(info.op) {
+			case flag_op::unknown:
+				throw std::runtime_error(fmt::format("Unknown SMPS coordination flag {:02X} at {:#x}", flag, flag_position));
+			case flag_op::pan:
+				log(index, event_type::pan, parameter);
+				break;
+			case flag_op::fm_volume:
+			case flag_op::psg_volume:
+				track.volume = static_cast<std::uint8_t>(track.volume + parameter);
+				log(index, event_type::volume, track.volume);
+				break;
+			case flag_op::tie:
+				track.tie = true;
+				break;
+			case flag_op::fill:
+				track.fill = parameter;
+				break;
+			case flag_op::transpose:
+				track.transpose = static_cast<std::int8_t>(track.transpose + static_cast<std::int8_t>(parameter));
+				break;
+			case flag_op::tempo:
+				main_tempo_ = parameter;
+				log(index, event_type::tempo, parameter);
+				break;
+			case flag_op::track_divider:
+				track.divider = std::max<std::uint8_t>(parameter, 1);
+				break;
+			case flag_op::all_dividers:
+				for(auto &other : tracks_) {
+					other.divider = std::max<std::uint8_t>(parameter, 1);
+				}
+				break;
+			case flag_op::voice_s3k:
+				if(parameter & 0x80) {
+					++track.position; // Voice comes from another song's table
+				}
+				[[fallthrough]];
+			case flag_op::voice:
+			case flag_op::psg_voice:
+				log(index, event_type::voice, parameter & 0x7F);
+				break;
+			case flag_op::noise:
+				log(index, event_type::noise, parameter);
+				break;
+			case flag_op::stop:
+				note_off(index);
+				track.playing = false;
+				log(index, event_type::stop);
+				return false;
+			case flag_op::jump: {
+				const auto target = jump_pointer(track.position);
+				if(target <= flag_position) {
+					track.loops = static_cast<std::uint8_t>(std::min(track.loops + 1, 0xFF)); // Saturates, a settled track stays settled
+					log(index, event_type::loop, track.loops);
+				}
+				track.position = target;
+				return true;
+			}
+			case flag_op::loop: {
+				auto &counter = track.loop_counters[parameter % loop_slots];
+				if(counter == 0) {
+					counter = byte(track.position + 1);
+				}
+				if(--counter != 0) {
+					track.position = jump_pointer(track.position + 2);
+					return true;
+				}
+				break;
+			}
+			case flag_op::call:
+				if(track.stack_size == stack_depth) {
+					throw std::runtime_error(fmt::format("SMPS call stack overflow at {:#x}", flag_position));
+				}
+				track.stack[track.stack_size++] = track.position + 2;
+				track.position = jump_pointer(track.position);
+				return true;
+			case flag_op::ret:
+				if(track.stack_size == 0) {
+					throw std::runtime_error(fmt::format("SMPS return without a call at {:#x}", flag_position));
+				}
+				track.position = track.stack[--track.stack_size];
+				return true;
+			default: break; // Conditional jumps are assumed not taken, nothing a converted song relies on
+		}
+		track.position += info.parameters;
+		return true;
+	}
+
+	void simulator::advance(const std::uint8_t index) {
+		auto &track = tracks_[index];
+		std::uint8_t data;
+		for(std::size_t flags = 0; (data = byte(track.position++)) >= first_flag; flags++) {
+			if(flags == max_flags_per_note) {
+				throw std::runtime_error(fmt::format("SMPS track {} never reaches a note after {:#x}", index, track.position - 1));
+			}
+			if(!coordination_flag(index, data)) {
+				return;
+			}
+		}
+
+		if(data >= rest) {
+			track.note = data;
+			if(const auto next = byte(track.position); next < rest) {
+				track.duration = next;
+				++track.position;
+			}
+		} else {
+			track.duration = data; // Repeats the previous note
+		}
+
+		if(!std::exchange(track.tie, false)) {
+			note_off(index);
+			if(track.note != rest) {
+				const auto note = track.info.type == channel_type::dac ? track.note : static_cast<std::uint8_t>(track.note + track.transpose);
+				log(index, event_type::note_on, note);
+				// DAC samples play out on their own, there is nothing to release
+				track.sounding = track.info.type != channel_type::dac;
+			}
+		}
+		track.timer      = static_cast<std::uint16_t>(std::max(track.duration * track.divider, 1));
+		track.fill_timer = track.fill;
+	}
+
+	void simulator::tick(const std::uint8_t index) {
+		auto &track = tracks_[index];
+		if(!track.playing) {
+			return;
+		}
+		if(--track.timer == 0) {
+			advance(index);
+			return;
+		}
+		if(track.fill_timer != 0 && --track.fill_timer == 0) {
+			note_off(index);
+		}
+	}
+
+	simulator::result simulator::run(const options &settings) {
+		tracks_ = header_tracks_;
+		events_.clear();
+		main_tempo_    = header_tempo_;
+		tempo_counter_ = profile_.tempo == tempo_mode::timeout ? (header_tempo_ == 0 ? 256 : header_tempo_) : 0;
+		frame_         = 0;
+
+		for(std::uint8_t idx = 0; idx < tracks_.size(); idx++) {
+			auto &track = tracks_[idx];
+			if(track.info.type == channel_type::psg) {
+				log(idx, event_type::voice, std::exchange(track.note, rest));
+			}
+			if(track.info.type != channel_type::dac) {
+				log(idx, event_type::volume, track.volume);
+			}
+		}
+
+		const auto settled = [&] {
+			return std::ranges::all_of(tracks_, [&](const track_state &track) {
+				return !track.playing || track.loops >= settings.loops;
+			});
+		};
+
+		result output;
+		for(; frame_ < settings.max_frames; frame_++) {
+			if(settled()) {
+				output.completed = true;
+				break;
+			}
+			if(!tick_this_frame()) {
+				continue;
+			}
+			for(std::uint8_t idx = 0; idx < tracks_.size(); idx++) {
+				tick(idx);
+			}
+		}
+		output.frames = frame_;
+		output.events = std::move(events_);
+		return output;
+	}
+}
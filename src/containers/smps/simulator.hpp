@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "driver_profile.hpp"
+
+namespace MID3SMPS::smps {
+	// Runs an SMPS song the way the sound driver would, frame by frame, without producing any audio.
+	// The result is a log of what every track did and when, which can be compared with the source MIDI or fed to the chip emulators.
+	class simulator {
+	public:
+		enum class channel_type : std::uint8_t {
+			dac,
+			fm,
+			psg,
+		};
+
+		enum class event_type : std::uint8_t {
+			note_on,  // value is the note after transposition, the sample ID on the DAC track
+			note_off,
+			voice,    // FM voice or PSG volume envelope
+			volume,   // value is the track's attenuation after the change
+			pan,      // Raw AMS/FMS/pan byte
+			tempo,    // New main tempo
+			noise,    // PSG noise mode byte
+			loop,     // Track jumped backwards, value is how many times it has now
+			stop,
+		};
+
+		struct event {
+			std::uint32_t frame;
+			std::uint8_t track;
+			event_type type;
+			std::uint8_t value;
+		};
+
+		struct options {
+			std::uint8_t loops       = 1;            // Stop once every track has looped this many times or stopped
+			std::uint32_t max_frames = 60 * 60 * 30; // Half an hour of NTSC frames, for songs that never settle
+		};
+
+		struct result {
+			std::vector<event> events{};
+			std::uint32_t frames = 0;
+			bool completed       = false; // False if max_frames ran out first
+
+			[[nodiscard]] constexpr double seconds(const event &logged, const double frame_rate = ntsc_frame_rate) const noexcept {
+				return logged.frame / frame_rate;
+			}
+		};
+
+		struct track_info {
+			channel_type type;
+			std::uint8_t channel; // Index among the tracks of the same type
+		};
+
+		// SMPS notes start at 81, which the classic drivers play as C0 (MIDI note 12)
+		[[nodiscard]] static constexpr std::uint8_t midi_note(const std::uint8_t smps_note) noexcept {
+			return static_cast<std::uint8_t>(smps_note - 0x81 + 12);
+		}
+
+	private:
+		static constexpr std::size_t loop_slots  = 8;
+		static constexpr std::size_t stack_depth = 8;
+		// More coordination flags than this in a row means a jump, loop or call cycle without a note in it
+		static constexpr std::size_t max_flags_per_note = 0x10000;
+
+		struct track_state {
+			track_info info;
+			std::size_t position;
+			std::int8_t transpose;
+			std::uint8_t volume;
+
+			bool playing            = true;
+			bool sounding           = false;
+			bool tie                = false; // Next note continues the current one
+			std::uint8_t divider    = 1;
+			std::uint16_t timer     = 1;
+			std::uint8_t duration   = 0;
+			std::uint8_t note       = 0x80;
+			std::uint8_t fill       = 0;
+			std::uint8_t fill_timer = 0;
+			std::uint8_t loops      = 0;
+			std::array<std::uint8_t, loop_slots> loop_counters{};
+			std::array<std::size_t, stack_depth> stack{};
+			std::uint8_t stack_size = 0;
+		};
+
+		std::span<const std::uint8_t> song_;
+		driver_profile profile_;
+
+		std::vector<track_state> header_tracks_{}; // As the header sets them up, copied into tracks_ for every run
+		std::size_t voice_table_   = 0;
+		std::uint8_t header_tempo_ = 0;
+
+		// Per run
+		std::vector<track_state> tracks_{};
+		std::vector<event> events_{};
+		std::uint8_t main_tempo_     = 0;
+		std::uint16_t tempo_counter_ = 0;
+		std::uint32_t frame_         = 0;
+
+		[[nodiscard]] std::uint8_t byte(std::size_t offset) const;
+		[[nodiscard]] std::uint16_t word(std::size_t offset) const;
+		[[nodiscard]] std::size_t header_pointer(std::size_t offset) const;
+		[[nodiscard]] std::size_t jump_pointer(std::size_t offset) const;
+
+		[[nodiscard]] bool tick_this_frame() noexcept;
+		void tick(std::uint8_t index);
+		void advance(std::uint8_t index);
+		// Returns false once the track stopped
+		bool coordination_flag(std::uint8_t index, std::uint8_t flag);
+		void note_off(std::uint8_t index);
+		void log(std::uint8_t index, event_type type, std::uint8_t value = 0);
+
+	public:
+		// The song has to outlive the simulator
+		simulator(std::span<const std::uint8_t> song, const driver_profile &profile);
+
+		[[nodiscard]] result run(const options &settings);
+		[[nodiscard]] result run() {
+			return run(options{});
+		}
+
+		[[nodiscard]] std::size_t track_count() const noexcept {
+			return header_tracks_.size();
+		}
+
+		[[nodiscard]] track_info track(const std::size_t index) const noexcept {
+			return header_tracks_[index].info;
+		}
+
+		// Offset of the FM voice table inside the song
+		[[nodiscard]] std::size_t voice_table() const noexcept {
+			return voice_table_;
+		}
+	};
+}
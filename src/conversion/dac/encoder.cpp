@@ -0,0 +1,213 @@
+#include "encoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "helpers/trace.hpp"
+
+namespace MID3SMPS::conversion::dac {
+	namespace {
+		// Every value the accumulator can hold is a state of the trellis
+		constexpr std::size_t states = 256;
+		// Paths that differ this many samples back have always merged by then in practice, so those deltas are final.
+		// Decisions are kept for twice this many samples and the older half is written out once it's this far behind.
+		constexpr std::size_t traceback = 128;
+		constexpr std::int32_t unreachable = 1 << 26;
+
+		// Costs keep the code that reached them in their low bits, so one min picks both the cheapest path and how it got there
+		constexpr int code_bits = 4;
+		constexpr std::int32_t code_mask = (1 << code_bits) - 1;
+		static_assert(dpcm_deltas.size() == 1 << code_bits);
+
+		// Squared error of landing on accumulator value state when aiming for target is squares[state - target + 255]
+		constexpr auto squares = [] {
+			std::array<std::int32_t, 511> table{};
+			for(std::size_t idx = 0; idx < table.size(); idx++) {
+				const auto diff = static_cast<std::int32_t>(idx) - 255;
+				table[idx]      = diff * diff << code_bits;
+			}
+			return table;
+		}();
+
+		// The state a delta came from is (state - delta) & 0xFF, with the costs stored twice over that's costs[state + offset]
+		constexpr auto offsets = [] {
+			std::array<std::size_t, dpcm_deltas.size()> table{};
+			for(std::size_t code = 0; code < table.size(); code++) {
+				table[code] = static_cast<std::size_t>((256 - dpcm_deltas[code]) & 0xFF);
+			}
+			return table;
+		}();
+
+#if defined(__SSE2__)
+		[[nodiscard]] __m128i min(const __m128i lhs, const __m128i rhs) noexcept {
+#if defined(__SSE4_1__)
+			return _mm_min_epi32(lhs, rhs);
+#else
+			const auto greater = _mm_cmpgt_epi32(lhs, rhs);
+			return _mm_or_si128(_mm_and_si128(greater, rhs), _mm_andnot_si128(greater, lhs));
+#endif
+		}
+#endif
+
+		// Cheapest way into every state from the previous sample's costs, and the code it took. Ties go to the lower code.
+		void step(const std::int32_t *costs, const std::uint8_t target, std::int32_t *next, std::uint8_t *codes) noexcept {
+			const auto *error = squares.data() + 255 - target;
+#if defined(__SSE2__)
+			const auto mask = _mm_set1_epi32(code_mask);
+			// Four states to a register, sixteen at a time so the codes pack into one store
+			for(std::size_t base = 0; base < states; base += 16) {
+				__m128i best[4];
+				for(std::size_t lane = 0; lane < 4; lane++) {
+					best[lane] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(costs + base + lane * 4 + offsets[0]));
+				}
+				for(std::size_t code = 1; code < offsets.size(); code++) {
+					const auto code_vector = _mm_set1_epi32(static_cast<int>(code));
+					for(std::size_t lane = 0; lane < 4; lane++) {
+						const auto candidate = _mm_loadu_si128(reinterpret_cast<const __m128i *>(costs + base + lane * 4 + offsets[code]));
+						best[lane]           = min(best[lane], _mm_or_si128(candidate, code_vector));
+					}
+				}
+				__m128i best_code[4];
+				for(std::size_t lane = 0; lane < 4; lane++) {
+					best_code[lane] = _mm_and_si128(best[lane], mask);
+					const auto cost = _mm_add_epi32(_mm_andnot_si128(mask, best[lane]), _mm_loadu_si128(reinterpret_cast<const __m128i *>(error + base + lane * 4)));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(next + base + lane * 4), cost);
+				}
+				const auto packed = _mm_packus_epi16(_mm_packs_epi32(best_code[0], best_code[1]), _mm_packs_epi32(best_code[2], best_code[3]));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(codes + base), packed);
+			}
+#else
+			for(std::size_t state = 0; state < states; state++) {
+				std::int32_t best = costs[state + offsets[0]];
+				for(std::size_t code = 1; code < offsets.size(); code++) {
+					best = std::min(best, costs[state + offsets[code]] | static_cast<std::int32_t>(code));
+				}
+				next[state]  = (best & ~code_mask) + error[state];
+				codes[state] = static_cast<std::uint8_t>(best & code_mask);
+			}
+#endif
+		}
+
+		void put(std::vector<std::uint8_t> &data, const std::size_t idx, const std::uint8_t code) noexcept {
+			data[idx / 2] |= static_cast<std::uint8_t>(idx % 2 == 0 ? code << 4 : code);
+		}
+
+		// Follows the chosen codes back from state through every decided sample, writing them out from first onwards
+		void trace(const std::vector<std::uint8_t> &decisions, const std::size_t steps, std::uint8_t state, std::vector<std::uint8_t> &path) {
+			path.resize(steps);
+			for(std::size_t idx = steps; idx-- > 0;) {
+				const auto code = decisions[idx * states + state];
+				path[idx]       = code;
+				state           = static_cast<std::uint8_t>(state - dpcm_deltas[code]);
+			}
+		}
+	}
+
+	std::vector<std::uint8_t> encode_pcm8(const std::span<const float> samples) {
+		TRACE_ZONE("Encode PCM");
+		std::vector<std::uint8_t> data(samples.size());
+		for(std::size_t idx = 0; idx < samples.size(); idx++) {
+			data[idx] = to_unsigned(samples[idx]);
+		}
+		return data;
+	}
+
+	std::vector<std::uint8_t> encode_dpcm(const std::span<const float> samples) {
+		TRACE_ZONE("Encode DPCM");
+		std::vector<std::uint8_t> data((samples.size() + 1) / 2);
+		// Path costs twice over so every delta's predecessors are one contiguous read, normalised so the cheapest is 0
+		alignas(16) std::array<std::int32_t, states * 2> costs;
+		alignas(16) std::array<std::int32_t, states> next;
+		costs.fill(unreachable);
+		costs[dpcm_start] = costs[dpcm_start + states] = 0;
+
+		// Decisions for the samples that aren't final yet, a row of codes per sample
+		std::vector<std::uint8_t> decisions(traceback * 2 * states);
+		std::vector<std::uint8_t> path;
+		std::size_t pending = 0;
+		std::size_t written = 0;
+		std::uint8_t best_state = dpcm_start;
+
+		for(std::size_t idx = 0; idx < samples.size(); idx++) {
+			step(costs.data(), to_unsigned(samples[idx]), next.data(), decisions.data() + pending * states);
+			pending++;
+
+			const auto cheapest = std::ranges::min_element(next);
+			best_state          = static_cast<std::uint8_t>(cheapest - next.begin());
+			const auto floor    = *cheapest;
+			for(std::size_t state = 0; state < states; state++) {
+				costs[state] = costs[state + states] = next[state] - floor;
+			}
+
+			if(pending == traceback * 2) {
+				trace(decisions, pending, best_state, path);
+				for(std::size_t decided = 0; decided < traceback; decided++) {
+					put(data, written++, path[decided]);
+				}
+				std::memmove(decisions.data(), decisions.data() + traceback * states, traceback * states);
+				pending = traceback;
+			}
+		}
+		trace(decisions, pending, best_state, path);
+		for(const auto code : path) {
+			put(data, written++, code);
+		}
+		return data;
+	}
+
+	std::vector<std::uint8_t> encode_dpcm_greedy(const std::span<const float> samples) {
+		TRACE_ZONE("Encode DPCM greedily");
+		std::vector<std::uint8_t> data((samples.size() + 1) / 2);
+		std::uint8_t accumulator = dpcm_start;
+		for(std::size_t idx = 0; idx < samples.size(); idx++) {
+			const int target      = to_unsigned(samples[idx]);
+			std::uint8_t best     = 0;
+			int best_error        = 256;
+			for(std::uint8_t code = 0; code < dpcm_deltas.size(); code++) {
+				// Wrapping is what the driver does, a delta that wraps around lands far from the target and loses on its own
+				const auto next  = static_cast<std::uint8_t>(accumulator + dpcm_deltas[code]);
+				const auto error = std::abs(target - next);
+				if(error < best_error) {
+					best       = code;
+					best_error = error;
+				}
+			}
+			accumulator = static_cast<std::uint8_t>(accumulator + dpcm_deltas[best]);
+			put(data, idx, best);
+		}
+		return data;
+	}
+
+	std::vector<std::uint8_t> decode_dpcm(const std::span<const std::uint8_t> data) {
+		std::vector<std::uint8_t> samples(data.size() * 2);
+		std::uint8_t accumulator = dpcm_start;
+		for(std::size_t idx = 0; idx < data.size(); idx++) {
+			accumulator          = static_cast<std::uint8_t>(accumulator + dpcm_deltas[data[idx] >> 4]);
+			samples[idx * 2]     = accumulator;
+			accumulator          = static_cast<std::uint8_t>(accumulator + dpcm_deltas[data[idx] & 0x0F]);
+			samples[idx * 2 + 1] = accumulator;
+		}
+		return samples;
+	}
+
+	double snr(const std::span<const float> samples, const std::span<const std::uint8_t> played) {
+		double signal = 0;
+		double noise  = 0;
+		for(std::size_t idx = 0; idx < std::min(samples.size(), played.size()); idx++) {
+			const double expected = static_cast<double>(samples[idx]) * 128;
+			const double error    = expected - (static_cast<double>(played[idx]) - 128);
+			signal += expected * expected;
+			noise += error * error;
+		}
+		return noise == 0 ? std::numeric_limits<double>::infinity() : 10 * std::log10(signal / noise);
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace MID3SMPS::conversion::dac {
+	// The Sonic 1/2 drivers' deltas, added to an 8-bit accumulator that starts at 0x80 and wraps
+	static constexpr std::array<std::int8_t, 16> dpcm_deltas = {0, 1, 2, 4, 8, 16, 32, 64, -128, -1, -2, -4, -8, -16, -32, -64};
+	static constexpr std::uint8_t dpcm_start = 0x80;
+
+	[[nodiscard]] constexpr std::uint8_t to_unsigned(const float sample) noexcept {
+		const auto scaled = sample * 128.f + 128.5f;
+		return static_cast<std::uint8_t>(scaled <= 0 ? 0 : scaled >= 255 ? 255 : scaled);
+	}
+
+	[[nodiscard]] std::vector<std::uint8_t> encode_pcm8(std::span<const float> samples);
+	// Two samples to a byte, high nibble first, an odd count is padded with a 0 delta.
+	// Searches every accumulator value at every sample (a Viterbi trellis) for the sequence of deltas with the least squared error.
+	[[nodiscard]] std::vector<std::uint8_t> encode_dpcm(std::span<const float> samples);
+	// Picks the delta closest to each sample in turn, fast but it can't plan around the big gaps in the delta table
+	[[nodiscard]] std::vector<std::uint8_t> encode_dpcm_greedy(std::span<const float> samples);
+	// What the driver plays back for DPCM data, as 8-bit unsigned
+	[[nodiscard]] std::vector<std::uint8_t> decode_dpcm(std::span<const std::uint8_t> data);
+
+	// Signal to noise ratio in dB of 8-bit unsigned playback against the samples it was encoded from
+	[[nodiscard]] double snr(std::span<const float> samples, std::span<const std::uint8_t> played);
+}
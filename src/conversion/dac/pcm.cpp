@@ -0,0 +1,121 @@
+#include "pcm.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <fmt/core.h>
+
+#include "exceptions/formatException.hpp"
+
+namespace MID3SMPS::conversion::dac {
+	namespace {
+		constexpr std::uint16_t format_pcm        = 1;
+		constexpr std::uint16_t format_float      = 3;
+		constexpr std::uint16_t format_extensible = 0xFFFE;
+
+		template<typename T>
+		[[nodiscard]] T read_le(const std::span<const std::uint8_t> data, const std::size_t offset) {
+			if(offset + sizeof(T) > data.size()) {
+				throw format_exception("WAV file is truncated");
+			}
+			T value;
+			std::memcpy(&value, data.data() + offset, sizeof(T)); // Little endian hosts only, like the rest of the loaders
+			return value;
+		}
+
+		[[nodiscard]] bool tag(const std::span<const std::uint8_t> data, const std::size_t offset, const std::string_view expected) noexcept {
+			return offset + 4 <= data.size() && std::memcmp(data.data() + offset, expected.data(), 4) == 0;
+		}
+
+		// One sample of one channel as -1 to 1
+		[[nodiscard]] float sample(const std::uint8_t *bytes, const std::uint16_t format, const std::uint16_t bits) noexcept {
+			switch(bits) {
+				case 8: return (static_cast<float>(bytes[0]) - 128.f) / 128.f;
+				case 16: {
+					std::int16_t value;
+					std::memcpy(&value, bytes, sizeof(value));
+					return static_cast<float>(value) / 32768.f;
+				}
+				case 24: {
+					// Shifted up into an int32 so the sign comes along
+					const auto value = static_cast<std::int32_t>(static_cast<std::uint32_t>(bytes[0]) << 8 | static_cast<std::uint32_t>(bytes[1]) << 16 |
+					                                             static_cast<std::uint32_t>(bytes[2]) << 24);
+					return static_cast<float>(value) / 2147483648.f;
+				}
+				case 32: {
+					if(format == format_float) {
+						float value;
+						std::memcpy(&value, bytes, sizeof(value));
+						return value;
+					}
+					std::int32_t value;
+					std::memcpy(&value, bytes, sizeof(value));
+					return static_cast<float>(value) / 2147483648.f;
+				}
+				default: return 0;
+			}
+		}
+	}
+
+	pcm load_wav(const std::span<const std::uint8_t> file) {
+		if(!tag(file, 0, "RIFF") || !tag(file, 8, "WAVE")) {
+			throw format_exception("Not a WAV file");
+		}
+		std::uint16_t format   = 0;
+		std::uint16_t channels = 0;
+		std::uint16_t bits     = 0;
+		std::uint32_t rate     = 0;
+		std::span<const std::uint8_t> data;
+		for(std::size_t offset = 12; offset + 8 <= file.size();) {
+			const auto size  = read_le<std::uint32_t>(file, offset + 4);
+			const auto body  = offset + 8;
+			const auto avail = std::min<std::size_t>(size, file.size() - body); // Some writers leave the data size at 0 or too big
+			if(tag(file, offset, "fmt ")) {
+				format   = read_le<std::uint16_t>(file, body);
+				channels = read_le<std::uint16_t>(file, body + 2);
+				rate     = read_le<std::uint32_t>(file, body + 4);
+				bits     = read_le<std::uint16_t>(file, body + 14);
+				if(format == format_extensible) {
+					format = read_le<std::uint16_t>(file, body + 24); // First two bytes of the sub-format GUID
+				}
+			} else if(tag(file, offset, "data")) {
+				data = file.subspan(body, size == 0 ? file.size() - body : avail);
+			}
+			offset = body + size + (size & 1); // Chunks are padded to even sizes
+			if(size == 0 && !data.empty()) {
+				break;
+			}
+		}
+
+		if(format != format_pcm && format != format_float) {
+			throw format_exception(fmt::format("Unsupported WAV format {}", format));
+		}
+		if(channels == 0 || rate == 0 || (format == format_float && bits != 32) || (bits != 8 && bits != 16 && bits != 24 && bits != 32)) {
+			throw format_exception(fmt::format("Unsupported WAV layout: {} channels, {} Hz, {}-bit", channels, rate, bits));
+		}
+
+		const std::size_t frame_size = static_cast<std::size_t>(channels) * (bits / 8);
+		pcm result;
+		result.rate = rate;
+		result.samples.resize(data.size() / frame_size);
+		const auto mix = 1.f / static_cast<float>(channels);
+		for(std::size_t frame = 0; frame < result.samples.size(); frame++) {
+			float total = 0;
+			for(std::size_t channel = 0; channel < channels; channel++) {
+				total += sample(data.data() + frame * frame_size + channel * (bits / 8), format, bits);
+			}
+			result.samples[frame] = total * mix;
+		}
+		return result;
+	}
+
+	pcm load_raw(const std::span<const std::uint8_t> file, const std::uint32_t rate) {
+		pcm result;
+		result.rate = rate;
+		result.samples.resize(file.size());
+		for(std::size_t idx = 0; idx < file.size(); idx++) {
+			result.samples[idx] = (static_cast<float>(file[idx]) - 128.f) / 128.f;
+		}
+		return result;
+	}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace MID3SMPS::conversion::dac {
+	// Mono samples between -1 and 1, whatever they were stored as
+	struct pcm {
+		std::vector<float> samples{};
+		std::uint32_t rate = 0;
+	};
+
+	// PCM (8, 16, 24 or 32-bit) or float WAV, channels are mixed down to mono. Throws format_exception for anything else.
+	[[nodiscard]] pcm load_wav(std::span<const std::uint8_t> file);
+	// Headerless 8-bit unsigned, what mid2smps' samples usually are
+	[[nodiscard]] pcm load_raw(std::span<const std::uint8_t> file, std::uint32_t rate);
+}
@@ -0,0 +1,105 @@
+#include "resampler.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "helpers/trace.hpp"
+
+namespace MID3SMPS::conversion::dac {
+	namespace {
+		constexpr double kaiser_beta = 8.6; // Stopband around -90 dB, well past what 8-bit output can show
+
+		// Zeroth order modified Bessel function of the first kind, for the Kaiser window
+		[[nodiscard]] double bessel_i0(const double x) noexcept {
+			double sum  = 1;
+			double term = 1;
+			for(int k = 1; k < 32; k++) {
+				term *= (x / (2 * k)) * (x / (2 * k));
+				sum += term;
+			}
+			return sum;
+		}
+
+		[[nodiscard]] float dot(const float *lhs, const float *rhs) noexcept {
+#if defined(__SSE2__)
+			static_assert(resampler::taps % 8 == 0);
+			auto sum0 = _mm_setzero_ps();
+			auto sum1 = _mm_setzero_ps();
+			for(std::size_t idx = 0; idx < resampler::taps; idx += 8) {
+				sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(lhs + idx), _mm_loadu_ps(rhs + idx)));
+				sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(lhs + idx + 4), _mm_loadu_ps(rhs + idx + 4)));
+			}
+			auto sum = _mm_add_ps(sum0, sum1);
+			sum      = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+			sum      = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+			return _mm_cvtss_f32(sum);
+#else
+			float sum = 0;
+			for(std::size_t idx = 0; idx < resampler::taps; idx++) {
+				sum += lhs[idx] * rhs[idx];
+			}
+			return sum;
+#endif
+		}
+	}
+
+	resampler::resampler(const std::uint32_t from, const std::uint32_t to) : from_(from), to_(to) {
+		if(from == 0 || to == 0) {
+			throw std::invalid_argument("Sample rates must be above 0");
+		}
+		// Downsampling moves the cutoff down to the new Nyquist frequency, a little under it so the transition band fits
+		const double cutoff = std::min(1., static_cast<double>(to) / from) * 0.92;
+		constexpr double half = taps / 2.;
+		filter_.resize((phases + 1) * taps);
+		for(std::size_t phase = 0; phase <= phases; phase++) {
+			const double offset = static_cast<double>(phase) / phases;
+			double total        = 0;
+			for(std::size_t tap = 0; tap < taps; tap++) {
+				// Distance of this tap's input sample from the output position
+				const double x      = static_cast<double>(tap) - (half - 1) - offset;
+				const double sinc   = x == 0 ? 1. : std::sin(std::numbers::pi * cutoff * x) / (std::numbers::pi * cutoff * x);
+				const double ratio  = x / half;
+				const double window = ratio * ratio < 1 ? bessel_i0(kaiser_beta * std::sqrt(1 - ratio * ratio)) / bessel_i0(kaiser_beta) : 0;
+				const double value  = sinc * window;
+				filter_[phase * taps + tap] = static_cast<float>(value);
+				total += value;
+			}
+			// Unity gain at DC for every phase, otherwise the rounding shows up as a whine at the output rate
+			for(std::size_t tap = 0; tap < taps; tap++) {
+				filter_[phase * taps + tap] = static_cast<float>(filter_[phase * taps + tap] / total);
+			}
+		}
+	}
+
+	std::vector<float> resampler::process(const std::span<const float> input) const {
+		TRACE_ZONE("Resample");
+		if(from_ == to_) {
+			return {input.begin(), input.end()};
+		}
+		// Zero padding so every output sample can read all its taps without bounds checks
+		constexpr std::size_t pad = taps / 2;
+		std::vector<float> padded(input.size() + taps * 2, 0.f);
+		std::ranges::copy(input, padded.begin() + pad);
+
+		const std::size_t out_size = input.size() * to_ / from_;
+		std::vector<float> output(out_size);
+		// Position in input samples as 32.32 fixed point, the top bits of the fraction pick the phase
+		const auto step         = (static_cast<std::uint64_t>(from_) << 32) / to_;
+		constexpr int phase_bits = std::countr_zero(phases);
+		std::uint64_t position  = 0;
+		for(std::size_t idx = 0; idx < out_size; idx++, position += step) {
+			const std::size_t whole = position >> 32;
+			// Rounded to the nearest phase, the extra row takes care of rounding up to the next sample
+			const std::size_t phase = ((position & 0xFFFF'FFFF) + (std::uint64_t{1} << (31 - phase_bits))) >> (32 - phase_bits);
+			output[idx]      = dot(filter_.data() + phase * taps, padded.data() + whole + 1);
+		}
+		return output;
+	}
+}
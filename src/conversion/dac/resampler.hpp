@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace MID3SMPS::conversion::dac {
+	// Windowed sinc polyphase resampler. The filter is precomputed for a fixed number of positions between two input samples,
+	// each output sample picks the closest one, so any pair of rates works without a table the size of their least common multiple.
+	class resampler {
+	public:
+		static constexpr std::size_t taps   = 32;  // Per phase, half on either side of the output position
+		static constexpr std::size_t phases = 256; // Positions are rounded to 1/256th of an input sample
+
+	private:
+		std::vector<float> filter_{}; // phases + 1 rows of taps, the extra row is phase 0 shifted by one sample
+		std::uint32_t from_;
+		std::uint32_t to_;
+
+	public:
+		resampler(std::uint32_t from, std::uint32_t to);
+
+		[[nodiscard]] std::vector<float> process(std::span<const float> input) const;
+
+		[[nodiscard]] constexpr std::uint32_t from() const noexcept {
+			return from_;
+		}
+
+		[[nodiscard]] constexpr std::uint32_t to() const noexcept {
+			return to_;
+		}
+	};
+}
@@ -0,0 +1,80 @@
+#include "sample_encoder.hpp"
+
+#include <cstring>
+#include <utility>
+#include <fmt/core.h>
+
+#include "encoder.hpp"
+#include "pcm.hpp"
+#include "resampler.hpp"
+#include "exceptions/formatException.hpp"
+#include "helpers/file_io.hpp"
+#include "helpers/hash.hpp"
+#include "helpers/trace.hpp"
+
+namespace MID3SMPS::conversion::dac {
+	namespace {
+		// Bump whenever the resampler or encoders change what they output, old cache entries stop matching
+		constexpr std::uint32_t pipeline_version = 3;
+
+		[[nodiscard]] bool is_wav(const std::span<const std::uint8_t> file) noexcept {
+			return file.size() >= 12 && std::memcmp(file.data(), "RIFF", 4) == 0 && std::memcmp(file.data() + 8, "WAVE", 4) == 0;
+		}
+	}
+
+	encoded_sample sample_encoder::encode(const fs::path &source, const std::uint32_t raw_rate, const encode_settings &settings) const {
+		TRACE_ZONE("Encode DAC sample");
+		const auto file = read_file(source);
+		const auto key  = fnv1a{}
+		                 .add(pipeline_version)
+		                 .add(std::to_underlying(settings.format))
+		                 .add(settings.rate)
+		                 .add(raw_rate)
+		                 .add(file.size())
+		                 .add(file)
+		                 .value();
+		const auto cache_path = cache_ / fmt::format("{:016x}.bin", key);
+		if(fs::exists(cache_path)) {
+			try {
+				return {read_file(cache_path), true};
+			} catch(const std::exception &) {
+				// Unreadable, encode it again and overwrite it
+			}
+		}
+
+		auto audio = is_wav(file) ? load_wav(file) : load_raw(file, raw_rate == 0 ? settings.rate : raw_rate);
+		if(audio.rate != settings.rate) {
+			audio.samples = resampler(audio.rate, settings.rate).process(audio.samples);
+		}
+		encoded_sample result{settings.format == smps::dac_format::dpcm ? encode_dpcm(audio.samples) : encode_pcm8(audio.samples), false};
+		try {
+			write_file_atomically(cache_path, result.data);
+		} catch(const std::exception &error) {
+			fmt::print(stderr, "Couldn't cache {}: {}\n", source.string(), error.what()); // Only costs encoding it again next time
+		}
+		return result;
+	}
+
+	std::vector<encoded_sample> sample_encoder::encode(const M2S::dac_list &list, const encode_settings &settings) const {
+		TRACE_ZONE("Encode DAC samples");
+		std::vector<encoded_sample> samples;
+		samples.reserve(list.entries.size());
+		for(const auto &entry : list.entries) {
+			try {
+				samples.push_back(encode(entry.path, entry.rate, settings));
+			} catch(const std::exception &error) {
+				throw format_exception(fmt::format("DAC list line {} ({}): {}", entry.line, entry.path.filename().string(), error.what()));
+			}
+		}
+		return samples;
+	}
+
+	encoded_list::encoded_list(const encode_settings &with, std::vector<encoded_sample> &&encoded) : settings(with) {
+		const auto owned = std::make_shared<const std::vector<encoded_sample>>(std::move(encoded));
+		samples.reserve(owned->size());
+		for(const auto &sample : *owned) {
+			samples.emplace_back(sample.data);
+		}
+		storage = owned;
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "containers/files/mid2smps/dac_list.hpp"
+#include "containers/smps/driver_profile.hpp"
+
+namespace MID3SMPS::conversion::dac {
+	namespace fs = std::filesystem;
+
+	static constexpr auto cache_directory = "cache/dac";
+
+	struct encode_settings {
+		smps::dac_format format;
+		std::uint32_t rate; // Hz the driver plays the result back at
+
+		[[nodiscard]] static constexpr encode_settings from(const smps::driver_profile &profile) noexcept {
+			return {profile.dac, profile.dac_rate};
+		}
+
+		[[nodiscard]] constexpr bool operator==(const encode_settings &) const noexcept = default;
+	};
+
+	struct encoded_sample {
+		std::vector<std::uint8_t> data{};
+		bool cached = false; // Came from the cache instead of being encoded
+	};
+
+	// A whole DAC list encoded for the driver, in list order. The samples point into storage, which either owns them
+	// or keeps alive the project file they were read from.
+	struct encoded_list {
+		encode_settings settings{};
+		std::vector<std::span<const std::uint8_t>> samples{};
+		std::shared_ptr<const void> storage{};
+
+		encoded_list() = default;
+		encoded_list(const encode_settings &with, std::vector<std::span<const std::uint8_t>> views, std::shared_ptr<const void> owner) :
+			settings(with), samples(std::move(views)), storage(std::move(owner)) {}
+		// Takes over what sample_encoder just encoded
+		encoded_list(const encode_settings &with, std::vector<encoded_sample> &&encoded);
+	};
+
+	// Loads, resamples and encodes samples for the driver. Results are cached on disk under a hash of the source file and the settings,
+	// so converting again only encodes samples that changed.
+	class sample_encoder {
+		fs::path cache_;
+
+	public:
+		explicit sample_encoder(fs::path cache = cache_directory) : cache_(std::move(cache)) {}
+
+		// WAV files are recognised by their header, anything else is taken as 8-bit unsigned at raw_rate (or the target rate if it's 0)
+		[[nodiscard]] encoded_sample encode(const fs::path &source, std::uint32_t raw_rate, const encode_settings &settings) const;
+		// Every sample in the list, in order. Errors name the list line of the sample that failed.
+		[[nodiscard]] std::vector<encoded_sample> encode(const M2S::dac_list &list, const encode_settings &settings) const;
+	};
+}
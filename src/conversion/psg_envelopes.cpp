@@ -0,0 +1,87 @@
+#include "psg_envelopes.hpp"
+
+#include <algorithm>
+#include <fmt/core.h>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "helpers/trace.hpp"
+
+namespace MID3SMPS::conversion {
+	namespace {
+		using end_mode = M2S::psg_list::end_mode;
+
+		// Sonic 1 and 2 only know one command, anything with the top bit set holds the last level
+		constexpr std::uint8_t classic_hold = 0x80;
+		// Sonic 3 & Knuckles' eReset, eHold and eStop
+		constexpr std::uint8_t s3k_loop = 0x80;
+		constexpr std::uint8_t s3k_hold = 0x81;
+		constexpr std::uint8_t s3k_stop = 0x83;
+
+		constexpr std::uint8_t silent = 0x0F;
+
+		std::vector<std::uint8_t> compile(const M2S::psg_list::envelope &envelope, const smps::driver_profile &profile) {
+			std::vector<std::uint8_t> bytes = envelope.levels;
+			if(profile.flags == smps::flag_set::s3k) {
+				bytes.push_back(envelope.end == end_mode::hold ? s3k_hold : envelope.end == end_mode::loop ? s3k_loop : s3k_stop);
+				return bytes;
+			}
+			switch(envelope.end) {
+				case end_mode::hold: break;
+				// Holding at full attenuation is as quiet as stopping
+				case end_mode::stop: bytes.push_back(silent); break;
+				case end_mode::loop: throw std::runtime_error(fmt::format("PSG envelope on line {} loops, which {} can't do", envelope.line, profile.name));
+				default: std::unreachable();
+			}
+			bytes.push_back(classic_hold);
+			return bytes;
+		}
+	}
+
+	psg_envelopes::psg_envelopes(const M2S::psg_list &list, const smps::driver_profile &profile) {
+		TRACE_ZONE("Compile PSG envelopes");
+		std::vector<std::vector<std::uint8_t>> compiled;
+		compiled.reserve(list.envelopes.size());
+		for(const auto &envelope : list.envelopes) {
+			compiled.push_back(compile(envelope, profile));
+		}
+
+		// Longest first, so anything that can share another envelope's tail finds it already placed
+		std::vector<std::size_t> order(compiled.size());
+		for(std::size_t idx = 0; idx < order.size(); idx++) {
+			order[idx] = idx;
+		}
+		std::ranges::stable_sort(order, std::ranges::greater{}, [&](const std::size_t idx) { return compiled[idx].size(); });
+
+		// Every envelope ends in a command, so a tail can only match at the end of another envelope
+		std::vector<std::size_t> ends;
+		std::unordered_map<std::string, std::uint16_t> placed;
+		offsets_.resize(compiled.size());
+		for(const auto idx : order) {
+			const auto &bytes = compiled[idx];
+			const std::string key(bytes.begin(), bytes.end());
+			if(const auto found = placed.find(key); found != placed.end()) {
+				offsets_[idx] = found->second;
+				continue;
+			}
+			const auto shares = std::ranges::find_if(ends, [&](const std::size_t end) {
+				return end >= bytes.size() && std::ranges::equal(bytes, std::span(data_).subspan(end - bytes.size(), bytes.size()));
+			});
+			std::size_t offset = 0;
+			if(shares != ends.end()) {
+				offset = *shares - bytes.size();
+			} else {
+				offset = data_.size();
+				data_.insert(data_.end(), bytes.begin(), bytes.end());
+				ends.push_back(data_.size());
+			}
+			if(offset > 0xFFFF) {
+				throw std::runtime_error("PSG envelopes don't fit in 64 KiB");
+			}
+			offsets_[idx] = static_cast<std::uint16_t>(offset);
+			placed.emplace(key, offsets_[idx]);
+		}
+	}
+}
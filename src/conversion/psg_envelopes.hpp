@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "containers/files/mid2smps/psg_list.hpp"
+#include "containers/smps/driver_profile.hpp"
+
+namespace MID3SMPS::conversion {
+	// A PSG list compiled for one driver: every envelope's bytes back to back with the driver's end commands,
+	// and where each envelope ID starts in them, which is what goes in the driver's envelope pointer table.
+	// Identical envelopes and envelopes that are the tail end of another one share their bytes.
+	class psg_envelopes {
+		std::vector<std::uint8_t> data_{};
+		std::vector<std::uint16_t> offsets_{}; // Indexed by ID - 1
+
+	public:
+		psg_envelopes() = default;
+		// Tables that were compiled before, from a project file
+		psg_envelopes(std::vector<std::uint8_t> data, std::vector<std::uint16_t> offsets) : data_(std::move(data)), offsets_(std::move(offsets)) {}
+		// Throws naming the list's line if an envelope needs something the driver can't do
+		psg_envelopes(const M2S::psg_list &list, const smps::driver_profile &profile);
+
+		[[nodiscard]] std::span<const std::uint8_t> data() const noexcept {
+			return data_;
+		}
+
+		[[nodiscard]] std::span<const std::uint16_t> offsets() const noexcept {
+			return offsets_;
+		}
+
+		// The envelope with the given ID from where it starts, up to the end of the table
+		[[nodiscard]] std::span<const std::uint8_t> envelope(const std::size_t id) const {
+			return std::span(data_).subspan(offsets_.at(id - 1));
+		}
+	};
+}
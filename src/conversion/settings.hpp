@@ -0,0 +1,18 @@
+#pragma once
+
+namespace MID3SMPS::conversion {
+	// Options for converting one song, kept with the project so they survive a restart
+	struct settings {
+		int ticks_per_quarter = 0;
+		int ticks_multiplier  = 0;
+
+		bool convert_song_title     = false;
+		bool per_file_instruments   = false;
+		bool auto_reload_midi       = true;
+		bool auto_optimize_midi     = true;
+		bool chorus_cc_volume_boost = true;
+		bool pan_law_compensation   = true;
+
+		[[nodiscard]] constexpr bool operator==(const settings &) const noexcept = default;
+	};
+}
@@ -0,0 +1,206 @@
+#include "tempo_solver.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "helpers/trace.hpp"
+
+namespace MID3SMPS::conversion {
+	namespace {
+		constexpr std::uint32_t default_us_per_quarter = 500'000; // 120 BPM, used until the first tempo event
+		constexpr double drift_tolerance = 0.5; // In frames, settings that close to the best are ranked by quantization instead
+	}
+
+	std::vector<tempo_change> tempo_map(const midi::event_store &events) {
+		std::vector<tempo_change> map;
+		for(std::size_t track_idx = 0; track_idx < events.track_count(); track_idx++) {
+			const auto track = events.track(track_idx);
+			midi::tick_t tick = 0;
+			std::size_t pos   = 0;
+			for(const auto &ref : track.payloads) {
+				for(; pos <= ref.event; pos++) {
+					tick += track.delta[pos];
+				}
+				if(track.status[ref.event] != midi::status::meta || track.data1[ref.event] != midi::meta_type::tempo) {
+					continue;
+				}
+				const auto data = events.payload(ref);
+				if(data.size() < 3) {
+					continue;
+				}
+				const auto us = static_cast<std::uint32_t>(data[0] << 16 | data[1] << 8 | data[2]);
+				map.push_back({tick, us});
+			}
+		}
+
+		std::ranges::stable_sort(map, {}, &tempo_change::tick);
+		// Keep the last change when several land on the same tick
+		std::vector<tempo_change> deduplicated;
+		deduplicated.reserve(map.size() + 1);
+		for(const auto &change : map) {
+			if(!deduplicated.empty() && deduplicated.back().tick == change.tick) {
+				deduplicated.back() = change;
+			} else if(deduplicated.empty() || deduplicated.back().us_per_quarter != change.us_per_quarter) {
+				deduplicated.push_back(change);
+			}
+		}
+		if(deduplicated.empty() || deduplicated.front().tick != 0) {
+			deduplicated.insert(deduplicated.begin(), {0, default_us_per_quarter});
+		}
+		return deduplicated;
+	}
+
+	tempo_solver::tempo_solver(const midi::event_store &events) : ticks_per_quarter_(events.ticks_per_quarter()) {
+		if(ticks_per_quarter_ == 0 || events.empty()) {
+			return;
+		}
+		map_ = tempo_map(events);
+
+		const auto length = events.length_in_ticks();
+		for(std::size_t idx = 0; idx < map_.size(); idx++) {
+			const auto end = idx + 1 < map_.size() ? map_[idx + 1].tick : length;
+			if(end <= map_[idx].tick) {
+				continue;
+			}
+			segments_.push_back({
+				.quarters = static_cast<double>(end - map_[idx].tick) / ticks_per_quarter_,
+				.us_per_quarter = map_[idx].us_per_quarter
+			});
+		}
+
+		residues_.assign(ticks_per_quarter_, 0);
+		for(std::size_t track_idx = 0; track_idx < events.track_count(); track_idx++) {
+			const auto track = events.track(track_idx);
+			midi::tick_t tick = 0;
+			for(std::size_t idx = 0; idx < track.size(); idx++) {
+				tick += track.delta[idx];
+				if(track.status[idx] < midi::status::sysex) {
+					++residues_[tick % ticks_per_quarter_];
+				}
+			}
+		}
+		for(const auto count : residues_) {
+			residue_total_ += count;
+		}
+	}
+
+	std::vector<tempo_solver::rate> tempo_solver::rates(const smps::driver_profile &profile) {
+		std::vector<rate> table;
+		table.reserve(256);
+		for(std::uint32_t tempo = 0; tempo <= std::numeric_limits<std::uint8_t>::max(); tempo++) {
+			const auto main_tempo = static_cast<std::uint8_t>(tempo);
+			if(const auto ticks = profile.ticks_per_frame(main_tempo); ticks > 0) {
+				table.push_back({ticks, main_tempo});
+			}
+		}
+		std::ranges::sort(table, {}, &rate::ticks_per_frame);
+		return table;
+	}
+
+	double tempo_solver::quantization(const std::uint16_t ticks_per_quarter) const noexcept {
+		if(residue_total_ == 0) {
+			return 0;
+		}
+		double error = 0;
+		for(std::size_t residue = 0; residue < residues_.size(); residue++) {
+			if(residues_[residue] == 0) {
+				continue;
+			}
+			const auto position = static_cast<double>(residue * ticks_per_quarter) / ticks_per_quarter_;
+			error += std::abs(position - std::round(position)) * residues_[residue];
+		}
+		return error / static_cast<double>(residue_total_);
+	}
+
+	void tempo_solver::drift(const std::span<const rate> table, const double frame_rate, const std::uint32_t ticks_per_quarter_note, tempo_setting &setting) const {
+		setting.tempos.clear();
+		setting.max_drift = 0;
+		double drift      = 0;
+		for(const auto &[quarters, us_per_quarter] : segments_) {
+			const auto ideal  = quarters * us_per_quarter / 1'000'000.;
+			const auto ticks  = quarters * ticks_per_quarter_note;
+			const auto target = ticks / (ideal * frame_rate);
+
+			// The two closest representable rates around the target, the one that leaves less accumulated drift wins
+			const auto upper = std::ranges::lower_bound(table, target, {}, &rate::ticks_per_frame);
+			double best_drift = std::numeric_limits<double>::infinity();
+			std::uint8_t best_tempo = 0;
+			for(auto candidate = upper == table.begin() ? upper : std::prev(upper); candidate != table.end() && candidate <= upper; ++candidate) {
+				const auto actual = ticks / (candidate->ticks_per_frame * frame_rate);
+				if(const auto new_drift = drift + actual - ideal; std::abs(new_drift) < std::abs(best_drift)) {
+					best_drift = new_drift;
+					best_tempo = candidate->main_tempo;
+				}
+			}
+			drift = best_drift;
+			setting.tempos.push_back(best_tempo);
+			setting.max_drift = std::max(setting.max_drift, std::abs(drift));
+		}
+		setting.end_drift = std::abs(drift);
+	}
+
+	tempo_setting tempo_solver::evaluate(const smps::driver_profile &profile, const double frame_rate, const std::uint16_t ticks_per_quarter, const std::uint16_t multiplier) const {
+		tempo_setting setting{.ticks_per_quarter = ticks_per_quarter, .multiplier = multiplier};
+		if(empty() || ticks_per_quarter == 0 || multiplier == 0) {
+			return setting;
+		}
+		const auto table = rates(profile);
+		drift(table, frame_rate, static_cast<std::uint32_t>(ticks_per_quarter) * multiplier, setting);
+		setting.quantization = quantization(ticks_per_quarter);
+		return setting;
+	}
+
+	tempo_setting tempo_solver::solve(const smps::driver_profile &profile, const double frame_rate, const search_limits limits) const {
+		TRACE_ZONE("Tempo solve");
+		tempo_setting best{};
+		if(empty()) {
+			return best;
+		}
+		const auto table = rates(profile);
+
+		// Drift only depends on the product of both values, quantization only on the ticks per quarter
+		const auto max_product = static_cast<std::size_t>(limits.max_ticks_per_quarter) * limits.max_multiplier;
+		std::vector<tempo_setting> by_product(max_product + 1);
+		std::vector<double> by_ticks(limits.max_ticks_per_quarter + 1u, -1);
+
+		const auto better = [tolerance = drift_tolerance / frame_rate](const tempo_setting &lhs, const tempo_setting &rhs) {
+			if(!rhs.valid()) {
+				return true;
+			}
+			if(std::abs(lhs.max_drift - rhs.max_drift) > tolerance) {
+				return lhs.max_drift < rhs.max_drift;
+			}
+			if(lhs.quantization != rhs.quantization) {
+				return lhs.quantization < rhs.quantization;
+			}
+			return lhs.ticks_per_quarter * lhs.multiplier < rhs.ticks_per_quarter * rhs.multiplier;
+		};
+
+		for(std::uint16_t multiplier = 1; multiplier <= limits.max_multiplier; multiplier++) {
+			for(std::uint16_t ticks = 1; ticks <= limits.max_ticks_per_quarter; ticks++) {
+				const auto product = static_cast<std::size_t>(ticks) * multiplier;
+				auto &cached = by_product[product];
+				if(!cached.valid()) {
+					drift(table, frame_rate, static_cast<std::uint32_t>(product), cached);
+				}
+				if(by_ticks[ticks] < 0) {
+					by_ticks[ticks] = quantization(ticks);
+				}
+				tempo_setting candidate{
+					.ticks_per_quarter = ticks,
+					.multiplier = multiplier,
+					.tempos = {},
+					.max_drift = cached.max_drift,
+					.end_drift = cached.end_drift,
+					.quantization = by_ticks[ticks]
+				};
+				if(better(candidate, best)) {
+					candidate.tempos = cached.tempos;
+					best = std::move(candidate);
+				}
+			}
+		}
+		return best;
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "containers/midi/event_store.hpp"
+#include "containers/smps/driver_profile.hpp"
+
+namespace MID3SMPS::conversion {
+	struct tempo_change {
+		midi::tick_t tick;
+		std::uint32_t us_per_quarter;
+	};
+
+	[[nodiscard]] std::vector<tempo_change> tempo_map(const midi::event_store &events);
+
+	struct tempo_setting {
+		std::uint16_t ticks_per_quarter = 0;
+		std::uint16_t multiplier        = 0;
+		std::vector<std::uint8_t> tempos{}; // Main tempo for every tempo map segment, the first one goes in the header
+		double max_drift    = 0;            // Seconds
+		double end_drift    = 0;            // Seconds
+		double quantization = 0;            // Average distance of an event from the SMPS tick grid, in SMPS ticks
+
+		[[nodiscard]] constexpr bool valid() const noexcept {
+			return !tempos.empty();
+		}
+	};
+
+	// Picks SMPS tempos for a song's tempo map. Tempo changes after the first are assumed to become set tempo flags,
+	// each one chosen to pull the accumulated drift back towards zero rather than only matching its own segment.
+	class tempo_solver {
+	public:
+		struct search_limits {
+			std::uint16_t max_ticks_per_quarter = 192;
+			std::uint16_t max_multiplier        = 16;
+		};
+
+	private:
+		struct segment {
+			double quarters;
+			std::uint32_t us_per_quarter;
+		};
+
+		struct rate {
+			double ticks_per_frame;
+			std::uint8_t main_tempo;
+		};
+
+		std::vector<tempo_change> map_{};
+		std::vector<segment> segments_{};
+		std::vector<std::uint32_t> residues_{}; // Events per tick position inside a quarter note
+		std::uint64_t residue_total_ = 0;
+		std::uint16_t ticks_per_quarter_ = 0;
+
+		[[nodiscard]] double quantization(std::uint16_t ticks_per_quarter) const noexcept;
+		void drift(std::span<const rate> table, double frame_rate, std::uint32_t ticks_per_quarter_note, tempo_setting &setting) const;
+		[[nodiscard]] static std::vector<rate> rates(const smps::driver_profile &profile);
+
+	public:
+		tempo_solver() = default;
+		explicit tempo_solver(const midi::event_store &events);
+
+		[[nodiscard]] tempo_setting evaluate(const smps::driver_profile &profile, double frame_rate, std::uint16_t ticks_per_quarter, std::uint16_t multiplier) const;
+		[[nodiscard]] tempo_setting solve(const smps::driver_profile &profile, double frame_rate, search_limits limits) const;
+		[[nodiscard]] tempo_setting solve(const smps::driver_profile &profile, double frame_rate) const {
+			return solve(profile, frame_rate, {});
+		}
+
+		[[nodiscard]] constexpr const std::vector<tempo_change> &map() const noexcept {
+			return map_;
+		}
+
+		[[nodiscard]] bool empty() const noexcept {
+			return segments_.empty();
+		}
+	};
+}
@@ -0,0 +1,233 @@
+#include "font_cache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <fmt/core.h>
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include "helpers/hash.hpp"
+#include "helpers/trace.hpp"
+
+namespace MID3SMPS::font_cache {
+	namespace {
+		constexpr std::array<char, 4> magic = {'M', '3', 'F', 'A'};
+		constexpr std::uint32_t format_version = 1;
+
+		static_assert(std::is_trivially_copyable_v<ImFontGlyph> && std::is_trivially_copyable_v<ImVec2> && std::is_trivially_copyable_v<ImVec4>);
+
+		struct header {
+			std::array<char, 4> magic;
+			std::uint32_t version;
+			std::uint64_t key;
+			std::int32_t width;
+			std::int32_t height;
+			std::uint32_t font_count;
+			std::uint32_t rect_count;
+			std::int32_t pack_id_mouse_cursors;
+			std::int32_t pack_id_lines;
+			ImVec2 uv_scale;
+			ImVec2 uv_white_pixel;
+		};
+
+		struct font_header {
+			float size;
+			float ascent;
+			float descent;
+			std::uint32_t glyph_count;
+			std::array<char, sizeof(ImFontConfig::Name)> name;
+		};
+
+		// Only what packing decided, rects for custom glyphs aren't cached since nothing adds them
+		struct rect {
+			unsigned short width;
+			unsigned short height;
+			unsigned short x;
+			unsigned short y;
+		};
+
+		template<typename T>
+		void write(std::ofstream &file, const T &value) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+		}
+
+		template<typename T>
+		void write(std::ofstream &file, const T *values, const std::size_t count) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			file.write(reinterpret_cast<const char *>(values), static_cast<std::streamsize>(count * sizeof(T)));
+		}
+
+		template<typename T>
+		bool read(std::ifstream &file, T &value) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			return static_cast<bool>(file.read(reinterpret_cast<char *>(&value), sizeof(T)));
+		}
+
+		template<typename T>
+		bool read(std::ifstream &file, T *values, const std::size_t count) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			return static_cast<bool>(file.read(reinterpret_cast<char *>(values), static_cast<std::streamsize>(count * sizeof(T))));
+		}
+	}
+
+	std::uint64_t key(const std::span<const fs::path> files, const std::span<const float> sizes, const int oversample) {
+		TRACE_ZONE("Hash fonts");
+		fnv1a hash;
+		hash.add(format_version).add(IMGUI_VERSION_NUM).add(sizeof(ImFontGlyph)).add(oversample);
+		for(const auto size : sizes) {
+			hash.add(size);
+		}
+		std::vector<std::uint8_t> data;
+		for(const auto &file_path : files) {
+			std::ifstream file(file_path, std::ios::binary | std::ios::ate);
+			if(!file) {
+				throw std::runtime_error(fmt::format("Font {} does not exist", file_path.string()));
+			}
+			data.resize(static_cast<std::size_t>(file.tellg()));
+			file.seekg(0);
+			file.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size()));
+			hash.add(data.size()).add(data);
+		}
+		return hash.value();
+	}
+
+	fs::path path(const std::uint64_t key) {
+		return fs::path(directory) / fmt::format("{:016x}.atlas", key);
+	}
+
+	bool load(ImFontAtlas &atlas, const std::uint64_t key) {
+		TRACE_ZONE("Load font atlas cache");
+		std::ifstream file(path(key), std::ios::binary);
+		if(!file) {
+			return false;
+		}
+		header head{};
+		if(!read(file, head) || head.magic != magic || head.version != format_version || head.key != key ||
+		   head.width <= 0 || head.height <= 0 || head.font_count == 0) {
+			return false;
+		}
+
+		std::vector<font_header> font_headers(head.font_count);
+		std::vector<std::vector<ImFontGlyph>> glyphs(head.font_count);
+		for(std::size_t idx = 0; idx < head.font_count; idx++) {
+			if(!read(file, font_headers[idx])) {
+				return false;
+			}
+			glyphs[idx].resize(font_headers[idx].glyph_count);
+			if(!read(file, glyphs[idx].data(), glyphs[idx].size())) {
+				return false;
+			}
+		}
+		std::vector<rect> rects(head.rect_count);
+		std::array<ImVec4, IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1> uv_lines{};
+		const auto pixel_count = static_cast<std::size_t>(head.width) * static_cast<std::size_t>(head.height);
+		std::vector<unsigned char> pixels(pixel_count);
+		if(!read(file, rects.data(), rects.size()) || !read(file, uv_lines) || !read(file, pixels.data(), pixels.size())) {
+			return false;
+		}
+
+		// Everything's been read, nothing below can fail
+		atlas.Clear();
+		atlas.ConfigData.reserve(static_cast<int>(head.font_count)); // Fonts point into it
+		for(std::size_t idx = 0; idx < head.font_count; idx++) {
+			const auto &font_head = font_headers[idx];
+			auto *font = IM_NEW(ImFont);
+
+			ImFontConfig config;
+			config.SizePixels           = font_head.size;
+			config.FontDataOwnedByAtlas = false;
+			config.DstFont              = font;
+			std::memcpy(config.Name, font_head.name.data(), sizeof(config.Name));
+			atlas.ConfigData.push_back(config);
+
+			font->ContainerAtlas  = &atlas;
+			font->ConfigData      = &atlas.ConfigData.back();
+			font->ConfigDataCount = 1;
+			font->FontSize        = font_head.size;
+			font->Ascent          = font_head.ascent;
+			font->Descent         = font_head.descent;
+			font->Glyphs.resize(static_cast<int>(glyphs[idx].size()));
+			std::memcpy(font->Glyphs.Data, glyphs[idx].data(), glyphs[idx].size() * sizeof(ImFontGlyph));
+			font->BuildLookupTable();
+			atlas.Fonts.push_back(font);
+		}
+		for(const auto &[width, height, x, y] : rects) {
+			ImFontAtlasCustomRect custom;
+			custom.Width  = width;
+			custom.Height = height;
+			custom.X      = x;
+			custom.Y      = y;
+			atlas.CustomRects.push_back(custom);
+		}
+		atlas.PackIdMouseCursors = head.pack_id_mouse_cursors;
+		atlas.PackIdLines        = head.pack_id_lines;
+		atlas.TexWidth           = head.width;
+		atlas.TexHeight          = head.height;
+		atlas.TexUvScale         = head.uv_scale;
+		atlas.TexUvWhitePixel    = head.uv_white_pixel;
+		std::ranges::copy(uv_lines, atlas.TexUvLines);
+		atlas.TexPixelsAlpha8 = static_cast<unsigned char *>(IM_ALLOC(pixel_count));
+		std::memcpy(atlas.TexPixelsAlpha8, pixels.data(), pixel_count);
+		atlas.TexReady = true;
+		return true;
+	}
+
+	void save(ImFontAtlas &atlas, const std::uint64_t key) {
+		TRACE_ZONE("Save font atlas cache");
+		unsigned char *pixels = nullptr;
+		int width             = 0;
+		int height            = 0;
+		atlas.GetTexDataAsAlpha8(&pixels, &width, &height); // Builds the atlas if it isn't already
+		if(pixels == nullptr) {
+			throw std::runtime_error("Font atlas has no pixels to cache");
+		}
+
+		const auto final_path = path(key);
+		fs::create_directories(final_path.parent_path());
+		// Written next to the real file and renamed over it, so a crash can't leave a truncated cache behind
+		auto temp_path = final_path;
+		temp_path += ".tmp";
+		{
+			std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+			if(!file) {
+				throw std::runtime_error(fmt::format("Failed to open {} for writing", temp_path.string()));
+			}
+			write(file, header{
+				magic,
+				format_version,
+				key,
+				width,
+				height,
+				static_cast<std::uint32_t>(atlas.Fonts.Size),
+				static_cast<std::uint32_t>(atlas.CustomRects.Size),
+				atlas.PackIdMouseCursors,
+				atlas.PackIdLines,
+				atlas.TexUvScale,
+				atlas.TexUvWhitePixel,
+			});
+			for(const auto *font : atlas.Fonts) {
+				font_header font_head{font->FontSize, font->Ascent, font->Descent, static_cast<std::uint32_t>(font->Glyphs.Size), {}};
+				if(font->ConfigData != nullptr) {
+					std::memcpy(font_head.name.data(), font->ConfigData->Name, font_head.name.size());
+				}
+				write(file, font_head);
+				write(file, font->Glyphs.Data, static_cast<std::size_t>(font->Glyphs.Size));
+			}
+			for(const auto &custom : atlas.CustomRects) {
+				write(file, rect{custom.Width, custom.Height, custom.X, custom.Y});
+			}
+			write(file, atlas.TexUvLines, IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1);
+			write(file, pixels, static_cast<std::size_t>(width) * static_cast<std::size_t>(height));
+			if(!file) {
+				throw std::runtime_error(fmt::format("Failed to write {}", temp_path.string()));
+			}
+		}
+		fs::rename(temp_path, final_path);
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+struct ImFontAtlas;
+
+namespace MID3SMPS::font_cache {
+	namespace fs = std::filesystem;
+
+	static constexpr auto directory = "cache/fonts";
+
+	// Identifies one baked atlas: the contents of every font file, every size they're baked at and the oversampling.
+	// The ImGui version is part of it too, the file stores ImGui's glyph structs as they are.
+	[[nodiscard]] std::uint64_t key(std::span<const fs::path> files, std::span<const float> sizes, int oversample);
+	[[nodiscard]] fs::path path(std::uint64_t key);
+
+	// Replaces the atlas' fonts with the ones saved under key, in the order they were added when it was baked.
+	// Returns false without touching the atlas if there's no usable cache.
+	[[nodiscard]] bool load(ImFontAtlas &atlas, std::uint64_t key);
+	// Builds the atlas if needed and writes it, throws if the file can't be written
+	void save(ImFontAtlas &atlas, std::uint64_t key);
+}
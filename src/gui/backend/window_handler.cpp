@@ -1,11 +1,15 @@
 #include <imguiwrap.dear.h>
 #include <imguiwrap.h>
-#include <imgui_internal.h>
+#include <chrono>
+#include <filesystem>
+#include <fmt/core.h>
 #include <GLFW/glfw3.h>
+#include <thread>
 
 #include "gui/backend/window_handler.hpp"
-#include "containers/program_persistence.hpp"
+#include "gui/backend/font_cache.hpp"
 #include "gui/windows/main_window.hpp"
+#include "helpers/trace.hpp"
 
 namespace MID3SMPS {
 	bool show_demo_window = true;
@@ -15,15 +19,6 @@ namespace MID3SMPS {
 void window_handler::main_loop_init() {
 	setvbuf(stdout, nullptr, _IONBF, 0); // Switch to line buffering
 
-	// Add .ini handle for UserData type
-	ImGuiSettingsHandler ini_handler;
-	ini_handler.TypeName   = MID3SMPS::program_persistence::TypeName;
-	ini_handler.TypeHash   = ImHashStr(MID3SMPS::program_persistence::TypeName);
-	ini_handler.ReadOpenFn = MID3SMPS::program_persistence::read_open;
-	ini_handler.ReadLineFn = MID3SMPS::program_persistence::read_line;
-	ini_handler.WriteAllFn = MID3SMPS::program_persistence::write_all;
-	ImGui::GetCurrentContext()->SettingsHandlers.push_back(ini_handler);
-
 	auto &style            = ImGui::GetStyle();
 	style.ItemInnerSpacing = dear::Zero;
 	style.ItemSpacing      = {0, 2};
@@ -39,26 +34,93 @@ void window_handler::main_loop_init() {
 	return cfg;
 }
 
-void window_handler::reload_fonts(const float pixel_size) {
+void window_handler::reload_fonts() {
+	TRACE_ZONE("Load fonts");
 	const auto fonts = ImGui::GetIO().Fonts;
-	fonts->ClearFonts();
 	static /*constexpr*/ auto cfg = generate_font_config();
 	#define FOLDER_PATH "data/fonts/" // macro because there's no way to concat strings at compile-time
-	main_font      = fonts->AddFontFromFileTTF(FOLDER_PATH "SourceCodePro-Semibold.ttf", pixel_size, &cfg);
-	main_font_bold = fonts->AddFontFromFileTTF(FOLDER_PATH "SourceCodePro-Black.ttf", pixel_size, &cfg);
+	static const std::array<std::filesystem::path, 2> files = {FOLDER_PATH "SourceCodePro-Semibold.ttf", FOLDER_PATH "SourceCodePro-Black.ttf"};
 	#undef FOLDER_PATH
+
+	// Fonts are in the order they're added here, whether they were just baked or came from the cache
+	const auto key = MID3SMPS::font_cache::key(files, font_sizes, cfg.OversampleH);
+	if(MID3SMPS::font_cache::load(*fonts, key)) {
+		for(std::size_t idx = 0; idx < font_sizes.size(); idx++) {
+			main_fonts[idx]      = fonts->Fonts[static_cast<int>(idx * 2)];
+			main_fonts_bold[idx] = fonts->Fonts[static_cast<int>(idx * 2 + 1)];
+		}
+		return;
+	}
+
+	{
+		TRACE_ZONE("Add base font");
+		fonts->Clear();
+		main_fonts.fill(fonts->AddFontFromFileTTF(files[0].string().c_str(), base_font_size, &cfg));
+		main_fonts_bold.fill(fonts->AddFontFromFileTTF(files[1].string().c_str(), base_font_size, &cfg));
+	}
+	// Its own atlas, the one being drawn with is never touched from this thread. It has its own copies of the paths and the
+	// config too, exiting while it bakes destroys the statics but the cache is written atomically, the next start bakes again.
+	std::thread([key, files = files, cfg = cfg] {
+		const auto job = fps_idling::track_job();
+		TRACE_ZONE("Bake fonts");
+		ImFontAtlas atlas;
+		for(const auto size : font_sizes) {
+			atlas.AddFontFromFileTTF(files[0].string().c_str(), size, &cfg);
+			atlas.AddFontFromFileTTF(files[1].string().c_str(), size, &cfg);
+		}
+		try {
+			MID3SMPS::font_cache::save(atlas, key);
+		} catch(const std::exception &error) {
+			fmt::print(stderr, "Couldn't cache the font atlas: {}\n", error.what()); // Next start bakes them again
+		}
+	}).detach();
+}
+
+ImFont *window_handler::font_for_size(const float pixel_size, const bool bold) const noexcept {
+	const auto &sizes = bold ? main_fonts_bold : main_fonts;
+	for(std::size_t idx = 0; idx < font_sizes.size(); idx++) {
+		if(font_sizes[idx] >= pixel_size) {
+			return sizes[idx];
+		}
+	}
+	return sizes.back();
+}
+
+void window_handler::log_startup(const std::string_view milestone) const {
+	if constexpr(MID3SMPS::debug_mode) {
+		using namespace std::chrono;
+		fmt::print("{} {} ms after starting\n", milestone, duration_cast<milliseconds>(steady_clock::now() - started_).count());
+	}
 }
 
 ImGuiWrapperReturnType window_handler::main_loop_step() {
-	idle_by_sleeping();
+	TRACE_FRAME();
+	TRACE_ZONE("Frame");
+	{
+		TRACE_ZONE("Idle");
+		idle_by_sleeping();
+	}
 	#ifdef DEBUG
 	if(MID3SMPS::show_demo_window) {
 		ImGui::ShowDemoWindow(&MID3SMPS::show_demo_window);
 	}
 	#endif
-	mainWindow->render();
-	mainWindow->render_children();
-	fflush(stdout); // Flush output every frame
+	{
+		TRACE_ZONE("Main window");
+		mainWindow->render();
+	}
+	{
+		TRACE_ZONE("Child windows");
+		mainWindow->render_children();
+	}
+	{
+		TRACE_ZONE("Flush stdout");
+		fflush(stdout); // Flush output every frame
+	}
+	if(!first_frame_drawn_) [[unlikely]] {
+		first_frame_drawn_ = true;
+		log_startup("First frame built");
+	}
 	if(mainWindow->keep()) {
 		return std::nullopt;
 	}
@@ -79,34 +141,39 @@ window_handler::window_handler() {
 }
 
 void window_handler::idle_by_sleeping() {
+	// ImGui can take a frame or two to catch up with an event, like laying out a popup that just opened
 	constexpr uint_fast8_t framesToWait  = 2;
 	static uint_fast8_t framesBeforeIdle = framesToWait;
 	auto &idle = MID3SMPS::handler.idling;
 	idle.is_idling                      = false;
-	if(idle.is_idle_override()) {
-		framesBeforeIdle           = framesToWait;
-		idle.override_this_frame = false;
+	const bool requested = idle.wake_requested.exchange(false) || idle.is_idle_override();
+	idle.override_this_frame = false;
+	if(requested) {
+		framesBeforeIdle = framesToWait;
 		return;
 	}
-	idle.override_this_frame = false;
 	if(framesBeforeIdle > 0) {
 		framesBeforeIdle--;
+		return;
 	}
-	if((idle.fps_idle > 0) && idle.enable_idling) {
-		using namespace std::chrono;
-		const auto beforeWait = system_clock::now();
-		//double waitTimeout = 1. / static_cast<double>(idling_.fpsIdle);
-		const double waitTimeout = 1. / static_cast<double>(idle.fps_idle);
-
-		// Backend specific call that will wait for an event for a maximum duration of waitTimeout
-		// (for example glfwWaitEventsTimeout(timeout_seconds))
-		glfwWaitEventsTimeout(waitTimeout);
-
-		const auto afterWait    = system_clock::now();
-		const auto waitDuration = afterWait - beforeWait;
-		const milliseconds waitIdleExpected(1000 / idle.fps_idle);
-		idle.is_idling = (waitDuration > waitIdleExpected * 0.9);
+	if(!idle.enable_idling) {
+		return;
 	}
+	using namespace std::chrono;
+	const auto beforeWait = steady_clock::now();
+	// Returns on input, on a wake from another thread or, if fps_idle is set, after the timeout
+	if(idle.fps_idle > 0) {
+		glfwWaitEventsTimeout(1. / static_cast<double>(idle.fps_idle));
+	} else {
+		glfwWaitEvents();
+	}
+	idle.is_idling   = steady_clock::now() - beforeWait > milliseconds{1};
+	framesBeforeIdle = framesToWait; // Whatever woke us up gets its frames
+}
+
+void fps_idling::wake() noexcept {
+	wake_requested = true;
+	glfwPostEmptyEvent();
 }
 
 fps_idling::override::override() noexcept {
@@ -118,6 +185,10 @@ fps_idling::override::~override() noexcept {
 	--MID3SMPS::handler.idling.overrides;
 }
 
+fps_idling::job::~job() noexcept {
+	MID3SMPS::handler.idling.wake();
+}
+
 const ImGuiWrapConfig &window_handler::config() const noexcept {
 	return config_;
 }
@@ -1,24 +1,33 @@
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <memory>
+#include <string_view>
 #include <imguiwrap.h>
 
 namespace MID3SMPS {
 	class main_window;
 }
 
+// Frames are only drawn when something could have changed: input, a background job finishing, or a request for another frame.
+// Otherwise the main loop blocks on the event queue and uses no CPU.
 struct fps_idling{
-	uint_fast8_t fps_idle = 5;         // FPS when idling_
+	uint_fast8_t fps_idle = 0;         // FPS when idling_, 0 waits for an event however long it takes
 	bool  enable_idling = true;   // a bool to enable/disable idling_
 	bool  is_idling = false;      // an output parameter filled by the runner
 	std::atomic<uint_fast8_t> overrides = 0;
-	bool override_this_frame = false; // Set whenever an override is requested and cleared every frame.
+	bool override_this_frame = false; // Set whenever an override is requested and cleared every frame. Asks for one more frame, for animations.
+	std::atomic<bool> wake_requested = false;
 
 	[[nodiscard]] bool is_idle_override() const noexcept{
 		return override_this_frame || overrides > 0;
 	}
 
+	// Draws a frame as soon as possible, safe to call from any thread
+	void wake() noexcept;
+
 	class override{
 		friend struct fps_idling;
 
@@ -31,13 +40,38 @@ struct fps_idling{
 	[[nodiscard]] static override get_override(){
 		return override();
 	}
+
+	// Held by background jobs, the UI is woken once the job is done so whatever it changed gets drawn
+	class job{
+		friend struct fps_idling;
+
+		job() noexcept = default;
+
+	public:
+		job(const job &) = delete;
+		job &operator=(const job &) = delete;
+		~job() noexcept;
+	};
+
+	[[nodiscard]] static job track_job(){
+		return job();
+	}
 };
 
 class window_handler {
 	std::unique_ptr<MID3SMPS::main_window> mainWindow;
 	ImGuiWrapConfig config_;
-	ImFont* main_font = nullptr;
-	ImFont* main_font_bold = nullptr;
+	std::chrono::steady_clock::time_point started_ = std::chrono::steady_clock::now(); // handler is a global, so this is about when the program started
+	bool first_frame_drawn_ = false;
+
+public:
+	// Every size is baked into the one atlas up front, zooming picks the closest one instead of rebuilding the atlas
+	static constexpr float base_font_size = 15.f;
+	static constexpr std::array font_sizes = {base_font_size, 20.f, 26.f, 34.f, 44.f};
+
+private:
+	std::array<ImFont*, font_sizes.size()> main_fonts{};
+	std::array<ImFont*, font_sizes.size()> main_fonts_bold{};
 
 public:
 	fps_idling idling;
@@ -49,7 +83,13 @@ public:
 	ImGuiWrapperReturnType main_loop_step();
 
 	static void idle_by_sleeping();
-	void reload_fonts(float pixel_size = 15.f);
+	// Loads the baked atlas from the font cache. Without a cache only the base size is baked, so the first frame isn't held up,
+	// and every size is baked and cached on a background thread for the next start.
+	void reload_fonts();
+	// The smallest baked font at least pixel_size tall, or the largest there is
+	[[nodiscard]] ImFont* font_for_size(float pixel_size, bool bold = false) const noexcept;
+	// Prints how long it took from starting up to milestone, only in debug builds
+	void log_startup(std::string_view milestone) const;
 
 private:
 	[[nodiscard]] /*consteval*/ static ImFontConfig generate_font_config();
@@ -1,7 +1,8 @@
 #include <ImGuiFileDialog.h>
 #include <imgui.h>
 #include <imguiwrap.dear.h>
-#include <ranges>
+#include <chrono>
+#include <future>
 #include <thread>
 #include <fmt/core.h>
 
@@ -11,6 +12,11 @@
 
 #include "containers/program_persistence.hpp"
 #include "containers/files/mid2smps/mapping.hpp"
+#include "conversion/dac/sample_encoder.hpp"
+#include "helpers/file_io.hpp"
+#include "playback/song_preview.hpp"
+#include "playback/wav_writer.hpp"
+#include "helpers/trace.hpp"
 
 static const IGFD::FileDialogConfig default_file_dialog_config{
 	.path = "",
@@ -40,8 +46,8 @@ namespace MID3SMPS {
 	void main_window::render() {
 		static bool first_frame_completed = false;
 		if(!first_frame_completed) [[unlikely]] {
-			if(!persistence->empty()) {
-				auto map(persistence->last_config_);
+			settings_ = persisted_settings_ = persistence->conversion();
+			if(auto map = persistence->last_config(); !map.empty()) {
 				open_mapping(std::move(map), false);
 			}
 		}
@@ -63,14 +69,15 @@ namespace MID3SMPS {
 				ImGui::NewLine();
 			}
 
-			cached_wrap_text("Loaded Bank: "s, &map_.gyb(), "No bank loaded"s);
+			const bool bank_modified = ym2612_edit_ && ym2612_edit_->modified();
+			cached_wrap_text(bank_modified ? "Loaded Bank (modified): "s : "Loaded Bank: "s, &map_.gyb(), "No bank loaded"s);
 			if(meets_min_height) {
 				ImGui::NewLine();
 			}
 
 			ImGui::PushItemWidth(40);
-			if(ImGui::InputInt("Ticks/Quarter", &ticks_per_quarter_, 0, 0)) {
-				ticks_per_quarter_ = std::clamp(ticks_per_quarter_, 0, 999);
+			if(ImGui::InputInt("Ticks/Quarter", &settings_.ticks_per_quarter, 0, 0)) {
+				settings_.ticks_per_quarter = std::clamp(settings_.ticks_per_quarter, 0, 999);
 			}
 			if(meets_min_width && windowWidth > minWidth + 50) {
 				ImGui::SameLine();
@@ -79,8 +86,8 @@ namespace MID3SMPS {
 			ImGui::PushItemWidth(40);
 			ImGui::InputInt("MIDI Resolution", &midi_resolution_, 0, 0, ImGuiInputTextFlags_ReadOnly);
 
-			if(ImGui::InputInt("Tick Multiplier", &ticks_multiplier_, 0, 0)) {
-				ticks_multiplier_ = std::clamp(ticks_multiplier_, 0, 999);
+			if(ImGui::InputInt("Tick Multiplier", &settings_.ticks_multiplier, 0, 0)) {
+				settings_.ticks_multiplier = std::clamp(settings_.ticks_multiplier, 0, 999);
 			}
 
 			if(meets_min_height) {
@@ -101,6 +108,11 @@ namespace MID3SMPS {
 				status_                             = statusMsg;
 			}
 
+			if(meets_min_height) {
+				ImGui::NewLine();
+			}
+			render_preview_controls();
+
 			ImGui::SetCursorPosY(windowHeight - 20);
 			ImGui::SetNextWindowBgAlpha(0.75f);
 			dear::Child{"Status Bar"} && [&] {
@@ -108,6 +120,11 @@ namespace MID3SMPS {
 			};
 		};
 
+		// Stored as soon as they change so they're there next time, the store writes them out in the background
+		if(settings_ != persisted_settings_) {
+			persisted_settings_ = settings_;
+			persistence->conversion(settings_);
+		}
 		first_frame_completed = true;
 	}
 
@@ -120,28 +137,39 @@ namespace MID3SMPS {
 					ImGuiFileDialog::Instance()->OpenDialog(OpenMidi, "Choose a Midi file", ".mid,.midi", default_file_dialog_config);
 				}
 				dear::Menu{"Open Recent"} && [this] {
-					const auto &paths = persistence->recent_midis();
-					for(const auto &current_path: std::ranges::reverse_view(paths)) {
-						ImGui::PushID(&current_path);
+					const auto paths = persistence->recent_midis();
+					for(std::size_t idx = 0; idx < paths.size(); idx++) {
+						const auto &current_path = paths[idx];
+						ImGui::PushID(static_cast<int>(idx));
 						#ifdef __WIN32 // Windows being windows uses UTF-16 instead of UTF-8
-						std::string str = current_path->string(); // Convert to UTF-8
+						std::string str = current_path.string(); // Convert to UTF-8
 						if(ImGui::MenuItem(str.c_str())) {
-							open_midi(fs::path(*current_path));
+							open_midi(fs::path(current_path));
 						}
 						#else
-						if(ImGui::MenuItem(current_path->c_str())) {
-							open_midi(fs::path(*current_path));
+						if(ImGui::MenuItem(current_path.c_str())) {
+							open_midi(fs::path(current_path));
 						}
 						#endif
 						ImGui::PopID();
 					}
 				};
+				if(ImGui::MenuItem("Open project..")) {
+					ImGuiFileDialog::Instance()->OpenDialog(OpenProject, "Choose a project", project::extension, default_file_dialog_config);
+				}
+				if(ImGui::MenuItem("Save project as..")) {
+					ImGuiFileDialog::Instance()->OpenDialog(SaveProject, "Select a destination", project::extension, default_file_dialog_config);
+				}
+				ImGui::Separator();
 				if(ImGui::MenuItem("Save", "Ctrl+S")) {
 					save_smps_menu();
 				}
 				if(ImGui::MenuItem("Save As..")) {
 					save_smps_menu(true);
 				}
+				if(ImGui::MenuItem("Render preview to WAV..")) {
+					render_preview_menu();
+				}
 				ImGui::Separator();
 				if(ImGui::MenuItem("Exit")) {
 					exit_menu();
@@ -166,12 +194,12 @@ namespace MID3SMPS {
 				if(ImGui::MenuItem("Tempo calculator", "Ctrl+T")) {
 					open_tempo_calculator();
 				}
-				ImGui::Checkbox("Convert song title", &convert_song_title_);
-				ImGui::Checkbox("Per-file instruments", &per_file_instruments_);
-				ImGui::Checkbox("Auto reload MIDI", &auto_reload_midi_);
-				ImGui::Checkbox("Auto optimize MIDI", &auto_optimize_midi_);
-				ImGui::Checkbox("Chorus CC volume boost", &chorus_cc_volume_boost_);
-				ImGui::Checkbox("Pan law compensation", &pan_law_compensation_);
+				ImGui::Checkbox("Convert song title", &settings_.convert_song_title);
+				ImGui::Checkbox("Per-file instruments", &settings_.per_file_instruments);
+				ImGui::Checkbox("Auto reload MIDI", &settings_.auto_reload_midi);
+				ImGui::Checkbox("Auto optimize MIDI", &settings_.auto_optimize_midi);
+				ImGui::Checkbox("Chorus CC volume boost", &settings_.chorus_cc_volume_boost);
+				ImGui::Checkbox("Pan law compensation", &settings_.pan_law_compensation);
 				if constexpr (debug_mode) {
 					ImGui::Separator();
 					static bool override;
@@ -182,6 +210,11 @@ namespace MID3SMPS {
 
 					ImGui::Checkbox("Show demo window", &MID3SMPS::show_demo_window);
 				}
+				if constexpr (trace::enabled) {
+					if(ImGui::MenuItem("Trace")) {
+						open_trace_panel();
+					}
+				}
 			};
 		};
 		ImGui::PopItemWidth();
@@ -219,6 +252,54 @@ namespace MID3SMPS {
 			}
 			ImGuiFileDialog::Instance()->Close();
 		}
+		if(ImGuiFileDialog::Instance()->Display(RenderPreview)) {
+			if(ImGuiFileDialog::Instance()->IsOk()) {
+				// Snapshot the bank being edited here, the editor carries on changing it while the preview renders
+				auto bank = ym2612_edit_ ? ym2612_edit_->snapshot() : nullptr;
+				if(!events_ || events_->empty()) {
+					status_ = "No midi loaded";
+				} else {
+					auto path = get_path_from_file_dialog();
+					status_   = fmt::format("Rendering {}", path.filename().string());
+					std::packaged_task<std::string()> task([path = std::move(path), events = events_, bank = std::move(bank), assets = assets_] {
+						return render_preview(path, events, bank, assets);
+					});
+					preview_render_ = task.get_future();
+					std::thread([task = std::move(task)]() mutable {
+						const auto job = fps_idling::track_job();
+						task();
+					}).detach();
+				}
+			}
+			ImGuiFileDialog::Instance()->Close();
+		}
+		if(ImGuiFileDialog::Instance()->Display(OpenProject)) {
+			if(ImGuiFileDialog::Instance()->IsOk()) {
+				open_project(get_path_from_file_dialog());
+			}
+			ImGuiFileDialog::Instance()->Close();
+		}
+		if(ImGuiFileDialog::Instance()->Display(SaveProject)) {
+			if(ImGuiFileDialog::Instance()->IsOk()) {
+				// The bank is saved as it is in the editor, edits made while saving go into the next save
+				auto bank          = ym2612_edit_ ? ym2612_edit_->snapshot() : nullptr;
+				const auto history = ym2612_edit_ ? ym2612_edit_->history_position() : edit_journal::position_t{};
+				auto path          = get_path_from_file_dialog();
+				status_            = fmt::format("Saving {}", path.filename().string());
+				std::packaged_task<saved_project()> task([path = std::move(path), midi = midi_path_, settings = settings_, map = map_, assets = assets_,
+				                                          bank = std::move(bank), history, previous = project_] {
+					auto saved    = save_project(path, midi, settings, map, assets, bank, previous);
+					saved.history = history;
+					return saved;
+				});
+				project_save_ = task.get_future();
+				std::thread([task = std::move(task)]() mutable {
+					const auto job = fps_idling::track_job();
+					task();
+				}).detach();
+			}
+			ImGuiFileDialog::Instance()->Close();
+		}
 		if(ImGuiFileDialog::Instance()->Display(OpenMapping)) {
 			if(ImGuiFileDialog::Instance()->IsOk()) {
 				if(auto path = get_path_from_file_dialog(); fs::exists(path)) {
@@ -232,7 +313,9 @@ namespace MID3SMPS {
 		}
 	}
 
-	void main_window::verify_and_set_midi(fs::path &&midi) {
+	main_window::loaded_midi main_window::verify_midi(fs::path midi) {
+		TRACE_ZONE("Load MIDI");
+		loaded_midi result;
 		// Read raw from a MIDI file
 		std::ifstream file{midi, std::ios::binary};
 
@@ -240,29 +323,46 @@ namespace MID3SMPS {
 		bytes.assign(std::istreambuf_iterator(file), std::istreambuf_iterator<char>());
 
 		// Parse
-		parse_result_ = reader_.parse(bytes);
-		switch(parse_result_) {
+		libremidi::reader reader;
+		result.result = reader.parse(bytes);
+		switch(result.result) {
 			case libremidi::reader::invalid:
 				// Throw error
-				status_ = fmt::format("Invalid midi file");
-				fmt::print(stderr, "{}", status_);
-				return;
+				result.status = fmt::format("Invalid midi file");
+				fmt::print(stderr, "{}", result.status);
+				return result;
 			case libremidi::reader::incomplete:
-				status_ = fmt::format("Midi file loading incomplete");
+				result.status = fmt::format("Midi file loading incomplete");
 				break;
 			case libremidi::reader::complete:
-				status_ = fmt::format("Midi file loading complete but not validated");
+				result.status = fmt::format("Midi file loading complete but not validated");
 				break;
 			case libremidi::reader::validated:
-				status_ = fmt::format("Midi file loaded and validated");
+				result.status = fmt::format("Midi file loaded and validated");
 				break;
 			default:
 				std::unreachable();
 		}
 
-		midi_path_ = midi;
+		// Everything after parsing works on the columnar copy, the reader's per-event messages are dropped with it
+		result.events = std::make_shared<const midi::event_store>(reader);
+		result.path   = std::move(midi);
+		return result;
+	}
+
+	void main_window::apply_midi(loaded_midi &&loaded) {
+		parse_result_ = loaded.result;
+		status_       = std::move(loaded.status);
+		if(!loaded.events) {
+			return;
+		}
+		events_          = std::move(loaded.events);
+		midi_resolution_ = events_->ticks_per_quarter();
+		preview_player_.reset(); // Stops the old song right away instead of on the next Play
+
+		midi_path_ = loaded.path;
 		cache_string(&midi_path_, midi_path_.filename().string());
-		persistence->insert_recent(std::move(midi));
+		persistence->insert_recent(std::move(loaded.path));
 	}
 
 	void main_window::save_smps_menu(bool save_as) {
@@ -275,27 +375,265 @@ namespace MID3SMPS {
 
 	void main_window::open_midi(fs::path &&midi) {
 		status_ = fmt::format("Loading {}", midi.string());
-		std::thread(&main_window::verify_and_set_midi, this, std::move(midi)).detach();
+		std::packaged_task<loaded_midi()> task([midi = std::move(midi)]() mutable {
+			return verify_midi(std::move(midi));
+		});
+		midi_load_ = task.get_future();
+		std::thread([task = std::move(task)]() mutable {
+			const auto job = fps_idling::track_job();
+			task();
+		}).detach();
 	}
 
 	void main_window::save_smps(const fs::path &path) {
+		const auto job = fps_idling::track_job();
 		last_smps_path_ = path;
 	}
 
 	void main_window::open_mapping(fs::path &&map_path, bool set_persistence) {
+		status_ = fmt::format("Loading {}", map_path.filename().string());
+		// Read off the UI thread, the window keeps drawing while the mapping and the files it names are checked
+		std::packaged_task<loaded_mapping()> task([map_path = std::move(map_path), set_persistence]() mutable {
+			TRACE_ZONE("Load mapping");
+			loaded_mapping result;
+			result.remember = set_persistence;
+			try {
+				result.map = M2S::mapping(map_path);
+				// Everything it points at loads in the background too, so it's likely ready by the time anything needs it
+				result.assets  = M2S::mapping_assets(result.map, [] { handler.idling.wake(); });
+				result.missing = result.map.missing_files();
+			} catch(const std::runtime_error &error) {
+				result.error = error.what();
+			}
+			result.path = std::move(map_path);
+			return result;
+		});
+		mapping_load_ = task.get_future();
+		std::thread([task = std::move(task)]() mutable {
+			const auto job = fps_idling::track_job();
+			task();
+		}).detach();
+	}
+
+	void main_window::apply_mapping(loaded_mapping &&loaded) {
+		if(!loaded.error.empty()) {
+			status_ = fmt::format("Failed to load map: {}", loaded.error);
+			return;
+		}
+		map_             = std::move(loaded.map);
+		assets_          = std::move(loaded.assets);
+		bank_pending_    = ym2612_edit_ != nullptr;
+		assets_reported_ = false;
+		project_.reset();
+		if(loaded.missing.empty()) {
+			status_ = fmt::format("Loaded {}", loaded.path.filename().string());
+		} else {
+			status_ = fmt::format("Loaded {}, {} is missing", loaded.path.filename().string(), loaded.missing.front().filename().string());
+		}
+		if(loaded.remember) {
+			persistence->last_config(loaded.path);
+		} else {
+			handler.log_startup("Last mapping loaded");
+		}
+		cache_string(&map_.gyb(), map_.gyb().filename().string());
+		mapping_path_ = std::move(loaded.path);
+	}
+
+	void main_window::open_project(const fs::path &path) {
+		TRACE_ZONE("Open project");
 		try {
-			map_ = M2S::mapping(map_path);
-			status_ = fmt::format("Loaded {}", map_path.filename().string());
-			if(set_persistence) {
-				persistence->last_config_ = map_path;
+			auto opened = std::make_shared<const project>(path);
+			mapping_load_ = {}; // A mapping still loading would replace the project's
+			settings_   = opened->settings();
+			map_        = opened->mapping();
+			// Whatever the project has comes from its mapped sections, only the lists are still read from their files
+			auto from = M2S::mapping_assets::loaders::from(map_);
+			if(opened->has(project::section::bank)) {
+				from.bank = [opened] { return std::make_shared<const M2S::gyb>(opened->bank()); };
+			}
+			if(opened->has(project::section::drums)) {
+				from.dac = [opened] { return std::make_shared<const M2S::dac_map>(opened->drums()); };
+			}
+			if(opened->has(project::section::samples)) {
+				from.encoded_samples = [opened] {
+					auto [format, rate, data] = opened->samples();
+					return std::make_shared<const conversion::dac::encoded_list>(conversion::dac::encode_settings{format, rate}, std::move(data), opened);
+				};
 			}
-			if(ym2612_edit_ && fs::exists(map_.gyb())) {
-				ym2612_edit_->gyb_ = M2S::gyb{map_.gyb()};
+			if(opened->has(project::section::envelopes)) {
+				from.compiled_envelopes = [opened] { return std::make_shared<const conversion::psg_envelopes>(opened->envelopes()); };
 			}
+			assets_          = M2S::mapping_assets(from, [] { handler.idling.wake(); });
+			bank_pending_    = ym2612_edit_ != nullptr;
+			assets_reported_ = false;
 			cache_string(&map_.gyb(), map_.gyb().filename().string());
-			mapping_path_ = std::move(map_path);
-		} catch(const std::runtime_error &error) {
-			status_ = fmt::format("Failed to load map: {}", error.what());
+			mapping_path_.clear();
+			status_ = fmt::format("Opened {}", path.filename().string());
+			if(auto midi = opened->midi(); !midi.empty() && fs::exists(midi)) {
+				open_midi(std::move(midi));
+			}
+			project_ = std::move(opened);
+		} catch(const std::exception &error) {
+			status_ = fmt::format("Failed to open project: {}", error.what());
+		}
+	}
+
+	main_window::saved_project main_window::save_project(const fs::path &path, const fs::path &midi, const conversion::settings settings, const M2S::mapping &map,
+	                                                     const M2S::mapping_assets assets, const std::shared_ptr<const M2S::gyb> bank,
+	                                                     const std::shared_ptr<const project> previous) {
+		TRACE_ZONE("Save project");
+		saved_project result{.path = path, .bank = bank};
+		try {
+			// There's no target driver to pick yet, samples and envelopes are built for the first one
+			const auto &profile = smps::profiles.front();
+
+			std::vector<std::uint8_t> bank_file;
+			if(bank) {
+				bank_file = bank->save();
+			} else if(std::error_code error; fs::exists(map.gyb(), error)) {
+				bank_file = read_file(map.gyb());
+			}
+			// Samples and envelopes a project was opened with are saved as they are, the lists are only built when there's nothing to reuse
+			const auto drums        = assets.dac();
+			const auto target       = conversion::dac::encode_settings::from(profile);
+			auto samples            = assets.encoded_samples();
+			if(!samples || samples->settings != target) {
+				samples = std::make_shared<const conversion::dac::encoded_list>(target, conversion::dac::sample_encoder().encode(*assets.samples(), target));
+			}
+			auto envelopes = assets.compiled_envelopes();
+			if(!envelopes) {
+				envelopes = std::make_shared<const conversion::psg_envelopes>(*assets.envelopes(), profile);
+			}
+
+			project::contents contents{
+				.midi          = midi,
+				.settings      = settings,
+				.mapping       = &map,
+				.bank          = bank_file,
+				.drums         = drums.get(),
+				.sample_format = samples->settings.format,
+				.sample_rate   = samples->settings.rate,
+				.samples       = samples->samples,
+				.envelopes     = envelopes.get(),
+			};
+
+			// A bank or drum table whose file is gone is carried over from the project that was open
+			std::optional<M2S::dac_map> previous_drums;
+			if(previous) {
+				if(bank_file.empty()) {
+					contents.bank = previous->raw(project::section::bank).value_or(std::span<const std::uint8_t>{});
+				}
+				if(drums->hits.empty()) {
+					contents.drums = &previous_drums.emplace(previous->drums());
+				}
+			}
+			project::save(path, contents);
+		} catch(const std::exception &error) {
+			result.error = error.what();
+		}
+		return result;
+	}
+
+	void main_window::apply_saved_project(saved_project &&saved) {
+		if(!saved.error.empty()) {
+			status_ = fmt::format("Failed to save project: {}", saved.error);
+			return;
+		}
+		status_ = fmt::format("Saved {}", saved.path.filename().string());
+		if(saved.bank && ym2612_edit_) {
+			ym2612_edit_->mark_saved(saved.history); // Edits made while it saved still count as changes
+		}
+	}
+
+	void main_window::render_preview_menu() {
+		ImGuiFileDialog::Instance()->OpenDialog(RenderPreview, "Select a destination", ".wav", default_file_dialog_config);
+	}
+
+	std::string main_window::render_preview(const fs::path &path, const std::shared_ptr<const midi::event_store> events, std::shared_ptr<const M2S::gyb> bank,
+	                                        const M2S::mapping_assets assets) {
+		TRACE_ZONE("Render preview");
+		try {
+			if(!bank) {
+				bank = assets.bank();
+			}
+			playback::song_preview preview(*events, *bank);
+			playback::wav_writer wav(path, playback::song_preview::sample_rate);
+			preview.render_to(wav);
+			return fmt::format("Rendered {} ({:.1f}s)", path.filename().string(), static_cast<double>(wav.frames_written()) / playback::song_preview::sample_rate);
+		} catch(const std::exception &error) {
+			return fmt::format("Failed to render preview: {}", error.what());
+		}
+	}
+
+	void main_window::render_preview_controls() {
+		const bool playing = preview_player_ && preview_player_->playing();
+		dear::Disabled(!events_ || events_->empty()) && [this, playing] {
+			if(ImGui::Button(playing ? "Pause" : "Play")) {
+				if(playing) {
+					preview_player_->pause();
+				} else {
+					play_preview();
+				}
+			}
+			ImGui::SameLine();
+			if(ImGui::Button("Stop") && preview_player_) {
+				preview_player_->stop();
+			}
+		};
+		ImGui::SameLine();
+		ImGui::SetNextItemWidth(-1);
+		dear::Disabled(!preview_player_) && [this] {
+			std::uint64_t event       = preview_seek_.value_or(preview_player_ ? preview_player_->cursor() : 0);
+			const std::uint64_t first = 0;
+			const std::uint64_t last  = preview_player_ ? preview_player_->event_count() : 0;
+			if(ImGui::SliderScalar("##Seek", ImGuiDataType_U64, &event, &first, &last, "Event %llu")) {
+				preview_seek_ = event;
+			}
+			if(ImGui::IsItemDeactivatedAfterEdit() && preview_seek_ && preview_player_) {
+				preview_player_->seek(static_cast<std::size_t>(*preview_seek_));
+				preview_seek_.reset();
+			}
+		};
+		if(playing) {
+			handler.idling.override_this_frame = true; // Keeps the seek bar moving along
+		}
+	}
+
+	void main_window::play_preview() {
+		// A snapshot of the bank being edited, like the WAV render
+		auto bank = ym2612_edit_ ? ym2612_edit_->snapshot() : nullptr;
+		try {
+			if(!bank && !assets_.bank_ready()) {
+				status_ = "The bank is still loading";
+				return;
+			}
+			if(!bank) {
+				bank = assets_.bank();
+			}
+			if(!bank) {
+				bank = std::make_shared<const M2S::gyb>(); // Everything falls back to the PSG
+			}
+			if(preview_player_ && preview_events_ == events_ && preview_bank_ == bank) {
+				preview_player_->play();
+				return;
+			}
+
+			if(!preview_sink_) {
+				preview_sink_ = std::make_unique<playback::device_sink>(playback::song_preview::sample_rate);
+			}
+			// Carries on from the same event with the edited bank. Only one player can write to the sink at a time.
+			const auto cursor = preview_player_ && preview_events_ == events_ ? preview_player_->cursor() : 0;
+			preview_player_.reset();
+			auto song = std::make_unique<playback::song_preview>(*events_, *bank);
+			if(cursor != 0) {
+				song->seek(cursor);
+			}
+			preview_player_ = std::make_unique<playback::preview_player>(std::move(song), *preview_sink_);
+			preview_events_ = events_;
+			preview_bank_   = std::move(bank);
+			preview_player_->play();
+		} catch(const std::exception &error) {
+			status_ = fmt::format("Failed to play preview: {}", error.what());
 		}
 	}
 
@@ -309,10 +647,8 @@ namespace MID3SMPS {
 
 	void main_window::open_instrument_editor() {
 		if(!ym2612_edit_) {
-			ym2612_edit_ = std::make_unique<ym2612_edit>();
-			if(fs::exists(map_.gyb())) {
-				ym2612_edit_->gyb_ = M2S::gyb{map_.gyb()};
-			}
+			ym2612_edit_  = std::make_unique<ym2612_edit>();
+			bank_pending_ = true;
 		} else {
 			ImGui::SetWindowFocus(ym2612_edit_->window_title());
 		}
@@ -321,14 +657,68 @@ namespace MID3SMPS {
 
 	void main_window::open_mappings_editor() {}
 
-	void main_window::open_tempo_calculator() {}
+	void main_window::open_tempo_calculator() {
+		if(!tempo_calculator_) {
+			tempo_calculator_ = std::make_unique<tempo_calculator>(*this);
+		} else {
+			ImGui::SetWindowFocus(tempo_calculator_->window_title());
+		}
+		tempo_calculator_->stay_open_ = true;
+	}
+
+	void main_window::open_trace_panel() {
+		if(!trace_panel_) {
+			trace_panel_ = std::make_unique<trace_panel>();
+		} else {
+			ImGui::SetWindowFocus(trace_panel_->window_title());
+		}
+		trace_panel_->stay_open_ = true;
+	}
 
 	void main_window::on_close() {}
 
 	void main_window::render_children() {
 		render_file_dialogs();
+		if(midi_load_.valid() && midi_load_.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+			apply_midi(midi_load_.get());
+		}
+		if(mapping_load_.valid() && mapping_load_.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+			apply_mapping(mapping_load_.get());
+		}
+		if(project_save_.valid() && project_save_.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+			apply_saved_project(project_save_.get());
+		}
+		if(preview_render_.valid() && preview_render_.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+			status_ = preview_render_.get();
+		}
+		if(ym2612_edit_ && bank_pending_ && assets_.bank_ready()) {
+			bank_pending_ = false;
+			try {
+				ym2612_edit_->set_bank(M2S::gyb(*assets_.bank()));
+			} catch(const std::exception &error) {
+				status_ = fmt::format("Failed to load bank: {}", error.what());
+			}
+		}
+		if(!assets_reported_ && assets_.ready()) {
+			assets_reported_ = true;
+			try {
+				static_cast<void>(assets_.dac());
+				static_cast<void>(assets_.samples());
+				static_cast<void>(assets_.envelopes());
+			} catch(const std::exception &error) {
+				status_ = fmt::format("Failed to load mapping: {}", error.what());
+			}
+		}
 		if(ym2612_edit_ && ym2612_edit_->keep()) {
+			TRACE_ZONE("Instrument editor");
 			ym2612_edit_->render();
 		}
+		if(tempo_calculator_ && tempo_calculator_->keep()) {
+			TRACE_ZONE("Tempo calculator");
+			tempo_calculator_->render();
+		}
+		if(trace_panel_ && trace_panel_->keep()) {
+			trace_panel_->render();
+		}
 	}
 } // MID3SMPS
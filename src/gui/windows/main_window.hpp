@@ -1,11 +1,24 @@
 #pragma once
 
 #include <filesystem>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 #include <libremidi/reader.hpp>
 
 #include "window.hpp"
 #include "ym2612_edit.hpp"
+#include "tempo_calculator.hpp"
+#include "trace_panel.hpp"
+#include "containers/files/project.hpp"
 #include "containers/files/mid2smps/mapping.hpp"
+#include "containers/files/mid2smps/mapping_assets.hpp"
+#include "containers/midi/event_store.hpp"
+#include "conversion/settings.hpp"
+#include "playback/device_sink.hpp"
+#include "playback/preview_player.hpp"
 
 namespace fs = std::filesystem;
 
@@ -14,16 +27,61 @@ namespace MID3SMPS {
 		fs::path midi_path_{};
 		fs::path last_smps_path_{};
 
-		libremidi::reader reader_{};
 		libremidi::reader::parse_result parse_result_{};
+		// Never changed once published, a new MIDI replaces the pointer on the UI thread so background jobs keep the store they started with
+		std::shared_ptr<const midi::event_store> events_{};
+
+		// A MIDI parsed on a background thread, render_children applies it once it's done
+		struct loaded_midi {
+			fs::path path{};
+			libremidi::reader::parse_result result{};
+			std::shared_ptr<const midi::event_store> events{}; // Empty if the file couldn't be parsed
+			std::string status{};
+		};
+		std::future<loaded_midi> midi_load_{};
 
 		fs::path mapping_path_{};
 		M2S::mapping map_;
+		M2S::mapping_assets assets_;
+		bool bank_pending_     = false; // The editor gets the mapping's bank once it has loaded
+		bool assets_reported_ = true;  // Load errors go to the status line once everything has finished
+		std::shared_ptr<const project> project_{};
+
+		// A mapping read on a background thread, render_children applies it once it's done
+		struct loaded_mapping {
+			fs::path path{};
+			bool remember = true; // Becomes the mapping opened on the next start
+			M2S::mapping map{};
+			M2S::mapping_assets assets{};
+			std::vector<fs::path> missing{};
+			std::string error{};
+		};
+		std::future<loaded_mapping> mapping_load_{};
+
+		// A project saved on a background thread, render_children reports it once it's done
+		struct saved_project {
+			fs::path path{};
+			std::shared_ptr<const M2S::gyb> bank{}; // The editor snapshot that was saved, empty if it was the GYB file
+			edit_journal::position_t history{};     // Where the editor's history was when the snapshot was taken
+			std::string error{};                    // Empty if it saved
+		};
+		std::future<saved_project> project_save_{};
+		std::future<std::string> preview_render_{}; // The status line once the preview has rendered
+
+		// Live preview. The device is opened on the first Play and kept open, the player is declared after it so it stops writing first.
+		std::unique_ptr<playback::device_sink> preview_sink_{};
+		std::unique_ptr<playback::preview_player> preview_player_{};
+		// What the player was built from, Play builds a new one once either has changed
+		std::shared_ptr<const midi::event_store> preview_events_{};
+		std::shared_ptr<const M2S::gyb> preview_bank_{};
+		std::optional<std::uint64_t> preview_seek_{}; // Event the seek bar is being dragged to, sent once it's let go
 
 		std::unique_ptr<ym2612_edit> ym2612_edit_{};
+		std::unique_ptr<tempo_calculator> tempo_calculator_{};
+		std::unique_ptr<trace_panel> trace_panel_{};
 
-		int ticks_per_quarter_{};
-		int ticks_multiplier_{};
+		conversion::settings settings_{};
+		conversion::settings persisted_settings_{}; // What the settings store last got
 
 		int midi_resolution_{};
 
@@ -33,14 +91,28 @@ namespace MID3SMPS {
 
 		void show_menu_bar();
 		void render_file_dialogs();
-		void verify_and_set_midi(fs::path &&midi);
+		void render_preview_controls();
+		// Plays from where the player is, with the MIDI and bank as they are now
+		void play_preview();
+		[[nodiscard]] static loaded_midi verify_midi(fs::path midi);
+		void apply_midi(loaded_midi &&loaded);
 		void open_midi(fs::path &&midi);
 		void save_smps(const fs::path &path);
+		// Renders with the snapshot of the bank, or the mapping's bank if the editor isn't open. Runs on its own thread and returns the status line.
+		[[nodiscard]] static std::string render_preview(const fs::path &path, std::shared_ptr<const midi::event_store> events, std::shared_ptr<const M2S::gyb> bank,
+		                    M2S::mapping_assets assets);
 		void open_mapping(fs::path &&map_path, bool set_persistence = true);
+		void apply_mapping(loaded_mapping &&loaded);
+		void open_project(const fs::path &path);
+		// Takes copies of everything it saves, it runs on its own thread. A bank snapshot from the editor is saved instead of the GYB file.
+		[[nodiscard]] static saved_project save_project(const fs::path &path, const fs::path &midi, conversion::settings settings, const M2S::mapping &map, M2S::mapping_assets assets,
+		                  std::shared_ptr<const M2S::gyb> bank, std::shared_ptr<const project> previous);
+		void apply_saved_project(saved_project &&saved);
 
 		// File Menu
 		//void openMidiMenu();
 		void save_smps_menu(bool save_as = false);
+		void render_preview_menu();
 		void exit_menu();
 
 		// Instruments & Mappings Menu
@@ -52,18 +124,17 @@ namespace MID3SMPS {
 
 		// Extras Menu
 		void open_tempo_calculator();
-		bool convert_song_title_{};
-		bool per_file_instruments_{};
-		bool auto_reload_midi_   = true;
-		bool auto_optimize_midi_ = true;
+		void open_trace_panel();
 
-		bool chorus_cc_volume_boost_ = true;
-		bool pan_law_compensation_   = true;
+		friend class tempo_calculator;
 
 		// ReSharper disable CppInconsistentNaming
 		static constexpr std::string OpenMidi    = "OpenMidi";
 		static constexpr std::string SaveSmps    = "SaveSmps";
 		static constexpr std::string OpenMapping = "OpenMapping";
+		static constexpr std::string RenderPreview = "RenderPreview";
+		static constexpr std::string OpenProject   = "OpenProject";
+		static constexpr std::string SaveProject   = "SaveProject";
 		// ReSharper restore CppInconsistentNaming
 
 	public:
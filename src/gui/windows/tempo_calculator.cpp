@@ -0,0 +1,134 @@
+#include "tempo_calculator.hpp"
+
+#include <imguiwrap.dear.h>
+#include <imgui.h>
+#include <fmt/core.h>
+
+#include "gui/windows/main_window.hpp"
+
+namespace MID3SMPS {
+	void tempo_calculator::update() {
+		if(solved_events_ != owner_.events_) {
+			solved_events_   = owner_.events_;
+			solver_          = solved_events_ ? conversion::tempo_solver(*solved_events_) : conversion::tempo_solver{};
+			solved_region_   = std::nullopt;
+			evaluated_values_ = {-1, -1};
+		}
+		if(solved_region_ != region_) {
+			for(std::size_t idx = 0; idx < smps::profiles.size(); idx++) {
+				best_[idx] = solver_.solve(smps::profiles[idx], frame_rate());
+			}
+			solved_region_    = region_;
+			evaluated_values_ = {-1, -1};
+		}
+
+		// Cheap enough to redo whenever the main window's values are edited
+		if(const std::pair values{owner_.settings_.ticks_per_quarter, owner_.settings_.ticks_multiplier}; values != evaluated_values_) {
+			for(std::size_t idx = 0; idx < smps::profiles.size(); idx++) {
+				current_[idx] = solver_.evaluate(smps::profiles[idx], frame_rate(), static_cast<std::uint16_t>(values.first), static_cast<std::uint16_t>(values.second));
+			}
+			evaluated_values_ = values;
+		}
+	}
+
+	void tempo_calculator::render() {
+		update();
+		dear::Begin{window_title(), &stay_open_} && [this] {
+			if(solver_.empty()) {
+				ImGui::TextUnformatted("Load a MIDI to calculate its tempo");
+				return;
+			}
+			render_settings();
+			render_results();
+			render_tempo_map();
+		};
+	}
+
+	void tempo_calculator::render_settings() {
+		static constexpr std::array regions = {
+			"NTSC (60 Hz)",
+			"PAL (50 Hz)"
+		};
+		ImGui::SetNextItemWidth(ImGui::GetFontSize() * 10);
+		dear::Combo{"Region", regions[std::to_underlying(region_)]} && [this] {
+			for(std::size_t idx = 0; idx < regions.size(); idx++) {
+				const auto current     = static_cast<region>(idx);
+				const bool is_selected = region_ == current;
+				if(ImGui::Selectable(regions[idx], is_selected)) {
+					region_ = current;
+				}
+				if(is_selected) {
+					ImGui::SetItemDefaultFocus();
+				}
+			}
+		};
+	}
+
+	void tempo_calculator::render_results() {
+		static constexpr auto table_flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg;
+		const auto drift_text = [](const conversion::tempo_setting &setting) {
+			if(!setting.valid()) {
+				return std::string{"-"};
+			}
+			return fmt::format("{:.1f} ms", setting.max_drift * 1000.);
+		};
+		const auto tempo_text = [](const conversion::tempo_setting &setting) {
+			if(!setting.valid()) {
+				return std::string{"-"};
+			}
+			return fmt::format("${:02X}", setting.tempos.front());
+		};
+
+		dear::Table{"Tempo results", 8, table_flags} && [&, this] {
+			ImGui::TableSetupColumn("Driver");
+			ImGui::TableSetupColumn("Tempo");
+			ImGui::TableSetupColumn("Drift");
+			ImGui::TableSetupColumn("Best Ticks/Quarter");
+			ImGui::TableSetupColumn("Best Multiplier");
+			ImGui::TableSetupColumn("Best Tempo");
+			ImGui::TableSetupColumn("Best Drift");
+			ImGui::TableSetupColumn("##Apply");
+			ImGui::TableHeadersRow();
+			for(std::size_t idx = 0; idx < smps::profiles.size(); idx++) {
+				const auto &current = current_[idx];
+				const auto &best    = best_[idx];
+				dear::WithID(static_cast<int>(idx)) && [&] {
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(smps::profiles[idx].name.data());
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(tempo_text(current).c_str());
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(drift_text(current).c_str());
+					ImGui::TableNextColumn();
+					ImGui::Text("%u", best.ticks_per_quarter);
+					ImGui::TableNextColumn();
+					ImGui::Text("%u", best.multiplier);
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(tempo_text(best).c_str());
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(drift_text(best).c_str());
+					ImGui::TableNextColumn();
+					dear::Disabled(!best.valid()) && [&] {
+						if(ImGui::SmallButton("Apply")) {
+							owner_.settings_.ticks_per_quarter = best.ticks_per_quarter;
+							owner_.settings_.ticks_multiplier  = best.multiplier;
+						}
+					};
+				};
+			}
+		};
+		if(const auto segments = current_.front().tempos.size(); segments > 1) {
+			ImGui::Text("%zu tempo changes will be written as set tempo flags", segments - 1);
+		}
+	}
+
+	void tempo_calculator::render_tempo_map() const {
+		dear::TreeNode{"Tempo map"} && [this] {
+			for(const auto &[tick, us_per_quarter] : solver_.map()) {
+				ImGui::Text("Tick %u: %.2f BPM", tick, 60'000'000. / us_per_quarter);
+			}
+		};
+	}
+
+	void tempo_calculator::on_close() {}
+} // MID3SMPS
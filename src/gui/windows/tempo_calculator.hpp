@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <optional>
+
+#include "gui/windows/window.hpp"
+#include "conversion/tempo_solver.hpp"
+#include "containers/smps/driver_profile.hpp"
+
+namespace MID3SMPS {
+	class main_window;
+
+	class tempo_calculator : public window {
+		main_window &owner_;
+
+		enum class region : std::uint8_t {
+			ntsc,
+			pal
+		} region_{};
+
+		conversion::tempo_solver solver_{};
+		std::shared_ptr<const midi::event_store> solved_events_{}; // Keeps the store alive and tells when the main window has a new one
+		std::optional<region> solved_region_          = std::nullopt;
+		std::array<conversion::tempo_setting, smps::profiles.size()> best_{};
+
+		std::pair<int, int> evaluated_values_{-1, -1};
+		std::array<conversion::tempo_setting, smps::profiles.size()> current_{};
+
+		[[nodiscard]] constexpr double frame_rate() const noexcept {
+			return region_ == region::pal ? smps::pal_frame_rate : smps::ntsc_frame_rate;
+		}
+
+		void update();
+		void render_settings();
+		void render_results();
+		void render_tempo_map() const;
+
+		friend class main_window;
+	public:
+		explicit tempo_calculator(main_window &owner) : owner_(owner) {}
+
+		void render() override;
+		void on_close() override;
+		[[nodiscard]] constexpr const char* window_title() const override{
+			return "Tempo Calculator";
+		}
+	};
+} // MID3SMPS
@@ -0,0 +1,161 @@
+#include "trace_panel.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <ImGuiFileDialog.h>
+#include <imguiwrap.dear.h>
+#include <imgui.h>
+#include <fmt/core.h>
+
+namespace MID3SMPS {
+	namespace {
+		constexpr std::uint64_t refresh_interval = 250'000'000; // Nanoseconds
+		constexpr auto frame_zone = "Frame";
+		constexpr auto export_dialog = "ExportTrace";
+
+		[[nodiscard]] double milliseconds(const std::uint64_t nanoseconds) noexcept {
+			return static_cast<double>(nanoseconds) / 1'000'000.;
+		}
+	}
+
+	void trace_panel::refresh() {
+		if(paused_ || trace::now() - refreshed_at_ < refresh_interval) {
+			return;
+		}
+		refreshed_at_ = trace::now();
+		recomputations_       = dirty_node::recomputations() - recomputations_total_;
+		recomputations_total_ = dirty_node::recomputations();
+		recomputation_frames_ = trace::frame() - refreshed_frame_;
+		refreshed_frame_      = trace::frame();
+		records_      = trace::snapshot();
+		last_frame_   = trace::frame() > 0 ? trace::frame() - 1 : 0;
+
+		frame_times_.clear();
+		stats_.clear();
+		for(const auto &zone : records_) {
+			if(zone.depth == 0 && std::strcmp(zone.name, frame_zone) == 0) {
+				frame_times_.push_back(static_cast<float>(milliseconds(zone.duration)));
+			}
+			auto found = std::ranges::find_if(stats_, [&](const zone_stats &stats) {
+				return std::strcmp(stats.name, zone.name) == 0;
+			});
+			if(found == stats_.end()) {
+				stats_.push_back({zone.name, 0, 0, 0});
+				found = std::prev(stats_.end());
+			}
+			++found->count;
+			found->total += zone.duration;
+			found->max = std::max(found->max, zone.duration);
+		}
+		std::ranges::sort(stats_, std::greater{}, &zone_stats::total);
+	}
+
+	void trace_panel::render() {
+		refresh();
+		dear::Begin{window_title(), &stay_open_} && [this] {
+			if constexpr (!trace::enabled) {
+				ImGui::TextUnformatted("Tracing is compiled out, build with MID3SMPS_TRACING to record zones");
+				return;
+			}
+			ImGui::Checkbox("Pause", &paused_);
+			ImGui::SameLine();
+			if(ImGui::Button("Export Chrome trace")) {
+				IGFD::FileDialogConfig config;
+				config.flags = ImGuiFileDialogFlags_ConfirmOverwrite;
+				ImGuiFileDialog::Instance()->OpenDialog(export_dialog, "Select a destination", ".json", config);
+			}
+			ImGui::SameLine();
+			ImGui::Text("%zu zones", records_.size());
+			ImGui::Text("%llu derived values recomputed in the last %u frames", static_cast<unsigned long long>(recomputations_), recomputation_frames_);
+
+			render_frame_times();
+			render_last_frame();
+			render_stats();
+		};
+		render_export_dialog();
+	}
+
+	void trace_panel::render_frame_times() const {
+		if(frame_times_.empty()) {
+			return;
+		}
+		const auto [min, max] = std::ranges::minmax(frame_times_);
+		const auto overlay    = fmt::format("Last {:.2f} ms, min {:.2f} ms, max {:.2f} ms", frame_times_.back(), min, max);
+		ImGui::PlotLines("##Frame times", frame_times_.data(), static_cast<int>(frame_times_.size()), 0, overlay.c_str(), 0, max, {-1, ImGui::GetFontSize() * 5});
+	}
+
+	void trace_panel::render_last_frame() const {
+		dear::TreeNode{"Last frame"} && [this] {
+			static constexpr auto table_flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg;
+			dear::Table{"Frame zones", 3, table_flags} && [this] {
+				ImGui::TableSetupColumn("Zone");
+				ImGui::TableSetupColumn("Thread");
+				ImGui::TableSetupColumn("Time");
+				ImGui::TableHeadersRow();
+				for(const auto &zone : records_) {
+					if(zone.frame != last_frame_) {
+						continue;
+					}
+					ImGui::TableNextColumn();
+					// Indent(0) would use the default spacing, so top level zones skip it
+					const auto indent = static_cast<float>(zone.depth) * ImGui::GetFontSize();
+					if(indent > 0) {
+						ImGui::Indent(indent);
+					}
+					ImGui::TextUnformatted(zone.name);
+					if(indent > 0) {
+						ImGui::Unindent(indent);
+					}
+					ImGui::TableNextColumn();
+					ImGui::Text("%u", zone.thread);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.3f ms", milliseconds(zone.duration));
+				}
+			};
+		};
+	}
+
+	void trace_panel::render_stats() const {
+		dear::TreeNode{"All zones"} && [this] {
+			static constexpr auto table_flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg;
+			dear::Table{"Zone stats", 5, table_flags} && [this] {
+				ImGui::TableSetupColumn("Zone");
+				ImGui::TableSetupColumn("Count");
+				ImGui::TableSetupColumn("Total");
+				ImGui::TableSetupColumn("Average");
+				ImGui::TableSetupColumn("Max");
+				ImGui::TableHeadersRow();
+				for(const auto &[name, count, total, max] : stats_) {
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(name);
+					ImGui::TableNextColumn();
+					ImGui::Text("%zu", count);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.3f ms", milliseconds(total));
+					ImGui::TableNextColumn();
+					ImGui::Text("%.3f ms", milliseconds(total) / static_cast<double>(count));
+					ImGui::TableNextColumn();
+					ImGui::Text("%.3f ms", milliseconds(max));
+				}
+			};
+		};
+	}
+
+	void trace_panel::render_export_dialog() {
+		if(!ImGuiFileDialog::Instance()->Display(export_dialog)) {
+			return;
+		}
+		if(ImGuiFileDialog::Instance()->IsOk()) {
+			try {
+				trace::export_chrome(ImGuiFileDialog::Instance()->GetFilePathName(), trace::snapshot());
+			} catch(const std::exception &error) {
+				fmt::print(stderr, "{}\n", error.what());
+			}
+		}
+		ImGuiFileDialog::Instance()->Close();
+	}
+
+	void trace_panel::on_close() {}
+} // MID3SMPS
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+
+#include "gui/windows/window.hpp"
+#include "containers/dirty_graph.hpp"
+#include "helpers/trace.hpp"
+
+namespace MID3SMPS {
+	// Shows what TRACE_ZONE recorded, only useful in builds with MID3SMPS_TRACING
+	class trace_panel : public window {
+		struct zone_stats {
+			const char *name;
+			std::size_t count;
+			std::uint64_t total;
+			std::uint64_t max;
+		};
+
+		std::vector<trace::record> records_{};
+		std::vector<float> frame_times_{}; // Milliseconds
+		std::vector<zone_stats> stats_{};
+		std::uint32_t last_frame_ = 0;   // Last frame whose zones are all in records_
+		std::uint64_t refreshed_at_ = 0;
+		std::uint32_t refreshed_frame_ = 0;
+		// Derived values recomputed between the last two refreshes, should stay at 0 while nothing changes
+		std::uint64_t recomputations_ = 0;
+		std::uint64_t recomputations_total_ = 0;
+		std::uint32_t recomputation_frames_ = 0;
+		bool paused_ = false;
+
+		void refresh();
+		void render_frame_times() const;
+		void render_last_frame() const;
+		void render_stats() const;
+		void render_export_dialog();
+
+	public:
+		void render() override;
+		void on_close() override;
+		[[nodiscard]] constexpr const char* window_title() const override{
+			return "Trace";
+		}
+	};
+} // MID3SMPS
@@ -3,12 +3,17 @@
 #include <imguiwrap.dear.h>
 #include <imgui.h>
 #include <misc/cpp/imgui_stdlib.h>
-#include <execution>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <ranges>
 #include <imgui_internal.h>
 #include <gui/backend/window_handler.hpp>
 
 #include "containers/files/mid2smps/gyb.hpp"
 #include "containers/files/mid2smps/fm/patch.hpp"
+#include "helpers/trace.hpp"
 
 static constexpr auto default_hover_flags = ImGuiHoveredFlags_AllowWhenDisabled | ImGuiHoveredFlags_ForTooltip;
 
@@ -62,25 +67,6 @@ namespace MID3SMPS {
 		return std::nullopt;
 	}
 
-	template<>
-	std::optional<operators::ssgeg_mode> ym2612_edit::handle_combo_scroll(const ym2612::operators::ssgeg_mode &enumeration) {
-		using T = operators::ssgeg_mode;
-		static constexpr auto size = std::to_underlying(T::mode7)+1;
-		const auto underlying = std::to_underlying(enumeration);
-		using underlying_t = decltype(underlying);
-		if(const auto new_enum = handle_combo_scroll<size, underlying_t>(underlying)) {
-			auto value = *new_enum;
-			if(value == std::to_underlying(T::disabled)+1) {
-				return T::mode0;
-			}
-			if(value == std::to_underlying(T::mode0)-1) {
-				return T::disabled;
-			}
-			return static_cast<T>(value);
-		}
-		return std::nullopt;
-	}
-
 	template<>
 	std::optional<lfo> ym2612_edit::handle_combo_scroll(const lfo &enumeration) {
 		using T = lfo;
@@ -104,6 +90,18 @@ namespace MID3SMPS {
 	void ym2612_edit::render() {
 		dear::Begin{window_title(), &stay_open_, ImGuiWindowFlags_MenuBar | ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse} && [this] {
 			//const auto dock_node = ImGui::GetWindowDockNode();
+			// Drawn with the baked size closest to the zoom, the window's font scale only makes up the difference
+			auto *font = handler.font_for_size(window_handler::base_font_size * zoom_);
+			ImGui::PushFont(font);
+			ImGui::SetWindowFontScale(window_handler::base_font_size * zoom_ / font->FontSize);
+			begin_edit_capture();
+			if(ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows) && !ImGui::GetIO().WantTextInput) {
+				if(ImGui::IsKeyChordPressed(ImGuiMod_Ctrl | ImGuiKey_Z)) {
+					undo();
+				} else if(ImGui::IsKeyChordPressed(ImGuiMod_Ctrl | ImGuiKey_Y) || ImGui::IsKeyChordPressed(ImGuiMod_Ctrl | ImGuiMod_Shift | ImGuiKey_Z)) {
+					redo();
+				}
+			}
 			render_menu_bar();
 			render_instrument_selection();
 			dear::TabBar{"Editor tabs"} && [this] {
@@ -119,12 +117,105 @@ namespace MID3SMPS {
 				};
 			};
 			scale_window();
+			end_edit_capture();
+			ImGui::PopFont();
+		};
+	}
+
+	void ym2612_edit::begin_edit_capture() {
+		frame_start_ = std::nullopt;
+		if(selected_id) {
+			frame_start_.emplace(selected_id->second, selected_instrument().operators.registers);
+		}
+	}
+
+	void ym2612_edit::end_edit_capture() {
+		if(!frame_start_ || selected_instrument_id() != frame_start_->first) {
+			return;
+		}
+		const auto &[id, before] = *frame_start_;
+		const auto &after = selected_instrument().operators.registers;
+		std::vector<edit_journal::delta> deltas;
+		for(std::uint8_t offset = 0; offset < before.size(); offset++) {
+			if(before[offset] != after[offset]) {
+				deltas.push_back({id, offset, before[offset].value, after[offset].value});
+			}
+		}
+		if(deltas.empty()) {
+			return;
+		}
+		// Drags keep the widget active and scrolling keeps it hovered, either way the edits of one widget become one step
+		const auto key = ImGui::GetActiveID() != 0 ? ImGui::GetActiveID() : ImGui::GetHoveredID();
+		journal_.record(std::move(deltas), key);
+		stale_index_rows_.insert(id);
+		changed(registers_changed_);
+	}
+
+	void ym2612_edit::changed(dirty_input &input) {
+		input.mark_dirty();
+		handler.idling.override_this_frame = true;
+	}
+
+	void ym2612_edit::undo() {
+		write_changes(journal_.undo(), true);
+	}
+
+	void ym2612_edit::redo() {
+		write_changes(journal_.redo(), false);
+	}
+
+	void ym2612_edit::write_changes(const edit_journal::changes &step, const bool undoing) {
+		const auto write = [this](const edit_journal::delta &change, const std::uint8_t value) {
+			if(change.offset == edit_journal::lfo_offset) {
+				gyb_.write().default_LFO_speed = static_cast<lfo>(value);
+				return;
+			}
+			if(!gyb_->instruments.contains(change.id)) {
+				return;
+			}
+			auto *patch = dynamic_cast<fm::patch *>(&gyb_.write().writable(change.id));
+			if(patch == nullptr) {
+				return;
+			}
+			if(change.offset == edit_journal::transposition_offset) {
+				patch->default_drum_note = value;
+			} else {
+				patch->operators.registers[change.offset] = value;
+				stale_index_rows_.insert(change.id);
+			}
 		};
+		if(undoing) {
+			for(const auto &change : step.deltas | std::views::reverse) {
+				write(change, change.before);
+			}
+		} else {
+			for(const auto &change : step.deltas) {
+				write(change, change.after);
+			}
+		}
+		for(const auto &[id, before, after] : step.renames) {
+			if(gyb_->instruments.contains(id)) {
+				gyb_.write().writable(id).name = undoing ? before : after;
+			}
+		}
+		if(!step.renames.empty()) {
+			changed(bank_changed_); // Trigrams come from the names
+		}
+		if(!step.deltas.empty()) {
+			changed(registers_changed_);
+			begin_edit_capture(); // Not an edit of this frame
+		}
 	}
 
 	void ym2612_edit::render_menu_bar() {
-		dear::WithStyleVar(ImGuiStyleVar_ItemSpacing, {8, 0}) && [] {
-			dear::MenuBar{} && [] {
+		dear::WithStyleVar(ImGuiStyleVar_ItemSpacing, {8, 0}) && [this] {
+			dear::MenuBar{} && [this] {
+				if(ImGui::MenuItem("Undo", "Ctrl+Z", false, journal_.can_undo())) {
+					undo();
+				}
+				if(ImGui::MenuItem("Redo", "Ctrl+Y", false, journal_.can_redo())) {
+					redo();
+				}
 				if(ImGui::MenuItem("Open new bank")) {}
 				if(ImGui::MenuItem("Save bank")) {}
 				if(ImGui::MenuItem("Bank switch")) {}
@@ -153,47 +244,104 @@ namespace MID3SMPS {
 		};
 	}
 
+	void ym2612_edit::set_bank(M2S::gyb &&bank) {
+		gyb_ = std::move(bank);
+		selected_id = std::nullopt;
+		open_banks_.clear();
+		multi_selection_.clear();
+		selection_anchor_ = std::nullopt;
+		journal_.clear();
+		stale_index_rows_.clear();
+		changed(bank_changed_);
+		changed(selection_changed_);
+		changed(open_banks_changed_);
+	}
+
+	std::vector<ym2612_edit::selector_row> ym2612_edit::build_selector_rows() const {
+		std::vector<selector_row> rows;
+		for(const auto &bank : *gyb_->bank_order) {
+			rows.push_back({bank, 0, true});
+			const auto order = gyb_->instruments_order->find(bank);
+			if(!open_banks_.contains(bank) || order == gyb_->instruments_order->end()) {
+				continue;
+			}
+			for(const auto &id : order->second) {
+				rows.push_back({bank, id, false});
+			}
+		}
+		return rows;
+	}
+
 	void ym2612_edit::render_instrument_selector() {
-		static constexpr ImGuiTreeNodeFlags base_flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth;
+		// Rows don't push onto the tree stack, the clipper needs every row to be independent of the ones before it
+		static constexpr ImGuiTreeNodeFlags base_flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_NoTreePushOnOpen;
 		static constexpr auto rename_dialog = "##ins_rename_dialog";
 
 		static decltype(selected_instrument_id()) id_for_edit = std::nullopt;
+		static std::string name_before_edit;
 		static bool popup_was_opened = false;
 		static bool trigger_popup = false;
 
-		for(const auto &bank : gyb_.bank_order) {
-			auto category_flags = base_flags;
-			if(selected_bank_id() == bank) {
-				category_flags |= ImGuiTreeNodeFlags_Selected;
-			}
-			dear::TreeNodeEx(gyb_.banks[bank].c_str(), category_flags) && [this, &bank] {
-				ImGui::Unindent(ImGui::GetTreeNodeToLabelSpacing());
-				for(const auto &id : gyb_.instruments_order[bank]) {
-					const auto &instrument = gyb_.instruments[id];
-					auto instrument_flags = base_flags;
-					if(selected_instrument_id() == id) {
-						instrument_flags |= ImGuiTreeNodeFlags_Selected;
-					}
-					instrument_flags |= ImGuiTreeNodeFlags_Leaf;
-					dear::TreeNodeEx(instrument->name.c_str(), instrument_flags) && [this, &bank, &id, &instrument] {
-						if(ImGui::IsItemClicked() && !ImGui::IsItemToggledOpen()) {
-							selected_id = {bank, id};
+		ImGui::SetNextItemWidth(-1);
+		if(ImGui::InputTextWithHint("##search", "Search: name, alg==7, fb>=5, ar<10", &search_text_)) {
+			changed(search_changed_);
+			selection_anchor_ = std::nullopt;
+		}
+		render_batch_edit();
+
+		if(!search_text_.empty()) {
+			render_search_results();
+		} else {
+			const auto &selector_rows = selector_rows_.get();
+			ImGuiListClipper clipper;
+			clipper.Begin(static_cast<int>(selector_rows.size()));
+			while(clipper.Step()) {
+				for(auto idx = static_cast<std::size_t>(clipper.DisplayStart); idx < static_cast<std::size_t>(clipper.DisplayEnd); idx++) {
+					const auto &[bank, id, is_bank] = selector_rows[idx];
+					// Names are looked up as they're drawn, editing a shared patch replaces it with a copy
+					const auto &label = is_bank ? gyb_->banks->at(bank) : gyb_->instruments.at(id)->name;
+					const auto *node_id = reinterpret_cast<const void *>(static_cast<std::uintptr_t>(is_bank ? 0x10000 | bank : id));
+					if(is_bank) {
+						auto category_flags = base_flags;
+						if(selected_bank_id() == bank) {
+							category_flags |= ImGuiTreeNodeFlags_Selected;
 						}
-						if(ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left) && ImGui::IsItemHovered()) {
-							id_for_edit = id;
-							trigger_popup = true;
+						const bool was_open = open_banks_.contains(bank);
+						ImGui::SetNextItemOpen(was_open);
+						if(ImGui::TreeNodeEx(node_id, category_flags, "%s", label.c_str()) != was_open) {
+							// Takes effect next frame, this frame keeps drawing the old rows
+							if(was_open) {
+								open_banks_.erase(bank);
+							} else {
+								open_banks_.insert(bank);
+							}
+							changed(open_banks_changed_);
 						}
-						dear::ItemTooltip() && [&instrument] {
-							ImGui::TextUnformatted(instrument->name.c_str());
-						};
+						continue;
+					}
+
+					auto instrument_flags = base_flags | ImGuiTreeNodeFlags_Leaf;
+					if(selected_instrument_id() == id || multi_selection_.contains(id)) {
+						instrument_flags |= ImGuiTreeNodeFlags_Selected;
+					}
+					ImGui::TreeNodeEx(node_id, instrument_flags, "%s", label.c_str());
+					if(ImGui::IsItemClicked() && !ImGui::IsItemToggledOpen()) {
+						click_instrument(bank, id, idx);
+					}
+					if(ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left) && ImGui::IsItemHovered()) {
+						id_for_edit = id;
+						trigger_popup = true;
+					}
+					dear::ItemTooltip() && [&label] {
+						ImGui::TextUnformatted(label.c_str());
 					};
 				}
-				ImGui::Indent(ImGui::GetTreeNodeToLabelSpacing());
-			};
+			}
 		}
 
 		if(trigger_popup) {
 			ImGui::OpenPopup(rename_dialog);
+			name_before_edit = gyb_->instruments.at(*id_for_edit)->name;
 			trigger_popup = false;
 		}
 
@@ -201,14 +349,194 @@ namespace MID3SMPS {
 			handler.idling.override_this_frame = true;
 			popup_was_opened = true;
 			ImGui::TextUnformatted("New instrument name");
-			auto &name = gyb_.instruments[*id_for_edit]->name;
-			ImGui::InputText("##New instrument name", &name);
+			// Edited on a copy, only a changed name is written to the bank
+			auto name = gyb_->instruments.at(*id_for_edit)->name;
+			if(ImGui::InputText("##New instrument name", &name)) {
+				gyb_.write().writable(*id_for_edit).name = std::move(name);
+			}
 		} else if(popup_was_opened) {
+			// The whole rename is one step, however many keys it took
+			if(const auto *renamed = gyb_->instruments.find(*id_for_edit)) {
+				journal_.record({*id_for_edit, std::move(name_before_edit), renamed->name});
+			}
 			id_for_edit = std::nullopt;
 			popup_was_opened = false;
+			changed(bank_changed_); // Trigrams come from the names
 		}
 
 	}
+
+	void ym2612_edit::render_search_results() {
+		const auto &search_results = search_results_.get();
+		const auto &index          = index_.get();
+		if(search_results.empty()) {
+			ImGui::TextDisabled("No matches");
+			return;
+		}
+		ImGuiListClipper clipper;
+		clipper.Begin(static_cast<int>(search_results.size()));
+		while(clipper.Step()) {
+			for(auto idx = static_cast<std::size_t>(clipper.DisplayStart); idx < static_cast<std::size_t>(clipper.DisplayEnd); idx++) {
+				const auto &[bank, id] = index[search_results[idx]];
+				const auto &name = gyb_->instruments.at(id)->name;
+				dear::WithID(static_cast<int>(id)) && [this, &bank, &id, &name, idx] {
+					if(ImGui::Selectable(name.c_str(), selected_instrument_id() == id || multi_selection_.contains(id))) {
+						click_instrument(bank, id, idx);
+					}
+					dear::ItemTooltip() && [this, &bank, &name] {
+						ImGui::Text("%s (%s)", name.c_str(), gyb_->banks->at(bank).c_str());
+					};
+				};
+			}
+		}
+	}
+	std::vector<instrument_index::row_t> ym2612_edit::search() {
+		TRACE_ZONE("Instrument search");
+		auto &index = index_.get();
+		for(const auto id : stale_index_rows_) {
+			if(const auto *patch = dynamic_cast<const fm_instrument *>(gyb_->instruments.find(id))) {
+				index.refresh(id, patch->operators);
+			}
+		}
+		stale_index_rows_.clear();
+		return index.search(instrument_index::query::parse(search_text_));
+	}
+
+	std::optional<M2S::batch_edit::target_t> ym2612_edit::selector_target(const std::size_t row) {
+		if(!search_text_.empty()) {
+			const auto &search_results = search_results_.get();
+			if(row >= search_results.size()) {
+				return std::nullopt;
+			}
+			const auto &[bank, id] = index_.get()[search_results[row]];
+			return std::pair{bank, id};
+		}
+		const auto &selector_rows = selector_rows_.get();
+		if(row >= selector_rows.size() || selector_rows[row].is_bank) {
+			return std::nullopt;
+		}
+		return std::pair{selector_rows[row].bank, selector_rows[row].id};
+	}
+
+	void ym2612_edit::click_instrument(const bank_key_t bank, const ins_key_t id, const std::size_t row) {
+		const auto &io = ImGui::GetIO();
+		if(io.KeyShift && selection_anchor_) {
+			const auto [first, last] = std::minmax(*selection_anchor_, row);
+			for(auto current = first; current <= last; current++) {
+				if(const auto target = selector_target(current)) {
+					multi_selection_.emplace(target->second, target->first);
+				}
+			}
+		} else if(io.KeyCtrl) {
+			if(multi_selection_.empty() && selected_id && selected_id->second != id) {
+				multi_selection_.emplace(selected_id->second, selected_id->first);
+			}
+			if(!multi_selection_.erase(id)) {
+				multi_selection_.emplace(id, bank);
+			}
+			selection_anchor_ = row;
+		} else {
+			multi_selection_.clear();
+			selection_anchor_ = row;
+		}
+		selected_id = {bank, id};
+		changed(selection_changed_);
+	}
+
+	void ym2612_edit::apply_batch(const M2S::batch_edit &edit) {
+		std::vector<M2S::batch_edit::target_t> targets;
+		targets.reserve(multi_selection_.size());
+		for(const auto &[id, bank] : multi_selection_) {
+			targets.emplace_back(bank, id);
+		}
+		auto deltas = edit.apply(gyb_, targets);
+		for(const auto &change : deltas) {
+			stale_index_rows_.insert(change.id);
+		}
+		journal_.record(std::move(deltas));
+		changed(registers_changed_);
+		begin_edit_capture(); // Already in the journal, don't record the selected patch's part of it again
+	}
+
+	void ym2612_edit::render_batch_edit() {
+		static constexpr auto batch_dialog = "##batch_edit_dialog";
+		using operation = M2S::batch_edit::operation;
+		static constexpr std::array operation_names = {"Set"sv, "Offset"sv, "Scale"sv, "Clamp"sv};
+
+		dear::Disabled(multi_selection_.size() < 2) && [this] {
+			if(ImGui::Button(fmt::format("Batch edit {} patches..", multi_selection_.size()).c_str())) {
+				ImGui::OpenPopup(batch_dialog);
+			}
+		};
+		if(!search_text_.empty()) {
+			ImGui::SameLine();
+			if(ImGui::Button("Select all")) {
+				const auto &index = index_.get();
+				for(const auto row : search_results_.get()) {
+					multi_selection_.emplace(index[row].id, index[row].bank);
+				}
+			}
+		}
+
+		dear::Popup(batch_dialog) && [this] {
+			handler.idling.override_this_frame = true;
+			auto &change = batch_change_;
+			ImGui::SetNextItemWidth(200);
+			dear::Combo{"Field", ym2612::string(change.target).data()} && [&change] {
+				for(const auto &current : list<ym2612::field>()) {
+					if(ImGui::Selectable(ym2612::string(current).data(), change.target == current)) {
+						change.target = current;
+					}
+				}
+			};
+			if(!ym2612::is_channel_field(change.target)) {
+				for(const auto &op : list<operators::op_id>()) {
+					bool enabled = (change.operators >> std::to_underlying(op) & 1) != 0;
+					if(ImGui::Checkbox(operators::string(op).data(), &enabled)) {
+						change.operators ^= static_cast<std::uint8_t>(1u << std::to_underlying(op));
+					}
+					ImGui::SameLine();
+				}
+				ImGui::NewLine();
+			}
+			ImGui::SetNextItemWidth(200);
+			dear::Combo{"Operation", operation_names[std::to_underlying(change.apply)].data()} && [&change] {
+				for(std::size_t idx = 0; idx < operation_names.size(); idx++) {
+					if(ImGui::Selectable(operation_names[idx].data(), std::to_underlying(change.apply) == idx)) {
+						change.apply = static_cast<operation>(idx);
+					}
+				}
+			};
+			ImGui::SetNextItemWidth(200);
+			switch(change.apply) {
+				case operation::set:
+				case operation::offset: ImGui::InputInt(change.apply == operation::set ? "Value" : "Amount", &change.amount);
+					break;
+				case operation::scale: ImGui::InputFloat("Factor", &change.factor, .1f, .5f, "%.2f");
+					break;
+				case operation::clamp: ImGui::InputScalar("Low", ImGuiDataType_U8, &change.low);
+					ImGui::SetNextItemWidth(200);
+					ImGui::InputScalar("High", ImGuiDataType_U8, &change.high);
+					break;
+				default: break;
+			}
+			if(ImGui::Button("Apply")) {
+				apply_batch({{change}, 0});
+			}
+
+			ImGui::Separator();
+			ImGui::SetNextItemWidth(200);
+			ImGui::InputInt("Semitones", &batch_transpose_);
+			batch_transpose_ = std::clamp(batch_transpose_, -127, 127);
+			if(ImGui::Button("Transpose")) {
+				apply_batch({{}, static_cast<std::int8_t>(batch_transpose_)});
+			}
+			dear::ItemTooltip() && [] {
+				ImGui::TextUnformatted("Moves the transposition of melody patches and the note of drum patches");
+			};
+		};
+	}
+
 	void ym2612_edit::render_instrument_mappings() {}
 
 	template<typename T, typename R = float>
@@ -224,29 +552,29 @@ namespace MID3SMPS {
 		vector[idx] = value;
 	}
 
-	void ym2612_edit::render_oscilloscope() {
-		static std::vector<float> adsr_data = {};
+	std::vector<float> ym2612_edit::build_envelope() const {
+		std::vector<float> adsr_data;
 		if(!has_selected_instrument()) {
-			std::fill(std::execution::par_unseq, adsr_data.begin(), adsr_data.end(), 0);
-		} else {
-			const auto &operators = selected_instrument().operators;
-			constexpr auto id     = operators::op_id::op4;
-			if(operators.attack_rate(id) == 0) {
-				goto skip_render;
-			}
-			float level = 0;
-			{
-				const float tl = normalize(127 - operators.total_level(id), 127.f);
-				float step = normalize(operators.attack_rate(id), 31.f);
-				step *= tl;
-				for(std::size_t idx = 0; level < tl; idx++) {
-					level = std::min(level + step, tl);
-					grow_and_insert(adsr_data, idx, level);
-				}
-			}
+			return adsr_data;
 		}
+		const auto &operators = selected_instrument().operators;
+		constexpr auto id     = operators::op_id::op4;
+		if(operators.attack_rate(id) == 0) {
+			return adsr_data; // Never rises
+		}
+		float level = 0;
+		const float tl = normalize(127 - operators.total_level(id), 127.f);
+		float step = normalize(operators.attack_rate(id), 31.f);
+		step *= tl;
+		for(std::size_t idx = 0; level < tl; idx++) {
+			level = std::min(level + step, tl);
+			grow_and_insert(adsr_data, idx, level);
+		}
+		return adsr_data;
+	}
 
-	skip_render:
+	void ym2612_edit::render_oscilloscope() {
+		const auto &adsr_data = envelope_.get();
 		ImGui::PlotLines("##Envelope", adsr_data.data(), static_cast<int>(adsr_data.size()), 0, nullptr, 0.f, 1.f, {-1, -1});
 	}
 
@@ -256,119 +584,18 @@ namespace MID3SMPS {
 		child_size.y = 0;
 		child_size.x *= 5.f / 7.f;
 		dear::Table{"Patch Editor Table 1", 5, table_flags, child_size} && [this] {
-			static constexpr auto row_count = 12;
-			//const auto availible_space = ImGui::GetContentRegionAvail();
-			//const auto cell_space = availible_space.y / row_count;
 			const auto column_0_width = ImGui::CalcTextSize("Amplitude Modulation");
 			ImGui::TableSetupColumn(nullptr, ImGuiTableColumnFlags_WidthFixed, column_0_width.x);
-			for(std::uint_fast8_t row = 0; row < row_count; row++) {
-				switch(row) {
-					case 0: {
-						ImGui::TableNextColumn();
-						render_lfo();
-						render_operator_headers();
-						break;
-					}
-					case 1: {
-						ImGui::TableNextColumn();
-						ImGui::TextUnformatted("Detune");
-						for(const auto &op_id : list<operators::op_id>()) {
-							ImGui::TableNextColumn();
-							render_detune(op_id);
-						}
-						break;
-					}
-					case 2: {
-						ImGui::TableNextColumn();
-						ImGui::TextUnformatted("Multiple");
-						for(const auto &op_id : list<operators::op_id>()) {
-							ImGui::TableNextColumn();
-							render_multiple(op_id);
-						}
-						break;
-					}
-					case 3: {
-						ImGui::TableNextColumn();
-						ImGui::TextUnformatted("Total Level");
-						for(const auto &op_id : list<operators::op_id>()) {
-							ImGui::TableNextColumn();
-							render_total_level(op_id);
-						}
-						break;
-					}
-					case 4: {
-						ImGui::TableNextColumn();
-						ImGui::TextUnformatted("Rate Scaling");
-						for(const auto &op_id : list<operators::op_id>()) {
-							ImGui::TableNextColumn();
-							render_rate_scaling(op_id);
-						}
-						break;
-					}
-					case 5: {
-						ImGui::TableNextColumn();
-						ImGui::TextUnformatted("Attack Rate");
-						for(const auto &op_id : list<operators::op_id>()) {
-							ImGui::TableNextColumn();
-							render_attack_rate(op_id);
-						}
-						break;
-					}
-					case 6: {
-						ImGui::TableNextColumn();
-						ImGui::TextUnformatted("Amplitude Modulation");
-						for(const auto &op_id : list<operators::op_id>()) {
-							ImGui::TableNextColumn();
-							render_amplitude_modulation(op_id);
-						}
-						break;
-					}
-					case 7: {
-						ImGui::TableNextColumn();
-						ImGui::TextUnformatted("Decay Rate");
-						for(const auto &op_id : list<operators::op_id>()) {
-							ImGui::TableNextColumn();
-							render_decay_rate(op_id);
-						}
-						break;
-					}
-					case 8: {
-						ImGui::TableNextColumn();
-						ImGui::TextUnformatted("Sustain Rate");
-						for(const auto &op_id : list<operators::op_id>()) {
-							ImGui::TableNextColumn();
-							render_sustain_rate(op_id);
-						}
-						break;
-					}
-					case 9: {
-						ImGui::TableNextColumn();
-						ImGui::TextUnformatted("Sustain Level");
-						for(const auto &op_id : list<operators::op_id>()) {
-							ImGui::TableNextColumn();
-							render_sustain_level(op_id);
-						}
-						break;
-					}
-					case 10: {
-						ImGui::TableNextColumn();
-						ImGui::TextUnformatted("Release Rate");
-						for(const auto &op_id : list<operators::op_id>()) {
-							ImGui::TableNextColumn();
-							render_release_rate(op_id);
-						}
-						break;
-					}
-					case 11: {
-						ImGui::TableNextColumn();
-						ImGui::TextUnformatted("SSG-EG");
-						for(const auto &op_id : list<operators::op_id>()) {
-							ImGui::TableNextColumn();
-							render_ssgeg(op_id);
-						}
-						break;
-					}
-					default: break;
+			ImGui::TableNextColumn();
+			render_lfo();
+			render_operator_headers();
+			// One row per operator field, in field order
+			for(const auto &desc : std::span(field_table).subspan(channel_field_count)) {
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(desc.name.data(), desc.name.data() + desc.name.size());
+				for(const auto &op_id : list<operators::op_id>()) {
+					ImGui::TableNextColumn();
+					render_field(desc, op_id);
 				}
 			}
 		};
@@ -379,17 +606,17 @@ namespace MID3SMPS {
 				switch(row) {
 					case 0:
 						ImGui::TableNextColumn();
-						render_ams();
+						render_channel_field(field::ams, false);
 						ImGui::TableNextColumn();
-						render_fms();
+						render_channel_field(field::fms, false);
 						break;
 					case 1:
 						ImGui::TableNextColumn();
-						render_feedback();
+						render_channel_field(field::feedback, true);
 						break;
 					case 2:
 						ImGui::TableNextColumn();
-						render_algorithm();
+						render_channel_field(field::algorithm, true);
 						break;
 					case 3:
 						ImGui::TableNextColumn();
@@ -436,19 +663,26 @@ namespace MID3SMPS {
 		const auto cursor_y = ImGui::GetCursorPosY();
 		const auto window_height = ImGui::GetWindowHeight();
 		last_space_remaining = window_height-cursor_y;
-		auto *current_window = ImGui::GetCurrentWindow();
-		auto &window_scale = current_window->FontWindowScale;
 		static constexpr float free_space_range = 17.f;
-		static constexpr float scale_diff = 0.04f;
-		// ReSharper disable once CppEntityAssignedButNoRead
-		if(last_space_remaining > free_space_range) {
-			window_scale += scale_diff;
-		} else if(last_space_remaining < 0) {
-			window_scale -= scale_diff;
-		} else {
+		static constexpr float min_scale = 0.5f;
+		static constexpr float max_scale = 4.f;
+		if(last_space_remaining >= 0 && last_space_remaining <= free_space_range) {
+			return;
+		}
+		// The content's height grows with the zoom, so the zoom that fills the window comes straight from this frame's layout
+		// instead of stepping towards it over many frames
+		const auto content_start = ImGui::GetCursorStartPos().y;
+		const auto used = cursor_y - content_start;
+		const auto available = window_height - content_start - free_space_range / 2;
+		if(used <= 0 || available <= 0) {
 			return;
 		}
-		handler.idling.override_this_frame = true; // Set the override temporarily so the screen can scale
+		const auto target = std::clamp(zoom_ * available / used, min_scale, max_scale);
+		if(std::abs(target - zoom_) < 0.001f) {
+			return; // Clamped, nothing more to gain
+		}
+		zoom_ = target;
+		handler.idling.override_this_frame = true; // One more frame to lay out at the new scale
 		//ImGui::DebugLog("Cursor Y: %f WindowHeight: %f Available space: %f\n", cursor_y, window_height, last_space_remaining);
 	}
 
@@ -457,15 +691,15 @@ namespace MID3SMPS {
 		ImGui::TextUnformatted("Not done yet, go away");
 	}
 
-	fm_instrument& ym2612_edit::selected_instrument() {
+	fm_instrument& ym2612_edit::writable_instrument() {
 		if(selected_id) {
-			return *dynamic_cast<fm_instrument*>(gyb_.instruments[selected_id->second].get());
+			return *dynamic_cast<fm_instrument*>(&gyb_.write().writable(selected_id->second));
 		}
 		return fm::empty_patch; // Patch editing is disabled if there is no patch selected
 	}
 	const fm_instrument& ym2612_edit::selected_instrument() const{
 		if(selected_id) {
-			return *dynamic_cast<fm_instrument*>(gyb_.instruments.at(selected_id->second).get());
+			return *dynamic_cast<const fm_instrument*>(gyb_->instruments.at(selected_id->second).get());
 		}
 		return fm::empty_patch;
 	}
@@ -477,13 +711,15 @@ namespace MID3SMPS {
 			hovered = true;
 		}
 		ImGui::SameLine();
-		auto &val = gyb_.default_LFO_speed;
+		// Only written when it changes, writing would unshare the bank from any snapshot of it
+		const auto val = gyb_->default_LFO_speed;
+		const auto key = ImGui::GetID("##LFO Value"); // Picking and scrolling through speeds undo in one go
 		ImGui::SetNextItemWidth(-1);
-		dear::Combo{"##LFO Value", gyb::string(val).data()} && [this, &val] {
+		dear::Combo{"##LFO Value", gyb::string(val).data()} && [this, &val, key] {
 			for (const auto &current : list<lfo>()){
-				const bool is_selected = gyb_.default_LFO_speed == current;
-				if (ImGui::Selectable(gyb::string(current).data(), is_selected)) {
-					val = current;
+				const bool is_selected = val == current;
+				if (ImGui::Selectable(gyb::string(current).data(), is_selected) && !is_selected) {
+					set_lfo(current, key);
 				}
 
 				if (is_selected) {
@@ -497,11 +733,17 @@ namespace MID3SMPS {
 		dear::Tooltip{hovered} && [] {
 			ImGui::TextUnformatted("Used to enable FMS and AMS to work for some simple vibrato and tremolo-like effects.");
 		};
-		if(const auto new_val = handle_combo_scroll(val)) {
-			val = *new_val;
+		if(const auto new_val = handle_combo_scroll(val); new_val && *new_val != val) {
+			set_lfo(*new_val, key);
 		}
 	}
 
+	void ym2612_edit::set_lfo(const lfo speed, const std::uint32_t key) {
+		const auto before = gyb_->default_LFO_speed;
+		gyb_.write().default_LFO_speed = speed;
+		journal_.record({{0, edit_journal::lfo_offset, std::to_underlying(before), std::to_underlying(speed)}}, key);
+	}
+
 	void ym2612_edit::render_operator_headers() {
 		for(const auto &op_id : list<operators::op_id>()) {
 			ImGui::TableNextColumn();
@@ -519,330 +761,76 @@ namespace MID3SMPS {
 		}
 	}
 
-	void ym2612_edit::render_detune(const operators::op_id &op_id) {
-		using oper = operators;
-		dear::WithID(&op_id) && [this, &op_id] {
-			ImGui::SetNextItemWidth(-1);
-			auto &op = selected_instrument().operators;
-			const auto val = op.detune(op_id);
-			dear::Combo{"##detune", oper::string(val).data()} && [&op, &op_id, &val] {
-				for (const auto &current : list<oper::detune_mode>()){
-					const bool is_selected = val == current;
-					if (ImGui::Selectable(oper::string(current).data(), is_selected)) {
-						op.detune(op_id, current);
+	// Fields with named values get a combo, scrolling moves through the names in order. The rest are plain numbers.
+	void ym2612_edit::render_field(const field_descriptor &desc, const operators::op_id &op_id) {
+		dear::WithID(&desc) && [this, &desc, &op_id] {
+			dear::WithID(&op_id) && [this, &desc, &op_id] {
+				const auto val = selected_instrument().operators.get(desc, op_id);
+				const auto set = [this, &desc, &op_id, val](const std::uint8_t value) {
+					if(value != val) {
+						writable_instrument().operators.set(desc, op_id, value);
 					}
-
-					if (is_selected) {
-						ImGui::SetItemDefaultFocus();
-					}
-				}
-			};
-			if(const auto new_val = handle_combo_scroll(val)) {
-				op.detune(op_id, *new_val);
-			}
-		};
-	}
-	void ym2612_edit::render_multiple(const operators::op_id &op_id) {
-		static constexpr std::uint8_t step = 0x1, step_fast = 16/4;
-		dear::WithID(&op_id) && [this, &op_id] {
-			auto &op = selected_instrument().operators;
-			auto val = op.multiple(op_id);
-			ImGui::SetNextItemWidth(-1);
-			if(ImGui::InputScalar("##multiple", ImGuiDataType_U8, &val, &step, &step_fast, num_format().data())) {
-				op.multiple(op_id, val);
-			}
-			if(const auto new_val = handle_combo_scroll(val, true)) {
-				op.multiple(op_id, *new_val);
-			}
-		};
-	}
-	void ym2612_edit::render_total_level(const operators::op_id &op_id) {
-		static constexpr std::uint8_t step = 0x1, step_fast = 128/4;
-		dear::WithID(&op_id) && [this, &op_id] {
-			auto &op = selected_instrument().operators;
-			auto val = op.total_level(op_id);
-			ImGui::SetNextItemWidth(-1);
-			if(ImGui::InputScalar("##total_level", ImGuiDataType_U8, &val, &step, &step_fast, num_format().data())) {
-				op.total_level(op_id, val);
-			}
-			if(const auto new_val = handle_combo_scroll(val, true)) {
-				op.total_level(op_id, *new_val);
-			}
-		};
-	}
-	void ym2612_edit::render_rate_scaling(const operators::op_id &op_id) {
-		using oper = operators;
-		dear::WithID(&op_id) && [this, &op_id] {
-			auto &op = selected_instrument().operators;
-			const auto val = op.rate_scaling(op_id);
-			ImGui::SetNextItemWidth(-1);
-			dear::Combo{"##rate_scaling",  oper::string(val).data()} && [&op, &op_id, &val] {
-				for (const auto &current : list<oper::rate_scaling_mode>()){
-					const bool is_selected = val == current;
-					if (ImGui::Selectable(oper::string(current).data(), is_selected)) {
-						op.rate_scaling(op_id, current);
+				};
+				using enum scroll_wheel_direction;
+				ImGui::SetNextItemWidth(-1);
+				if(desc.options.empty()) {
+					const std::uint8_t step = 0x1, step_fast = static_cast<std::uint8_t>((desc.max + 1) / 4);
+					auto new_val = val;
+					if(ImGui::InputScalar("##value", ImGuiDataType_U8, &new_val, &step, &step_fast, num_format().data())) {
+						set(std::min(new_val, desc.max));
 					}
-
-					if (is_selected) {
-						ImGui::SetItemDefaultFocus();
+					if(const auto scroll = handle_scroll(); scroll == positive && val < desc.max) {
+						set(static_cast<std::uint8_t>(val + 1));
+					} else if(scroll == negative && val > 0) {
+						set(static_cast<std::uint8_t>(val - 1));
 					}
+					return;
 				}
-			};
-			if(const auto new_val = handle_combo_scroll(val)) {
-				op.rate_scaling(op_id, *new_val);
-			}
-		};
-	}
-	void ym2612_edit::render_attack_rate(const operators::op_id &op_id) {
-		static constexpr std::uint8_t step = 0x1, step_fast = 32/4;
-		dear::WithID(&op_id) && [this, &op_id] {
-			auto &op = selected_instrument().operators;
-			auto val = op.attack_rate(op_id);
-			ImGui::SetNextItemWidth(-1);
-			if(ImGui::InputScalar("##attack_rate", ImGuiDataType_U8, &val, &step, &step_fast, num_format().data())) {
-				op.attack_rate(op_id, val);
-			}
-			if(const auto new_val = handle_combo_scroll(val, true)) {
-				op.attack_rate(op_id, *new_val);
-			}
-		};
-	}
-	void ym2612_edit::render_amplitude_modulation(const operators::op_id &op_id) {
-		static constexpr std::array values = {
-			"Disabled",
-			"Enabled"
-		};
-		dear::WithID(&op_id) && [this, &op_id] {
-			auto &op = selected_instrument().operators;
-			const auto val = op.amplitude_modulation(op_id);
-			ImGui::SetNextItemWidth(-1);
-			dear::Combo{"##amplitude_modulation", val ? values[1] : values[0]} && [&op, &op_id, &val] {
-				for (const auto &current : values){
-					const bool current_bool = current == values[1];
-					const bool is_selected = val == current_bool;
-					if (ImGui::Selectable(current, is_selected)) {
-						op.amplitude_modulation(op_id, current_bool);
-					}
 
-					if (is_selected) {
-						ImGui::SetItemDefaultFocus();
-					}
-				}
-			};
-			using enum scroll_wheel_direction;
-			if(const auto new_val = handle_scroll(); new_val != neutral) {
-				op.amplitude_modulation(op_id, !val);
-			}
-		};
-	}
-	void ym2612_edit::render_decay_rate(const operators::op_id &op_id) {
-		static constexpr std::uint8_t step = 0x1, step_fast = 32/4;
-		dear::WithID(&op_id) && [this, &op_id] {
-			auto &op = selected_instrument().operators;
-			auto val = op.decay_rate(op_id);
-			ImGui::SetNextItemWidth(-1);
-			if(ImGui::InputScalar("##decay_rate", ImGuiDataType_U8, &val, &step, &step_fast, num_format().data())) {
-				op.decay_rate(op_id, val);
-			}
-			if(const auto new_val = handle_combo_scroll(val, true)) {
-				op.decay_rate(op_id, *new_val);
-			}
-		};
-	}
-	void ym2612_edit::render_sustain_rate(const operators::op_id &op_id) {
-		static constexpr std::uint8_t step = 0x1, step_fast = 32/4;
-		dear::WithID(&op_id) && [this, &op_id] {
-			auto &op = selected_instrument().operators;
-			auto val = op.sustain_rate(op_id);
-			ImGui::SetNextItemWidth(-1);
-			if(ImGui::InputScalar("##sustain_rate", ImGuiDataType_U8, &val, &step, &step_fast, num_format().data())) {
-				op.sustain_rate(op_id, val);
-			}
-			if(const auto new_val = handle_combo_scroll(val, true)) {
-				op.sustain_rate(op_id, *new_val);
-			}
-		};
-	}
-	void ym2612_edit::render_sustain_level(const operators::op_id &op_id) {
-		static constexpr std::uint8_t step = 0x1, step_fast = 32/4;
-		dear::WithID(&op_id) && [this, &op_id] {
-			auto &op = selected_instrument().operators;
-			auto val = op.sustain_level(op_id);
-			ImGui::SetNextItemWidth(-1);
-			if(ImGui::InputScalar("##sustain_level", ImGuiDataType_U8, &val, &step, &step_fast, num_format().data())) {
-				op.sustain_level(op_id, val);
-			}
-			if(const auto new_val = handle_combo_scroll(val, true)) {
-				op.sustain_level(op_id, *new_val);
-			}
-		};
-	}
-	void ym2612_edit::render_release_rate(const operators::op_id &op_id) {
-		static constexpr std::uint8_t step = 0x1, step_fast = 32/4;
-		dear::WithID(&op_id) && [this, &op_id] {
-			auto &op = selected_instrument().operators;
-			auto val = op.release_rate(op_id);
-			ImGui::SetNextItemWidth(-1);
-			if(ImGui::InputScalar("##release_rate", ImGuiDataType_U8, &val, &step, &step_fast, num_format().data())) {
-				op.release_rate(op_id, val);
-			}
-			if(const auto new_val = handle_combo_scroll(val, true)) {
-				op.release_rate(op_id, *new_val);
-			}
-		};
-	}
-	void ym2612_edit::render_ssgeg(const operators::op_id &op_id) {
-		using oper = operators;
-		dear::WithID(&op_id) && [this, &op_id] {
-			auto &op = selected_instrument().operators;
-			const auto val = op.ssgeg(op_id);
-			ImGui::SetNextItemWidth(-1);
-			dear::Combo{"##ssgeg", oper::string(val).data()} && [&op, &op_id, &val] {
-				for (const auto &current : list<oper::ssgeg_mode>()){
-					const bool is_selected = val == current;
-					if (ImGui::Selectable(oper::string(current).data(), is_selected)) {
-						op.ssgeg(op_id, current);
-					}
+				dear::Combo{"##value", desc.option_name(val).data()} && [&set, &desc, &val] {
+					for(const auto &option : desc.options) {
+						const bool is_selected = val == option.value;
+						if(ImGui::Selectable(option.name.data(), is_selected)) {
+							set(option.value);
+						}
 
-					if (is_selected) {
-						ImGui::SetItemDefaultFocus();
+						if(is_selected) {
+							ImGui::SetItemDefaultFocus();
+						}
+					}
+				};
+				// A value that isn't one of the options scrolls to the first one
+				const auto current = std::ranges::find(desc.options, val, &field_choice::value);
+				if(const auto scroll = handle_scroll(); scroll == negative) {
+					if(const auto next = current == desc.options.end() ? desc.options.begin() : std::next(current); next != desc.options.end()) {
+						set(next->value);
 					}
+				} else if(scroll == positive && current != desc.options.begin() && current != desc.options.end()) {
+					set(std::prev(current)->value);
 				}
 			};
-			if(const auto new_val = handle_combo_scroll(val)) {
-				op.ssgeg(op_id, *new_val);
-			}
 		};
 	}
 
-	void ym2612_edit::render_ams() {
-		ImGui::TextUnformatted("AMS  ");
+	void ym2612_edit::render_channel_field(const field target, const bool own_column) {
+		const auto &desc = describe(target);
+		ImGui::TextUnformatted(desc.name.data(), desc.name.data() + desc.name.size());
 		bool hovered = false;
 		if (ImGui::IsItemHovered(default_hover_flags)){
 			hovered = true;
 		}
-		ImGui::SameLine();
-		using oper = operators;
-		static constexpr std::array strings = {
-			"0"sv,
-			"1.4"sv,
-			"5.9"sv,
-			"11.8"sv
-		};
-		auto &op = selected_instrument().operators;
-		const auto val = op.ams();
-		ImGui::SetNextItemWidth(-1);
-		dear::Combo{"##AMS value", strings[val].data()} && [&op] {
-			for (std::size_t i = 0; i < oper::ams_values.size(); i++){
-				const bool is_selected = op.ams() == i;
-				if (ImGui::Selectable(strings[i].data(), is_selected)) {
-					op.ams(static_cast<std::uint8_t>(i));
-				}
-
-				if (is_selected) {
-					ImGui::SetItemDefaultFocus();
-				}
-			}
-		};
-		if (ImGui::IsItemHovered(default_hover_flags)){
-			hovered = true;
-		}
-		dear::Tooltip{hovered} && [] {
-			ImGui::TextUnformatted("Amplitude modulation sensivity");
-		};
-		if(const auto new_val = handle_combo_scroll<oper::ams_values.size()>(op.ams())) {
-			op.ams(*new_val);
+		if(own_column) {
+			ImGui::TableNextColumn();
+		} else {
+			ImGui::SameLine();
 		}
-	}
-	void ym2612_edit::render_fms() {
-		ImGui::TextUnformatted("FMS  %");
-		bool hovered = false;
+		render_field(desc, operators::op_id::op1); // Channel fields ignore the operator
 		if (ImGui::IsItemHovered(default_hover_flags)){
 			hovered = true;
 		}
-		ImGui::SameLine();
-		using oper = operators;
-		static constexpr std::array strings = {
-			"0"sv,
-			"\u00b13.4"sv,
-			"\u00b16.7"sv,
-			"\u00b110"sv,
-			"\u00b114"sv,
-			"\u00b120"sv,
-			"\u00b140"sv,
-			"\u00b180"sv,
+		dear::Tooltip{hovered && !desc.description.empty()} && [&desc] {
+			ImGui::TextUnformatted(desc.description.data(), desc.description.data() + desc.description.size());
 		};
-		auto &op = selected_instrument().operators;
-		const auto val = op.fms();
-		ImGui::SetNextItemWidth(-1);
-		dear::Combo{"##FMS value", strings[val].data()} && [&op] {
-			for (std::size_t i = 0; i < oper::fms_values.size(); i++){
-				const bool is_selected = op.fms() == i;
-				if (ImGui::Selectable(strings[i].data(), is_selected)) {
-					op.fms(static_cast<std::uint8_t>(i));
-				}
-
-				if (is_selected) {
-					ImGui::SetItemDefaultFocus();
-				}
-			}
-		};
-		if (ImGui::IsItemHovered(default_hover_flags)){
-			hovered = true;
-		}
-		dear::Tooltip{hovered} && [] {
-			ImGui::TextUnformatted("Frequency modulation sensivity");
-		};
-		if(const auto new_val = handle_combo_scroll<oper::fms_values.size()>(op.fms())) {
-			op.fms(*new_val);
-		}
-	}
-	void ym2612_edit::render_feedback() {
-		ImGui::TextUnformatted("Feedback");
-		ImGui::TableNextColumn();
-		auto &op = selected_instrument().operators;
-		const auto val = op.feedback();
-		using oper = operators;
-		ImGui::SetNextItemWidth(-1);
-		dear::Combo{"##Feedback value", oper::string(val).data()} && [&op, &val] {
-			for (const auto &current : list<oper::feedback_mode>()){
-				const bool is_selected = val == current;
-				if (ImGui::Selectable(oper::string(current).data(), is_selected)) {
-					op.feedback(current);
-				}
-
-				if (is_selected) {
-					ImGui::SetItemDefaultFocus();
-				}
-			}
-		};
-		if(const auto new_val = handle_combo_scroll(val)) {
-			op.feedback(*new_val);
-		}
-	}
-
-	void ym2612_edit::render_algorithm() {
-		ImGui::TextUnformatted("Algorithm");
-		ImGui::TableNextColumn();
-		auto &op = selected_instrument().operators;
-		const auto val = op.algorithm();
-		using oper = operators;
-		ImGui::SetNextItemWidth(-1);
-		dear::Combo{"##Algorithm value", oper::string(val).data()} && [&op, &val] {
-			for (const auto &current : list<oper::algorithm_mode>()){
-				const bool is_selected = val == current;
-				if (ImGui::Selectable(oper::string(current).data(), is_selected)) {
-					op.algorithm(current);
-				}
-
-				if (is_selected) {
-					ImGui::SetItemDefaultFocus();
-				}
-			}
-		};
-		if(const auto new_val = handle_combo_scroll(val)) {
-			op.algorithm(*new_val);
-		}
 	}
 
 	void ym2612_edit::render_transposition() {
@@ -854,11 +842,20 @@ namespace MID3SMPS {
 		};
 	}
 
-	void ym2612_edit::render_registers(const std::uint_fast8_t current_row) const {
+	ym2612_edit::register_hex_t ym2612_edit::build_register_hex() const {
+		register_hex_t hex{};
+		const auto &registers = selected_instrument().operators.registers;
+		for(std::size_t idx = 0; idx < registers.size(); idx++) {
+			fmt::format_to_n(hex[idx].data(), 2, "{:02X}", registers[idx].value);
+		}
+		return hex;
+	}
+
+	void ym2612_edit::render_registers(const std::uint_fast8_t current_row) {
 		const std::uint_fast8_t offset = current_row * 8;
 		const std::uint_fast8_t max = current_row == 3 ? 6 : 8;
 		const auto width = ImGui::GetContentRegionAvail().x / 4;
-		auto &op = const_cast<operators &>(selected_instrument().operators); // InputScalar takes non-const pointer but can't actually write in this case
+		const auto &hex = register_hex_.get();
 		for(std::uint_fast8_t i = 0; i < max; i++) {
 			if(i == 4) {
 				ImGui::TableNextColumn();
@@ -866,7 +863,16 @@ namespace MID3SMPS {
 				ImGui::SameLine();
 			}
 			ImGui::SetNextItemWidth(width);
-			ImGui::InputScalar("##", ImGuiDataType_U8, &op.registers[offset + i], nullptr, nullptr, "%02X");
+			auto text = hex[offset + i];
+			dear::WithID(offset + i) && [&text, this, offset, i] {
+				if(ImGui::InputText("##", text.data(), text.size(), ImGuiInputTextFlags_CharsHexadecimal | ImGuiInputTextFlags_CharsUppercase)) {
+					std::uint8_t value = 0;
+					if(std::from_chars(text.data(), text.data() + std::strlen(text.data()), value, 16).ec == std::errc{}
+					   && value != selected_instrument().operators.registers[offset + i].value) {
+						writable_instrument().operators.registers[offset + i] = value; // Recorded and marked as changed at the end of the frame
+					}
+				}
+			};
 		}
 	}
 
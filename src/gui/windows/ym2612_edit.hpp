@@ -1,8 +1,17 @@
 #pragma once
 
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "gui/windows/window.hpp"
 #include "containers/files/mid2smps/gyb.hpp"
+#include "containers/files/mid2smps/batch_edit.hpp"
 #include "containers/chips/ym2612/operators.hpp"
+#include "containers/dirty_graph.hpp"
+#include "containers/edit_journal.hpp"
+#include "containers/instrument_index.hpp"
+#include "helpers/copy_on_write.hpp"
 
 namespace MID3SMPS {
 	using namespace std::string_view_literals;
@@ -23,9 +32,67 @@ namespace MID3SMPS {
 			return num_formats[0];
 		}
 		float last_space_remaining = 0;
+		float zoom_ = 1.f; // Font size relative to window_handler::base_font_size, scale_window fits it to the window
+
+		// Background jobs get snapshots of this instead of a copy, edits only copy what they change
+		copy_on_write<M2S::gyb> gyb_{};
+
+		// Edits are found by comparing the selected patch's registers before and after every frame
+		edit_journal journal_{};
+		std::optional<std::pair<ins_key_t, decltype(ym2612::operators::registers)>> frame_start_ = std::nullopt;
+		void begin_edit_capture();
+		void end_edit_capture();
+		void undo();
+		void redo();
+		void write_changes(const edit_journal::changes &step, bool undoing);
+		void set_lfo(ym2612::lfo speed, std::uint32_t key);
+
+		// What the derived data below is computed from. Whatever changes one of these marks it, which also asks for another frame
+		// since the change may come after the data was drawn this frame.
+		dirty_input bank_changed_{};      // Bank order and names, or a new bank altogether
+		dirty_input registers_changed_{}; // Registers of the selected patch, or the patches in stale_index_rows_
+		dirty_input selection_changed_{};
+		dirty_input open_banks_changed_{};
+		dirty_input search_changed_{};
+		void changed(dirty_input &input);
+
+		// The selector only draws the rows in view, this is what it draws them from
+		struct selector_row {
+			bank_key_t bank;
+			ins_key_t id;
+			bool is_bank;
+		};
+		std::unordered_set<bank_key_t> open_banks_{};
+		[[nodiscard]] std::vector<selector_row> build_selector_rows() const;
+		derived<std::vector<selector_row>> selector_rows_{[this] { return build_selector_rows(); }, {&bank_changed_, &open_banks_changed_}};
+
+		// Typing into the search box replaces the tree with a flat list of matches. The index is only rebuilt for a new bank or new names,
+		// edited patches have their rows refreshed before the next search.
+		std::string search_text_{};
+		std::unordered_set<ins_key_t> stale_index_rows_{};
+		derived<instrument_index> index_{[this] { return instrument_index(*gyb_); }, {&bank_changed_}};
+		[[nodiscard]] std::vector<instrument_index::row_t> search();
+		derived<std::vector<instrument_index::row_t>> search_results_{[this] { return search(); }, {&index_, &search_changed_, &registers_changed_}};
+		void render_search_results();
+
+		// Attack of operator 4, drawn by the oscilloscope
+		[[nodiscard]] std::vector<float> build_envelope() const;
+		derived<std::vector<float>> envelope_{[this] { return build_envelope(); }, {&selection_changed_, &registers_changed_}};
 
-		M2S::gyb gyb_{};
-		bool dirty_ = false;
+		// The selected patch's registers as hex digits for the register view
+		using register_hex_t = std::array<std::array<char, 3>, std::tuple_size_v<decltype(ym2612::operators::registers)>>;
+		[[nodiscard]] register_hex_t build_register_hex() const;
+		derived<register_hex_t> register_hex_{[this] { return build_register_hex(); }, {&selection_changed_, &registers_changed_}};
+
+		// Ctrl+click toggles patches, shift+click adds the rows up to the last click. Batch edits apply to all of them.
+		std::unordered_map<ins_key_t, bank_key_t> multi_selection_{};
+		std::optional<std::size_t> selection_anchor_ = std::nullopt; // Row of the last click, in the tree or the search results
+		M2S::batch_edit::field_change batch_change_{};
+		int batch_transpose_ = 0;
+		[[nodiscard]] std::optional<M2S::batch_edit::target_t> selector_target(std::size_t row);
+		void click_instrument(bank_key_t bank, ins_key_t id, std::size_t row);
+		void apply_batch(const M2S::batch_edit &edit);
+		void render_batch_edit();
 
 		void render_menu_bar();
 		void render_instrument_selection();
@@ -50,7 +117,8 @@ namespace MID3SMPS {
 		}
 		[[nodiscard]] instrument_bank::ins_order_t& selected_bank();
 		[[nodiscard]] const instrument_bank::ins_order_t& selected_bank() const;
-		[[nodiscard]] fm_instrument& selected_instrument();
+		// Reads go through the const one. The other unshares the bank and the patch from any snapshot, so it's only for changes a widget reported.
+		[[nodiscard]] fm_instrument& writable_instrument();
 		[[nodiscard]] const fm_instrument& selected_instrument() const;
 
 		void render_instrument_selector();
@@ -60,24 +128,10 @@ namespace MID3SMPS {
 		void render_lfo();
 		void render_operator_headers();
 
-		void render_detune					(const ym2612::operators::op_id &op_id);
-		void render_multiple				(const ym2612::operators::op_id &op_id);
-		void render_total_level				(const ym2612::operators::op_id &op_id);
-		void render_rate_scaling			(const ym2612::operators::op_id &op_id);
-		void render_attack_rate				(const ym2612::operators::op_id &op_id);
-		void render_amplitude_modulation	(const ym2612::operators::op_id &op_id);
-		void render_decay_rate				(const ym2612::operators::op_id &op_id);
-		void render_sustain_rate			(const ym2612::operators::op_id &op_id);
-		void render_sustain_level			(const ym2612::operators::op_id &op_id);
-		void render_release_rate			(const ym2612::operators::op_id &op_id);
-		void render_ssgeg					(const ym2612::operators::op_id &op_id);
-
-		void render_ams();
-		void render_fms();
-		void render_feedback();
-		void render_algorithm();
+		void render_field(const ym2612::field_descriptor &desc, const ym2612::operators::op_id &op_id);
+		void render_channel_field(ym2612::field target, bool own_column);
 		void render_transposition();
-		void render_registers(std::uint_fast8_t current_row) const;
+		void render_registers(std::uint_fast8_t current_row);
 
 		void scale_window();
 
@@ -95,6 +149,27 @@ namespace MID3SMPS {
 
 		friend class main_window;
 	public:
+		// Replaces the bank being edited, drops the selection and history since their IDs belong to the old bank
+		void set_bank(M2S::gyb &&bank);
+
+		// Whether the bank has changed since it was loaded or last saved
+		[[nodiscard]] bool modified() const noexcept {
+			return journal_.modified();
+		}
+
+		// The bank as it is right now, for reading on another thread while editing carries on
+		[[nodiscard]] std::shared_ptr<const M2S::gyb> snapshot() const noexcept {
+			return gyb_.snapshot();
+		}
+		// Where the edit history is, taken with a snapshot that gets saved
+		[[nodiscard]] edit_journal::position_t history_position() noexcept {
+			return journal_.position();
+		}
+		// The snapshot taken at position was saved
+		void mark_saved(const edit_journal::position_t position) noexcept {
+			journal_.mark_saved(position);
+		}
+
 		void render() override;
 		void on_close() override;
 		[[nodiscard]] constexpr const char* window_title() const override{
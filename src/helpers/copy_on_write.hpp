@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace MID3SMPS {
+	// True if owner holds the only reference, so what it points at can be written in place.
+	// use_count() is a relaxed load. Another thread's last read of the value happens before it drops its reference, which
+	// shared_ptr does with a release decrement, and the acquire fence pairs with that so the write can't overtake the read.
+	// The count can't go back up behind the caller's back since only the owner hands out new references.
+	template<typename T>
+	[[nodiscard]] bool sole_owner(const std::shared_ptr<T> &owner) noexcept {
+		if(owner.use_count() > 1) {
+			return false;
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return true;
+	}
+
+	// A value that can be handed to other threads as read-only snapshots without copying it.
+	// Taking a snapshot copies a pointer, the owner's next write() copies the value first if a snapshot still holds it.
+	// Only the owning thread may call write(), snapshots can be read from anywhere.
+	template<typename T>
+	class copy_on_write {
+		std::shared_ptr<T> value_;
+
+	public:
+		copy_on_write() : value_(std::make_shared<T>()) {}
+		explicit copy_on_write(T &&value) : value_(std::make_shared<T>(std::move(value))) {}
+
+		copy_on_write &operator=(T &&value) {
+			value_ = std::make_shared<T>(std::move(value));
+			return *this;
+		}
+
+		[[nodiscard]] const T &operator*() const noexcept {
+			return *value_;
+		}
+
+		[[nodiscard]] const T *operator->() const noexcept {
+			return value_.get();
+		}
+
+		[[nodiscard]] T &write() {
+			if(!sole_owner(value_)) {
+				value_ = std::make_shared<T>(std::as_const(*value_));
+			}
+			return *value_;
+		}
+
+		[[nodiscard]] std::shared_ptr<const T> snapshot() const noexcept {
+			return value_;
+		}
+	};
+}
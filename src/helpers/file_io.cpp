@@ -0,0 +1,38 @@
+#include "file_io.hpp"
+
+#include <fstream>
+#include <stdexcept>
+#include <fmt/core.h>
+
+namespace MID3SMPS {
+	std::vector<std::uint8_t> read_file(const fs::path &path) {
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if(!file) {
+			throw std::runtime_error(fmt::format("Failed to open {}", path.string()));
+		}
+		std::vector<std::uint8_t> data(static_cast<std::size_t>(file.tellg()));
+		file.seekg(0);
+		if(!file.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size()))) {
+			throw std::runtime_error(fmt::format("Failed to read {}", path.string()));
+		}
+		return data;
+	}
+
+	void write_file_atomically(const fs::path &path, const std::span<const std::uint8_t> data) {
+		if(path.has_parent_path()) {
+			fs::create_directories(path.parent_path());
+		}
+		auto temp_path = path;
+		temp_path += ".tmp";
+		{
+			std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+			if(!file) {
+				throw std::runtime_error(fmt::format("Failed to open {} for writing", temp_path.string()));
+			}
+			if(!file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size())) || !file.flush()) {
+				throw std::runtime_error(fmt::format("Failed to write {}", temp_path.string()));
+			}
+		}
+		fs::rename(temp_path, path);
+	}
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace MID3SMPS {
+	namespace fs = std::filesystem;
+
+	// The whole file in one read, throws if it can't be opened
+	[[nodiscard]] std::vector<std::uint8_t> read_file(const fs::path &path);
+
+	// Writes to a temporary file next to path and renames it over path, so readers only ever see the old or the new contents.
+	// Creates the parent directories, throws if anything fails.
+	void write_file_atomically(const fs::path &path, std::span<const std::uint8_t> data);
+}
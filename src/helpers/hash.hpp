@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+namespace MID3SMPS {
+	// 64-bit FNV-1a. Not for hash tables, for cache keys that have to come out the same from one run (and build) to the next.
+	class fnv1a {
+		static constexpr std::uint64_t offset_basis = 0xCBF29CE484222325;
+		static constexpr std::uint64_t prime        = 0x100000001B3;
+
+		std::uint64_t state_ = offset_basis;
+
+	public:
+		constexpr fnv1a() = default;
+
+		constexpr fnv1a &add(const std::span<const std::uint8_t> bytes) noexcept {
+			for(const auto byte : bytes) {
+				state_ = (state_ ^ byte) * prime;
+			}
+			return *this;
+		}
+
+		// Integers and floats are hashed as their bytes in memory
+		template<typename T> requires std::is_arithmetic_v<T>
+		constexpr fnv1a &add(const T value) noexcept {
+			const auto bytes = std::bit_cast<std::array<std::uint8_t, sizeof(T)>>(value);
+			return add(bytes);
+		}
+
+		[[nodiscard]] constexpr std::uint64_t value() const noexcept {
+			return state_;
+		}
+	};
+}
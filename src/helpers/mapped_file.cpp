@@ -0,0 +1,101 @@
+#include "mapped_file.hpp"
+
+#include <stdexcept>
+#include <utility>
+#include <fmt/core.h>
+
+#ifdef __WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace MID3SMPS {
+#ifdef __WIN32
+	mapped_file::mapped_file(const fs::path &path) {
+		const auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if(file == INVALID_HANDLE_VALUE) {
+			throw std::runtime_error(fmt::format("Failed to open {}", path.string()));
+		}
+		LARGE_INTEGER size{};
+		if(!GetFileSizeEx(file, &size)) {
+			CloseHandle(file);
+			throw std::runtime_error(fmt::format("Failed to read the size of {}", path.string()));
+		}
+		size_ = static_cast<std::size_t>(size.QuadPart);
+		if(size_ != 0) { // Windows refuses to map empty files
+			mapping_ = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if(mapping_ != nullptr) {
+				data_ = static_cast<const std::uint8_t *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+			}
+		}
+		CloseHandle(file); // The mapping keeps the file open
+		if(size_ != 0 && data_ == nullptr) {
+			if(mapping_ != nullptr) {
+				CloseHandle(mapping_);
+			}
+			throw std::runtime_error(fmt::format("Failed to map {}", path.string()));
+		}
+	}
+
+	mapped_file::~mapped_file() {
+		if(data_ != nullptr) {
+			UnmapViewOfFile(data_);
+		}
+		if(mapping_ != nullptr) {
+			CloseHandle(mapping_);
+		}
+	}
+#else
+	mapped_file::mapped_file(const fs::path &path) {
+		const int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if(file < 0) {
+			throw std::runtime_error(fmt::format("Failed to open {}", path.string()));
+		}
+		struct stat info{};
+		if(fstat(file, &info) != 0) {
+			close(file);
+			throw std::runtime_error(fmt::format("Failed to read the size of {}", path.string()));
+		}
+		size_ = static_cast<std::size_t>(info.st_size);
+		if(size_ != 0) { // Mapping nothing is an error
+			void *mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file, 0);
+			if(mapped == MAP_FAILED) {
+				close(file);
+				throw std::runtime_error(fmt::format("Failed to map {}", path.string()));
+			}
+			data_ = static_cast<const std::uint8_t *>(mapped);
+		}
+		close(file); // The mapping keeps the file open
+	}
+
+	mapped_file::~mapped_file() {
+		if(data_ != nullptr) {
+			munmap(const_cast<std::uint8_t *>(data_), size_);
+		}
+	}
+#endif
+
+	mapped_file::mapped_file(mapped_file &&other) noexcept :
+		data_(std::exchange(other.data_, nullptr)),
+		size_(std::exchange(other.size_, 0))
+#ifdef __WIN32
+		, mapping_(std::exchange(other.mapping_, nullptr))
+#endif
+	{}
+
+	mapped_file &mapped_file::operator=(mapped_file &&other) noexcept {
+		if(this != &other) {
+			mapped_file old(std::move(*this));
+			data_ = std::exchange(other.data_, nullptr);
+			size_ = std::exchange(other.size_, 0);
+#ifdef __WIN32
+			mapping_ = std::exchange(other.mapping_, nullptr);
+#endif
+		}
+		return *this;
+	}
+}
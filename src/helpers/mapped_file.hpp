@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace MID3SMPS {
+	namespace fs = std::filesystem;
+
+	// A whole file mapped read-only into memory, pages are only read from disk once something touches them
+	class mapped_file {
+		const std::uint8_t *data_ = nullptr;
+		std::size_t size_         = 0;
+#ifdef __WIN32
+		void *mapping_ = nullptr;
+#endif
+
+	public:
+		mapped_file() = default;
+		// Throws if the file can't be opened or mapped
+		explicit mapped_file(const fs::path &path);
+		mapped_file(const mapped_file &) = delete;
+		mapped_file(mapped_file &&other) noexcept;
+		mapped_file &operator=(const mapped_file &) = delete;
+		mapped_file &operator=(mapped_file &&other) noexcept;
+		~mapped_file();
+
+		[[nodiscard]] std::span<const std::uint8_t> bytes() const noexcept {
+			return {data_, size_};
+		}
+	};
+}
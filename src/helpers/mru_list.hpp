@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace MID3SMPS {
+	// Most recently used list holding up to a fixed number of distinct values.
+	// Touching a value appends it to a ring and points the hash index at the new slot, the slot it had before goes stale
+	// instead of being erased, so touches are O(1). Stale slots are squeezed out when the ring fills up, which happens
+	// at most once every capacity touches.
+	template<typename T, typename Hash = std::hash<T>>
+	class mru_list {
+		struct slot {
+			T value{};
+			std::uint64_t stamp = 0;
+		};
+
+		std::vector<slot> ring_;
+		std::size_t oldest_ = 0; // Ring index of the oldest slot, stale or not
+		std::size_t used_   = 0;
+		std::size_t capacity_;
+		std::uint64_t next_stamp_ = 0;
+		std::unordered_map<T, std::uint64_t, Hash> index_; // Each value's stamp, only the slot with it is live
+
+		[[nodiscard]] bool live(const slot &entry) const {
+			const auto found = index_.find(entry.value);
+			return found != index_.end() && found->second == entry.stamp;
+		}
+
+		[[nodiscard]] slot &at(const std::size_t age) noexcept {
+			return ring_[(oldest_ + age) % ring_.size()];
+		}
+
+		[[nodiscard]] const slot &at(const std::size_t age) const noexcept {
+			return ring_[(oldest_ + age) % ring_.size()];
+		}
+
+		void drop_oldest() {
+			at(0) = {};
+			oldest_ = (oldest_ + 1) % ring_.size();
+			used_--;
+		}
+
+		void compact() {
+			std::vector<slot> kept(ring_.size());
+			std::size_t count = 0;
+			for(std::size_t age = 0; age < used_; age++) {
+				if(auto &entry = at(age); live(entry)) {
+					kept[count++] = std::move(entry);
+				}
+			}
+			ring_   = std::move(kept);
+			oldest_ = 0;
+			used_   = count;
+		}
+
+	public:
+		explicit mru_list(const std::size_t capacity) : ring_(capacity * 2), capacity_(capacity) {
+			index_.reserve(capacity + 1);
+		}
+
+		// Makes value the most recent, adding it if it isn't there and forgetting the oldest one if that goes over capacity
+		void touch(T value) {
+			if(capacity_ == 0) {
+				return;
+			}
+			index_.insert_or_assign(value, next_stamp_);
+			if(used_ == ring_.size()) {
+				compact(); // At most capacity slots are live, so this always frees some
+			}
+			at(used_++) = {std::move(value), next_stamp_++};
+			while(index_.size() > capacity_) {
+				while(!live(at(0))) {
+					drop_oldest();
+				}
+				index_.erase(at(0).value);
+				drop_oldest();
+			}
+		}
+
+		bool erase(const T &value) {
+			return index_.erase(value) != 0; // Its slot is stale now
+		}
+
+		void clear() {
+			ring_.assign(ring_.size(), {});
+			oldest_ = used_ = 0;
+			index_.clear();
+		}
+
+		[[nodiscard]] bool contains(const T &value) const {
+			return index_.contains(value);
+		}
+
+		[[nodiscard]] std::size_t size() const noexcept {
+			return index_.size();
+		}
+
+		[[nodiscard]] bool empty() const noexcept {
+			return index_.empty();
+		}
+
+		[[nodiscard]] std::size_t capacity() const noexcept {
+			return capacity_;
+		}
+
+		// Calls visit with every value, most recent first
+		template<typename F>
+		void for_each(F &&visit) const {
+			for(std::size_t age = used_; age-- > 0;) {
+				if(const auto &entry = at(age); live(entry)) {
+					visit(entry.value);
+				}
+			}
+		}
+
+		[[nodiscard]] std::vector<T> items() const {
+			std::vector<T> result;
+			result.reserve(size());
+			for_each([&](const T &value) { result.push_back(value); });
+			return result;
+		}
+	};
+}
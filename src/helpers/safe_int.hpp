@@ -2,7 +2,10 @@
 
 #include <concepts>
 #include <cstdint>
+#include <limits>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 namespace MID3SMPS {
 	template<std::integral From, std::integral To>
@@ -20,21 +23,161 @@ namespace MID3SMPS {
 	static_assert(!safe_promote_v<std::uint8_t, std::int8_t>);
 	static_assert(!safe_promote_v<std::uint16_t, std::uint8_t>);
 
+	// How safe_int does arithmetic. Every operation goes through one of these, so swapping the policy swaps every check.
+	namespace safe_int_policy {
+		// What the underlying type does, results that don't fit are truncated. Compiles to the plain integer operation.
+		struct wrapping {
+			static constexpr bool checks = false;
+
+			template<std::integral To, std::integral From>
+			[[nodiscard, gnu::always_inline]] static constexpr To narrow(const From value) noexcept {
+				return static_cast<To>(value);
+			}
+
+			template<std::integral T>
+			[[nodiscard, gnu::always_inline]] static constexpr T add(const T lhs, const T rhs) noexcept {
+				return static_cast<T>(lhs + rhs);
+			}
+
+			template<std::integral T>
+			[[nodiscard, gnu::always_inline]] static constexpr T subtract(const T lhs, const T rhs) noexcept {
+				return static_cast<T>(lhs - rhs);
+			}
+
+			template<std::integral T>
+			[[nodiscard, gnu::always_inline]] static constexpr T multiply(const T lhs, const T rhs) noexcept {
+				return static_cast<T>(lhs * rhs);
+			}
+
+			template<std::integral T>
+			[[nodiscard, gnu::always_inline]] static constexpr T divide(const T lhs, const T rhs) noexcept {
+				return static_cast<T>(lhs / rhs);
+			}
+
+			template<std::integral T>
+			[[nodiscard, gnu::always_inline]] static constexpr T remainder(const T lhs, const T rhs) noexcept {
+				return static_cast<T>(lhs % rhs);
+			}
+
+			template<std::integral T>
+			[[nodiscard, gnu::always_inline]] static constexpr T shift_left(const T value, const T count) noexcept {
+				return static_cast<T>(value << count);
+			}
+
+			template<std::integral T>
+			[[nodiscard, gnu::always_inline]] static constexpr T shift_right(const T value, const T count) noexcept {
+				return static_cast<T>(value >> count);
+			}
+		};
+
+		// Throws std::overflow_error for anything that wouldn't fit: a result, a value converted in, a shift past the width
+		// or a division by zero. In a constant expression that's a compile error instead.
+		struct checked {
+			static constexpr bool checks = true;
+
+			template<std::integral To, std::integral From>
+			[[nodiscard]] static constexpr To narrow(const From value) {
+				if constexpr(std::is_same_v<From, bool> || std::is_same_v<From, char>) {
+					return narrow<To>(static_cast<int>(value)); // in_range only takes the integer types
+				} else if(!std::in_range<To>(value)) {
+					throw std::overflow_error("Value doesn't fit in safe_int");
+				}
+				return static_cast<To>(value);
+			}
+
+			template<std::integral T>
+			[[nodiscard]] static constexpr T add(const T lhs, const T rhs) {
+				T result{};
+				if(__builtin_add_overflow(lhs, rhs, &result)) {
+					throw std::overflow_error("safe_int addition overflowed");
+				}
+				return result;
+			}
+
+			template<std::integral T>
+			[[nodiscard]] static constexpr T subtract(const T lhs, const T rhs) {
+				T result{};
+				if(__builtin_sub_overflow(lhs, rhs, &result)) {
+					throw std::overflow_error("safe_int subtraction overflowed");
+				}
+				return result;
+			}
+
+			template<std::integral T>
+			[[nodiscard]] static constexpr T multiply(const T lhs, const T rhs) {
+				T result{};
+				if(__builtin_mul_overflow(lhs, rhs, &result)) {
+					throw std::overflow_error("safe_int multiplication overflowed");
+				}
+				return result;
+			}
+
+			template<std::integral T>
+			[[nodiscard]] static constexpr T divide(const T lhs, const T rhs) {
+				if(rhs == 0) {
+					throw std::overflow_error("safe_int division by zero");
+				}
+				if constexpr(std::is_signed_v<T>) {
+					if(lhs == std::numeric_limits<T>::min() && rhs == -1) {
+						throw std::overflow_error("safe_int division overflowed");
+					}
+				}
+				return static_cast<T>(lhs / rhs);
+			}
+
+			template<std::integral T>
+			[[nodiscard]] static constexpr T remainder(const T lhs, const T rhs) {
+				static_cast<void>(divide(lhs, rhs)); // Fails for the same operands
+				return static_cast<T>(lhs % rhs);
+			}
+
+			template<std::integral T>
+			[[nodiscard]] static constexpr T shift_left(const T value, const T count) {
+				check_shift(count);
+				if(std::cmp_less(value, 0) || value > (std::numeric_limits<T>::max() >> count)) {
+					throw std::overflow_error("safe_int left shift overflowed");
+				}
+				return static_cast<T>(value << count);
+			}
+
+			template<std::integral T>
+			[[nodiscard]] static constexpr T shift_right(const T value, const T count) {
+				check_shift(count);
+				return static_cast<T>(value >> count);
+			}
+
+		private:
+			template<std::integral T>
+			static constexpr void check_shift(const T count) {
+				if(std::cmp_less(count, 0) || std::cmp_greater_equal(count, std::numeric_limits<T>::digits)) {
+					throw std::overflow_error("safe_int shift count is out of range");
+				}
+			}
+		};
+
+		// Debug builds check, release builds get the plain operations
+		#ifdef DEBUG
+		using default_policy = checked;
+		#else
+		using default_policy = wrapping;
+		#endif
+	}
+
 	// ReSharper disable CppNonExplicitConversionOperator
 	// ReSharper disable CppNonExplicitConvertingConstructor
-	template<std::integral Int>
+	template<std::integral Int, typename Policy = safe_int_policy::default_policy>
 	struct safe_int {
-		using value_type = std::remove_cvref_t<Int>;
+		using value_type  = std::remove_cvref_t<Int>;
+		using policy_type = Policy;
 
 		value_type value{};
 
 		template<std::integral T> requires std::is_convertible_v<T, value_type>
-		constexpr safe_int(T underlying_) noexcept : value(static_cast<value_type>(underlying_)) {}
+		constexpr safe_int(T underlying_) noexcept(!Policy::checks) : value(Policy::template narrow<value_type>(underlying_)) {}
 
-		template<std::integral T>
-		constexpr explicit(!safe_promote_v<T, value_type>) safe_int(const safe_int<T> &other) noexcept {
-			value = static_cast<value_type>(other.value); // Promote safely OR explicitly
-		}
+		template<std::integral T, typename P>
+		constexpr explicit(!safe_promote_v<T, value_type>) safe_int(const safe_int<T, P> &other) noexcept(!Policy::checks) :
+			value(Policy::template narrow<value_type>(other.value)) {} // Promote safely OR explicitly
 
 		constexpr safe_int(value_type underlying_) noexcept : value(underlying_) {}
 		constexpr safe_int() = default;
@@ -58,23 +201,23 @@ namespace MID3SMPS {
 		}
 
 		constexpr safe_int operator+(const safe_int &rhs) const {
-			return static_cast<value_type>(value + rhs.value);
+			return Policy::add(value, rhs.value);
 		}
 
 		constexpr safe_int operator-(const safe_int &rhs) const {
-			return static_cast<value_type>(value - rhs.value);
+			return Policy::subtract(value, rhs.value);
 		}
 
 		constexpr safe_int operator*(const safe_int &rhs) const {
-			return static_cast<value_type>(value * rhs.value);
+			return Policy::multiply(value, rhs.value);
 		}
 
 		constexpr safe_int operator/(const safe_int &rhs) const {
-			return static_cast<value_type>(value / rhs.value);
+			return Policy::divide(value, rhs.value);
 		}
 
 		constexpr safe_int operator%(const safe_int &rhs) const {
-			return static_cast<value_type>(value % rhs.value);
+			return Policy::remainder(value, rhs.value);
 		}
 
 		constexpr safe_int operator&(const safe_int &rhs) const {
@@ -90,11 +233,11 @@ namespace MID3SMPS {
 		}
 
 		constexpr safe_int operator<<(const safe_int &rhs) const {
-			return static_cast<value_type>(value << rhs.value);
+			return Policy::shift_left(value, rhs.value);
 		}
 
 		constexpr safe_int operator>>(const safe_int &rhs) const {
-			return static_cast<value_type>(value >> rhs.value);
+			return Policy::shift_right(value, rhs.value);
 		}
 
 		constexpr safe_int operator~() const {
@@ -102,156 +245,144 @@ namespace MID3SMPS {
 		}
 
 		constexpr safe_int &operator++() {
-			++value;
+			value = Policy::add(value, value_type{1});
 			return *this;
 		}
 
 		constexpr safe_int &operator--() {
-			--value;
+			value = Policy::subtract(value, value_type{1});
 			return *this;
 		}
 
 		constexpr safe_int operator++(int) {
 			const auto copy = *this;
-			++value;
+			++*this;
 			return copy;
 		}
 
 		constexpr safe_int operator--(int) {
 			const auto copy = *this;
-			--value;
+			--*this;
 			return copy;
 		}
 
 		constexpr safe_int &operator +=(const safe_int &rhs) {
-			*this = this->operator+(rhs);
+			value = operator+(rhs).value;
 			return *this;
 		}
 
 		constexpr safe_int &operator -=(const safe_int &rhs) {
-			*this = this->operator-(rhs);
+			value = operator-(rhs).value;
 			return *this;
 		}
 
 		constexpr safe_int &operator *=(const safe_int &rhs) {
-			*this = this->operator*(rhs);
+			value = operator*(rhs).value;
 			return *this;
 		}
 
 		constexpr safe_int &operator /=(const safe_int &rhs) {
-			*this = this->operator/(rhs);
+			value = operator/(rhs).value;
 			return *this;
 		}
 
 		constexpr safe_int &operator %=(const safe_int &rhs) {
-			*this = this->operator%(rhs);
+			value = operator%(rhs).value;
 			return *this;
 		}
 
 		constexpr safe_int &operator &=(const safe_int &rhs) {
-			*this = this->operator&(rhs);
+			value = operator&(rhs).value;
 			return *this;
 		}
 
 		constexpr safe_int &operator ^=(const safe_int &rhs) {
-			*this = this->operator^(rhs);
+			value = operator^(rhs).value;
 			return *this;
 		}
 
 		constexpr safe_int &operator |=(const safe_int &rhs) {
-			*this = this->operator|(rhs);
+			value = operator|(rhs).value;
 			return *this;
 		}
 
 		constexpr safe_int &operator <<=(const safe_int &rhs) {
-			*this = this->operator<<(rhs);
+			value = operator<<(rhs).value;
 			return *this;
 		}
 
 		constexpr safe_int &operator >>=(const safe_int &rhs) {
-			*this = this->operator>>(rhs);
+			value = operator>>(rhs).value;
 			return *this;
 		}
 
 		template<std::integral T> requires std::is_convertible_v<T, value_type>
 		constexpr safe_int operator+(const T &rhs) const {
-			return static_cast<value_type>(value + static_cast<value_type>(rhs));
+			return Policy::add(value, Policy::template narrow<value_type>(rhs));
 		}
 
 		template<std::integral T> requires std::is_convertible_v<T, value_type>
 		constexpr safe_int operator-(const T &rhs) const {
-			return static_cast<value_type>(value - static_cast<value_type>(rhs));
+			return Policy::subtract(value, Policy::template narrow<value_type>(rhs));
 		}
 
 		template<std::integral T> requires std::is_convertible_v<T, value_type>
 		constexpr safe_int operator*(const T &rhs) const {
-			return static_cast<value_type>(value * static_cast<value_type>(rhs));
+			return Policy::multiply(value, Policy::template narrow<value_type>(rhs));
 		}
 
 		template<std::integral T> requires std::is_convertible_v<T, value_type>
 		constexpr safe_int operator/(const T &rhs) const {
-			return static_cast<value_type>(value / static_cast<value_type>(rhs));
+			return Policy::divide(value, Policy::template narrow<value_type>(rhs));
 		}
 
 		template<std::integral T> requires std::is_convertible_v<T, value_type>
 		constexpr safe_int operator%(const T &rhs) const {
-			return static_cast<value_type>(value % static_cast<value_type>(rhs));
+			return Policy::remainder(value, Policy::template narrow<value_type>(rhs));
 		}
 
 		template<std::integral T> requires std::is_convertible_v<T, value_type>
 		constexpr safe_int operator&(const T &rhs) const {
-			return static_cast<value_type>(value & static_cast<value_type>(rhs));
+			return static_cast<value_type>(value & Policy::template narrow<value_type>(rhs));
 		}
 
 		template<std::integral T> requires std::is_convertible_v<T, value_type>
 		constexpr safe_int operator^(const T &rhs) const {
-			return static_cast<value_type>(value ^ static_cast<value_type>(rhs));
+			return static_cast<value_type>(value ^ Policy::template narrow<value_type>(rhs));
 		}
 
 		template<std::integral T> requires std::is_convertible_v<T, value_type>
 		constexpr safe_int operator|(const T &rhs) const {
-			return static_cast<value_type>(value | static_cast<value_type>(rhs));
+			return static_cast<value_type>(value | Policy::template narrow<value_type>(rhs));
 		}
 
 		template<std::integral T> requires std::is_convertible_v<T, value_type>
 		constexpr safe_int operator<<(const T &rhs) const {
-			return static_cast<value_type>(value << static_cast<value_type>(rhs));
+			return Policy::shift_left(value, Policy::template narrow<value_type>(rhs));
 		}
 
 		template<std::integral T> requires std::is_convertible_v<T, value_type>
 		constexpr safe_int operator>>(const T &rhs) const {
-			return static_cast<value_type>(value >> static_cast<value_type>(rhs));
+			return Policy::shift_right(value, Policy::template narrow<value_type>(rhs));
 		}
 
 		template<std::integral T> requires std::is_convertible_v<T, value_type>
-		constexpr safe_int operator <<=(const T &rhs) {
-			value = static_cast<value_type>(value << static_cast<value_type>(rhs));
-			return value;
+		constexpr safe_int &operator <<=(const T &rhs) {
+			value = Policy::shift_left(value, Policy::template narrow<value_type>(rhs));
+			return *this;
 		}
 
 		template<std::integral T> requires std::is_convertible_v<T, value_type>
-		constexpr safe_int operator >>=(const T &rhs) {
-			value = static_cast<value_type>(value >> static_cast<value_type>(rhs));
-			return value;
-		}
-
-		// Boilerplate
-		constexpr safe_int(const safe_int &other) : value(other.value) {}
-		constexpr safe_int(safe_int &&other) noexcept : value(std::move(other.value)) {}
-
-		constexpr safe_int &operator=(const safe_int &other) {
-			if(this == &other)
-				return *this;
-			value = other.value;
+		constexpr safe_int &operator >>=(const T &rhs) {
+			value = Policy::shift_right(value, Policy::template narrow<value_type>(rhs));
 			return *this;
 		}
 
-		constexpr safe_int &operator=(safe_int &&other) noexcept {
-			if(this == &other)
-				return *this;
-			value = std::move(other.value);
-			return *this;
-		}
+		// Defaulted so it stays trivially copyable, arrays of registers copy with memcpy and pass in registers
+		constexpr safe_int(const safe_int &other)            = default;
+		constexpr safe_int(safe_int &&other) noexcept        = default;
+		constexpr safe_int &operator=(const safe_int &other) = default;
+		constexpr safe_int &operator=(safe_int &&other)      = default;
 
 		template<std::integral T> requires std::is_convertible_v<T, value_type>
 		constexpr auto operator<=>(const T &rhs) const {
@@ -282,5 +413,10 @@ namespace MID3SMPS {
 	};
 	// ReSharper restore CppNonExplicitConversionOperator
 	// ReSharper restore CppNonExplicitConvertingConstructor
+
+	// Whichever policy is in use it has to cost nothing over the integer it wraps
+	static_assert(sizeof(safe_int<std::uint8_t>) == sizeof(std::uint8_t));
+	static_assert(std::is_trivially_copyable_v<safe_int<std::uint8_t, safe_int_policy::wrapping>>);
+	static_assert(std::is_trivially_copyable_v<safe_int<std::uint8_t, safe_int_policy::checked>>);
 }
 
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <optional>
+#include <span>
+#include <type_traits>
+
+namespace MID3SMPS {
+	// Wait-free queue between exactly one producer thread and one consumer thread, nothing in it allocates or locks
+	template<typename T, std::size_t Capacity> requires (std::has_single_bit(Capacity) && std::is_trivially_copyable_v<T>)
+	class spsc_queue {
+		static constexpr std::size_t mask = Capacity - 1;
+		static constexpr std::size_t cache_line = 64;
+
+		std::array<T, Capacity> items_{};
+		alignas(cache_line) std::atomic<std::size_t> head_ = 0; // Next slot to read, owned by the consumer
+		alignas(cache_line) std::atomic<std::size_t> tail_ = 0; // Next slot to write, owned by the producer
+
+	public:
+		// Producer side, false when the queue is full
+		bool push(const T &item) noexcept {
+			const auto tail = tail_.load(std::memory_order_relaxed);
+			if(tail - head_.load(std::memory_order_acquire) == Capacity) {
+				return false;
+			}
+			items_[tail & mask] = item;
+			tail_.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Producer side, pushes as many items from the front as fit and returns how many that was
+		std::size_t push(const std::span<const T> items) noexcept {
+			const auto tail  = tail_.load(std::memory_order_relaxed);
+			const auto count = std::min(items.size(), Capacity - (tail - head_.load(std::memory_order_acquire)));
+			for(std::size_t idx = 0; idx < count; idx++) {
+				items_[(tail + idx) & mask] = items[idx];
+			}
+			tail_.store(tail + count, std::memory_order_release);
+			return count;
+		}
+
+		// Consumer side
+		std::optional<T> pop() noexcept {
+			const auto head = head_.load(std::memory_order_relaxed);
+			if(head == tail_.load(std::memory_order_acquire)) {
+				return std::nullopt;
+			}
+			const auto item = items_[head & mask];
+			head_.store(head + 1, std::memory_order_release);
+			return item;
+		}
+
+		// Consumer side, fills the front of out with as many items as there are and returns how many that was
+		std::size_t pop(const std::span<T> out) noexcept {
+			const auto head  = head_.load(std::memory_order_relaxed);
+			const auto count = std::min(out.size(), tail_.load(std::memory_order_acquire) - head);
+			for(std::size_t idx = 0; idx < count; idx++) {
+				out[idx] = items_[(head + idx) & mask];
+			}
+			head_.store(head + count, std::memory_order_release);
+			return count;
+		}
+
+		[[nodiscard]] bool empty() const noexcept {
+			return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+		}
+
+		[[nodiscard]] static constexpr std::size_t capacity() noexcept {
+			return Capacity;
+		}
+	};
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <charconv>
+#include <concepts>
+#include <optional>
+#include <string_view>
+
+// Small pieces shared by the parsers for mid2smps' text files
+namespace MID3SMPS {
+	[[nodiscard]] constexpr bool is_blank(const char character) noexcept {
+		return character == ' ' || character == '\t' || character == '\r' || character == '\n' || character == '\v' || character == '\f';
+	}
+
+	[[nodiscard]] constexpr std::string_view trim(std::string_view text) noexcept {
+		while(!text.empty() && is_blank(text.front())) {
+			text.remove_prefix(1);
+		}
+		while(!text.empty() && is_blank(text.back())) {
+			text.remove_suffix(1);
+		}
+		return text;
+	}
+
+	// Removes the first blank separated word from text and returns it
+	[[nodiscard]] constexpr std::string_view take_word(std::string_view &text) noexcept {
+		text           = trim(text);
+		std::size_t end = 0;
+		while(end < text.size() && !is_blank(text[end])) {
+			end++;
+		}
+		const auto word = text.substr(0, end);
+		text            = trim(text.substr(end));
+		return word;
+	}
+
+	// Decimal, or hexadecimal after 0x or $. The whole of text has to be the number.
+	template<std::integral T>
+	[[nodiscard]] constexpr std::optional<T> parse_number(std::string_view text) noexcept {
+		int base = 10;
+		if(text.starts_with("0x") || text.starts_with("0X")) {
+			text.remove_prefix(2);
+			base = 16;
+		} else if(text.starts_with('$')) {
+			text.remove_prefix(1);
+			base = 16;
+		}
+		T value{};
+		const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value, base);
+		if(text.empty() || error != std::errc{} || end != text.data() + text.size()) {
+			return std::nullopt;
+		}
+		return value;
+	}
+
+	// Walks text a line at a time, counting from 1. A last line without a newline still counts, carriage returns are dropped.
+	class text_lines {
+		std::string_view rest_;
+		std::size_t number_ = 0;
+
+	public:
+		constexpr explicit text_lines(const std::string_view text) noexcept : rest_(text) {}
+
+		[[nodiscard]] constexpr bool next(std::string_view &line) noexcept {
+			if(rest_.empty()) {
+				return false;
+			}
+			number_++;
+			const auto end = rest_.find('\n');
+			line           = rest_.substr(0, end);
+			rest_.remove_prefix(end == std::string_view::npos ? rest_.size() : end + 1);
+			if(line.ends_with('\r')) {
+				line.remove_suffix(1);
+			}
+			return true;
+		}
+
+		[[nodiscard]] constexpr std::size_t number() const noexcept {
+			return number_;
+		}
+	};
+}
@@ -0,0 +1,125 @@
+#include "trace.hpp"
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <fmt/format.h>
+
+namespace MID3SMPS::trace {
+	namespace {
+		static_assert(std::has_single_bit(capacity));
+
+		// Every field is atomic so a snapshot taken while zones are being submitted is never a data race.
+		// sequence is odd while the slot is written and tells the reader whether what it copied is consistent.
+		struct slot {
+			std::atomic<std::uint64_t> sequence{0};
+			std::atomic<const char *> name{nullptr};
+			std::atomic<std::uint64_t> start{0};
+			std::atomic<std::uint64_t> duration{0};
+			std::atomic<std::uint32_t> frame{0};
+			std::atomic<std::uint16_t> thread{0};
+			std::atomic<std::uint16_t> depth{0};
+		};
+
+		std::array<slot, capacity> ring{};
+		std::atomic<std::uint64_t> head{0};
+		std::atomic<std::uint32_t> current_frame{0};
+		std::atomic<std::uint16_t> next_thread{0};
+
+		const auto epoch = std::chrono::steady_clock::now();
+
+		std::uint16_t thread_number() noexcept {
+			thread_local const std::uint16_t number = next_thread.fetch_add(1, std::memory_order_relaxed);
+			return number;
+		}
+
+		void write_escaped(std::ofstream &file, const std::string_view text) {
+			for(const char character : text) {
+				if(character == '"' || character == '\\') {
+					file.put('\\');
+				}
+				file.put(character);
+			}
+		}
+	}
+
+	std::uint64_t now() noexcept {
+		return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+	}
+
+	std::uint16_t &thread_depth() noexcept {
+		thread_local std::uint16_t depth = 0;
+		return depth;
+	}
+
+	void submit(const char *name, const std::uint64_t start, const std::uint16_t depth) noexcept {
+		const auto end   = now();
+		const auto index = head.fetch_add(1, std::memory_order_relaxed);
+		auto &target     = ring[index & (capacity - 1)];
+		target.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		target.name.store(name, std::memory_order_relaxed);
+		target.start.store(start, std::memory_order_relaxed);
+		target.duration.store(end - start, std::memory_order_relaxed);
+		target.frame.store(current_frame.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		target.thread.store(thread_number(), std::memory_order_relaxed);
+		target.depth.store(depth, std::memory_order_relaxed);
+		target.sequence.store(index * 2 + 2, std::memory_order_release);
+	}
+
+	void new_frame() noexcept {
+		current_frame.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	std::uint32_t frame() noexcept {
+		return current_frame.load(std::memory_order_relaxed);
+	}
+
+	std::vector<record> snapshot() {
+		const auto end   = head.load(std::memory_order_acquire);
+		const auto begin = end > capacity ? end - capacity : 0;
+		std::vector<record> records;
+		records.reserve(end - begin);
+		for(auto index = begin; index < end; index++) {
+			const auto &source  = ring[index & (capacity - 1)];
+			const auto sequence = source.sequence.load(std::memory_order_acquire);
+			if(sequence != index * 2 + 2) {
+				continue; // Still being written, or already reused by a newer zone
+			}
+			const record copy{
+				.name = source.name.load(std::memory_order_relaxed),
+				.start = source.start.load(std::memory_order_relaxed),
+				.duration = source.duration.load(std::memory_order_relaxed),
+				.frame = source.frame.load(std::memory_order_relaxed),
+				.thread = source.thread.load(std::memory_order_relaxed),
+				.depth = source.depth.load(std::memory_order_relaxed),
+			};
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(source.sequence.load(std::memory_order_relaxed) == sequence) {
+				records.push_back(copy);
+			}
+		}
+		return records;
+	}
+
+	void export_chrome(const fs::path &path, const std::span<const record> records) {
+		std::ofstream file(path);
+		if(!file) {
+			throw std::runtime_error(fmt::format("Could not open {} for writing", path.string()));
+		}
+		file << R"({"displayTimeUnit":"ms","traceEvents":[)";
+		bool first = true;
+		for(const auto &zone : records) {
+			file << (first ? "\n" : ",\n") << R"({"name":")";
+			write_escaped(file, zone.name);
+			// Chrome wants microseconds, fractions are allowed
+			file << fmt::format(R"(","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f},"args":{{"frame":{}}}}})",
+			                    zone.thread, static_cast<double>(zone.start) / 1000., static_cast<double>(zone.duration) / 1000., zone.frame);
+			first = false;
+		}
+		file << "\n]}\n";
+	}
+}
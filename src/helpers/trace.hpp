@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+// Scoped timing zones. Build with MID3SMPS_TRACING defined to record them, otherwise TRACE_ZONE compiles to nothing.
+//	TRACE_ZONE("Load GYB");
+#ifdef MID3SMPS_TRACING
+	#define MID3SMPS_TRACE_CONCAT_IMPL(a, b) a##b
+	#define MID3SMPS_TRACE_CONCAT(a, b) MID3SMPS_TRACE_CONCAT_IMPL(a, b)
+	#define TRACE_ZONE(name) const ::MID3SMPS::trace::zone MID3SMPS_TRACE_CONCAT(trace_zone_, __LINE__){name}
+	#define TRACE_FRAME() ::MID3SMPS::trace::new_frame()
+#else
+	#define TRACE_ZONE(name) static_cast<void>(0)
+	#define TRACE_FRAME() static_cast<void>(0)
+#endif
+
+namespace MID3SMPS::trace {
+	namespace fs = std::filesystem;
+
+	#ifdef MID3SMPS_TRACING
+	constexpr bool enabled = true;
+	#else
+	constexpr bool enabled = false;
+	#endif
+
+	static constexpr std::size_t capacity = 1 << 14; // Zones kept before the oldest get overwritten
+
+	struct record {
+		const char *name;        // Must be a string literal, only the pointer is stored
+		std::uint64_t start;     // Nanoseconds since the first zone
+		std::uint64_t duration;  // Nanoseconds
+		std::uint32_t frame;     // Frame the zone ended in
+		std::uint16_t thread;    // Small per-thread number, 0 is whoever traced first (normally the main thread)
+		std::uint16_t depth;     // Zones open on the same thread when this one started
+	};
+
+	[[nodiscard]] std::uint64_t now() noexcept;
+	void submit(const char *name, std::uint64_t start, std::uint16_t depth) noexcept;
+	[[nodiscard]] std::uint16_t &thread_depth() noexcept;
+
+	void new_frame() noexcept;
+	[[nodiscard]] std::uint32_t frame() noexcept;
+
+	// Copies what's in the ring buffer, oldest first. Zones being written at the same time are skipped.
+	[[nodiscard]] std::vector<record> snapshot();
+	// Chrome's about:tracing / Perfetto JSON format
+	void export_chrome(const fs::path &path, std::span<const record> records);
+
+	class zone {
+		const char *name_;
+		std::uint64_t start_;
+		std::uint16_t depth_;
+
+	public:
+		explicit zone(const char *name) noexcept : name_(name), start_(now()), depth_(thread_depth()++) {}
+		zone(const zone &) = delete;
+		zone &operator=(const zone &) = delete;
+
+		~zone() {
+			--thread_depth();
+			submit(name_, start_, depth_);
+		}
+	};
+}
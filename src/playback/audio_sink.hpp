@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+namespace MID3SMPS::playback {
+	// Destination for rendered audio, called from whichever thread renders the preview.
+	// A sink that plays in real time blocks in write while it's full, which is what keeps preview_player at the device's pace.
+	class audio_sink {
+	public:
+		virtual void write(std::span<const std::int16_t> stereo) = 0;
+		virtual void flush() {}
+		// Drops whatever was written but hasn't been heard yet, so a seek or stop doesn't wait for it to play out
+		virtual void discard() {}
+
+		audio_sink()                   = default;
+		audio_sink(const audio_sink &) = delete;
+		audio_sink &operator=(const audio_sink &) = delete;
+		virtual ~audio_sink()          = default;
+	};
+}
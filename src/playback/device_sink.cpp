@@ -0,0 +1,74 @@
+#include "device_sink.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <fmt/core.h>
+#include <miniaudio.h>
+
+namespace MID3SMPS::playback {
+	namespace {
+		static_assert(std::is_same_v<ma_uint32, std::uint32_t>, "pull has to match ma_device_data_proc");
+
+		// How often write looks for room again in a full buffer, well under what the device takes in one go
+		constexpr std::chrono::milliseconds poll_interval{2};
+	}
+
+	device_sink::device_sink(const std::uint32_t sample_rate) : device_(std::make_unique<ma_device>()) {
+		auto config              = ma_device_config_init(ma_device_type_playback);
+		config.playback.format   = ma_format_s16;
+		config.playback.channels = 2;
+		config.sampleRate        = sample_rate;
+		config.dataCallback      = &device_sink::pull;
+		config.pUserData         = this;
+
+		if(const auto result = ma_device_init(nullptr, &config, device_.get()); result != MA_SUCCESS) {
+			throw std::runtime_error(fmt::format("Couldn't open the audio device: {}", ma_result_description(result)));
+		}
+		if(const auto result = ma_device_start(device_.get()); result != MA_SUCCESS) {
+			ma_device_uninit(device_.get());
+			throw std::runtime_error(fmt::format("Couldn't start the audio device: {}", ma_result_description(result)));
+		}
+	}
+
+	device_sink::~device_sink() {
+		ma_device_uninit(device_.get()); // Stops the device and waits for pull to return
+	}
+
+	void device_sink::pull(ma_device *device, void *output, const void *, const std::uint32_t frames) {
+		auto &sink = *static_cast<device_sink *>(device->pUserData);
+		const std::span out(static_cast<std::int16_t *>(output), static_cast<std::size_t>(frames) * 2);
+
+		if(sink.discard_.load(std::memory_order_acquire)) {
+			std::array<std::int16_t, 256> dropped{};
+			while(sink.samples_.pop(dropped) != 0) {}
+			sink.discard_.store(false, std::memory_order_release);
+		}
+		// Whatever the preview hasn't rendered in time plays as silence
+		const auto played = sink.samples_.pop(out);
+		std::ranges::fill(out.subspan(played), std::int16_t{0});
+	}
+
+	void device_sink::write(std::span<const std::int16_t> stereo) {
+		while(!stereo.empty()) {
+			// Nothing goes in until the device has dropped what was there before a discard
+			if(!discard_.load(std::memory_order_acquire)) {
+				stereo = stereo.subspan(samples_.push(stereo));
+				if(stereo.empty()) {
+					break;
+				}
+			}
+			if(!ma_device_is_started(device_.get())) {
+				return; // The device went away, nothing would ever make room
+			}
+			std::this_thread::sleep_for(poll_interval);
+		}
+	}
+
+	void device_sink::discard() {
+		discard_.store(true, std::memory_order_release);
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "audio_sink.hpp"
+#include "helpers/spsc_queue.hpp"
+
+struct ma_device;
+
+namespace MID3SMPS::playback {
+	// Plays through the default output device with miniaudio, which resamples to whatever rate the device runs at.
+	// The device's thread pulls from a lock-free buffer, write waits while that buffer is full.
+	class device_sink final : public audio_sink {
+	public:
+		static constexpr std::size_t buffer_frames = 4096; // About 80ms at the chip's rate, how far ahead of the speakers the preview can get
+
+	private:
+		spsc_queue<std::int16_t, buffer_frames * 2> samples_{};
+		std::atomic<bool> discard_ = false; // Set by discard, cleared by the device once it has emptied the buffer
+		std::unique_ptr<ma_device> device_;
+
+		static void pull(ma_device *device, void *output, const void *input, std::uint32_t frames);
+
+	public:
+		// Throws if there's no device to play on
+		explicit device_sink(std::uint32_t sample_rate);
+		~device_sink() override;
+
+		void write(std::span<const std::int16_t> stereo) override;
+		void discard() override;
+	};
+}
@@ -0,0 +1,3 @@
+// miniaudio is a single header, this is the one place its implementation gets compiled
+#define MINIAUDIO_IMPLEMENTATION
+#include <miniaudio.h>
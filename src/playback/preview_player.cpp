@@ -0,0 +1,84 @@
+#include "preview_player.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "helpers/trace.hpp"
+
+namespace MID3SMPS::playback {
+	namespace {
+		constexpr std::chrono::milliseconds idle_wait{10};
+	}
+
+	preview_player::preview_player(std::unique_ptr<song_preview> song, audio_sink &sink)
+		: song_(std::move(song)), sink_(sink), event_count_(song_->event_count()), length_(song_->length()) {
+		position_.store(song_->position(), std::memory_order_relaxed);
+		cursor_.store(song_->cursor(), std::memory_order_relaxed);
+		thread_ = std::thread(&preview_player::run, this);
+	}
+
+	preview_player::~preview_player() {
+		quit_.store(true, std::memory_order_relaxed);
+		if(thread_.joinable()) {
+			thread_.join();
+		}
+	}
+
+	void preview_player::apply(const command &next) {
+		switch(next.type) {
+			case command_type::play:
+				if(song_->finished()) {
+					song_->seek(0);
+				}
+				playing_.store(true, std::memory_order_relaxed);
+				break;
+			case command_type::pause:
+				playing_.store(false, std::memory_order_relaxed);
+				sink_.discard();
+				break;
+			case command_type::stop:
+				playing_.store(false, std::memory_order_relaxed);
+				song_->seek(0);
+				sink_.discard();
+				break;
+			case command_type::seek:
+				song_->seek(next.event);
+				sink_.discard();
+				break;
+			default: break;
+		}
+		position_.store(song_->position(), std::memory_order_relaxed);
+		cursor_.store(song_->cursor(), std::memory_order_relaxed);
+	}
+
+	void preview_player::run() {
+		std::vector<std::int16_t> block(block_frames * 2);
+
+		while(!quit_.load(std::memory_order_relaxed)) {
+			while(const auto next = commands_.pop()) {
+				apply(*next);
+			}
+			if(!playing_.load(std::memory_order_relaxed)) {
+				std::this_thread::sleep_for(idle_wait);
+				continue;
+			}
+
+			{
+				TRACE_ZONE("Preview block");
+				// Stops right at the end of the release tail, like render_to
+				const auto frames = std::min<std::uint64_t>(block_frames, length_ - std::min(length_, song_->position()));
+				const auto out    = std::span{block}.first(frames * 2);
+				song_->render(out);
+				sink_.write(out);
+			}
+			position_.store(song_->position(), std::memory_order_relaxed);
+			cursor_.store(song_->cursor(), std::memory_order_relaxed);
+			if(song_->finished()) {
+				playing_.store(false, std::memory_order_relaxed);
+				sink_.flush();
+			}
+		}
+		sink_.discard();
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "helpers/spsc_queue.hpp"
+#include "song_preview.hpp"
+
+namespace MID3SMPS::playback {
+	// Runs a song_preview on its own audio thread. The sink sets the pace, a device_sink takes blocks as fast as they're heard.
+	// The GUI only talks to it through a lock-free command queue and reads the position back through atomics.
+	class preview_player {
+	public:
+		static constexpr std::size_t block_frames = 1024;
+
+		enum class command_type : std::uint8_t {
+			play,
+			pause,
+			stop,
+			seek,
+		};
+
+		struct command {
+			command_type type;
+			std::size_t event = 0; // Only used by seek
+		};
+
+	private:
+		std::unique_ptr<song_preview> song_;
+		audio_sink &sink_;
+		spsc_queue<command, 64> commands_{};
+		const std::size_t event_count_;
+		const std::uint64_t length_;
+
+		std::atomic<bool> quit_ = false;
+		std::atomic<bool> playing_ = false;
+		std::atomic<std::uint64_t> position_ = 0;
+		std::atomic<std::size_t> cursor_ = 0;
+		std::thread thread_;
+
+		void run();
+		void apply(const command &next);
+
+	public:
+		preview_player(std::unique_ptr<song_preview> song, audio_sink &sink);
+		preview_player(const preview_player &) = delete;
+		preview_player &operator=(const preview_player &) = delete;
+		~preview_player();
+
+		// False if the audio thread is too far behind to take more commands
+		bool send(const command &next) noexcept {
+			return commands_.push(next);
+		}
+
+		// Starts over if the song had finished
+		bool play() noexcept {
+			return send({command_type::play});
+		}
+
+		bool pause() noexcept {
+			return send({command_type::pause});
+		}
+
+		// Pauses and goes back to the start
+		bool stop() noexcept {
+			return send({command_type::stop});
+		}
+
+		bool seek(const std::size_t event) noexcept {
+			return send({command_type::seek, event});
+		}
+
+		[[nodiscard]] bool playing() const noexcept {
+			return playing_.load(std::memory_order_relaxed);
+		}
+
+		// Output sample the audio thread has rendered up to
+		[[nodiscard]] std::uint64_t position() const noexcept {
+			return position_.load(std::memory_order_relaxed);
+		}
+
+		// Next MIDI event to be played
+		[[nodiscard]] std::size_t cursor() const noexcept {
+			return cursor_.load(std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] constexpr std::size_t event_count() const noexcept {
+			return event_count_;
+		}
+
+		// In output samples, including the release tail
+		[[nodiscard]] constexpr std::uint64_t length() const noexcept {
+			return length_;
+		}
+	};
+}
@@ -0,0 +1,357 @@
+#include "song_preview.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "conversion/tempo_solver.hpp"
+
+namespace MID3SMPS::playback {
+	using op_id = ym2612::operators::op_id;
+
+	namespace {
+		namespace cc {
+			constexpr std::uint8_t bank_msb        = 0;
+			constexpr std::uint8_t volume          = 7;
+			constexpr std::uint8_t pan             = 10;
+			constexpr std::uint8_t expression      = 11;
+			constexpr std::uint8_t bank_lsb        = 32;
+			constexpr std::uint8_t reset_all       = 121;
+			constexpr std::uint8_t all_notes_off   = 123;
+		}
+
+		constexpr double bend_range = 2.; // Semitones
+		constexpr double db_per_total_level = 0.75;
+		constexpr double db_per_psg_step    = 2.;
+
+		struct timed_event {
+			midi::tick_t tick;
+			std::uint8_t status;
+			std::uint8_t data1;
+			std::uint8_t data2;
+		};
+
+		[[nodiscard]] std::span<const op_id> carriers(const ym2612::operators::algorithm_mode algorithm) {
+			static constexpr std::array all = {op_id::op1, op_id::op2, op_id::op3, op_id::op4};
+			using enum ym2612::operators::algorithm_mode;
+			switch(algorithm) {
+				case mode4: {
+					static constexpr std::array ops = {op_id::op2, op_id::op4};
+					return ops;
+				}
+				case mode5:
+				case mode6: {
+					static constexpr std::array ops = {op_id::op2, op_id::op3, op_id::op4};
+					return ops;
+				}
+				case mode7: return all;
+				default: return std::span{all}.subspan(3);
+			}
+		}
+
+		[[nodiscard]] std::uint8_t pan_bits(const std::uint8_t pan) {
+			if(pan < 43) {
+				return 0x80;
+			}
+			if(pan > 85) {
+				return 0x40;
+			}
+			return 0xC0;
+		}
+	}
+
+	song_preview::song_preview(const midi::event_store &events, const M2S::gyb &bank) {
+		resolve_instruments(bank);
+
+		std::vector<timed_event> merged;
+		merged.reserve(events.event_count());
+		for(std::size_t track_idx = 0; track_idx < events.track_count(); track_idx++) {
+			const auto track = events.track(track_idx);
+			midi::tick_t tick = 0;
+			for(std::size_t idx = 0; idx < track.size(); idx++) {
+				tick += track.delta[idx];
+				if(track.status[idx] < midi::status::sysex) {
+					merged.push_back({tick, track.status[idx], track.data1[idx], track.data2[idx]});
+				}
+			}
+		}
+		std::ranges::stable_sort(merged, {}, &timed_event::tick);
+
+		when_.reserve(merged.size());
+		status_.reserve(merged.size());
+		data1_.reserve(merged.size());
+		data2_.reserve(merged.size());
+
+		const auto map        = conversion::tempo_map(events);
+		const double ppq      = std::max<double>(events.ticks_per_quarter(), 1);
+		std::size_t segment   = 0;
+		double segment_start  = 0; // In samples
+		for(const auto &[tick, status, data1, data2] : merged) {
+			while(segment + 1 < map.size() && map[segment + 1].tick <= tick) {
+				segment_start += (map[segment + 1].tick - map[segment].tick) / ppq * map[segment].us_per_quarter / 1'000'000. * sample_rate;
+				++segment;
+			}
+			const auto offset = (tick - map[segment].tick) / ppq * map[segment].us_per_quarter / 1'000'000. * sample_rate;
+			when_.push_back(static_cast<std::uint64_t>(std::llround(segment_start + offset)));
+			status_.push_back(status);
+			data1_.push_back(data1);
+			data2_.push_back(data2);
+		}
+	}
+
+	void song_preview::resolve_instruments(const M2S::gyb &bank) {
+		// Copy every patch the maps can reach so the preview doesn't hold onto the bank
+		const auto resolve = [&, this](const M2S::gyb::instrument_map &source, resolved_map &destination, const bool drums) {
+			for(std::size_t key = 0; key < source.size(); key++) {
+				for(const auto &entry : source[key]) {
+					const auto *patch = bank.find_patch(source, static_cast<std::uint8_t>(key), entry.bank_msb, entry.bank_lsb);
+					if(patch == nullptr) {
+						continue;
+					}
+					destination[key].push_back({entry.bank_msb, entry.bank_lsb, static_cast<std::uint16_t>(patches_.size())});
+					patches_.push_back({
+						.operators = patch->operators,
+						.transposition = drums ? std::int8_t{0} : patch->instrument_transposition,
+						.drum_note = drums ? patch->default_drum_note : std::uint8_t{0}
+					});
+				}
+			}
+		};
+		resolve(*bank.melody_map, melody_, false);
+		resolve(*bank.drum_map, drums_, true);
+	}
+
+	std::uint16_t song_preview::find_patch(const resolved_map &map, const std::uint8_t key, const std::uint8_t bank_msb, const std::uint8_t bank_lsb) const {
+		std::uint16_t fallback = no_patch;
+		for(const auto &entry : map[key & 0x7F]) {
+			const bool msb_matches = entry.bank_msb == bank_msb || entry.bank_msb == M2S::gyb::map_entry::all;
+			const bool lsb_matches = entry.bank_lsb == bank_lsb || entry.bank_lsb == M2S::gyb::map_entry::all;
+			if(msb_matches && lsb_matches) {
+				return entry.patch;
+			}
+			if(entry.bank_msb == 0 && fallback == no_patch) {
+				fallback = entry.patch;
+			}
+		}
+		return fallback;
+	}
+
+	template<std::size_t Count>
+	std::size_t song_preview::pick_voice(const std::array<voice, Count> &voices) noexcept {
+		std::size_t oldest = 0;
+		for(std::size_t idx = 0; idx < Count; idx++) {
+			if(!voices[idx].active) {
+				return idx;
+			}
+			if(voices[idx].started < voices[oldest].started) {
+				oldest = idx;
+			}
+		}
+		return oldest;
+	}
+
+	double song_preview::gain(const voice &played) const noexcept {
+		const auto &channel = channels_[played.midi_channel];
+		return played.velocity / 127. * channel.volume / 127. * channel.expression / 127.;
+	}
+
+	double song_preview::pitch(const voice &played) const noexcept {
+		const auto &channel = channels_[played.midi_channel];
+		double note         = played.note;
+		if(played.patch != no_patch) {
+			const auto &patch = patches_[played.patch];
+			note = patch.drum_note != 0 ? patch.drum_note : note + patch.transposition;
+		}
+		note += (channel.bend - 0x2000) / 8192. * bend_range;
+		return 440. * std::exp2((note - 69.) / 12.);
+	}
+
+	void song_preview::load_fm(const std::uint8_t fm_channel, const voice &played) {
+		auto operators        = patches_[played.patch].operators;
+		const auto level      = std::max(gain(played), 1e-4);
+		const auto attenuation = static_cast<std::uint32_t>(std::lround(-40. * std::log10(level) / db_per_total_level));
+		for(const auto &op : carriers(operators.algorithm())) {
+			operators.total_level(op, static_cast<std::uint8_t>(std::min<std::uint32_t>(operators.total_level(op).value + attenuation, 0x7F)));
+		}
+
+		if(fm_[fm_channel].patch == played.patch) {
+			// Same instrument, only the carrier levels change with velocity and volume
+			for(const auto &op : list<op_id>()) {
+				opn2_.write_channel(fm_channel, static_cast<std::uint8_t>(0x40 + std::to_underlying(op) * 4), operators.reg(op, 1).value);
+			}
+		} else {
+			opn2_.load_patch(fm_channel, operators);
+		}
+		const auto ams_fms = operators.registers[operators.registers.size() - 1].value & 0x3F;
+		opn2_.write_channel(fm_channel, 0xB4, static_cast<std::uint8_t>(ams_fms | pan_bits(channels_[played.midi_channel].pan)));
+	}
+
+	void song_preview::note_on(const std::uint8_t midi_channel, const std::uint8_t note, const std::uint8_t velocity) {
+		const auto &channel = channels_[midi_channel];
+		const bool is_drum  = midi_channel == drum_channel;
+		const auto patch    = is_drum ? find_patch(drums_, note, channel.program, 0) : find_patch(melody_, channel.program, channel.bank_msb, channel.bank_lsb);
+		voice played{.active = true, .midi_channel = midi_channel, .note = note, .velocity = velocity, .patch = patch, .started = position_};
+
+		if(patch != no_patch) {
+			const auto slot = static_cast<std::uint8_t>(pick_voice(fm_));
+			opn2_.key(slot, false);
+			load_fm(slot, played);
+			opn2_.frequency(slot, pitch(played));
+			opn2_.key(slot, true);
+			fm_[slot] = played;
+			return;
+		}
+
+		const auto attenuation = static_cast<std::uint8_t>(std::min(std::lround(-40. * std::log10(std::max(gain(played), 1e-4)) / db_per_psg_step), 15l));
+		if(is_drum) {
+			// Higher drum notes get the faster noise rates
+			psg_chip_.noise(true, static_cast<std::uint8_t>(2 - std::min(note / 43, 2)));
+			psg_chip_.volume(sn76489::psg::noise_channel, attenuation);
+			noise_ = played;
+			return;
+		}
+		const auto slot = static_cast<std::uint8_t>(pick_voice(psg_));
+		psg_chip_.tone(slot, pitch(played));
+		psg_chip_.volume(slot, attenuation);
+		psg_[slot] = played;
+	}
+
+	void song_preview::note_off(const std::uint8_t midi_channel, const std::uint8_t note) {
+		for(std::uint8_t slot = 0; slot < fm_.size(); slot++) {
+			if(auto &current = fm_[slot]; current.active && current.midi_channel == midi_channel && current.note == note) {
+				opn2_.key(slot, false);
+				current.active = false;
+			}
+		}
+		for(std::uint8_t slot = 0; slot < psg_.size(); slot++) {
+			if(auto &current = psg_[slot]; current.active && current.midi_channel == midi_channel && current.note == note) {
+				psg_chip_.volume(slot, sn76489::psg::silent);
+				current.active = false;
+			}
+		}
+		if(noise_.active && noise_.midi_channel == midi_channel && noise_.note == note) {
+			psg_chip_.volume(sn76489::psg::noise_channel, sn76489::psg::silent);
+			noise_.active = false;
+		}
+	}
+
+	void song_preview::refresh_pitch(const std::uint8_t midi_channel) {
+		for(std::uint8_t slot = 0; slot < fm_.size(); slot++) {
+			if(const auto &current = fm_[slot]; current.active && current.midi_channel == midi_channel) {
+				opn2_.frequency(slot, pitch(current));
+			}
+		}
+		for(std::uint8_t slot = 0; slot < psg_.size(); slot++) {
+			if(const auto &current = psg_[slot]; current.active && current.midi_channel == midi_channel) {
+				psg_chip_.tone(slot, pitch(current));
+			}
+		}
+	}
+
+	void song_preview::control_change(const std::uint8_t midi_channel, const std::uint8_t controller, const std::uint8_t value, const bool silent) {
+		auto &channel = channels_[midi_channel];
+		switch(controller) {
+			case cc::bank_msb: channel.bank_msb = value; break;
+			case cc::bank_lsb: channel.bank_lsb = value; break;
+			case cc::volume: channel.volume = value; break;
+			case cc::expression: channel.expression = value; break;
+			case cc::pan: channel.pan = value; break;
+			case cc::reset_all:
+				channel.volume     = 100;
+				channel.expression = 127;
+				channel.pan        = 64;
+				channel.bend       = 0x2000;
+				break;
+			case cc::all_notes_off:
+				if(!silent) {
+					for(std::uint8_t note = 0; note < 128; note++) {
+						note_off(midi_channel, note);
+					}
+				}
+				break;
+			default: break;
+		}
+	}
+
+	void song_preview::dispatch(const std::size_t event, const bool silent) {
+		const auto status  = status_[event];
+		const auto channel = midi::status::channel(status);
+		const auto data1   = data1_[event];
+		const auto data2   = data2_[event];
+		switch(midi::status::kind(status)) {
+			case midi::status::note_on:
+				if(silent) {
+					break;
+				}
+				if(data2 == 0) {
+					note_off(channel, data1);
+				} else {
+					note_on(channel, data1, data2);
+				}
+				break;
+			case midi::status::note_off:
+				if(!silent) {
+					note_off(channel, data1);
+				}
+				break;
+			case midi::status::control_change:
+				control_change(channel, data1, data2, silent);
+				break;
+			case midi::status::program_change:
+				channels_[channel].program = data1;
+				break;
+			case midi::status::pitch_bend:
+				channels_[channel].bend = static_cast<std::uint16_t>(data2 << 7 | data1);
+				if(!silent) {
+					refresh_pitch(channel);
+				}
+				break;
+			default: break;
+		}
+	}
+
+	void song_preview::render(const std::span<std::int16_t> stereo) {
+		const auto frames = stereo.size() / 2;
+		std::size_t done  = 0;
+		while(done < frames) {
+			while(cursor_ < when_.size() && when_[cursor_] <= position_) {
+				dispatch(cursor_++, false);
+			}
+			auto chunk = frames - done;
+			if(cursor_ < when_.size()) {
+				chunk = std::min<std::size_t>(chunk, when_[cursor_] - position_);
+			}
+			const auto out = stereo.subspan(done * 2, chunk * 2);
+			opn2_.render(out);
+			psg_chip_.mix(out);
+			position_ += chunk;
+			done += chunk;
+		}
+	}
+
+	void song_preview::render_to(audio_sink &sink, const std::size_t block_frames) {
+		std::vector<std::int16_t> block(block_frames * 2);
+		while(!finished()) {
+			const auto frames = std::min<std::uint64_t>(block_frames, length() - position_);
+			const auto out    = std::span{block}.first(frames * 2);
+			render(out);
+			sink.write(out);
+		}
+		sink.flush();
+	}
+
+	void song_preview::seek(const std::size_t event) {
+		opn2_.reset();
+		psg_chip_.reset();
+		channels_.fill({});
+		fm_.fill({});
+		psg_.fill({});
+		noise_ = {};
+
+		const auto target = std::min(event, when_.size());
+		for(std::size_t idx = 0; idx < target; idx++) {
+			dispatch(idx, true);
+		}
+		cursor_   = target;
+		position_ = target < when_.size() ? when_[target] : length();
+	}
+}
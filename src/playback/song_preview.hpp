@@ -0,0 +1,125 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "containers/chips/sn76489/psg.hpp"
+#include "containers/chips/ym2612/chip.hpp"
+#include "containers/files/mid2smps/gyb.hpp"
+#include "containers/midi/event_store.hpp"
+#include "playback/audio_sink.hpp"
+
+namespace MID3SMPS::playback {
+	// Plays a song's channel events on an emulated YM2612 using the GYB's instrument maps.
+	// Notes without an FM instrument fall back to the PSG, melodic parts on the tone channels and drums on the noise channel.
+	// Not thread safe, whatever renders it owns it.
+	class song_preview {
+	public:
+		static constexpr std::uint32_t sample_rate   = ym2612::chip::sample_rate;
+		static constexpr std::uint8_t drum_channel   = 9;
+		static constexpr std::uint32_t release_tail  = sample_rate; // Rendered after the last event so releases can ring out
+
+	private:
+		static constexpr std::uint16_t no_patch = std::numeric_limits<std::uint16_t>::max();
+
+		// Song, merged across tracks and timed in output samples
+		std::vector<std::uint64_t> when_{};
+		std::vector<std::uint8_t> status_{};
+		std::vector<std::uint8_t> data1_{};
+		std::vector<std::uint8_t> data2_{};
+
+		struct voice_patch {
+			ym2612::operators operators;
+			std::int8_t transposition;
+			std::uint8_t drum_note;
+		};
+		struct map_entry {
+			std::uint8_t bank_msb;
+			std::uint8_t bank_lsb;
+			std::uint16_t patch;
+		};
+		using resolved_map = std::array<std::vector<map_entry>, 128>;
+		std::vector<voice_patch> patches_{};
+		resolved_map melody_{};
+		resolved_map drums_{};
+
+		struct channel_state {
+			std::uint8_t program    = 0;
+			std::uint8_t bank_msb   = 0;
+			std::uint8_t bank_lsb   = 0;
+			std::uint8_t volume     = 100;
+			std::uint8_t expression = 127;
+			std::uint8_t pan        = 64;
+			std::uint16_t bend      = 0x2000;
+		};
+		std::array<channel_state, 16> channels_{};
+
+		struct voice {
+			bool active               = false;
+			std::uint8_t midi_channel = 0;
+			std::uint8_t note         = 0;
+			std::uint8_t velocity     = 0;
+			std::uint16_t patch       = no_patch; // Patch currently loaded on the FM channel
+			std::uint64_t started     = 0;
+		};
+		std::array<voice, ym2612::chip::channel_count> fm_{};
+		std::array<voice, sn76489::psg::noise_channel> psg_{};
+		voice noise_{};
+
+		ym2612::chip opn2_{};
+		sn76489::psg psg_chip_{sample_rate};
+
+		std::uint64_t position_ = 0;
+		std::size_t cursor_     = 0;
+
+		void resolve_instruments(const M2S::gyb &bank);
+		[[nodiscard]] std::uint16_t find_patch(const resolved_map &map, std::uint8_t key, std::uint8_t bank_msb, std::uint8_t bank_lsb) const;
+
+		void dispatch(std::size_t event, bool silent);
+		void note_on(std::uint8_t midi_channel, std::uint8_t note, std::uint8_t velocity);
+		void note_off(std::uint8_t midi_channel, std::uint8_t note);
+		void control_change(std::uint8_t midi_channel, std::uint8_t controller, std::uint8_t value, bool silent);
+		void refresh_pitch(std::uint8_t midi_channel);
+
+		[[nodiscard]] double gain(const voice &played) const noexcept;
+		[[nodiscard]] double pitch(const voice &played) const noexcept;
+		void load_fm(std::uint8_t fm_channel, const voice &played);
+
+		template<std::size_t Count>
+		[[nodiscard]] static std::size_t pick_voice(const std::array<voice, Count> &voices) noexcept;
+
+	public:
+		song_preview(const midi::event_store &events, const M2S::gyb &bank);
+
+		// Renders interleaved stereo frames at sample_rate, keeps producing silence once the song is over
+		void render(std::span<std::int16_t> stereo);
+		// Renders the rest of the song as fast as possible, used for WAV export and headless checks
+		void render_to(audio_sink &sink, std::size_t block_frames = 4096);
+
+		// Rebuilds the chip state as it would be right before the given event and continues from there
+		void seek(std::size_t event);
+
+		[[nodiscard]] constexpr std::uint64_t position() const noexcept {
+			return position_;
+		}
+
+		[[nodiscard]] constexpr std::size_t cursor() const noexcept {
+			return cursor_;
+		}
+
+		[[nodiscard]] std::size_t event_count() const noexcept {
+			return when_.size();
+		}
+
+		[[nodiscard]] std::uint64_t length() const noexcept {
+			return when_.empty() ? 0 : when_.back() + release_tail;
+		}
+
+		[[nodiscard]] bool finished() const noexcept {
+			return cursor_ == when_.size() && position_ >= length();
+		}
+	};
+}
@@ -0,0 +1,63 @@
+#include "wav_writer.hpp"
+
+#include <array>
+#include <bit>
+#include <stdexcept>
+#include <fmt/core.h>
+
+namespace MID3SMPS::playback {
+	namespace {
+		constexpr std::uint16_t channels        = 2;
+		constexpr std::uint16_t bits_per_sample = 16;
+		constexpr std::uint16_t block_align     = channels * bits_per_sample / 8;
+		constexpr std::uint32_t header_size     = 44;
+
+		template<typename T>
+		void put(std::ofstream &file, const T value) {
+			static_assert(std::endian::native == std::endian::little, "WAV output assumes a little endian host");
+			const auto bytes = std::bit_cast<std::array<char, sizeof(T)>>(value);
+			file.write(bytes.data(), bytes.size());
+		}
+	}
+
+	wav_writer::wav_writer(const fs::path &path, const std::uint32_t sample_rate) : file_(path, std::ios::binary), sample_rate_(sample_rate) {
+		if(!file_) {
+			throw std::runtime_error(fmt::format("Could not open {} for writing", path.string()));
+		}
+		write_header();
+	}
+
+	wav_writer::~wav_writer() {
+		flush();
+	}
+
+	void wav_writer::write_header() {
+		file_.seekp(0);
+		file_.write("RIFF", 4);
+		put<std::uint32_t>(file_, header_size - 8 + data_bytes_);
+		file_.write("WAVEfmt ", 8);
+		put<std::uint32_t>(file_, 16);
+		put<std::uint16_t>(file_, 1); // PCM
+		put<std::uint16_t>(file_, channels);
+		put<std::uint32_t>(file_, sample_rate_);
+		put<std::uint32_t>(file_, sample_rate_ * block_align);
+		put<std::uint16_t>(file_, block_align);
+		put<std::uint16_t>(file_, bits_per_sample);
+		file_.write("data", 4);
+		put<std::uint32_t>(file_, data_bytes_);
+	}
+
+	void wav_writer::write(const std::span<const std::int16_t> stereo) {
+		file_.write(reinterpret_cast<const char*>(stereo.data()), static_cast<std::streamsize>(stereo.size_bytes()));
+		data_bytes_ += static_cast<std::uint32_t>(stereo.size_bytes());
+	}
+
+	void wav_writer::flush() {
+		if(!file_) {
+			return;
+		}
+		write_header();
+		file_.seekp(0, std::ios::end);
+		file_.flush();
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+
+#include "audio_sink.hpp"
+
+namespace MID3SMPS::playback {
+	namespace fs = std::filesystem;
+
+	// 16-bit stereo PCM WAV file, the header sizes are patched in when the writer is flushed or destroyed
+	class wav_writer final : public audio_sink {
+		std::ofstream file_;
+		std::uint32_t sample_rate_;
+		std::uint32_t data_bytes_ = 0;
+
+		void write_header();
+
+	public:
+		wav_writer(const fs::path &path, std::uint32_t sample_rate);
+		~wav_writer() override;
+
+		void write(std::span<const std::int16_t> stereo) override;
+		void flush() override;
+
+		[[nodiscard]] constexpr std::uint32_t frames_written() const noexcept {
+			return data_bytes_ / 4;
+		}
+	};
+}
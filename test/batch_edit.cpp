@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "containers/files/mid2smps/batch_edit.hpp"
+#include "helpers/copy_on_write.hpp"
+
+namespace MID3SMPS::M2S {
+	namespace {
+		using op_id = ym2612::operators::op_id;
+
+		// Three melody patches at total levels 0, 10 and 20, and a kick on note 36
+		gyb small_bank() {
+			gyb bank;
+			bank.melody_bank = bank.add_bank("Melody");
+			bank.drum_bank   = bank.add_bank("Drums");
+			for(std::uint8_t idx = 0; idx < 3; idx++) {
+				auto &patch = bank.add_patch(bank.melody_bank);
+				patch.name  = "Lead " + std::to_string(unsigned{idx});
+				patch.operators.set<ym2612::field::total_level>(op_id::op1, static_cast<std::uint8_t>(idx * 10));
+			}
+			auto &kick             = bank.add_patch(bank.drum_bank);
+			kick.default_drum_note = 36;
+			return bank;
+		}
+
+		const fm::patch &patch(const gyb &bank, const ins_key_t id) {
+			return dynamic_cast<const fm::patch &>(*bank.instruments.at(id));
+		}
+
+		batch_edit set_total_level(const int value) {
+			batch_edit edit;
+			edit.changes.push_back({.target = ym2612::field::total_level, .operators = 0b0001, .apply = batch_edit::operation::set, .amount = value});
+			return edit;
+		}
+	}
+
+	TEST(batch_edit, records_the_bytes_it_changed) {
+		copy_on_write<gyb> bank(small_bank());
+		const std::vector<batch_edit::target_t> targets = {{bank->melody_bank, 0}, {bank->melody_bank, 2}};
+		const auto deltas = set_total_level(10).apply(bank, targets);
+
+		ASSERT_EQ(deltas.size(), 2);
+		EXPECT_EQ(deltas[0].id, 0);
+		EXPECT_EQ(deltas[0].before, 0);
+		EXPECT_EQ(deltas[0].after, 10);
+		EXPECT_EQ(deltas[1].id, 2);
+		EXPECT_EQ(deltas[1].before, 20);
+		EXPECT_EQ(deltas[1].after, 10);
+		for(const ins_key_t id : {ins_key_t{0}, ins_key_t{1}, ins_key_t{2}}) {
+			EXPECT_EQ(patch(*bank, id).operators.total_level(op_id::op1).value, 10);
+		}
+	}
+
+	TEST(batch_edit, only_unshares_patches_that_change) {
+		copy_on_write<gyb> bank(small_bank());
+		const auto snapshot = bank.snapshot();
+		const std::vector<batch_edit::target_t> targets = {{bank->melody_bank, 0}, {bank->melody_bank, 1}};
+		static_cast<void>(set_total_level(10).apply(bank, targets));
+
+		EXPECT_NE(bank->instruments.at(0), snapshot->instruments.at(0));
+		EXPECT_EQ(bank->instruments.at(1), snapshot->instruments.at(1));
+		EXPECT_EQ(patch(*snapshot, 0).operators.total_level(op_id::op1).value, 0);
+	}
+
+	TEST(batch_edit, leaves_the_bank_shared_when_nothing_changes) {
+		copy_on_write<gyb> bank(small_bank());
+		const auto snapshot = bank.snapshot();
+		const std::vector<batch_edit::target_t> targets = {{bank->melody_bank, 1}, {bank->melody_bank, 999}};
+
+		EXPECT_TRUE(set_total_level(10).apply(bank, targets).empty());
+		EXPECT_EQ(&*bank, snapshot.get());
+	}
+
+	TEST(batch_edit, transposes_drum_notes_and_melody_patches) {
+		copy_on_write<gyb> bank(small_bank());
+		batch_edit edit;
+		edit.transpose = 5;
+		const std::vector<batch_edit::target_t> targets = {{bank->melody_bank, 0}, {bank->drum_bank, 3}};
+		const auto deltas = edit.apply(bank, targets);
+
+		ASSERT_EQ(deltas.size(), 2);
+		EXPECT_EQ(deltas[0].offset, edit_journal::transposition_offset);
+		EXPECT_EQ(deltas[0].after, 5);
+		EXPECT_EQ(deltas[1].offset, edit_journal::transposition_offset);
+		EXPECT_EQ(deltas[1].after, 41);
+		EXPECT_EQ(patch(*bank, 3).default_drum_note, 41);
+		EXPECT_EQ(patch(*bank, 0).instrument_transposition, 5);
+	}
+}
@@ -0,0 +1,59 @@
+# Disassembles OBJECT and checks that every function codegen_<name> in NAMES compiled to the same instructions as
+# codegen_<name>_raw. Addresses are stripped, so only the instruction sequences are compared.
+#   cmake -DOBJDUMP=<objdump> -DOBJECT=<object file> -DNAMES=<name>[,<name>...] -P compare.cmake
+
+foreach (variable OBJDUMP OBJECT NAMES)
+	if (NOT DEFINED ${variable})
+		message(FATAL_ERROR "compare.cmake needs ${variable}")
+	endif ()
+endforeach ()
+
+execute_process(
+		COMMAND ${OBJDUMP} -d --no-show-raw-insn ${OBJECT}
+		OUTPUT_VARIABLE disassembly
+		RESULT_VARIABLE result
+)
+if (NOT result EQUAL 0)
+	message(FATAL_ERROR "${OBJDUMP} failed on ${OBJECT}")
+endif ()
+string(REPLACE ";" "\;" disassembly "${disassembly}")
+string(REPLACE "\n" ";" lines "${disassembly}")
+
+# The instructions of one function, without addresses, padding or the targets of jumps
+function(instructions name out)
+	set(inside FALSE)
+	set(found FALSE)
+	set(body "")
+	foreach (line IN LISTS lines)
+		if (line MATCHES "^[0-9a-f]+ <([^>]+)>:$")
+			set(inside FALSE)
+			if (CMAKE_MATCH_1 STREQUAL name)
+				set(inside TRUE)
+				set(found TRUE)
+			endif ()
+		elseif (inside AND line MATCHES "^ *[0-9a-f]+:[ \t]+(.+)$")
+			set(instruction "${CMAKE_MATCH_1}")
+			if (instruction MATCHES "^(nop|xchg +%ax,%ax|data16|cs nopw)")
+				continue()
+			endif ()
+			string(REGEX REPLACE "[0-9a-f]+ <[^>]+>" "<target>" instruction "${instruction}")
+			string(REGEX REPLACE "[ \t]+" " " instruction "${instruction}")
+			string(APPEND body "${instruction}\n")
+		endif ()
+	endforeach ()
+	if (NOT found)
+		message(FATAL_ERROR "${name} isn't in ${OBJECT}")
+	endif ()
+	set(${out} "${body}" PARENT_SCOPE)
+endfunction()
+
+string(REPLACE "," ";" names "${NAMES}")
+foreach (name IN LISTS names)
+	instructions(codegen_${name} accessor)
+	instructions(codegen_${name}_raw raw)
+	if (accessor STREQUAL raw)
+		message(STATUS "${name}: same instructions")
+	else ()
+		message(SEND_ERROR "${name} differs from the raw code\naccessor:\n${accessor}raw:\n${raw}")
+	endif ()
+endforeach ()
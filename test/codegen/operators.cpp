@@ -0,0 +1,43 @@
+// Compiled on its own at -O2 and disassembled by compare.cmake. Each accessor has a raw counterpart doing the same
+// thing by hand on plain bytes, the test fails if the two don't come out as the same instructions.
+#undef DEBUG
+#undef _GLIBCXX_DEBUG
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+
+#include "containers/chips/ym2612/operators.hpp"
+
+namespace MID3SMPS::ym2612::codegen {
+	using op_id     = operators::op_id;
+	using raw_patch = std::array<std::uint8_t, sizeof(operators)>;
+
+	static_assert(!operators::register_t::policy_type::checks, "The accessors are only expected to match raw code without checks");
+}
+
+// Unmangled so the script can find them by name
+extern "C" {
+	std::uint8_t codegen_read_attack_rate(const MID3SMPS::ym2612::operators &patch, MID3SMPS::ym2612::codegen::op_id op);
+	std::uint8_t codegen_read_attack_rate_raw(const MID3SMPS::ym2612::codegen::raw_patch &patch, MID3SMPS::ym2612::codegen::op_id op);
+	void codegen_write_attack_rate(MID3SMPS::ym2612::operators &patch, MID3SMPS::ym2612::codegen::op_id op, std::uint8_t value);
+	void codegen_write_attack_rate_raw(MID3SMPS::ym2612::codegen::raw_patch &patch, MID3SMPS::ym2612::codegen::op_id op, std::uint8_t value);
+
+	std::uint8_t codegen_read_attack_rate(const MID3SMPS::ym2612::operators &patch, const MID3SMPS::ym2612::codegen::op_id op) {
+		return patch.attack_rate(op).value;
+	}
+
+	std::uint8_t codegen_read_attack_rate_raw(const MID3SMPS::ym2612::codegen::raw_patch &patch, const MID3SMPS::ym2612::codegen::op_id op) {
+		return static_cast<std::uint8_t>(patch[std::to_underlying(op) + 8] & 0x1F);
+	}
+
+	void codegen_write_attack_rate(MID3SMPS::ym2612::operators &patch, const MID3SMPS::ym2612::codegen::op_id op, const std::uint8_t value) {
+		patch.attack_rate(op, value);
+	}
+
+	void codegen_write_attack_rate_raw(MID3SMPS::ym2612::codegen::raw_patch &patch, const MID3SMPS::ym2612::codegen::op_id op, const std::uint8_t value) {
+		const std::size_t index = std::to_underlying(op) + std::size_t{8};
+		patch[index]            = static_cast<std::uint8_t>((patch[index] & 0xE0) | std::min<std::uint8_t>(value, 0x1F));
+	}
+}
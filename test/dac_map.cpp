@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+
+#include "containers/files/mid2smps/dac_map.hpp"
+#include "exceptions/formatException.hpp"
+
+namespace MID3SMPS::M2S {
+	namespace {
+		// What parsing text threw, empty if it didn't
+		std::string error_of(const std::string_view text) {
+			try {
+				static_cast<void>(dac_map(text, "drums.txt"));
+			} catch(const format_exception &error) {
+				return error.what();
+			}
+			return {};
+		}
+	}
+
+	TEST(dac_map, reads_hits_and_fills_in_defaults) {
+		const dac_map map("36 0\n"
+		                  "38 $1 0x0C ; Snare\n"
+		                  "\n"
+		                  "# Hat\n"
+		                  "42 2 0 90\n",
+		                  "drums.txt");
+
+		ASSERT_EQ(map.kit_count(), 1);
+		EXPECT_EQ(map.find(0, 36).sample, 0);
+		EXPECT_EQ(map.find(0, 36).pitch, 0);
+		EXPECT_EQ(map.find(0, 36).volume, 127);
+		EXPECT_EQ(map.find(0, 38).sample, 1);
+		EXPECT_EQ(map.find(0, 38).pitch, 12);
+		EXPECT_EQ(map.find(0, 42).volume, 90);
+		EXPECT_EQ(map.find(0, 40).sample, dac_map::no_sample);
+	}
+
+	TEST(dac_map, switches_kits) {
+		const dac_map map("36 0\n"
+		                  "kit 2\n"
+		                  "36 5\n"
+		                  "kit 0\n"
+		                  "38 1\n",
+		                  "drums.txt");
+
+		ASSERT_EQ(map.kit_count(), 3);
+		EXPECT_EQ(map.find(0, 36).sample, 0);
+		EXPECT_EQ(map.find(0, 38).sample, 1);
+		EXPECT_EQ(map.find(1, 36).sample, dac_map::no_sample);
+		EXPECT_EQ(map.find(2, 36).sample, 5);
+		EXPECT_EQ(map.find(2, 38).sample, dac_map::no_sample);
+		EXPECT_EQ(map.find(7, 36).sample, dac_map::no_sample); // Past the last kit
+	}
+
+	TEST(dac_map, the_same_note_in_another_kit_is_not_a_duplicate) {
+		EXPECT_EQ(error_of("36 0\nkit 1\n36 1\n"), "");
+	}
+
+	TEST(dac_map, names_both_lines_of_a_duplicate_note) {
+		EXPECT_EQ(error_of("36 0\n38 1\n\n36 2\n"), "drums.txt:4: Note 36 of kit 0 is already mapped on line 1");
+		EXPECT_EQ(error_of("kit 3\n40 0\nkit 0\n40 0\nkit 3\n40 1\n"), "drums.txt:6: Note 40 of kit 3 is already mapped on line 2");
+	}
+
+	TEST(dac_map, rejects_values_out_of_range) {
+		EXPECT_EQ(error_of("128 0\n"), "drums.txt:1: Invalid note '128'");
+		EXPECT_EQ(error_of("36 255\n"), "drums.txt:1: Invalid sample '255'");
+		EXPECT_EQ(error_of("36 0 0 128\n"), "drums.txt:1: Invalid volume '128'");
+		EXPECT_EQ(error_of("kit 128\n"), "drums.txt:1: Invalid kit '128'");
+		EXPECT_EQ(error_of("36\n"), "drums.txt:1: Missing sample");
+		EXPECT_EQ(error_of("kit\n"), "drums.txt:1: Missing kit");
+	}
+
+	TEST(dac_map, rejects_text_after_a_line) {
+		EXPECT_EQ(error_of("36 0 0 127 loud\n"), "drums.txt:1: Unexpected text after the volume 'loud'");
+		EXPECT_EQ(error_of("kit 1 drums\n"), "drums.txt:1: Unexpected text after the kit 'drums'");
+	}
+}
@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "containers/edit_journal.hpp"
+
+namespace MID3SMPS {
+	namespace {
+		using delta = edit_journal::delta;
+		using namespace std::chrono_literals;
+
+		const auto start = edit_journal::clock::time_point{} + 1h;
+
+		std::vector<delta> change(const ins_key_t id, const std::uint8_t offset, const std::uint8_t before, const std::uint8_t after) {
+			return {{id, offset, before, after}};
+		}
+	}
+
+	TEST(edit_journal, undoes_and_redoes_in_order) {
+		edit_journal journal;
+		EXPECT_FALSE(journal.can_undo());
+		EXPECT_TRUE(journal.undo().empty());
+
+		journal.record(change(1, 4, 10, 20), 0, start);
+		journal.record(change(2, 5, 30, 40), 0, start);
+		ASSERT_EQ(journal.size(), 2);
+
+		auto undone = journal.undo();
+		ASSERT_EQ(undone.deltas.size(), 1);
+		EXPECT_EQ(undone.deltas[0].id, 2);
+		EXPECT_EQ(undone.deltas[0].before, 30);
+		undone = journal.undo();
+		ASSERT_EQ(undone.deltas.size(), 1);
+		EXPECT_EQ(undone.deltas[0].id, 1);
+		EXPECT_FALSE(journal.can_undo());
+		EXPECT_TRUE(journal.can_redo());
+
+		const auto redone = journal.redo();
+		ASSERT_EQ(redone.deltas.size(), 1);
+		EXPECT_EQ(redone.deltas[0].id, 1);
+		EXPECT_EQ(redone.deltas[0].after, 20);
+		EXPECT_EQ(journal.redo().deltas[0].id, 2);
+		EXPECT_FALSE(journal.can_redo());
+		EXPECT_TRUE(journal.redo().empty());
+	}
+
+	TEST(edit_journal, merges_a_drag_into_one_step) {
+		edit_journal journal;
+		journal.record(change(1, 4, 10, 11), 7, start);
+		journal.record(change(1, 4, 11, 12), 7, start + 500ms);
+		journal.record(change(1, 5, 0, 1), 7, start + 1000ms); // The window counts from the last change, not the first
+		ASSERT_EQ(journal.size(), 1);
+
+		const auto undone = journal.undo();
+		ASSERT_EQ(undone.deltas.size(), 2);
+		EXPECT_EQ(undone.deltas[0].before, 10); // Still starts from the first value
+		EXPECT_EQ(undone.deltas[0].after, 12);
+		EXPECT_EQ(undone.deltas[1].offset, 5);
+	}
+
+	TEST(edit_journal, keeps_steps_apart_that_cant_merge) {
+		edit_journal journal;
+		journal.record(change(1, 4, 10, 11), 7, start);
+		journal.record(change(1, 4, 11, 12), 7, start + edit_journal::coalesce_window); // Too late
+		journal.record(change(1, 4, 12, 13), 8, start + edit_journal::coalesce_window); // Another widget
+		journal.record(change(2, 4, 12, 13), 8, start + edit_journal::coalesce_window); // Another patch
+		journal.record(change(2, 4, 13, 14), 0, start + edit_journal::coalesce_window); // No key
+		journal.record(change(2, 4, 14, 15), 0, start + edit_journal::coalesce_window);
+		EXPECT_EQ(journal.size(), 6);
+
+		journal.record(change(3, 4, 0, 1), 9, start);
+		journal.seal();
+		journal.record(change(3, 4, 1, 2), 9, start);
+		EXPECT_EQ(journal.size(), 8);
+
+		static_cast<void>(journal.undo()); // Whatever comes after an undo is a new step
+		journal.record(change(3, 4, 1, 2), 9, start);
+		EXPECT_EQ(journal.size(), 8);
+		EXPECT_FALSE(journal.can_redo());
+	}
+
+	TEST(edit_journal, drops_the_redo_branch_on_a_new_edit) {
+		edit_journal journal;
+		journal.record(change(1, 4, 0, 1), 0, start);
+		journal.record(change(1, 4, 1, 2), 0, start);
+		journal.record(change(1, 4, 2, 3), 0, start);
+		static_cast<void>(journal.undo());
+		static_cast<void>(journal.undo());
+		ASSERT_TRUE(journal.can_redo());
+
+		journal.record(change(1, 5, 0, 9), 0, start);
+		EXPECT_FALSE(journal.can_redo());
+		EXPECT_EQ(journal.size(), 2);
+		EXPECT_EQ(journal.undo().deltas[0].offset, 5);
+		EXPECT_EQ(journal.undo().deltas[0].after, 1);
+	}
+
+	TEST(edit_journal, knows_when_it_is_back_at_the_save) {
+		edit_journal journal;
+		EXPECT_FALSE(journal.modified());
+		journal.record(change(1, 4, 0, 1), 0, start);
+		EXPECT_TRUE(journal.modified());
+		static_cast<void>(journal.undo());
+		EXPECT_FALSE(journal.modified());
+		static_cast<void>(journal.redo());
+
+		journal.mark_saved();
+		EXPECT_FALSE(journal.modified());
+		journal.record(change(1, 4, 1, 2), 0, start);
+		EXPECT_TRUE(journal.modified());
+		static_cast<void>(journal.undo());
+		EXPECT_FALSE(journal.modified());
+		static_cast<void>(journal.undo());
+		EXPECT_TRUE(journal.modified());
+	}
+
+	TEST(edit_journal, loses_a_save_in_a_dropped_redo_branch) {
+		edit_journal journal;
+		journal.record(change(1, 4, 0, 1), 0, start);
+		journal.record(change(1, 4, 1, 2), 0, start);
+		journal.mark_saved();
+		static_cast<void>(journal.undo());
+		journal.record(change(1, 5, 0, 1), 0, start);
+
+		// The saved patches can't be reached any more, wherever the history goes
+		EXPECT_TRUE(journal.modified());
+		static_cast<void>(journal.undo());
+		EXPECT_TRUE(journal.modified());
+		static_cast<void>(journal.undo());
+		EXPECT_TRUE(journal.modified());
+	}
+
+	TEST(edit_journal, saves_the_position_a_snapshot_was_taken_at) {
+		edit_journal journal;
+		journal.record(change(1, 4, 0, 1), 7, start);
+		const auto saved = journal.position();
+		journal.record(change(1, 4, 1, 2), 7, start); // Sealed by taking the position, so it doesn't merge into it
+		EXPECT_EQ(journal.size(), 2);
+
+		journal.mark_saved(saved); // The save finished after the second edit
+		EXPECT_TRUE(journal.modified());
+		static_cast<void>(journal.undo());
+		EXPECT_FALSE(journal.modified());
+	}
+
+	TEST(edit_journal, ignores_saves_of_a_bank_it_no_longer_holds) {
+		edit_journal journal;
+		journal.record(change(1, 4, 0, 1), 0, start);
+		const auto old_bank = journal.position();
+		journal.clear();
+		EXPECT_FALSE(journal.modified());
+		journal.mark_saved(old_bank);
+		EXPECT_FALSE(journal.modified());
+		journal.record(change(1, 4, 0, 1), 0, start);
+		EXPECT_TRUE(journal.modified());
+	}
+
+	TEST(edit_journal, drops_the_oldest_steps_over_capacity) {
+		edit_journal journal(0); // Only ever keeps the latest step
+		journal.record(change(1, 4, 0, 1), 0, start);
+		journal.record(change(1, 4, 1, 2), 0, start);
+		journal.record(change(1, 4, 2, 3), 0, start);
+		EXPECT_EQ(journal.size(), 1);
+		EXPECT_EQ(journal.undo().deltas[0].after, 3);
+		EXPECT_FALSE(journal.can_undo());
+		EXPECT_TRUE(journal.modified()); // The loaded bank went with the dropped steps
+	}
+
+	TEST(edit_journal, finds_a_save_right_before_the_oldest_step) {
+		edit_journal journal(0);
+		journal.record(change(1, 4, 0, 1), 0, start);
+		journal.mark_saved();
+		journal.record(change(1, 4, 1, 2), 0, start); // Drops the saved step, but undoing this one still gets back to it
+		EXPECT_EQ(journal.size(), 1);
+		EXPECT_TRUE(journal.modified());
+		static_cast<void>(journal.undo());
+		EXPECT_FALSE(journal.modified());
+	}
+
+	TEST(edit_journal, counts_the_memory_it_keeps) {
+		edit_journal journal;
+		EXPECT_EQ(journal.memory_usage(), 0);
+		journal.record(change(1, 4, 0, 1), 0, start);
+		const auto one_step = journal.memory_usage();
+		EXPECT_GT(one_step, 0);
+		journal.record(change(1, 4, 1, 2), 0, start);
+		EXPECT_EQ(journal.memory_usage(), one_step * 2);
+		static_cast<void>(journal.undo());
+		journal.record(change(1, 5, 1, 2), 0, start); // Replaces the undone step
+		EXPECT_EQ(journal.memory_usage(), one_step * 2);
+		journal.clear();
+		EXPECT_EQ(journal.memory_usage(), 0);
+	}
+
+	TEST(edit_journal, undoes_a_rename_as_a_step_of_its_own) {
+		edit_journal journal;
+		journal.record(change(1, 4, 0, 1), 7, start);
+		journal.record({1, "Bass", "Slap Bass"}, start);
+		journal.record({1, "Same", "Same"}, start);
+		EXPECT_EQ(journal.size(), 2);
+		EXPECT_TRUE(journal.modified());
+
+		const auto undone = journal.undo();
+		EXPECT_TRUE(undone.deltas.empty());
+		ASSERT_EQ(undone.renames.size(), 1);
+		EXPECT_EQ(undone.renames[0].before, "Bass");
+		journal.record(change(1, 4, 1, 2), 7, start); // Undoing sealed the step before the rename
+		EXPECT_EQ(journal.size(), 2);
+	}
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "containers/files/mid2smps/gyb.hpp"
+
+namespace MID3SMPS::M2S {
+	namespace {
+		using op_id = ym2612::operators::op_id;
+
+		gyb two_banks() {
+			gyb bank;
+			bank.default_LFO_speed = ym2612::lfo::mode3;
+			bank.melody_bank       = bank.add_bank("Melody");
+			bank.drum_bank         = bank.add_bank("Drums");
+			for(std::uint8_t idx = 0; idx < 3; idx++) {
+				auto &patch = bank.add_patch(bank.melody_bank);
+				patch.name  = "Lead " + std::to_string(unsigned{idx});
+				patch.operators.set<ym2612::field::algorithm>(op_id::op1, idx);
+				patch.operators.set<ym2612::field::total_level>(op_id::op3, static_cast<std::uint8_t>(idx * 20));
+				patch.instrument_transposition = static_cast<std::int8_t>(-12 * idx);
+			}
+			auto &kick             = bank.add_patch(bank.drum_bank);
+			kick.name              = "Kick";
+			kick.default_drum_note = 36;
+			bank.melody_map.write()[0].push_back({0, gyb::map_entry::all, 2});
+			bank.melody_map.write()[0].push_back({8, 0, 1});
+			bank.drum_map.write()[36].push_back({0, 0, gyb::map_entry::drum_bank_bit});
+			return bank;
+		}
+
+		std::vector<const fm::patch *> patches(const gyb &bank, const bank_key_t id) {
+			std::vector<const fm::patch *> result;
+			for(const auto key : bank.instruments_order->at(id)) {
+				result.push_back(dynamic_cast<const fm::patch *>(bank.instruments.find(key)));
+			}
+			return result;
+		}
+	}
+
+	TEST(gyb, reads_back_what_it_saved) {
+		const auto original = two_banks();
+		const auto file     = original.save();
+		const gyb loaded(file);
+
+		EXPECT_EQ(loaded.default_LFO_speed, ym2612::lfo::mode3);
+		const auto melody = patches(loaded, loaded.melody_bank);
+		const auto drums  = patches(loaded, loaded.drum_bank);
+		ASSERT_EQ(melody.size(), 3);
+		ASSERT_EQ(drums.size(), 1);
+		const auto expected = patches(original, original.melody_bank);
+		for(std::size_t idx = 0; idx < melody.size(); idx++) {
+			ASSERT_NE(melody[idx], nullptr);
+			EXPECT_EQ(melody[idx]->name, expected[idx]->name);
+			EXPECT_EQ(melody[idx]->operators.registers, expected[idx]->operators.registers);
+			EXPECT_EQ(melody[idx]->instrument_transposition, expected[idx]->instrument_transposition);
+		}
+		EXPECT_EQ(drums[0]->name, "Kick");
+		EXPECT_EQ(drums[0]->default_drum_note, 36);
+
+		ASSERT_EQ((*loaded.melody_map)[0].size(), 2);
+		EXPECT_EQ((*loaded.melody_map)[0][1].bank_msb, 8);
+		EXPECT_EQ((*loaded.melody_map)[0][1].instrument, 1);
+		EXPECT_EQ(loaded.find_patch(*loaded.melody_map, 0)->name, "Lead 2");
+		EXPECT_EQ(loaded.find_patch(*loaded.drum_map, 36)->name, "Kick");
+	}
+
+	TEST(gyb, saves_the_same_bytes_twice) {
+		const auto file = two_banks().save();
+		EXPECT_EQ(gyb(file).save(), file);
+	}
+
+	TEST(gyb, saves_a_bank_without_drums) {
+		gyb bank;
+		bank.melody_bank = bank.add_bank("Melody");
+		bank.add_patch(bank.melody_bank).name = "Only";
+		const gyb loaded(bank.save());
+		EXPECT_EQ(loaded.instruments.size(), 1);
+		EXPECT_TRUE(loaded.instruments_order->at(loaded.drum_bank).empty());
+	}
+
+	TEST(gyb, cuts_long_names_short) {
+		gyb bank;
+		bank.melody_bank = bank.add_bank("Melody");
+		bank.add_patch(bank.melody_bank).name = std::string(300, 'x');
+		const gyb loaded(bank.save());
+		EXPECT_EQ(loaded.instruments.at(0)->name, std::string(255, 'x'));
+	}
+
+	TEST(gyb, rejects_a_truncated_file) {
+		auto file = two_banks().save();
+		file.pop_back();
+		EXPECT_THROW((void)gyb(file), std::runtime_error);
+	}
+}
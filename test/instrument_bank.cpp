@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "containers/files/mid2smps/gyb.hpp"
+#include "helpers/copy_on_write.hpp"
+
+namespace MID3SMPS {
+	namespace {
+		using op_id = ym2612::operators::op_id;
+
+		// Enough patches to fill a few pages of the instrument table
+		M2S::gyb bank_of(const std::size_t count) {
+			M2S::gyb bank;
+			bank.melody_bank = bank.add_bank("Melody");
+			for(std::size_t idx = 0; idx < count; idx++) {
+				bank.add_patch(bank.melody_bank).name = "Patch " + std::to_string(idx);
+			}
+			bank.melody_map.write()[0].push_back({0, M2S::gyb::map_entry::all, 0});
+			return bank;
+		}
+
+		std::uint8_t total_level(const M2S::gyb &bank, const ins_key_t id) {
+			return dynamic_cast<const M2S::fm::patch &>(*bank.instruments.at(id)).operators.total_level(op_id::op1).value;
+		}
+	}
+
+	TEST(instrument_bank, finds_what_was_added) {
+		const auto bank = bank_of(1000);
+		EXPECT_EQ(bank.instruments.size(), 1000);
+		EXPECT_EQ(bank.instruments_order->at(bank.melody_bank).size(), 1000);
+		EXPECT_TRUE(bank.instruments.contains(999));
+		EXPECT_FALSE(bank.instruments.contains(1000));
+		EXPECT_EQ(bank.instruments.find(1000), nullptr);
+		EXPECT_EQ(bank.instruments.at(700)->name, "Patch 700");
+		EXPECT_THROW((void)bank.instruments.at(1000), std::out_of_range);
+	}
+
+	TEST(instrument_bank, copies_share_their_instruments) {
+		const auto bank = bank_of(600);
+		const auto copy = bank;
+		for(const auto id : std::array<ins_key_t, 4>{0, 255, 256, 599}) {
+			EXPECT_EQ(copy.instruments.find(id), bank.instruments.find(id));
+		}
+		EXPECT_EQ(&*copy.instruments_order, &*bank.instruments_order);
+		EXPECT_EQ(&*copy.melody_map, &*bank.melody_map);
+	}
+
+	TEST(instrument_bank, writing_leaves_other_copies_alone) {
+		auto bank       = bank_of(600);
+		const auto copy = bank;
+		dynamic_cast<M2S::fm::patch &>(bank.writable(300)).operators.set<ym2612::field::total_level>(op_id::op1, 42);
+
+		EXPECT_EQ(total_level(bank, 300), 42);
+		EXPECT_EQ(total_level(copy, 300), 0);
+		// Only the patch that changed was cloned, its neighbours and the other pages are still shared
+		EXPECT_NE(bank.instruments.find(300), copy.instruments.find(300));
+		EXPECT_EQ(bank.instruments.find(301), copy.instruments.find(301));
+		EXPECT_EQ(bank.instruments.find(10), copy.instruments.find(10));
+		EXPECT_EQ(&*bank.instruments_order, &*copy.instruments_order);
+	}
+
+	TEST(instrument_bank, writing_an_unshared_bank_changes_it_in_place) {
+		auto bank         = bank_of(10);
+		const auto *patch = bank.instruments.find(5);
+		EXPECT_EQ(&bank.writable(5), patch);
+		EXPECT_THROW((void)bank.writable(10), std::out_of_range);
+	}
+
+	TEST(instrument_bank, adding_to_a_copy_leaves_the_original_alone) {
+		const auto bank = bank_of(10);
+		auto copy       = bank;
+		const auto drums = copy.add_bank("Drums");
+		copy.add_patch(drums);
+		copy.melody_map.write()[1].push_back({0, 0, 1});
+
+		EXPECT_EQ(bank.instruments.size(), 10);
+		EXPECT_EQ(copy.instruments.size(), 11);
+		EXPECT_FALSE(bank.banks->contains(drums));
+		EXPECT_FALSE(bank.instruments_order->contains(drums));
+		EXPECT_TRUE((*bank.melody_map)[1].empty());
+		EXPECT_EQ((*copy.melody_map)[1].size(), 1);
+	}
+
+	TEST(instrument_bank, snapshots_keep_what_they_saw) {
+		copy_on_write<M2S::gyb> bank(bank_of(300));
+		const auto snapshot = bank.snapshot();
+		bank.write().writable(7).name = "Renamed";
+		EXPECT_EQ(bank->instruments.at(7)->name, "Renamed");
+		EXPECT_EQ(snapshot->instruments.at(7)->name, "Patch 7");
+		EXPECT_NE(bank->find_patch(*bank->melody_map, 0), nullptr);
+	}
+}
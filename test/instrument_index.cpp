@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "containers/instrument_index.hpp"
+#include "containers/files/mid2smps/gyb.hpp"
+
+namespace MID3SMPS {
+	namespace {
+		using op_id      = ym2612::operators::op_id;
+		using comparison = instrument_index::comparison;
+		using field      = ym2612::field;
+
+		// Every attack rate at the maximum except where a test lowers one
+		M2S::fm::patch &add(M2S::gyb &bank, const std::string_view name, const std::uint8_t algorithm = 0) {
+			auto &patch = bank.add_patch(bank.melody_bank);
+			patch.name  = name;
+			patch.operators.set<field::algorithm>(op_id::op1, algorithm);
+			for(const auto op : {op_id::op1, op_id::op2, op_id::op3, op_id::op4}) {
+				patch.operators.set<field::attack_rate>(op, 31);
+			}
+			return patch;
+		}
+
+		// Names the rows a search found, in the order it found them
+		std::vector<std::string> names(const M2S::gyb &bank, const instrument_index &index, const std::string_view text) {
+			std::vector<std::string> result;
+			for(const auto row : index.search(instrument_index::query::parse(text))) {
+				result.push_back(bank.instruments.at(index[row].id)->name);
+			}
+			return result;
+		}
+
+		using name_list = std::vector<std::string>;
+	}
+
+	TEST(instrument_index, parses_predicates_and_terms) {
+		const auto query = instrument_index::query::parse("  Bass alg==7 AR2<$10 fb>=5 tl!=0x7F x=y");
+
+		EXPECT_EQ(query.terms, (name_list{"bass", "x=y"}));
+		ASSERT_EQ(query.predicates.size(), 4);
+		EXPECT_EQ(query.predicates[0].target, field::algorithm);
+		EXPECT_EQ(query.predicates[0].compare, comparison::equal);
+		EXPECT_EQ(query.predicates[0].value, 7);
+		EXPECT_EQ(query.predicates[1].target, field::attack_rate);
+		EXPECT_EQ(query.predicates[1].op, op_id::op2);
+		EXPECT_EQ(query.predicates[1].compare, comparison::less);
+		EXPECT_EQ(query.predicates[1].value, 16);
+		EXPECT_EQ(query.predicates[2].target, field::feedback);
+		EXPECT_EQ(query.predicates[2].op, std::nullopt);
+		EXPECT_EQ(query.predicates[2].compare, comparison::greater_equal);
+		EXPECT_EQ(query.predicates[3].compare, comparison::not_equal);
+		EXPECT_EQ(query.predicates[3].value, 0x7F);
+	}
+
+	TEST(instrument_index, parses_what_is_not_a_predicate_as_a_name) {
+		// An operator number on a channel field, a value past a byte, a missing value and a missing field
+		const auto query = instrument_index::query::parse("alg1=3 ar<256 fb= =4");
+		EXPECT_TRUE(query.predicates.empty());
+		EXPECT_EQ(query.terms, (name_list{"alg1=3", "ar<256", "fb=", "=4"}));
+		EXPECT_TRUE(instrument_index::query::parse("   ").empty());
+	}
+
+	TEST(instrument_index, operator_fields_without_a_number_match_any_operator) {
+		M2S::gyb bank;
+		bank.melody_bank = bank.add_bank("Melody");
+		add(bank, "Pad");
+		add(bank, "Pluck").operators.set<field::attack_rate>(op_id::op3, 5);
+		add(bank, "Lead", 7);
+		const instrument_index index(bank);
+
+		EXPECT_EQ(names(bank, index, "ar<10"), (name_list{"Pluck"}));
+		EXPECT_EQ(names(bank, index, "ar3<10"), (name_list{"Pluck"}));
+		EXPECT_TRUE(names(bank, index, "ar1<10").empty());
+		EXPECT_EQ(names(bank, index, "ar==31"), (name_list{"Pad", "Pluck", "Lead"}));
+		EXPECT_EQ(names(bank, index, "alg==7"), (name_list{"Lead"}));
+		EXPECT_EQ(names(bank, index, "alg<7 ar<10"), (name_list{"Pluck"}));
+	}
+
+	TEST(instrument_index, ranks_exact_names_above_fuzzy_ones) {
+		M2S::gyb bank;
+		bank.melody_bank = bank.add_bank("Melody");
+		add(bank, "Brass");
+		add(bank, "Lead");
+		add(bank, "Slap Bass");
+		add(bank, "BASS DRUM");
+		const instrument_index index(bank);
+
+		// Brass only shares "ass" with the term, half of its trigrams
+		EXPECT_EQ(names(bank, index, "bass"), (name_list{"Slap Bass", "BASS DRUM", "Brass"}));
+		EXPECT_EQ(names(bank, index, "bass drum"), (name_list{"BASS DRUM"}));
+		// Too short for trigrams, only substrings match
+		EXPECT_EQ(names(bank, index, "ea"), (name_list{"Lead"}));
+		EXPECT_TRUE(names(bank, index, "organ").empty());
+		EXPECT_EQ(names(bank, index, ""), (name_list{"Brass", "Lead", "Slap Bass", "BASS DRUM"}));
+	}
+
+	TEST(instrument_index, refresh_picks_up_parameter_edits) {
+		M2S::gyb bank;
+		bank.melody_bank = bank.add_bank("Melody");
+		add(bank, "Pad");
+		auto &pluck = add(bank, "Pluck");
+		instrument_index index(bank);
+		EXPECT_TRUE(names(bank, index, "ar<10").empty());
+
+		pluck.operators.set<field::attack_rate>(op_id::op4, 2);
+		index.refresh(1, pluck.operators);
+		EXPECT_EQ(names(bank, index, "ar<10"), (name_list{"Pluck"}));
+	}
+}
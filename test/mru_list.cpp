@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "helpers/mru_list.hpp"
+
+namespace MID3SMPS {
+	namespace {
+		// What mru_list should hold, kept the slow and obvious way
+		class reference_list {
+			std::vector<int> items_{}; // Most recent first
+			std::size_t capacity_;
+
+		public:
+			explicit reference_list(const std::size_t capacity) : capacity_(capacity) {}
+
+			void touch(const int value) {
+				std::erase(items_, value);
+				items_.insert(items_.begin(), value);
+				if(items_.size() > capacity_) {
+					items_.pop_back();
+				}
+			}
+
+			void erase(const int value) {
+				std::erase(items_, value);
+			}
+
+			[[nodiscard]] const std::vector<int> &items() const noexcept {
+				return items_;
+			}
+		};
+	}
+
+	TEST(mru_list, lists_the_most_recent_first) {
+		mru_list<std::string> recent(4);
+		recent.touch("a.mid");
+		recent.touch("b.mid");
+		recent.touch("c.mid");
+		EXPECT_EQ(recent.items(), (std::vector<std::string>{"c.mid", "b.mid", "a.mid"}));
+		EXPECT_EQ(recent.size(), 3);
+	}
+
+	TEST(mru_list, touching_a_value_again_moves_it_to_the_front) {
+		mru_list<int> recent(4);
+		for(const auto value : {1, 2, 3, 2, 1, 1}) {
+			recent.touch(value);
+		}
+		EXPECT_EQ(recent.items(), (std::vector<int>{1, 2, 3}));
+		EXPECT_EQ(recent.size(), 3);
+	}
+
+	TEST(mru_list, forgets_the_oldest_past_capacity) {
+		mru_list<int> recent(3);
+		for(const auto value : {1, 2, 3, 1, 4}) {
+			recent.touch(value);
+		}
+		EXPECT_EQ(recent.items(), (std::vector<int>{4, 1, 3}));
+		EXPECT_FALSE(recent.contains(2));
+		EXPECT_EQ(recent.size(), recent.capacity());
+	}
+
+	TEST(mru_list, keeps_its_order_through_compaction) {
+		// Touching the same few values over and over fills the ring with stale slots many times over
+		mru_list<int> recent(4);
+		reference_list expected(4);
+		for(int round = 0; round < 100; round++) {
+			for(const auto value : {round % 3, 7, round % 5}) {
+				recent.touch(value);
+				expected.touch(value);
+			}
+			ASSERT_EQ(recent.items(), expected.items()) << "after round " << round;
+		}
+	}
+
+	TEST(mru_list, matches_a_plain_list_on_random_touches) {
+		mru_list<int> recent(8);
+		reference_list expected(8);
+		std::mt19937 random(0x4D3353);
+		std::uniform_int_distribution value(0, 20);
+		for(int step = 0; step < 5000; step++) {
+			const auto picked = value(random);
+			if(step % 7 == 0) {
+				recent.erase(picked);
+				expected.erase(picked);
+			} else {
+				recent.touch(picked);
+				expected.touch(picked);
+			}
+			ASSERT_EQ(recent.items(), expected.items()) << "after step " << step;
+			ASSERT_EQ(recent.size(), expected.items().size());
+		}
+	}
+
+	TEST(mru_list, erases_and_clears) {
+		mru_list<int> recent(3);
+		recent.touch(1);
+		recent.touch(2);
+		EXPECT_TRUE(recent.erase(1));
+		EXPECT_FALSE(recent.erase(1));
+		EXPECT_EQ(recent.items(), (std::vector<int>{2}));
+
+		recent.clear();
+		EXPECT_TRUE(recent.empty());
+		recent.touch(3);
+		EXPECT_EQ(recent.items(), (std::vector<int>{3}));
+	}
+
+	TEST(mru_list, holds_nothing_without_capacity) {
+		mru_list<int> recent(0);
+		recent.touch(1);
+		EXPECT_TRUE(recent.empty());
+		EXPECT_TRUE(recent.items().empty());
+	}
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <bit>
+#include <utility>
+#include <vector>
+
+#include "containers/chips/ym2612/operator_columns.hpp"
+#include "random_operators.hpp"
+
+namespace MID3SMPS::ym2612 {
+	namespace {
+		using op_id = operators::op_id;
+
+		using namespace test_helpers;
+
+		// Every column against the accessors, one patch at a time so a mismatch names the patch and field
+		void expect_matches_accessors(const std::vector<operators> &patches) {
+			const operator_columns columns(patches);
+			ASSERT_EQ(columns.size(), patches.size());
+			for(std::size_t idx = 0; idx < patches.size(); idx++) {
+				SCOPED_TRACE(testing::Message() << "patch " << idx);
+				const auto &patch = patches[idx];
+				for(const auto &op : list<op_id>()) {
+					SCOPED_TRACE(testing::Message() << "operator " << operator_columns::slot(op));
+					const auto slot = operator_columns::slot(op);
+					ASSERT_EQ(columns.detune[slot].size(), patches.size());
+					EXPECT_EQ(columns.detune[slot][idx], std::to_underlying(patch.detune(op)));
+					EXPECT_EQ(columns.multiple[slot][idx], patch.multiple(op).value);
+					EXPECT_EQ(columns.total_level[slot][idx], patch.total_level(op).value);
+					EXPECT_EQ(columns.rate_scaling[slot][idx], std::to_underlying(patch.rate_scaling(op)));
+					EXPECT_EQ(columns.attack_rate[slot][idx], patch.attack_rate(op).value);
+					EXPECT_EQ(columns.amplitude_modulation[slot][idx], patch.amplitude_modulation(op));
+					EXPECT_EQ(columns.decay_rate[slot][idx], patch.decay_rate(op).value);
+					EXPECT_EQ(columns.sustain_rate[slot][idx], patch.sustain_rate(op).value);
+					EXPECT_EQ(columns.sustain_level[slot][idx], patch.sustain_level(op).value);
+					EXPECT_EQ(columns.release_rate[slot][idx], patch.release_rate(op).value);
+					EXPECT_EQ(columns.ssgeg[slot][idx], std::to_underlying(patch.ssgeg(op)));
+				}
+				EXPECT_EQ(columns.ams[idx], patch.ams().value);
+				EXPECT_EQ(columns.fms[idx], patch.fms().value);
+				EXPECT_EQ(columns.feedback[idx], std::to_underlying(patch.feedback()));
+				EXPECT_EQ(columns.algorithm[idx], std::to_underlying(patch.algorithm()));
+			}
+		}
+	}
+
+	TEST(operator_columns, decodes_nothing) {
+		expect_matches_accessors({});
+	}
+
+	TEST(operator_columns, decodes_fewer_patches_than_a_vector) {
+		expect_matches_accessors(random_patches(7));
+	}
+
+	TEST(operator_columns, decodes_a_partial_last_chunk) {
+		// Neither a multiple of the 512 patch chunks nor of the 16 patch SIMD blocks
+		expect_matches_accessors(random_patches(1000));
+	}
+
+	TEST(operator_columns, decodes_several_chunks) {
+		expect_matches_accessors(random_patches(1537));
+	}
+
+	TEST(operator_columns, decoding_again_replaces_the_columns) {
+		operator_columns columns(random_patches(1000));
+		const auto fewer = random_patches(33);
+		columns.decode(fewer);
+		EXPECT_EQ(columns, operator_columns(fewer));
+		EXPECT_EQ(columns.total_level[0].size(), 33);
+	}
+
+	TEST(operator_columns, decodes_like_masking_the_raw_bytes) {
+		const auto patches = random_patches(100);
+		operator_columns columns(patches);
+		for(std::size_t idx = 0; idx < patches.size(); idx++) {
+			const auto bytes = std::bit_cast<raw_bank>(patches[idx]);
+			for(const auto &raw : layout) {
+				for(const auto &op : list<op_id>()) {
+					ASSERT_EQ(columns.column(raw.id, std::to_underlying(op))[idx], raw_get(bytes, raw, op)) << describe(raw.id).name;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <bit>
+#include <random>
+#include <stdexcept>
+
+#include "random_operators.hpp"
+
+namespace MID3SMPS::ym2612 {
+	namespace {
+		using op_id = operators::op_id;
+		using namespace test_helpers;
+	}
+
+	TEST(operators, is_its_raw_registers) {
+		static_assert(sizeof(operators) == operators::instrument_register_size);
+		std::mt19937 random(49);
+		const auto bytes = random_bytes(random);
+		EXPECT_EQ(std::bit_cast<raw_bank>(std::bit_cast<operators>(bytes)), bytes);
+	}
+
+	TEST(operators, reads_like_masking_the_raw_bytes) {
+		std::mt19937 random(49);
+		for(int round = 0; round < 64; round++) {
+			const auto bytes = random_bytes(random);
+			const auto patch = std::bit_cast<operators>(bytes);
+			for(const auto &raw : layout) {
+				for(const auto &op : list<op_id>()) {
+					EXPECT_EQ(patch.get(describe(raw.id), op), raw_get(bytes, raw, op)) << describe(raw.id).name;
+				}
+			}
+
+			for(const auto &op : list<op_id>()) {
+				EXPECT_EQ(std::to_underlying(patch.detune(op)), raw_get(bytes, layout[4], op));
+				EXPECT_EQ(patch.total_level(op).value, raw_get(bytes, layout[6], op));
+				EXPECT_EQ(patch.amplitude_modulation(op), raw_get(bytes, layout[9], op) != 0);
+				EXPECT_EQ(std::to_underlying(patch.ssgeg(op)), raw_get(bytes, layout[14], op));
+			}
+			EXPECT_EQ(std::to_underlying(patch.algorithm()), raw_get(bytes, layout[0], op_id::op1));
+			EXPECT_EQ(std::to_underlying(patch.feedback()), raw_get(bytes, layout[1], op_id::op1));
+			EXPECT_EQ(patch.ams().value, raw_get(bytes, layout[2], op_id::op1));
+			EXPECT_EQ(patch.fms().value, raw_get(bytes, layout[3], op_id::op1));
+		}
+	}
+
+	TEST(operators, writes_like_masking_the_raw_bytes) {
+		std::mt19937 random(49);
+		for(int round = 0; round < 64; round++) {
+			auto bytes = random_bytes(random);
+			auto patch = std::bit_cast<operators>(bytes);
+			for(const auto &raw : layout) {
+				for(const auto &op : list<op_id>()) {
+					const auto value = static_cast<std::uint8_t>(random() & raw.mask);
+					patch.set(describe(raw.id), op, value);
+					raw_set(bytes, raw, op, value);
+					// Every other field in the register and every other register stays as it was
+					ASSERT_EQ(std::bit_cast<raw_bank>(patch), bytes) << describe(raw.id).name;
+				}
+			}
+		}
+	}
+
+	TEST(operators, named_setters_write_the_same_bits) {
+		std::mt19937 random(49);
+		auto bytes = random_bytes(random);
+		auto patch = std::bit_cast<operators>(bytes);
+
+		patch.total_level(op_id::op3, 0x55);
+		raw_set(bytes, layout[6], op_id::op3, 0x55);
+		patch.detune(op_id::op2, operators::detune_mode::minus_2e);
+		raw_set(bytes, layout[4], op_id::op2, 6);
+		patch.amplitude_modulation(op_id::op4, true);
+		raw_set(bytes, layout[9], op_id::op4, 1);
+		patch.ssgeg(op_id::op1, operators::ssgeg_mode::mode5);
+		raw_set(bytes, layout[14], op_id::op1, 13);
+		patch.algorithm(operators::algorithm_mode::mode4);
+		raw_set(bytes, layout[0], op_id::op1, 4);
+		patch.fms(5);
+		raw_set(bytes, layout[3], op_id::op1, 5);
+
+		EXPECT_EQ(std::bit_cast<raw_bank>(patch), bytes);
+	}
+
+	TEST(operators, rejects_or_clamps_values_above_the_field) {
+		operators patch;
+		if constexpr(operators::register_t::policy_type::checks) {
+			EXPECT_THROW(patch.set<field::total_level>(op_id::op1, 0x80), std::overflow_error);
+			EXPECT_THROW(patch.set(describe(field::attack_rate), op_id::op1, 0xFF), std::overflow_error);
+			EXPECT_EQ(std::bit_cast<raw_bank>(patch), raw_bank{}); // Nothing was written
+		} else {
+			patch.set<field::total_level>(op_id::op1, 0xFF);
+			patch.set<field::attack_rate>(op_id::op1, 0xFF);
+			EXPECT_EQ(patch.total_level(op_id::op1), 0x7F);
+			EXPECT_EQ(patch.attack_rate(op_id::op1), 0x1F);
+			EXPECT_EQ(patch.rate_scaling(op_id::op1), operators::rate_scaling_mode::kc8); // The clamp kept out of its neighbour
+		}
+	}
+
+	TEST(operators, takes_the_field_maximum) {
+		operators patch;
+		patch.set<field::total_level>(op_id::op2, 0x7F);
+		patch.set<field::attack_rate>(op_id::op2, 0x1F);
+		EXPECT_EQ(patch.total_level(op_id::op2), 0x7F);
+		EXPECT_EQ(patch.attack_rate(op_id::op2), 0x1F);
+		EXPECT_EQ(patch.rate_scaling(op_id::op2), operators::rate_scaling_mode::kc8);
+	}
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "preview_song.hpp"
+#include "playback/preview_player.hpp"
+
+namespace MID3SMPS {
+	namespace {
+		using playback::preview_player;
+		using playback::song_preview;
+		using namespace test_helpers;
+
+		// Lets a test wait for an amount of audio without reading the samples while the player writes them
+		class counted_sink final : public playback::audio_sink {
+		public:
+			std::vector<std::int16_t> samples{};
+			std::atomic<std::size_t> written = 0;
+
+			void write(const std::span<const std::int16_t> stereo) override {
+				samples.insert(samples.end(), stereo.begin(), stereo.end());
+				written.fetch_add(stereo.size(), std::memory_order_relaxed);
+			}
+		};
+
+		std::unique_ptr<song_preview> make_song() {
+			return std::make_unique<song_preview>(two_notes(), one_patch_bank());
+		}
+
+		// The memory sink never blocks, so the player renders as fast as it can. Gives up after a while instead of hanging the test.
+		template<typename Done>
+		bool wait_for(const Done &done) {
+			const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+			while(!done()) {
+				if(std::chrono::steady_clock::now() > deadline) {
+					return false;
+				}
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			return true;
+		}
+	}
+
+	TEST(preview_player, waits_for_play) {
+		memory_sink sink;
+		{
+			const preview_player player(make_song(), sink);
+			EXPECT_EQ(player.event_count(), 5);
+			EXPECT_EQ(player.cursor(), 0);
+			std::this_thread::sleep_for(std::chrono::milliseconds(30));
+			EXPECT_FALSE(player.playing());
+		}
+		EXPECT_TRUE(sink.samples.empty());
+	}
+
+	TEST(preview_player, plays_the_song_like_rendering_it) {
+		memory_sink sink;
+		{
+			preview_player player(make_song(), sink);
+			ASSERT_TRUE(player.play());
+			ASSERT_TRUE(wait_for([&player] { return player.position() >= player.length() && !player.playing(); }));
+			EXPECT_EQ(player.cursor(), player.event_count());
+		} // Joined, the sink can be read now
+
+		auto song = make_song();
+		EXPECT_EQ(sink.samples, render(*song));
+	}
+
+	TEST(preview_player, plays_from_a_seek) {
+		memory_sink sink;
+		{
+			preview_player player(make_song(), sink);
+			ASSERT_TRUE(player.seek(3));
+			ASSERT_TRUE(player.play());
+			ASSERT_TRUE(wait_for([&player] { return player.position() >= player.length() && !player.playing(); }));
+		}
+
+		auto song = make_song();
+		song->seek(3);
+		EXPECT_EQ(sink.samples, render(*song));
+	}
+
+	TEST(preview_player, stop_goes_back_to_the_start) {
+		memory_sink sink;
+		{
+			preview_player player(make_song(), sink);
+			ASSERT_TRUE(player.seek(3));
+			ASSERT_TRUE(wait_for([&player] { return player.cursor() == 3; }));
+			ASSERT_TRUE(player.stop());
+			ASSERT_TRUE(wait_for([&player] { return player.cursor() == 0; }));
+			EXPECT_EQ(player.position(), 0);
+			EXPECT_FALSE(player.playing());
+		}
+		EXPECT_TRUE(sink.samples.empty());
+	}
+
+	TEST(preview_player, play_after_the_end_starts_over) {
+		auto song       = make_song();
+		const auto once = render(*song);
+		counted_sink sink;
+		{
+			preview_player player(make_song(), sink);
+			ASSERT_TRUE(player.play());
+			ASSERT_TRUE(wait_for([&sink, &once] { return sink.written.load() == once.size(); }));
+			ASSERT_TRUE(wait_for([&player] { return !player.playing(); }));
+			ASSERT_TRUE(player.play());
+			ASSERT_TRUE(wait_for([&sink, &once] { return sink.written.load() == once.size() * 2; }));
+		}
+
+		auto twice = once;
+		twice.insert(twice.end(), once.begin(), once.end());
+		EXPECT_EQ(sink.samples, twice);
+	}
+}
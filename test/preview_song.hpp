@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "containers/files/mid2smps/gyb.hpp"
+#include "containers/midi/event_store.hpp"
+#include "playback/audio_sink.hpp"
+#include "playback/song_preview.hpp"
+
+// A short song and a bank to play it with, shared by the song_preview and preview_player tests
+namespace MID3SMPS::test_helpers {
+	class memory_sink final : public playback::audio_sink {
+	public:
+		std::vector<std::int16_t> samples{};
+
+		void write(const std::span<const std::int16_t> stereo) override {
+			samples.insert(samples.end(), stereo.begin(), stereo.end());
+		}
+	};
+
+	inline constexpr std::uint16_t ticks_per_quarter = 480;
+
+	// Program 0, middle C for a quarter note at the default 120 BPM, then a second note half a beat later
+	[[nodiscard]] inline midi::event_store two_notes() {
+		midi::event_store events;
+		events.ticks_per_quarter(ticks_per_quarter);
+		events.begin_track();
+		events.push(0, 0xC0, 0);
+		events.push(0, 0x90, 60, 100);
+		events.push(ticks_per_quarter, 0x80, 60, 0);
+		events.push(ticks_per_quarter / 2, 0x90, 67, 100);
+		events.push(ticks_per_quarter, 0x80, 67, 0);
+		return events;
+	}
+
+	// One loud patch on program 0, every operator a carrier
+	[[nodiscard]] inline M2S::gyb one_patch_bank() {
+		using op_id = ym2612::operators::op_id;
+		M2S::gyb bank;
+		bank.melody_bank = bank.add_bank("Melody");
+		auto &patch      = bank.add_patch(bank.melody_bank);
+		patch.operators.set<ym2612::field::algorithm>(op_id::op1, 7);
+		for(const auto &op : list<op_id>()) {
+			patch.operators.set<ym2612::field::multiple>(op, 1);
+			patch.operators.set<ym2612::field::total_level>(op, 0);
+			patch.operators.set<ym2612::field::attack_rate>(op, 31);
+			patch.operators.set<ym2612::field::release_rate>(op, 15);
+		}
+		bank.melody_map.write()[0].push_back({0, M2S::gyb::map_entry::all, 0});
+		return bank;
+	}
+
+	// The rest of the song, rendered as fast as it goes
+	[[nodiscard]] inline std::vector<std::int16_t> render(playback::song_preview &preview) {
+		memory_sink sink;
+		preview.render_to(sink);
+		return std::move(sink.samples);
+	}
+}
@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "containers/files/project.hpp"
+#include "exceptions/formatException.hpp"
+#include "helpers/file_io.hpp"
+
+namespace MID3SMPS {
+	namespace {
+		constexpr std::size_t header_size = 16;
+		constexpr std::size_t entry_size  = 24;
+
+		// A file in the temp directory that's removed again when the test is done with it
+		class temp_project {
+			fs::path path_;
+
+		public:
+			explicit temp_project(const std::string &name) : path_(fs::temp_directory_path() / ("MID3SMPS_project_test_" + name + project::extension)) {}
+			temp_project(const temp_project &) = delete;
+			temp_project &operator=(const temp_project &) = delete;
+
+			~temp_project() {
+				std::error_code ignored;
+				fs::remove(path_, ignored);
+			}
+
+			[[nodiscard]] const fs::path &path() const noexcept {
+				return path_;
+			}
+		};
+
+		M2S::mapping paths() {
+			M2S::mapping map;
+			map.gyb("bank.gyb");
+			map.dac_map("drums.txt");
+			map.dac_list("samples.txt");
+			map.psg_list("envelopes.txt");
+			return map;
+		}
+
+		M2S::gyb one_patch() {
+			M2S::gyb bank;
+			bank.melody_bank = bank.add_bank("Melody");
+			auto &patch      = bank.add_patch(bank.melody_bank);
+			patch.name       = "Lead";
+			patch.operators.set<ym2612::field::algorithm>(ym2612::operators::op_id::op1, 4);
+			return bank;
+		}
+
+		M2S::dac_map two_kits() {
+			M2S::dac_map drums;
+			drums.hits.resize(2 * M2S::dac_map::notes);
+			drums.hits[36]                       = {0, 0, 127};
+			drums.hits[M2S::dac_map::notes + 38] = {1, 4, 90};
+			return drums;
+		}
+
+		const std::array<std::uint8_t, 5> kick  = {0x80, 0x81, 0x7F, 0x00, 0xFF};
+		const std::array<std::uint8_t, 3> snare = {0x12, 0x34, 0x56};
+
+		conversion::psg_envelopes two_envelopes() {
+			return {{0x00, 0x01, 0x02, 0x80, 0x03, 0x81}, {0, 4}};
+		}
+
+		// Everything save() can write
+		void save_all(const fs::path &path) {
+			const auto map       = paths();
+			const auto bank      = one_patch().save();
+			const auto drums     = two_kits();
+			const auto envelopes = two_envelopes();
+
+			project::contents contents{
+				.midi          = "song.mid",
+				.settings      = {},
+				.mapping       = &map,
+				.bank          = bank,
+				.drums         = &drums,
+				.sample_format = smps::dac_format::pcm8,
+				.sample_rate   = 17'000,
+				.samples       = {kick, snare},
+				.envelopes     = &envelopes,
+			};
+			contents.settings.ticks_per_quarter    = 480;
+			contents.settings.ticks_multiplier     = 3;
+			contents.settings.pan_law_compensation = true;
+			contents.settings.convert_song_title   = false;
+			project::save(path, contents);
+		}
+
+		// Where a section starts in the file, from its entry in the table
+		std::size_t section_offset(const std::span<const std::uint8_t> file, const project::section id) {
+			const auto count = file[8] | file[9] << 8;
+			for(std::size_t idx = 0; idx < static_cast<std::size_t>(count); idx++) {
+				const auto entry = file.subspan(header_size + idx * entry_size, entry_size);
+				const auto found = static_cast<std::uint32_t>(entry[0] | entry[1] << 8 | entry[2] << 16 | entry[3] << 24);
+				if(found == std::to_underlying(id)) {
+					return static_cast<std::size_t>(entry[8] | entry[9] << 8 | entry[10] << 16);
+				}
+			}
+			ADD_FAILURE() << "No such section";
+			return 0;
+		}
+
+		void write_u32(std::vector<std::uint8_t> &file, const std::size_t at, const std::uint32_t value) {
+			for(std::size_t idx = 0; idx < 4; idx++) {
+				file[at + idx] = static_cast<std::uint8_t>(value >> (idx * 8));
+			}
+		}
+	}
+
+	TEST(project, reads_back_every_section) {
+		const temp_project file("round_trip");
+		save_all(file.path());
+		const project opened(file.path());
+
+		EXPECT_EQ(opened.midi(), "song.mid");
+		const auto settings = opened.settings();
+		EXPECT_EQ(settings.ticks_per_quarter, 480);
+		EXPECT_EQ(settings.ticks_multiplier, 3);
+		EXPECT_TRUE(settings.pan_law_compensation);
+		EXPECT_FALSE(settings.convert_song_title);
+
+		const auto map = opened.mapping();
+		EXPECT_EQ(map.gyb(), "bank.gyb");
+		EXPECT_EQ(map.dac_map(), "drums.txt");
+		EXPECT_EQ(map.dac_list(), "samples.txt");
+		EXPECT_EQ(map.psg_list(), "envelopes.txt");
+
+		EXPECT_EQ(opened.raw(project::section::bank)->size(), one_patch().save().size());
+		const auto bank = opened.bank();
+		ASSERT_EQ(bank.instruments_order->at(bank.melody_bank).size(), 1);
+
+		const auto drums    = opened.drums();
+		const auto expected = two_kits();
+		ASSERT_EQ(drums.hits.size(), expected.hits.size());
+		for(std::size_t idx = 0; idx < drums.hits.size(); idx++) {
+			EXPECT_EQ(drums.hits[idx].sample, expected.hits[idx].sample);
+			EXPECT_EQ(drums.hits[idx].pitch, expected.hits[idx].pitch);
+			EXPECT_EQ(drums.hits[idx].volume, expected.hits[idx].volume);
+		}
+
+		const auto [format, rate, samples] = opened.samples();
+		EXPECT_EQ(format, smps::dac_format::pcm8);
+		EXPECT_EQ(rate, 17'000);
+		ASSERT_EQ(samples.size(), 2);
+		EXPECT_TRUE(std::ranges::equal(samples[0], kick));
+		EXPECT_TRUE(std::ranges::equal(samples[1], snare));
+
+		const auto envelopes = opened.envelopes();
+		EXPECT_TRUE(std::ranges::equal(envelopes.data(), two_envelopes().data()));
+		EXPECT_TRUE(std::ranges::equal(envelopes.offsets(), two_envelopes().offsets()));
+	}
+
+	TEST(project, leaves_empty_parts_out) {
+		const temp_project file("empty");
+		project::save(file.path(), {.midi = "song.mid"});
+		const project opened(file.path());
+
+		EXPECT_TRUE(opened.has(project::section::settings));
+		for(const auto id : {project::section::mapping, project::section::bank, project::section::drums, project::section::samples,
+		                     project::section::envelopes}) {
+			EXPECT_FALSE(opened.has(id));
+		}
+		EXPECT_TRUE(opened.drums().hits.empty());
+		EXPECT_TRUE(opened.samples().data.empty());
+		EXPECT_TRUE(opened.envelopes().offsets().empty());
+	}
+
+	TEST(project, rejects_a_truncated_file) {
+		const temp_project file("truncated");
+		save_all(file.path());
+		auto bytes = read_file(file.path());
+		bytes.resize(section_offset(bytes, project::section::envelopes) + 2);
+		write_file_atomically(file.path(), bytes);
+
+		EXPECT_THROW(project{file.path()}, format_exception);
+	}
+
+	TEST(project, rejects_a_section_count_past_the_table) {
+		const temp_project file("count");
+		save_all(file.path());
+		auto bytes = read_file(file.path());
+		write_u32(bytes, 8, 0xFFFF'FFFF);
+		write_file_atomically(file.path(), bytes);
+
+		EXPECT_THROW(project{file.path()}, format_exception);
+	}
+
+	TEST(project, rejects_a_newer_format_version) {
+		const temp_project file("version");
+		save_all(file.path());
+		auto bytes = read_file(file.path());
+		write_u32(bytes, 4, 2);
+		write_file_atomically(file.path(), bytes);
+
+		EXPECT_THROW(project{file.path()}, format_exception);
+	}
+
+	TEST(project, rejects_an_unknown_dac_format) {
+		const temp_project file("dac_format");
+		save_all(file.path());
+		auto bytes = read_file(file.path());
+		write_u32(bytes, section_offset(bytes, project::section::samples), 0x7F);
+		write_file_atomically(file.path(), bytes);
+
+		const project opened(file.path());
+		EXPECT_NO_THROW(static_cast<void>(opened.envelopes()));
+		EXPECT_THROW(static_cast<void>(opened.samples()), format_exception);
+	}
+
+	TEST(project, rejects_files_that_are_not_projects) {
+		const temp_project file("magic");
+		save_all(file.path());
+		auto bytes = read_file(file.path());
+		bytes[0]   = 'X';
+		write_file_atomically(file.path(), bytes);
+
+		EXPECT_THROW(project{file.path()}, format_exception);
+	}
+}
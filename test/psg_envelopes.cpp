@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "conversion/psg_envelopes.hpp"
+
+namespace MID3SMPS::conversion {
+	namespace {
+		const auto &sonic_1 = smps::profiles[0];
+		const auto &s3k     = smps::profiles[2];
+
+		template<typename T>
+		std::vector<T> to_vector(const std::span<const T> data) {
+			return {data.begin(), data.end()};
+		}
+	}
+
+	TEST(psg_envelopes, ends_classic_envelopes_with_a_hold) {
+		const psg_envelopes compiled(M2S::psg_list("0 1 2\n3 4 stop\n", "psg.txt"), sonic_1);
+
+		ASSERT_EQ(compiled.offsets().size(), 2);
+		EXPECT_EQ(to_vector(compiled.envelope(1)).front(), 0);
+		EXPECT_EQ(to_vector(compiled.data()), (std::vector<std::uint8_t>{0, 1, 2, 0x80, 3, 4, 0x0F, 0x80}));
+		EXPECT_EQ(compiled.offsets()[1], 4);
+	}
+
+	TEST(psg_envelopes, rejects_loops_on_classic_drivers) {
+		const M2S::psg_list list("0 1\n0 2 loop\n", "psg.txt");
+		try {
+			static_cast<void>(psg_envelopes(list, sonic_1));
+			FAIL() << "A looping envelope compiled for Sonic 1";
+		} catch(const std::runtime_error &error) {
+			EXPECT_STREQ(error.what(), "PSG envelope on line 2 loops, which Sonic 1 can't do");
+		}
+	}
+
+	TEST(psg_envelopes, uses_the_s3k_commands) {
+		const psg_envelopes compiled(M2S::psg_list("1 hold\n2 loop\n3 stop\n", "psg.txt"), s3k);
+
+		EXPECT_EQ(to_vector(compiled.envelope(1)).front(), 1);
+		EXPECT_EQ(compiled.data()[compiled.offsets()[0] + 1], 0x81);
+		EXPECT_EQ(compiled.data()[compiled.offsets()[1] + 1], 0x80);
+		EXPECT_EQ(compiled.data()[compiled.offsets()[2] + 1], 0x83);
+	}
+
+	TEST(psg_envelopes, shares_tails_and_duplicates) {
+		// The second is the end of the first and the third repeats the first, only the fourth needs bytes of its own
+		const psg_envelopes compiled(M2S::psg_list("1 2 3\n2 3\n1 2 3\n3 2\n", "psg.txt"), sonic_1);
+
+		EXPECT_EQ(to_vector(compiled.data()), (std::vector<std::uint8_t>{1, 2, 3, 0x80, 3, 2, 0x80}));
+		EXPECT_EQ(to_vector(compiled.offsets()), (std::vector<std::uint16_t>{0, 1, 0, 4}));
+		for(std::size_t id = 1; id <= 4; id++) {
+			EXPECT_EQ(compiled.envelope(id).back(), 0x80);
+		}
+	}
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "containers/files/mid2smps/psg_list.hpp"
+#include "exceptions/formatException.hpp"
+
+namespace MID3SMPS::M2S {
+	namespace {
+		// What parsing text threw, empty if it didn't
+		std::string error_of(const std::string_view text) {
+			try {
+				static_cast<void>(psg_list(text, "psg.txt"));
+			} catch(const format_exception &error) {
+				return error.what();
+			}
+			return {};
+		}
+	}
+
+	TEST(psg_list, reads_levels_names_and_end_modes) {
+		const psg_list list("0 1 2 ; Plain\n"
+		                    "\n"
+		                    "decay: 0 $4 0x8 15 stop\n"
+		                    "tremolo: 0 2 loop # Comment\n"
+		                    "3 hold\n",
+		                    "psg.txt");
+
+		ASSERT_EQ(list.envelopes.size(), 4);
+		EXPECT_EQ(list.envelopes[0].levels, (std::vector<std::uint8_t>{0, 1, 2}));
+		EXPECT_EQ(list.envelopes[0].end, psg_list::end_mode::hold);
+		EXPECT_EQ(list.envelopes[1].name, "decay");
+		EXPECT_EQ(list.envelopes[1].levels, (std::vector<std::uint8_t>{0, 4, 8, 15}));
+		EXPECT_EQ(list.envelopes[1].end, psg_list::end_mode::stop);
+		EXPECT_EQ(list.envelopes[1].line, 3);
+		EXPECT_EQ(list.envelopes[2].end, psg_list::end_mode::loop);
+		EXPECT_EQ(list.envelopes[3].end, psg_list::end_mode::hold);
+	}
+
+	TEST(psg_list, finds_envelopes_by_name) {
+		const psg_list list("0\ndecay: 0 4 8\ntremolo: 0 2 loop\n", "psg.txt");
+		EXPECT_EQ(list.find("decay"), 2);
+		EXPECT_EQ(list.find("tremolo"), 3);
+		EXPECT_EQ(list.find("missing"), std::nullopt);
+	}
+
+	TEST(psg_list, names_both_lines_of_a_duplicate_name) {
+		EXPECT_EQ(error_of("decay: 0 4\n0\ndecay: 1\n"), "psg.txt:3: Envelope 'decay' is already defined on line 1");
+	}
+
+	TEST(psg_list, rejects_malformed_lines) {
+		EXPECT_EQ(error_of("0 16\n"), "psg.txt:1: Invalid level '16', levels go from 0 to 15");
+		EXPECT_EQ(error_of("0 loud\n"), "psg.txt:1: Invalid level 'loud', levels go from 0 to 15");
+		EXPECT_EQ(error_of("name: stop\n"), "psg.txt:1: Envelope has no levels");
+		EXPECT_EQ(error_of(": 0 1\n"), "psg.txt:1: Missing envelope name before ':'");
+		EXPECT_EQ(error_of("0 1 loop 2\n"), "psg.txt:1: Unexpected text after 'loop' '2'");
+	}
+}
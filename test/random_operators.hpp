@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "containers/chips/ym2612/operators.hpp"
+
+// Random patches and the YM2612 register layout written out by hand, shared by the tests that check the accessors
+namespace MID3SMPS::ym2612::test_helpers {
+	using raw_bank = std::array<std::uint8_t, sizeof(operators)>;
+
+	// Independent of field_table, so a mistake there doesn't show up on both sides
+	struct raw_field {
+		field id;
+		std::size_t row; // 30, 40, ... B0 in steps of 0x10
+		std::size_t slot; // For the channel fields, operator fields use the operator's slot
+		int shift;
+		std::uint8_t mask;
+	};
+	inline constexpr std::array<raw_field, field_count> layout = {{
+		{field::algorithm, 7, 0, 0, 0x07},
+		{field::feedback, 7, 0, 3, 0x07},
+		{field::ams, 7, 1, 4, 0x03},
+		{field::fms, 7, 1, 0, 0x07},
+		{field::detune, 0, 0, 4, 0x07},
+		{field::multiple, 0, 0, 0, 0x0F},
+		{field::total_level, 1, 0, 0, 0x7F},
+		{field::rate_scaling, 2, 0, 6, 0x03},
+		{field::attack_rate, 2, 0, 0, 0x1F},
+		{field::amplitude_modulation, 3, 0, 7, 0x01},
+		{field::decay_rate, 3, 0, 0, 0x1F},
+		{field::sustain_rate, 4, 0, 0, 0x1F},
+		{field::sustain_level, 5, 0, 4, 0x0F},
+		{field::release_rate, 5, 0, 0, 0x0F},
+		{field::ssgeg, 6, 0, 0, 0x0F},
+	}};
+
+	[[nodiscard]] inline std::size_t raw_index(const raw_field &raw, const operators::op_id op) {
+		return raw.row * 4 + (is_channel_field(raw.id) ? raw.slot : std::to_underlying(op));
+	}
+
+	[[nodiscard]] inline std::uint8_t raw_get(const raw_bank &bytes, const raw_field &raw, const operators::op_id op) {
+		return static_cast<std::uint8_t>(bytes[raw_index(raw, op)] >> raw.shift & raw.mask);
+	}
+
+	inline void raw_set(raw_bank &bytes, const raw_field &raw, const operators::op_id op, const std::uint8_t value) {
+		auto &target = bytes[raw_index(raw, op)];
+		target       = static_cast<std::uint8_t>((target & ~(raw.mask << raw.shift)) | (value & raw.mask) << raw.shift);
+	}
+
+	// Every bit random, including the ones no field uses
+	[[nodiscard]] inline raw_bank random_bytes(std::mt19937 &random) {
+		raw_bank bytes{};
+		for(auto &byte : bytes) {
+			byte = static_cast<std::uint8_t>(random());
+		}
+		return bytes;
+	}
+
+	[[nodiscard]] inline std::vector<operators> random_patches(const std::size_t count, const std::mt19937::result_type seed = 0x4D3353) {
+		std::mt19937 random(seed);
+		std::vector<operators> patches(count);
+		for(auto &patch : patches) {
+			patch = std::bit_cast<operators>(random_bytes(random));
+		}
+		return patches;
+	}
+}
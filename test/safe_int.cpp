@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+#include "helpers/safe_int.hpp"
+
+namespace MID3SMPS {
+	namespace {
+		using checked_u8  = safe_int<std::uint8_t, safe_int_policy::checked>;
+		using checked_i8  = safe_int<std::int8_t, safe_int_policy::checked>;
+		using wrapping_u8 = safe_int<std::uint8_t, safe_int_policy::wrapping>;
+		using wrapping_i8 = safe_int<std::int8_t, safe_int_policy::wrapping>;
+	}
+
+	TEST(safe_int, checked_does_plain_arithmetic_that_fits) {
+		const checked_u8 value = 200;
+		EXPECT_EQ((value + 55).value, 255);
+		EXPECT_EQ((value - 200).value, 0);
+		EXPECT_EQ((checked_u8{15} * 17).value, 255);
+		EXPECT_EQ((value / 3).value, 66);
+		EXPECT_EQ((value % 3).value, 2);
+		EXPECT_EQ((checked_u8{1} << 7).value, 0x80);
+		EXPECT_EQ((value >> 7).value, 1);
+	}
+
+	TEST(safe_int, checked_throws_on_overflow) {
+		const checked_u8 value = 200;
+		EXPECT_THROW((void)(value + 56), std::overflow_error);
+		EXPECT_THROW((void)(value - 201), std::overflow_error);
+		EXPECT_THROW((void)(value * 2), std::overflow_error);
+		EXPECT_THROW((void)(checked_i8{-128} / -1), std::overflow_error);
+		EXPECT_THROW((void)(checked_u8{0x81} << 1), std::overflow_error);
+
+		auto counter = checked_u8{255};
+		EXPECT_THROW(++counter, std::overflow_error);
+		auto signed_counter = checked_i8{-128};
+		EXPECT_THROW(--signed_counter, std::overflow_error);
+	}
+
+	TEST(safe_int, checked_throws_on_values_that_dont_fit) {
+		EXPECT_THROW((void)checked_u8(256), std::overflow_error);
+		EXPECT_THROW((void)checked_u8(-1), std::overflow_error);
+		EXPECT_THROW((void)(checked_u8{1} + 300), std::overflow_error);
+	}
+
+	TEST(safe_int, checked_throws_on_out_of_range_shifts) {
+		const checked_u8 value = 1;
+		EXPECT_THROW((void)(value << 8), std::overflow_error);
+		EXPECT_THROW((void)(value >> 8), std::overflow_error);
+		EXPECT_THROW((void)(checked_i8{1} << -1), std::overflow_error);
+		EXPECT_THROW((void)(checked_i8{-1} << 1), std::overflow_error); // Shifting a negative value left
+	}
+
+	TEST(safe_int, checked_throws_on_division_by_zero) {
+		const checked_u8 value = 42;
+		EXPECT_THROW((void)(value / 0), std::overflow_error);
+		EXPECT_THROW((void)(value % 0), std::overflow_error);
+		EXPECT_THROW((void)(value / checked_u8{0}), std::overflow_error);
+	}
+
+	TEST(safe_int, wrapping_wraps) {
+		const wrapping_u8 value = 200;
+		EXPECT_EQ((value + 56).value, 0);
+		EXPECT_EQ((value - 201).value, 255);
+		EXPECT_EQ((value * 2).value, 144);
+		EXPECT_EQ((wrapping_u8{0x81} << 1).value, 0x02);
+		EXPECT_EQ((wrapping_i8{127} + 1).value, -128);
+		EXPECT_EQ(wrapping_u8(300).value, 44);
+
+		auto counter = wrapping_u8{255};
+		++counter;
+		EXPECT_EQ(counter.value, 0);
+		--counter;
+		EXPECT_EQ(counter.value, 255);
+	}
+
+	TEST(safe_int, policies_agree_when_nothing_overflows) {
+		for(int lhs = 0; lhs < 256; lhs += 7) {
+			for(int rhs = 1; rhs < 256; rhs += 11) {
+				const auto checked  = checked_u8(lhs);
+				const auto wrapping = wrapping_u8(lhs);
+				if(lhs + rhs <= std::numeric_limits<std::uint8_t>::max()) {
+					EXPECT_EQ((checked + rhs).value, (wrapping + rhs).value);
+				}
+				if(lhs >= rhs) {
+					EXPECT_EQ((checked - rhs).value, (wrapping - rhs).value);
+				}
+				EXPECT_EQ((checked / rhs).value, (wrapping / rhs).value);
+				EXPECT_EQ((checked % rhs).value, (wrapping % rhs).value);
+			}
+		}
+	}
+}
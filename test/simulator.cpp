@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "containers/smps/simulator.hpp"
+
+namespace MID3SMPS::smps {
+	namespace {
+		using event_type = simulator::event_type;
+
+		struct logged {
+			std::uint32_t frame;
+			std::uint8_t track;
+			event_type type;
+			std::uint8_t value;
+
+			bool operator==(const logged &) const = default;
+		};
+
+		// Prints something readable when a log doesn't match
+		[[maybe_unused]] void PrintTo(const logged &event, std::ostream *out) {
+			*out << "{frame " << event.frame << ", track " << unsigned{event.track} << ", type " << unsigned{std::to_underlying(event.type)} << ", value "
+			     << unsigned{event.value} << "}";
+		}
+
+		std::vector<logged> log_of(const simulator::result &result) {
+			std::vector<logged> events;
+			for(const auto &[frame, track, type, value] : result.events) {
+				events.push_back({frame, track, type, value});
+			}
+			return events;
+		}
+
+		// A DAC track that plays one sample and stops, and an FM track that loops a note and a rest forever.
+		// Pointers and words are written the way the given driver expects them.
+		std::vector<std::uint8_t> song(const driver_profile &profile, const std::uint8_t tempo) {
+			std::vector<std::uint8_t> data;
+			const auto word = [&](const std::uint16_t value) {
+				const auto high = static_cast<std::uint8_t>(value >> 8);
+				const auto low  = static_cast<std::uint8_t>(value & 0xFF);
+				if(profile.byte_order == std::endian::big) {
+					data.insert(data.end(), {high, low});
+				} else {
+					data.insert(data.end(), {low, high});
+				}
+			};
+			const auto pointer = [&](const std::size_t target) {
+				word(static_cast<std::uint16_t>(target + profile.load_address));
+			};
+			const auto jump = [&](const std::size_t target) {
+				if(profile.pointers == pointer_mode::absolute) {
+					pointer(target);
+				} else {
+					word(static_cast<std::uint16_t>(static_cast<std::ptrdiff_t>(target) - static_cast<std::ptrdiff_t>(data.size()) - 1));
+				}
+			};
+
+			constexpr std::size_t dac_track = 14, fm_track = 17, fm_loop = 19, voices = 26;
+			pointer(voices);
+			data.insert(data.end(), {2, 0, 1, tempo}); // DAC and one FM track, no PSG, divider 1
+			pointer(dac_track);
+			data.insert(data.end(), {0, 0});
+			pointer(fm_track);
+			data.insert(data.end(), {2, 0x10}); // Transposed up two semitones
+
+			// DAC: sample 81 for 6 ticks, then stop
+			data.insert(data.end(), {0x81, 6, 0xF2});
+			// FM: voice 0, then note A1 for 4 ticks, rest for 4 ticks, jump back to the note
+			data.insert(data.end(), {0xEF, 0});
+			EXPECT_EQ(data.size(), fm_loop);
+			data.insert(data.end(), {0xA1, 4, 0x80, 4, 0xF6});
+			jump(fm_loop);
+			EXPECT_EQ(data.size(), voices);
+			return data;
+		}
+
+		const auto &sonic_1 = profiles[0];
+		const auto &sonic_2 = profiles[1];
+	}
+
+	TEST(simulator, reads_the_header) {
+		const auto data = song(sonic_1, 0);
+		const simulator sim(data, sonic_1);
+		ASSERT_EQ(sim.track_count(), 2);
+		EXPECT_EQ(sim.track(0).type, simulator::channel_type::dac);
+		EXPECT_EQ(sim.track(1).type, simulator::channel_type::fm);
+		EXPECT_EQ(sim.track(1).channel, 0);
+		EXPECT_EQ(sim.voice_table(), 26);
+	}
+
+	TEST(simulator, logs_notes_loops_and_stops) {
+		const auto data = song(sonic_1, 0); // A timeout of 256 only skips frame 255
+		simulator sim(data, sonic_1);
+		const auto result = sim.run({.loops = 2});
+
+		EXPECT_TRUE(result.completed);
+		EXPECT_EQ(result.frames, 17);
+		const std::vector<logged> expected = {
+			{0, 1, event_type::volume, 0x10},
+			{0, 0, event_type::note_on, 0x81}, // DAC samples aren't transposed
+			{0, 1, event_type::voice, 0},
+			{0, 1, event_type::note_on, 0xA3},
+			{4, 1, event_type::note_off, 0},
+			{6, 0, event_type::stop, 0},
+			{8, 1, event_type::loop, 1},
+			{8, 1, event_type::note_on, 0xA3},
+			{12, 1, event_type::note_off, 0},
+			{16, 1, event_type::loop, 2},
+			{16, 1, event_type::note_on, 0xA3},
+		};
+		EXPECT_EQ(log_of(result), expected);
+	}
+
+	TEST(simulator, slows_down_with_the_main_tempo) {
+		// A timeout of 2 delays every second frame, so every tick takes two frames
+		const auto data = song(sonic_1, 2);
+		simulator sim(data, sonic_1);
+		const auto events = log_of(sim.run({.loops = 1}));
+
+		const std::vector<logged> expected = {
+			{0, 1, event_type::volume, 0x10},
+			{0, 0, event_type::note_on, 0x81},
+			{0, 1, event_type::voice, 0},
+			{0, 1, event_type::note_on, 0xA3},
+			{8, 1, event_type::note_off, 0},
+			{12, 0, event_type::stop, 0},
+			{16, 1, event_type::loop, 1},
+			{16, 1, event_type::note_on, 0xA3},
+		};
+		EXPECT_EQ(events, expected);
+	}
+
+	TEST(simulator, plays_the_same_song_on_every_driver) {
+		const auto classic = song(sonic_1, 0);
+		const auto z80     = song(sonic_2, 0xFF);
+		simulator first(classic, sonic_1);
+		simulator second(z80, sonic_2);
+		const auto first_result  = first.run({.loops = 3});
+		const auto second_result = second.run({.loops = 3});
+		ASSERT_TRUE(first_result.completed);
+		ASSERT_TRUE(second_result.completed);
+
+		// Timing differs between the tempo modes, what gets played doesn't
+		ASSERT_EQ(first_result.events.size(), second_result.events.size());
+		for(std::size_t idx = 0; idx < first_result.events.size(); idx++) {
+			EXPECT_EQ(first_result.events[idx].track, second_result.events[idx].track);
+			EXPECT_EQ(first_result.events[idx].type, second_result.events[idx].type);
+			EXPECT_EQ(first_result.events[idx].value, second_result.events[idx].value);
+		}
+	}
+
+	TEST(simulator, stops_at_the_frame_limit) {
+		const auto data = song(sonic_1, 0);
+		simulator sim(data, sonic_1);
+		const auto result = sim.run({.loops = 200, .max_frames = 100});
+		EXPECT_FALSE(result.completed);
+		EXPECT_EQ(result.frames, 100);
+	}
+
+	TEST(simulator, rejects_data_that_runs_out) {
+		auto data = song(sonic_1, 0);
+		data.resize(20); // Cuts the FM track off in the middle of its loop
+		simulator sim(data, sonic_1);
+		EXPECT_THROW((void)sim.run({.loops = 2}), std::runtime_error);
+	}
+
+	TEST(simulator, rejects_a_track_that_never_reaches_a_note) {
+		auto data = song(sonic_1, 0);
+		// The FM loop becomes a jump to itself
+		data[19] = 0xF6;
+		data[20] = 0xFF;
+		data[21] = 0xFE;
+		simulator sim(data, sonic_1);
+		EXPECT_THROW((void)sim.run({.loops = 2}), std::runtime_error);
+	}
+
+	TEST(simulator, maps_smps_notes_to_midi) {
+		EXPECT_EQ(simulator::midi_note(0x81), 12);
+		EXPECT_EQ(simulator::midi_note(0xA3), 46);
+	}
+}
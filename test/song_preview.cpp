@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "preview_song.hpp"
+#include "playback/wav_writer.hpp"
+
+namespace MID3SMPS {
+	namespace {
+		using playback::song_preview;
+		using namespace test_helpers;
+	}
+
+	TEST(song_preview, renders_the_whole_song) {
+		song_preview preview(two_notes(), one_patch_bank());
+		ASSERT_EQ(preview.event_count(), 5);
+
+		const auto samples = render(preview);
+		EXPECT_TRUE(preview.finished());
+		EXPECT_EQ(samples.size(), preview.length() * 2);
+		EXPECT_TRUE(std::ranges::any_of(samples, [](const std::int16_t sample) noexcept { return sample != 0; }));
+	}
+
+	TEST(song_preview, falls_back_to_the_psg_without_an_instrument) {
+		song_preview preview(two_notes(), M2S::gyb{});
+		const auto samples = render(preview);
+		EXPECT_TRUE(std::ranges::any_of(samples, [](const std::int16_t sample) noexcept { return sample != 0; }));
+	}
+
+	TEST(song_preview, renders_nothing_for_an_empty_song) {
+		song_preview empty(midi::event_store{}, one_patch_bank());
+		EXPECT_EQ(empty.length(), 0);
+		EXPECT_TRUE(render(empty).empty());
+	}
+
+	TEST(song_preview, renders_the_same_audio_every_time) {
+		song_preview first(two_notes(), one_patch_bank());
+		song_preview second(two_notes(), one_patch_bank());
+		EXPECT_EQ(render(first), render(second));
+	}
+
+	TEST(song_preview, seeks_by_event_index) {
+		song_preview preview(two_notes(), one_patch_bank());
+		const auto quarter = static_cast<std::uint64_t>(std::llround(song_preview::sample_rate * 0.5));
+
+		preview.seek(2);
+		EXPECT_EQ(preview.cursor(), 2);
+		EXPECT_EQ(preview.position(), quarter);
+
+		preview.seek(3);
+		EXPECT_EQ(preview.position(), static_cast<std::uint64_t>(std::llround(song_preview::sample_rate * 0.75)));
+
+		preview.seek(preview.event_count() + 10);
+		EXPECT_EQ(preview.cursor(), preview.event_count());
+		EXPECT_TRUE(preview.finished());
+	}
+
+	TEST(song_preview, seeking_back_to_the_start_replays_the_song) {
+		song_preview preview(two_notes(), one_patch_bank());
+		const auto first = render(preview);
+		preview.seek(0);
+		EXPECT_EQ(render(preview), first);
+	}
+
+	TEST(song_preview, writes_a_wav_file) {
+		const auto path = std::filesystem::temp_directory_path() / "MID3SMPS_song_preview_test.wav";
+		song_preview preview(two_notes(), one_patch_bank());
+		std::uint32_t frames = 0;
+		{
+			playback::wav_writer wav(path, song_preview::sample_rate);
+			preview.render_to(wav);
+			frames = wav.frames_written();
+		}
+		EXPECT_EQ(frames, preview.length());
+
+		std::ifstream file(path, std::ios::binary);
+		const std::vector<char> bytes{std::istreambuf_iterator(file), std::istreambuf_iterator<char>()};
+		file.close();
+		std::filesystem::remove(path);
+
+		ASSERT_EQ(bytes.size(), 44 + std::size_t{frames} * 4);
+		EXPECT_EQ(std::string_view(bytes.data(), 4), "RIFF");
+		EXPECT_EQ(std::string_view(bytes.data() + 8, 4), "WAVE");
+		EXPECT_EQ(std::string_view(bytes.data() + 36, 4), "data");
+	}
+}
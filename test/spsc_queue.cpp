@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "helpers/spsc_queue.hpp"
+
+namespace MID3SMPS {
+	TEST(spsc_queue, pops_in_the_order_pushed) {
+		spsc_queue<int, 4> queue;
+		EXPECT_TRUE(queue.empty());
+		EXPECT_FALSE(queue.pop().has_value());
+
+		EXPECT_TRUE(queue.push(1));
+		EXPECT_TRUE(queue.push(2));
+		EXPECT_FALSE(queue.empty());
+		EXPECT_EQ(queue.pop(), 1);
+		EXPECT_EQ(queue.pop(), 2);
+		EXPECT_TRUE(queue.empty());
+	}
+
+	TEST(spsc_queue, refuses_items_once_full) {
+		spsc_queue<int, 4> queue;
+		for(int item = 0; item < 4; item++) {
+			EXPECT_TRUE(queue.push(item));
+		}
+		EXPECT_FALSE(queue.push(4));
+		EXPECT_EQ(queue.pop(), 0);
+		EXPECT_TRUE(queue.push(4)); // Room again, and it wraps around
+		for(int item = 1; item <= 4; item++) {
+			EXPECT_EQ(queue.pop(), item);
+		}
+	}
+
+	TEST(spsc_queue, moves_spans_as_far_as_they_fit) {
+		spsc_queue<std::int16_t, 8> queue;
+		const std::array<std::int16_t, 6> first{1, 2, 3, 4, 5, 6};
+		EXPECT_EQ(queue.push(first), 6);
+		EXPECT_EQ(queue.push(first), 2); // Only the front of it fits
+
+		std::array<std::int16_t, 5> out{};
+		EXPECT_EQ(queue.pop(out), 5);
+		EXPECT_EQ(out, (std::array<std::int16_t, 5>{1, 2, 3, 4, 5}));
+		EXPECT_EQ(queue.push(first), 5); // Across the end of the storage
+
+		std::array<std::int16_t, 16> rest{};
+		EXPECT_EQ(queue.pop(rest), 8);
+		EXPECT_EQ(std::vector(rest.begin(), rest.begin() + 8), (std::vector<std::int16_t>{6, 1, 2, 1, 2, 3, 4, 5}));
+		EXPECT_EQ(queue.pop(rest), 0);
+	}
+
+	TEST(spsc_queue, hands_everything_over_between_threads) {
+		constexpr int count = 100000;
+		spsc_queue<int, 64> queue;
+		std::thread producer([&queue] {
+			for(int item = 0; item < count;) {
+				if(queue.push(item)) {
+					item++;
+				}
+			}
+		});
+
+		std::vector<int> received;
+		received.reserve(count);
+		while(received.size() < count) {
+			if(const auto item = queue.pop()) {
+				received.push_back(*item);
+			}
+		}
+		producer.join();
+
+		std::vector<int> expected(count);
+		std::iota(expected.begin(), expected.end(), 0);
+		EXPECT_EQ(received, expected);
+	}
+}